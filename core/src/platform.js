@@ -1,4 +1,4 @@
-import { nativeFunction, globalOf, getSecurityToken, setSecurityToken, setFunctionName } from '@dragiyski/v8-extensions';
+import { nativeFunction, globalOf, setFunctionName, SecurityScope } from '@dragiyski/v8-extensions';
 import { createContext, runInContext, compileFunction, Script } from 'node:vm';
 import Namespace from './namespace.js';
 import { copyPrimordials } from './primordials.js';
@@ -10,11 +10,9 @@ export default class Platform extends Namespace {
     #context;
     #execute;
     #executionState;
-    #securityStack = [];
-    #unlockToken;
-    #lockToken;
+    #security;
     #captureStackTrace;
-    #nativeError;
+    #errorTable;
     #thrown = new WeakSet();
     #expose;
 
@@ -64,8 +62,10 @@ export default class Platform extends Namespace {
         // Since the constructor will be different from this context Function.prototype, it won't have a name, so rename it.
         setFunctionName(realmGlobal.constructor, globalName);
         const realmObject = Object.create(null);
-        this.#unlockToken = getSecurityToken(realmGlobal);
-        this.#lockToken = Object.create(null);
+        // The lock/unlock state stack and the security token switch are native, bound to the realm context once.
+        this.#security = new SecurityScope(realmGlobal, {
+            stateError: Platform.SecurityStateError
+        });
         Object.defineProperties(this, {
             global: {
                 value: realmGlobal
@@ -81,12 +81,17 @@ export default class Platform extends Namespace {
         this.setImplementation(realmGlobal, Object.create(null));
         this.setImplementation(realmObject, Object.create(null));
         copyPrimordials(this.primordials, this.global);
-        this.#nativeError = Object.getOwnPropertyNames(realmGlobal)
-            .filter(name => (
+        // Prototype of a native error class of this context -> the constructor of the same class in the platform context.
+        this.#errorTable = new Map();
+        for (const name of Object.getOwnPropertyNames(realmGlobal)) {
+            if (
                 typeof realmGlobal[name] === 'function' &&
-                this.call(this.primordials['Function.prototype.[Symbol.hasInstance]'], this.primordials.Error, realmGlobal[name].prototype)
-            ));
-        this.#nativeError.push('Error');
+                typeof globalThis[name] === 'function' &&
+                (name === 'Error' || this.call(this.primordials['Function.prototype.[Symbol.hasInstance]'], this.primordials.Error, realmGlobal[name].prototype))
+            ) {
+                this.#errorTable.set(globalThis[name].prototype, this.primordials[name]);
+            }
+        }
         this.#captureStackTrace = this.compileFunction(`platform.enterLock();
 try {
     platform.call(platform.primordials['Error.captureStackTrace'], platform.primordials.Error, object, constructor);
@@ -285,20 +290,19 @@ try {
             return this.interfaceOf(e);
         }
         let prototype = Object.getPrototypeOf(e);
-        const errors = this.#nativeError.map(name => globalThis[name].prototype);
-        let name = 'Error';
+        let constructor = this.primordials.Error;
         while (prototype != null) {
-            const index = errors.indexOf(prototype);
-            if (index >= 0) {
-                name = this.#nativeError[index];
+            const value = this.#errorTable.get(prototype);
+            if (value != null) {
+                constructor = value;
                 break;
             }
             prototype = Object.getPrototypeOf(prototype);
         }
-        if (name === 'AggregateError') {
+        if (constructor === this.primordials.AggregateError) {
             return this.remapAggregateError(e);
         }
-        return this.remapGenericError(e, name);
+        return this.remapGenericError(e, constructor);
     }
 
     // AggregateError may contain multiple errors.
@@ -328,7 +332,7 @@ try {
         return errorInterface;
     }
 
-    remapGenericError(errorImpl, name) {
+    remapGenericError(errorImpl, constructor) {
         const args = [];
         if (errorImpl instanceof Error) {
             const message = errorImpl.message;
@@ -342,7 +346,7 @@ try {
                 };
             }
         }
-        const errorInterface = new this.primordials[name](...args);
+        const errorInterface = new constructor(...args);
         this.setImplementation(errorInterface, errorImpl);
         this.captureStackTrace(errorInterface);
         return errorInterface;
@@ -371,72 +375,25 @@ try {
     }
 
     enterLock() {
-        if (this.#securityStack.length > 0) {
-            const top = this.#securityStack[0];
-            if (top.lock) {
-                top.ref++;
-                return this;
-            }
-        }
-        this.#securityStack.unshift({
-            lock: true,
-            ref: 1
-        });
-        setSecurityToken(this.global, this.#lockToken);
+        this.#security.enterLock();
         this.#executionState = this.#executeLocked;
+        return this;
     }
 
     leaveLock() {
-        if (this.#securityStack.length <= 0) {
-            throw new Platform.SecurityStateError('Attempting to leave non-existent state');
-        }
-        const top = this.#securityStack[0];
-        if (!top.lock) {
-            throw new Platform.SecurityStateError('Attempting to leave locked state of unlocked platform');
-        }
-        if (--top.ref <= 0) {
-            this.#securityStack.shift();
-            if (this.#securityStack.length > 0 && this.#securityStack[0].lock) {
-                return this;
-            }
-            setSecurityToken(this.global, this.#unlockToken);
-            this.#executionState = this.#executeDirect;
-        }
+        this.#executionState = this.#security.leaveLock() ? this.#executeLocked : this.#executeDirect;
         return this;
     }
 
     enterUnlock() {
-        if (this.#securityStack.length > 0) {
-            const top = this.#securityStack[0];
-            if (!top.lock) {
-                top.ref++;
-                return this;
-            }
-        }
-        this.#securityStack.unshift({
-            lock: false,
-            ref: 1
-        });
-        setSecurityToken(this.global, this.#unlockToken);
+        this.#security.enterUnlock();
         this.#executionState = this.#executeDirect;
+        return this;
     }
 
     leaveUnlock() {
-        if (this.#securityStack.length <= 0) {
-            throw Platform.SecurityStateError('Attempting to leave non-existent state');
-        }
-        const top = this.#securityStack[0];
-        if (top.lock) {
-            throw Platform.SecurityStateError('Attempting to leave unlocked state of locked platform');
-        }
-        if (--top.ref <= 0) {
-            this.#securityStack.shift();
-            if (this.#securityStack.length > 0 && this.#securityStack[0].lock) {
-                setSecurityToken(this.global, this.#lockToken);
-                this.#executionState = this.#executeLocked;
-            }
-            // When the security stack is empty, the platform is left unlocked.
-        }
+        // When the security stack is empty, the platform is left unlocked.
+        this.#executionState = this.#security.leaveUnlock() ? this.#executeLocked : this.#executeDirect;
         return this;
     }
 
@@ -0,0 +1,48 @@
+// Compile and call a large function in fresh worker isolates, with each "compileOptions" mode. One source calls most of its
+// helpers ("hot"), the other only a few ("cold"). The adaptive policy is first trained in the main isolate; the workers see
+// the decisions through the process-wide table, but have no compilation cache of their own.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/compile-policy.cjs [helpers] [repetitions]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const helpers = Number(process.argv[2] ?? 3000);
+const repetitions = Number(process.argv[3] ?? 5);
+
+const { Context, IsolatePool } = native;
+const body = [
+    ...Array.from({ length: helpers }, (_, i) => `function helper${i}(v) { let s = 0; for (let k = 0; k < v; ++k) { s += k * ${i}; } return s + ${i}; }`),
+    `const helpers = [${Array.from({ length: helpers }, (_, i) => `helper${i}`).join(', ')}];`
+].join('\n');
+const sources = {
+    hot: `${body}\nfor (let i = 0; i < ${Math.floor(helpers * 0.9)}; ++i) helpers[i](2);`,
+    cold: `${body}\nfor (let i = 0; i < ${Math.floor(helpers * 0.03)}; ++i) helpers[i](2);`
+};
+
+// A decision takes three conclusive observations, each measured at the next compile.
+for (const source of Object.values(sources)) {
+    for (let i = 0; i < 4; ++i) {
+        new Context().compileFunction({ source, compileOptions: 'adaptive' })();
+    }
+}
+const trained = Context.compileStatistics().sources.map(entry => entry.decision).join(', ');
+console.log(`trained: ${trained}`);
+
+(async () => {
+    for (const [name, source] of Object.entries(sources)) {
+        for (const compileOptions of ['eager', 'lazy', 'adaptive']) {
+            let total = 0;
+            for (let i = 0; i < repetitions; ++i) {
+                // A new isolate for every repetition: nothing is left in the compilation cache of V8.
+                const pool = new IsolatePool({ size: 1, exports: 'native' });
+                total += await pool.run(`
+                    const start = Date.now();
+                    new native.Context().compileFunction({ source: ${JSON.stringify(source)}, compileOptions: '${compileOptions}' })();
+                    Date.now() - start;
+                `);
+                pool.close();
+            }
+            console.log(`${name} ${compileOptions}: ${(total / repetitions).toFixed(1)}ms compile + call`);
+        }
+    }
+})();
@@ -0,0 +1,44 @@
+// Create an error that is caught and discarded (feature detection), and one whose stack is read, comparing the JavaScript
+// constructor followed by Error.captureStackTrace() with the native createError().
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/create-error.cjs [iterations]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const iterations = Number(process.argv[2] ?? 200000);
+const { createError } = native;
+
+function javascript() {
+    const error = new TypeError('Illegal invocation');
+    Error.captureStackTrace(error, javascript);
+    return error;
+}
+
+function nativeError() {
+    return createError('TypeError', 'Illegal invocation', { constructorOpt: nativeError });
+}
+
+function nested(depth, create) {
+    return depth > 0 ? nested(depth - 1, create) : create();
+}
+
+function measure(name, create, read) {
+    let sink = 0;
+    for (let i = 0; i < 10000; ++i) {
+        const error = nested(20, create);
+        sink += read ? error.stack.length : 1;
+    }
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < iterations; ++i) {
+        const error = nested(20, create);
+        sink += read ? error.stack.length : 1;
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${elapsed.toFixed(2)}ms (${(elapsed * 1e6 / iterations).toFixed(1)}ns/error)`);
+    return sink;
+}
+
+measure('javascript, discarded', javascript, false);
+measure('native, discarded', nativeError, false);
+measure('javascript, stack read', javascript, true);
+measure('native, stack read', nativeError, true);
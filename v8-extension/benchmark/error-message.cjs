@@ -0,0 +1,38 @@
+// Throw and catch native errors whose messages are built from several parts: literals, an integer range and
+// converted values, in the one-byte and in the two-byte representation.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/error-message.cjs [iterations]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const iterations = Number(process.argv[2] ?? 200000);
+
+const { idl } = native;
+const octet = idl.enforceRange(idl.octet);
+const mode = idl.enumeration('Mode', ['open', 'closed']);
+
+function measure(name, convert, value) {
+    let sink = 0;
+    for (let i = 0; i < 10000; ++i) {
+        try {
+            convert(value);
+        } catch (error) {
+            sink += error.message.length;
+        }
+    }
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < iterations; ++i) {
+        try {
+            convert(value);
+        } catch (error) {
+            sink += error.message.length;
+        }
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${elapsed.toFixed(2)}ms (${(elapsed * 1e6 / iterations).toFixed(1)}ns/throw)`);
+    return sink;
+}
+
+measure('range', octet, 256);
+measure('enum (one-byte)', mode, 'half-open');
+measure('enum (two-byte)', mode, 'полуоткрыт');
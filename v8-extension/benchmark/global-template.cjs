@@ -0,0 +1,61 @@
+// Create a sequence of new contexts whose global has a number of interfaces, and use a few of them: interfaces defined on the
+// global after creation, or lazy data properties of the global template (materialized on first access), either
+// Template.LazyDataProperty or an InterfaceRegistry.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/global-template.cjs [interfaces] [used] [contexts]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const interfaces = Number(process.argv[2] ?? 200);
+const used = Number(process.argv[3] ?? 5);
+const contexts = Number(process.argv[4] ?? 200);
+
+const { Context, Template, ObjectTemplate, InterfaceRegistry } = native;
+const names = Array.from({ length: interfaces }, (_, i) => `Interface${i}`);
+const install = `
+    for (const name of names) {
+        const constructor = { [name]: function () {} }[name];
+        constructor.prototype.method = function method() { return name; };
+        Object.defineProperty(globalThis, name, { value: constructor, writable: true, configurable: true });
+    }
+`;
+const use = `return [${names.slice(0, used).join(', ')}].length;`;
+
+function eager() {
+    const context = new Context();
+    context.compileFunction({ source: install, arguments: ['names'] })(names);
+    context.compileFunction({ source: use })();
+}
+
+const installer = new Context().compileFunction({ source: `
+    return function (receiver, holder, name) {
+        const constructor = { [name]: function () {} }[name];
+        constructor.prototype.method = function method() { return name; };
+        return constructor;
+    };
+` })();
+const lazyInterface = new Template.LazyDataProperty({ getter: installer });
+const globalTemplate = new ObjectTemplate({ properties: Object.fromEntries(names.map(name => [name, lazyInterface])) });
+
+function lazy() {
+    new Context({ globalTemplate }).compileFunction({ source: use })();
+}
+
+const registry = new InterfaceRegistry();
+for (const name of names) {
+    registry.register(name, installer);
+}
+
+function registered() {
+    new Context({ globalTemplate: registry }).compileFunction({ source: use })();
+}
+
+for (const [name, create] of Object.entries({ eager, lazy, registered })) {
+    create();
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < contexts; ++i) {
+        create();
+    }
+    const time = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${(time / contexts).toFixed(3)}ms per context (${interfaces} interfaces, ${used} used)`);
+}
@@ -0,0 +1,63 @@
+// Run a fixed number of CPU-bound scripts on IsolatePool instances of increasing size and report the speed-up relative to a
+// single worker isolate, and the parallel efficiency against the number of available CPUs. Sizes double up to maxSize (by
+// default twice the available parallelism, at least 4), so oversubscription is measured as well. Finally the round trip of
+// an empty script (queue, run in a new context, serialize, settle) is measured on a single worker.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/isolate-pool.cjs [tasks] [iterations] [maxSize]
+const { availableParallelism } = require('node:os');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const tasks = Number(process.argv[2] ?? 64);
+const iterations = Number(process.argv[3] ?? 2000000);
+const maxSize = Number(process.argv[4] ?? Math.max(2 * availableParallelism(), 4));
+
+const source = `
+let hash = 0x811c9dc5;
+for (let i = 0; i < ${iterations}; ++i) {
+    hash = Math.imul(hash ^ (i & 0xff), 0x01000193) >>> 0;
+}
+hash;
+`;
+
+async function measure(size) {
+    const pool = new native.IsolatePool({ size });
+    // Warm up every worker.
+    await Promise.all(Array.from({ length: size }, () => pool.run('0')));
+    const start = process.hrtime.bigint();
+    await Promise.all(Array.from({ length: tasks }, () => pool.run(source)));
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    pool.close();
+    return elapsed;
+}
+
+async function roundTrip(count) {
+    const pool = new native.IsolatePool({ size: 1 });
+    await pool.run('0');
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < count; ++i) {
+        await pool.run('0');
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e3;
+    pool.close();
+    return elapsed / count;
+}
+
+(async function () {
+    const parallelism = availableParallelism();
+    const sizes = [];
+    for (let size = 1; size < maxSize; size *= 2) {
+        sizes.push(size);
+    }
+    sizes.push(maxSize);
+    console.log(`${parallelism} available CPU(s), ${tasks} tasks of ${iterations} iterations`);
+    let baseline;
+    for (const size of sizes) {
+        const elapsed = await measure(size);
+        baseline ??= elapsed;
+        const speedup = baseline / elapsed;
+        const efficiency = speedup / Math.min(size, parallelism);
+        console.log(`size ${size}: ${elapsed.toFixed(2)}ms (${speedup.toFixed(2)}x, ${(efficiency * 100).toFixed(0)}% efficiency)`);
+    }
+    console.log(`round trip: ${(await roundTrip(1000)).toFixed(1)}us per empty task`);
+})();
@@ -0,0 +1,40 @@
+// Load a generated multi-megabyte ASCII bundle as a compile source: fs.readFileSync() into a string on the V8 heap versus
+// a MappedSource exposing the mapped file as an external string. The loaded source is compiled and called once to check it.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/mapped-source.cjs [megabytes] [iterations]
+const fs = require('node:fs');
+const os = require('node:os');
+const { join: joinPath, resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const megabytes = Number(process.argv[2] ?? 8);
+const iterations = Number(process.argv[3] ?? 50);
+
+const directory = fs.mkdtempSync(joinPath(os.tmpdir(), 'mapped-source-'));
+const path = joinPath(directory, 'bundle.js');
+{
+    const chunk = 'function f(a, b) { return a + b; } // padding padding padding padding\n';
+    fs.writeFileSync(path, chunk.repeat(Math.ceil(megabytes * 1024 * 1024 / chunk.length)) + 'return 42;\n');
+}
+
+function measure(name, load) {
+    let sink = 0;
+    for (let i = 0; i < 3; ++i) {
+        sink += load().length;
+    }
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < iterations; ++i) {
+        sink += load().length;
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    const result = native.Context.current.compileFunction({ source: load() })();
+    console.log(`${name}: ${elapsed.toFixed(2)}ms (${(elapsed / iterations).toFixed(2)}ms/load, result ${result})`);
+    return sink;
+}
+
+try {
+    measure('readFileSync', () => fs.readFileSync(path, 'utf8'));
+    measure('MappedSource', () => new native.MappedSource(path).source);
+} finally {
+    fs.rmSync(directory, { recursive: true });
+}
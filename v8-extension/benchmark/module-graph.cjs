@@ -0,0 +1,41 @@
+// Link and evaluate a generated module graph in a sequence of new contexts. The first context loads and parses every
+// module; the following contexts consume the code caches kept by the addon (the files are still read on the threadpool).
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/module-graph.cjs [modules] [contexts]
+const fs = require('node:fs');
+const os = require('node:os');
+const { join: joinPath, resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const modules = Number(process.argv[2] ?? 200);
+const contexts = Number(process.argv[3] ?? 10);
+
+const directory = fs.mkdtempSync(joinPath(os.tmpdir(), 'module-graph-'));
+const body = Array.from({ length: 50 }, (_, i) => `export function helper${i}(value) { return value * ${i} + ${i}; }`).join('\n');
+for (let i = 0; i < modules; ++i) {
+    // Every module imports up to two modules with a higher index: a tree of depth log2(modules).
+    const imports = [2 * i + 1, 2 * i + 2].filter(j => j < modules);
+    fs.writeFileSync(joinPath(directory, `m${i}.mjs`), [
+        ...imports.map(j => `import { value as value${j} } from './m${j}.mjs';`),
+        body,
+        `export const value = ${imports.map(j => `value${j}`).join(' + ') || 1};`
+    ].join('\n'));
+}
+const rootPath = joinPath(directory, 'm0.mjs');
+const rootSource = fs.readFileSync(rootPath, 'utf8');
+
+(async () => {
+    try {
+        for (let i = 0; i < contexts; ++i) {
+            const context = new native.Context();
+            const start = process.hrtime.bigint();
+            const module = context.compileModule({ source: rootSource, location: rootPath });
+            await module.link();
+            await module.evaluate();
+            const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+            console.log(`context ${i}: ${elapsed.toFixed(2)}ms (cached ${module.cached}, value ${module.namespace.value})`);
+        }
+    } finally {
+        fs.rmSync(directory, { recursive: true });
+    }
+})();
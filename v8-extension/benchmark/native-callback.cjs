@@ -0,0 +1,63 @@
+// Call small helpers in a hot loop, comparing plain JavaScript, a FunctionTemplate with a JavaScript "function"
+// and a FunctionTemplate with a "native" callback.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/native-callback.cjs [iterations]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const iterations = Number(process.argv[2] ?? 5000000);
+
+const javascript = {
+    stringCompare: (a, b) => a < b ? -1 : a > b ? 1 : 0,
+    clamp: (value, min, max) => Math.min(Math.max(value, min), max),
+    hasFlags: (flags, mask) => (flags & mask) === mask
+};
+
+function fromTemplate(name) {
+    const callee = javascript[name];
+    return new native.FunctionTemplate({
+        function: info => callee(...info.arguments)
+    }).get();
+}
+
+function fromNative(name) {
+    return new native.FunctionTemplate({ native: name }).get();
+}
+
+const cases = {
+    stringCompare: f => {
+        let sum = 0;
+        for (let i = 0; i < iterations; ++i) {
+            sum += f((i & 1) ? 'addEventListener' : 'removeEventListener', 'dispatchEvent');
+        }
+        return sum;
+    },
+    clamp: f => {
+        let sum = 0;
+        for (let i = 0; i < iterations; ++i) {
+            sum += f(i * 0.5, 100.25, 1000.75);
+        }
+        return sum;
+    },
+    hasFlags: f => {
+        let sum = 0;
+        for (let i = 0; i < iterations; ++i) {
+            sum += f(i, 0x5) ? 1 : 0;
+        }
+        return sum;
+    }
+};
+
+function measure(name, loop, callee) {
+    loop(callee);
+    const start = process.hrtime.bigint();
+    loop(callee);
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${elapsed.toFixed(2)}ms (${(elapsed * 1e6 / iterations).toFixed(2)}ns/call)`);
+}
+
+for (const [name, loop] of Object.entries(cases)) {
+    measure(`${name} javascript`, loop, javascript[name]);
+    measure(`${name} template function`, loop, fromTemplate(name));
+    measure(`${name} template native`, loop, fromNative(name));
+}
@@ -0,0 +1,49 @@
+// Measure the overhead of Scheduler: the same generators are drained directly in JavaScript and through the scheduler, with a
+// number of concurrent tasks sharing the CPU.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/scheduler.cjs [steps] [work]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const steps = Number(process.argv[2] ?? 200000);
+const work = Number(process.argv[3] ?? 100);
+
+function* task() {
+    let hash = 0x811c9dc5;
+    for (let i = 0; i < steps; ++i) {
+        for (let j = 0; j < work; ++j) {
+            hash = Math.imul(hash ^ j, 0x01000193) >>> 0;
+        }
+        yield;
+    }
+    return hash;
+}
+
+function direct(count) {
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < count; ++i) {
+        for (const _ of task()) {}
+    }
+    return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+async function scheduled(count, slice) {
+    const scheduler = new native.Scheduler({ slice });
+    const start = process.hrtime.bigint();
+    await Promise.all(Array.from({ length: count }, () => scheduler.run(task)));
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    return { elapsed, stats: scheduler.stats };
+}
+
+(async function () {
+    direct(1);
+    for (const count of [1, 4, 16]) {
+        const baseline = direct(count);
+        console.log(`${count} task(s) direct: ${baseline.toFixed(2)}ms`);
+        for (const slice of [1, 10]) {
+            const { elapsed, stats } = await scheduled(count, slice);
+            const overhead = (elapsed - baseline) * 1e6 / stats.steps;
+            console.log(`${count} task(s) slice ${slice}ms: ${elapsed.toFixed(2)}ms, ${stats.slices} slices, ${stats.preemptions} preemptions, ${overhead.toFixed(1)}ns/step overhead`);
+        }
+    }
+})();
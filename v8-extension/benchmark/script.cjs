@@ -0,0 +1,33 @@
+// Run a generated bootstrap script in a sequence of new contexts: compiled for every context, or compiled once and bound to
+// every context.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/script.cjs [functions] [contexts]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const functions = Number(process.argv[2] ?? 2000);
+const contexts = Number(process.argv[3] ?? 50);
+
+const { Script, Context } = native;
+const body = Array.from({ length: functions }, (_, i) => `globalThis.helper${i} = function helper${i}(value) { return value * ${i} + ${i}; };`);
+// A distinct source per measurement, so V8's in-isolate compilation cache does not serve one from another.
+const source = tag => `// ${tag}\n${body.join('\n')}\nhelper${functions - 1}(1);`;
+
+function measure(name, run) {
+    const realms = Array.from({ length: contexts }, () => new Context());
+    const start = process.hrtime.bigint();
+    for (const context of realms) {
+        run(context);
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${(elapsed / contexts).toFixed(3)}ms per context`);
+}
+
+{
+    let i = 0;
+    measure('compile per context', context => new Script({ source: source(`per-context ${i++}`) }).run(context));
+}
+{
+    const script = new Script({ source: source('shared') });
+    measure('compile once, run', context => script.run(context));
+}
@@ -0,0 +1,26 @@
+// Measure the cost of the trace instrumentation on a native entry point: a FunctionTemplate callback is called with tracing
+// stopped and started. Build with -Dnode_ext_trace=0 to compare against the instrumentation compiled out.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/trace.cjs [calls]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const calls = Number(process.argv[2] ?? 2000000);
+const callback = new native.FunctionTemplate({ function: function () {} }).get();
+
+function measure() {
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < calls; ++i) {
+        callback(i);
+    }
+    return Number(process.hrtime.bigint() - start) / calls;
+}
+
+measure();
+console.log(`available: ${native.Trace.available}`);
+console.log(`stopped: ${measure().toFixed(1)}ns/call`);
+native.Trace.start();
+console.log(`started: ${measure().toFixed(1)}ns/call`);
+native.Trace.stop();
+console.log(`exported: ${native.Trace.export().length} bytes`);
+native.Trace.clear();
@@ -0,0 +1,60 @@
+// Clone 1MB payloads into another context with Context.prototype.transfer() and compare with structuredClone() (which clones
+// within the current context and allocates a new wire buffer per call).
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/value-transfer.cjs [iterations]
+const vm = require('node:vm');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const iterations = Number(process.argv[2] ?? 200);
+const payloadSize = 1024 * 1024;
+
+const target = native.Context.for(vm.runInContext('globalThis', vm.createContext({})));
+
+function createDocument() {
+    const items = [];
+    let size = 0;
+    for (let i = 0; size < payloadSize; ++i) {
+        const item = { id: i, name: `item-${i}`, tags: ['a', 'b', 'c'], price: i * 0.25, active: (i & 1) === 0 };
+        size += JSON.stringify(item).length;
+        items.push(item);
+    }
+    return { items };
+}
+
+const cases = {
+    'json document': {
+        create: createDocument,
+        structuredClone: value => structuredClone(value),
+        transfer: value => target.transfer(value)
+    },
+    'binary (copy)': {
+        create: () => new Uint8Array(payloadSize).fill(1),
+        structuredClone: value => structuredClone(value),
+        transfer: value => target.transfer(value)
+    },
+    'binary (transfer)': {
+        create: () => new Uint8Array(payloadSize).fill(1),
+        structuredClone: value => structuredClone(value, { transfer: [value.buffer] }),
+        transfer: value => target.transfer(value, { transfer: [value.buffer] })
+    }
+};
+
+function measure(name, create, callee) {
+    // A fresh payload per iteration, so that transferred (detached) buffers are not reused.
+    const payloads = Array.from({ length: iterations * 2 }, create);
+    for (let i = 0; i < iterations; ++i) {
+        callee(payloads[i]);
+    }
+    const start = process.hrtime.bigint();
+    for (let i = iterations; i < iterations * 2; ++i) {
+        callee(payloads[i]);
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${(elapsed / iterations).toFixed(3)}ms/op, ${(iterations * payloadSize / 1048576 / (elapsed / 1000)).toFixed(0)}MB/s`);
+}
+
+for (const [name, { create, structuredClone, transfer }] of Object.entries(cases)) {
+    measure(`${name} structuredClone`, create, structuredClone);
+    measure(`${name} Context.transfer`, create, transfer);
+}
@@ -0,0 +1,139 @@
+// Convert a 5-member options dictionary (2 inherited members) from a few object shapes, comparing the classes of
+// whatwg-dom/src/EventTarget.js (extended with the same members) with a converter of the native idl namespace, and
+// report the speedup of the converter against the target of the native conversion library (5x the JavaScript classes).
+// Then call addEventListener(type, callback, options) of the generated bindings (WebIDL.createInterface), which convert
+// all arguments natively, against a JavaScript binding doing the same conversions before calling the implementation:
+// once with the dictionaries above, once with a boolean, which measures the binding itself without the dictionary.
+//
+// Usage: JS_COMPILED_MODULE_PATH=build/Release node benchmark/webidl-dictionary.cjs [iterations]
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH ?? 'build/Release', 'native.node'));
+
+const iterations = Number(process.argv[2] ?? 1000000);
+
+class EventListenerOptions {
+    constructor(options) {
+        this.capture = false;
+        if (options === Object(options)) {
+            this.capture = !!options.capture;
+        }
+    }
+}
+
+class AddEventListenerOptions extends EventListenerOptions {
+    constructor(options) {
+        super(options);
+        this.once = false;
+        this.passive = null;
+        this.priority = 'normal';
+        this.signal = null;
+        if (options === Object(options)) {
+            this.once = !!options.once;
+            if ('passive' in options) {
+                const passive = options.passive;
+                this.passive = passive == null ? null : !!passive;
+            }
+            if (options.priority !== undefined) {
+                this.priority = '' + options.priority;
+            }
+            if (options.signal != null) {
+                if (options.signal !== Object(options.signal)) {
+                    throw new TypeError(`Failed to read the 'signal' property from 'AddEventListenerOptions': The provided value is not of type 'object'.`);
+                }
+                this.signal = options.signal;
+            }
+        }
+    }
+}
+
+const { idl } = native;
+const nativeEventListenerOptions = idl.dictionary({
+    capture: { type: idl.boolean, default: false }
+}, { name: 'EventListenerOptions' });
+const nativeAddEventListenerOptions = idl.dictionary({
+    once: { type: idl.boolean, default: false },
+    passive: idl.nullable(idl.boolean),
+    priority: { type: idl.DOMString, default: 'normal' },
+    signal: { type: idl.nullable(idl.object), default: null }
+}, { name: 'AddEventListenerOptions', parent: nativeEventListenerOptions });
+
+const signal = {};
+const inputs = [
+    { capture: true },
+    { once: true, passive: false },
+    { capture: 1, once: 0, passive: true, priority: 'high', signal },
+    undefined,
+    { passive: null, signal: null }
+];
+
+// Read by the loops, so the conversions are not optimized away.
+let sink = 0;
+
+function measure(name, convert) {
+    for (let i = 0; i < 100000; ++i) {
+        sink += convert(inputs[i % inputs.length]).once ? 1 : 0;
+    }
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < iterations; ++i) {
+        sink += convert(inputs[i % inputs.length]).once ? 1 : 0;
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${elapsed.toFixed(2)}ms (${(elapsed * 1e6 / iterations).toFixed(1)}ns/conversion)`);
+    return elapsed;
+}
+
+const target = 5;
+const javascript = measure('javascript', options => new AddEventListenerOptions(options));
+const converted = measure('native', nativeAddEventListenerOptions);
+const speedup = javascript / converted;
+console.log(`native speedup: ${speedup.toFixed(2)}x (target ${target}x: ${speedup >= target ? 'met' : 'not met'})`);
+
+let calls = 0;
+const implementation = {
+    constructor() {},
+    addEventListener(type, callback, options) {
+        calls += options.once ? 1 : 0;
+    },
+    removeEventListener() {},
+    dispatchEvent() {
+        return true;
+    }
+};
+
+class JavaScriptEventTarget {
+    addEventListener(type, callback, options = undefined) {
+        if (arguments.length < 2) {
+            throw new TypeError(`Failed to execute 'addEventListener' on 'EventTarget': 2 arguments required, but only ${arguments.length} present.`);
+        }
+        type = '' + type;
+        if (callback != null && callback !== Object(callback)) {
+            throw new TypeError(`Failed to execute 'addEventListener' on 'EventTarget': parameter 2 is not of type 'EventListener'.`);
+        }
+        options = typeof options === 'boolean' ? options : new AddEventListenerOptions(options);
+        return implementation.addEventListener.call(this, type, callback ?? null, options);
+    }
+}
+
+const { WebIDL } = native;
+const NativeEventTarget = WebIDL.createInterface('EventTarget', implementation);
+const listener = { handleEvent() {} };
+
+function measureBinding(name, target, options) {
+    for (let i = 0; i < 100000; ++i) {
+        target.addEventListener('type', listener, options[i % options.length]);
+    }
+    const start = process.hrtime.bigint();
+    for (let i = 0; i < iterations; ++i) {
+        target.addEventListener('type', listener, options[i % options.length]);
+    }
+    const elapsed = Number(process.hrtime.bigint() - start) / 1e6;
+    console.log(`${name}: ${elapsed.toFixed(2)}ms (${(elapsed * 1e6 / iterations).toFixed(1)}ns/call)`);
+    return elapsed;
+}
+
+for (const [kind, options] of [['dictionary', inputs], ['boolean', [false, true]]]) {
+    const javascriptBinding = measureBinding(`javascript binding (${kind})`, new JavaScriptEventTarget(), options);
+    const generatedBinding = measureBinding(`generated binding (${kind})`, new NativeEventTarget(), options);
+    console.log(`generated binding speedup (${kind}): ${(javascriptBinding / generatedBinding).toFixed(2)}x`);
+}
+sink += calls;
@@ -1,7 +1,32 @@
 {
+    "variables": {
+        # Set to 0 (node-gyp rebuild -- -Dnode_ext_trace=0) to compile JS_TRACE_SCOPE out entirely.
+        "node_ext_trace%": 1,
+        # The interfaces bound by tools/webidl-bindings.mjs and instantiated by WebIDL.createInterface().
+        "webidl_files": [
+            "webidl/dom.webidl"
+        ]
+    },
     "targets": [
+        {
+            # Subclasses of V8 delegates need the typeinfo of their base, which a V8 built without RTTI does not export.
+            "target_name": "native-no-rtti",
+            "type": "static_library",
+            "cflags": [ "-fPIC" ],
+            "cflags_cc": [
+                "-std=c++20",
+                "-fno-threadsafe-statics"
+            ],
+            "cflags_cc!": [
+                "-std=gnu++17"
+            ],
+            "sources": [
+                "src/value-transfer-delegate.cxx"
+            ]
+        },
         {
             "target_name": "native",
+            "dependencies": [ "native-no-rtti" ],
             "cflags_cc": [
                 "-std=c++20",
                 "-fno-threadsafe-statics"
@@ -11,25 +36,62 @@
                 "-fno-exceptions",
                 "-std=gnu++17"
             ],
+            "include_dirs": [ "src" ],
+            "actions": [
+                {
+                    "action_name": "webidl-bindings",
+                    "inputs": [ "tools/webidl-bindings.mjs", "<@(webidl_files)" ],
+                    "outputs": [ "<(INTERMEDIATE_DIR)/webidl-bindings.cxx" ],
+                    "action": [ "node", "tools/webidl-bindings.mjs", "<@(_outputs)", "<@(webidl_files)" ],
+                    "process_outputs_as_sources": 1,
+                    "message": "Generating WebIDL bindings"
+                }
+            ],
             "sources": [
                 "src/main.cxx",
                 "src/js-string-table.cxx",
                 "src/object.cxx",
+                "src/value-transfer.cxx",
+                "src/trace.cxx",
+                "src/function.cxx",
+                "src/compile-policy.cxx",
+                "src/webidl.cxx",
+                "src/webidl-converter.cxx",
                 "src//api/frozen-map.cxx",
                 "src/api/private.cxx",
                 "src/api/context.cxx",
+                "src/api/security-scope.cxx",
+                "src/api/membrane.cxx",
+                "src/api/isolate-pool.cxx",
+                "src/api/scheduler.cxx",
+                "src/api/profiler.cxx",
+                "src/api/trace.cxx",
+                "src/api/webidl.cxx",
+                "src/api/idl-converter.cxx",
+                "src/api/error-stack.cxx",
+                "src/api/mapped-source.cxx",
+                "src/api/module.cxx",
+                "src/api/script.cxx",
+                "src/api/interface-registry.cxx",
                 "src/api/template.cxx",
                 "src/api/template/lazy-data-property.cxx",
                 "src/api/template/native-data-property.cxx",
+                "src/api/template/internal-field-property.cxx",
+                "src/api/function-template/native-callback.cxx",
                 "src/api/function-template.cxx",
                 "src/api/object-template/accessor-property.cxx",
                 "src/api/object-template/named-property-handler-configuration.cxx",
                 "src/api/object-template/indexed-property-handler-configuration.cxx",
+                "src/api/object-template/named-property-storage.cxx",
+                "src/api/object-template/indexed-property-storage.cxx",
                 "src/api/object-template.cxx",
             ]
         }
     ],
     "target_defaults": {
+        "conditions": [
+            [ "node_ext_trace==1", { "defines": [ "NODE_EXT_TRACE" ] } ]
+        ],
         "default_configuration": "Release",
         "configurations": {
             "Debug": {
@@ -6,6 +6,17 @@ export const useDefaultSecurityToken = binding.useDefaultSecurityToken;
 export const globalOf = binding.globalOf;
 export const getFunctionName = binding.getFunctionName;
 export const Script = binding.Script;
+export const SecurityScope = binding.SecurityScope;
+export const Membrane = binding.Membrane;
+export const IsolatePool = binding.IsolatePool;
+export const Scheduler = binding.Scheduler;
+export const Profiler = binding.Profiler;
+export const Trace = binding.Trace;
+export const WebIDL = binding.WebIDL;
+export const idl = binding.idl;
+export const createError = binding.createError;
+export const MappedSource = binding.MappedSource;
+export const Module = binding.Module;
 
 export function setFunctionName(func, name = '') {
     name = '' + name;
@@ -2,12 +2,49 @@
 
 #include "../js-string-table.hxx"
 #include "../function.hxx"
+#include "../compile-policy.hxx"
+#include "../value-transfer.hxx"
+#include "../trace.hxx"
+#include "membrane.hxx"
+#include "module.hxx"
+#include "object-template.hxx"
+#include "function-template.hxx"
+#include "interface-registry.hxx"
 #include <map>
+#include <string>
+#include <vector>
 
 namespace dragiyski::node_ext {
     namespace {
-        std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
-        std::map<v8::Isolate*, Shared<v8::Private>> per_isolate_class_symbol;
+        thread_local std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate*, Shared<v8::Private>> per_isolate_class_symbol;
+
+        // Contexts disposed by Context.prototype.dispose(), held weakly for Context.leakCheck().
+        struct DisposedContext {
+            Shared<v8::Context> context;
+            std::string label;
+        };
+        thread_local std::map<v8::Isolate*, std::vector<DisposedContext>> per_isolate_disposed_contexts;
+
+        void remove_collected_contexts(std::vector<DisposedContext>& disposed_contexts) {
+            std::erase_if(disposed_contexts, [](const DisposedContext& disposed) {
+                return disposed.context.IsEmpty();
+            });
+        }
+
+        // Whether a function of the target context is on the stack (not only the current or the entered context). V8 does not
+        // expose the context of a frame, but omits from a stack trace the frames of contexts whose security token differs from
+        // the one of the current context: a frame of the target context is counted only while it has the current token.
+        bool has_frames_on_stack(v8::Isolate* isolate, v8::Local<v8::Context> current_context, v8::Local<v8::Context> target_context) {
+            static const constexpr int frame_limit = 1 << 16;
+            auto token = target_context->GetSecurityToken();
+            target_context->SetSecurityToken(current_context->GetSecurityToken());
+            auto visible_frames = v8::StackTrace::CurrentStackTrace(isolate, frame_limit)->GetFrameCount();
+            target_context->SetSecurityToken(v8::Object::New(isolate));
+            auto hidden_frames = v8::StackTrace::CurrentStackTrace(isolate, frame_limit)->GetFrameCount();
+            target_context->SetSecurityToken(token);
+            return visible_frames != hidden_frames;
+        }
     }
 
     void Context::initialize(v8::Isolate* isolate) {
@@ -76,6 +113,32 @@ namespace dragiyski::node_ext {
             value->SetClassName(name);
             class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
         }
+        {
+            auto name = StringTable::Get(isolate, "compileStatistics");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                static_compile_statistics,
+                {},
+                {},
+                0,
+                v8::ConstructorBehavior::kThrow
+            );
+            value->SetClassName(name);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "leakCheck");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                static_leak_check,
+                {},
+                {},
+                0,
+                v8::ConstructorBehavior::kThrow
+            );
+            value->SetClassName(name);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
         {
             auto name = StringTable::Get(isolate, "global");
             auto value = v8::FunctionTemplate::New(
@@ -102,6 +165,45 @@ namespace dragiyski::node_ext {
             value->SetClassName(name);
             prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
         }
+        {
+            auto name = StringTable::Get(isolate, "compileModule");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_compile_module,
+                {},
+                signature,
+                1,
+                v8::ConstructorBehavior::kThrow
+            );
+            value->SetClassName(name);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "transfer");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_transfer,
+                {},
+                signature,
+                1,
+                v8::ConstructorBehavior::kThrow
+            );
+            value->SetClassName(name);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "dispose");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_dispose,
+                {},
+                signature,
+                0,
+                v8::ConstructorBehavior::kThrow
+            );
+            value->SetClassName(name);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
 
         class_template->ReadOnlyPrototype();
         class_template->InstanceTemplate()->SetInternalFieldCount(1);
@@ -118,11 +220,18 @@ namespace dragiyski::node_ext {
             std::forward_as_tuple(isolate, class_template)
         );
 
+        per_isolate_disposed_contexts.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple()
+        );
+
         Object<Context>::initialize(isolate);
     }
 
     void Context::uninitialize(v8::Isolate* isolate) {
         Object<Context>::uninitialize(isolate);
+        per_isolate_disposed_contexts.erase(isolate);
         per_isolate_template.erase(isolate);
         per_isolate_class_symbol.erase(isolate);
     }
@@ -151,29 +260,59 @@ namespace dragiyski::node_ext {
             JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
         }
 
-        // TODO: Allow single argument - a wrapper for object template or function template (whose InstanceTemplate would be used).
-        // if (info.Length() < 1) {
-        //     JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
-        // }
-        // if (!info[0]->IsObject()) {
-        //     JS_THROW_ERROR(TypeError, isolate, "argument 1 is not not an object.");
-        // }
-
         // Access to "object" for global is too complex. The idea of having v8::Local<v8::Value> as global is
         // to reuse it upon creation of multiple contexts. The state of the object (its map) will be changed,
         // thus properties will be reinitialized, but the object identity would remain.
 
         // Instead we shall only access globalTemplate here. This shall be the only way to pre-initialize a context.
         // Anything else must be done by retrieving the global object after context creation.
+        v8::Local<v8::ObjectTemplate> global_template;
+        InterfaceRegistry *interface_registry = nullptr;
+        if (!info[0]->IsNullOrUndefined()) {
+            if (!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "argument 1 is not an object.");
+            }
+            auto options = info[0].As<v8::Object>();
+            auto name = StringTable::Get(isolate, "globalTemplate");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if (!js_value->IsNullOrUndefined()) {
+                // The properties of the template (including lazy data properties) are instantiated by V8 on the new global.
+                if (js_value->IsObject()) {
+                    auto js_object = js_value.As<v8::Object>();
+                    auto object_template = Object<ObjectTemplate>::get_implementation(isolate, js_object);
+                    auto function_template = Object<FunctionTemplate>::get_implementation(isolate, js_object);
+                    if (object_template != nullptr) {
+                        global_template = object_template->get_value(isolate);
+                    } else if (function_template != nullptr) {
+                        global_template = function_template->get_value(isolate)->InstanceTemplate();
+                    } else {
+                        interface_registry = Object<InterfaceRegistry>::get_implementation(isolate, js_object);
+                        if (interface_registry != nullptr) {
+                            global_template = interface_registry->instantiate(isolate);
+                        }
+                    }
+                }
+                if (global_template.IsEmpty()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Option \"globalTemplate\" is not an [object ObjectTemplate], [object FunctionTemplate] or [object InterfaceRegistry]");
+                }
+            }
+        }
 
         auto new_context = v8::Context::New(
             isolate,
             nullptr,
-            {},
+            global_template,
             {},
             v8::DeserializeInternalFieldsCallback(),
             context->GetMicrotaskQueue()
         );
+        if V8_UNLIKELY(new_context.IsEmpty()) {
+            // Instantiating the global template has thrown.
+            return;
+        }
+        if (interface_registry != nullptr) {
+            interface_registry->on_context_created();
+        }
 
         JS_EXPRESSION_IGNORE(new_context->Global()->SetPrivate(context, Context::get_class_symbol(isolate), info.This()));
 
@@ -245,14 +384,16 @@ namespace dragiyski::node_ext {
                 goto create_new_holder;
             }
             auto wrapper_value = wrapper->get_value(isolate);
-            if V8_UNLIKELY(context.IsEmpty()) {
+            if V8_UNLIKELY(wrapper_value.IsEmpty()) {
                 JS_EXPRESSION_IGNORE(global->DeletePrivate(target_context, class_symbol));
                 wrapper->clear_interface(isolate);
+                delete wrapper;
                 goto create_new_holder;
             }
             if V8_UNLIKELY(!wrapper_value->Global()->SameValue(global)) {
                 JS_EXPRESSION_IGNORE(global->DeletePrivate(target_context, class_symbol));
                 wrapper->clear_interface(isolate);
+                delete wrapper;
                 goto create_new_holder;
             }
             return existing_holder.As<v8::Object>();
@@ -315,6 +456,7 @@ namespace dragiyski::node_ext {
     }
 
     void Context::prototype_compile_function(const v8::FunctionCallbackInfo<v8::Value>& info) {
+        JS_TRACE_SCOPE("context", "Context::prototype_compile_function");
         using __function_return_type__ = void;
         auto isolate = info.GetIsolate();
         v8::HandleScope scope(isolate);
@@ -361,7 +503,7 @@ namespace dragiyski::node_ext {
                 if (!js_value->IsArray()) {
                     JS_THROW_ERROR(TypeError, isolate, "option `scopes`: not an array");
                 }
-                arguments = js_value.As<v8::Array>();
+                scopes = js_value.As<v8::Array>();
             }
         }
 
@@ -380,7 +522,7 @@ namespace dragiyski::node_ext {
                 if (!value->IsString()) {
                     JS_THROW_ERROR(TypeError, isolate, "option `arguments[", i, "]`: not a string")
                 }
-                arguments_list[i] = value.As<v8::String>();
+                arguments_list.push_back(value.As<v8::String>());
             }
         }
         auto arguments_data = arguments_length > 0 ? arguments_list.data() : nullptr;
@@ -400,12 +542,15 @@ namespace dragiyski::node_ext {
                 if (!value->IsObject()) {
                     JS_THROW_ERROR(TypeError, isolate, "option `scopes[", i, "]`: not an object")
                 }
-                scopes_list[i] = value.As<v8::Object>();
+                scopes_list.push_back(value.As<v8::Object>());
             }
         }
         auto scopes_data = scopes_length > 0 ? scopes_list.data() : nullptr;
 
-        auto source = source_from_object(context, options);
+        JS_EXPRESSION_RETURN(compile_mode, CompilePolicy::mode_from_object(context, options));
+
+        v8::Local<v8::String> source_string;
+        auto source = source_from_object(context, options, nullptr, &source_string);
         if (!source) {
             return;
         }
@@ -421,14 +566,15 @@ namespace dragiyski::node_ext {
             JS_THROW_ERROR(ReferenceError, isolate, "the wrapped context is already disposed");
         }
 
-        JS_EXPRESSION_RETURN(compiled_function, v8::ScriptCompiler::CompileFunction(
+        JS_EXPRESSION_RETURN(compiled_function, CompilePolicy::compile_function(
             target_context,
             source.get(),
+            source_string,
             arguments_length,
             arguments_data,
             scopes_length,
             scopes_data,
-            v8::ScriptCompiler::kEagerCompile
+            compile_mode
         ));
 
         if (!function_name.IsEmpty()) {
@@ -438,10 +584,192 @@ namespace dragiyski::node_ext {
         info.GetReturnValue().Set(compiled_function);
     }
 
+    void Context::prototype_compile_module(const v8::FunctionCallbackInfo<v8::Value>& info) {
+        JS_TRACE_SCOPE("context", "Context::prototype_compile_module");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if (!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "argument 1 is not not an object.");
+        }
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Context", ".", "prototype", ".", "compileModule", " called on incompatible receiver ", receiver);
+        }
+        auto target_context = implementation->get_value(isolate);
+        if V8_UNLIKELY(target_context.IsEmpty()) {
+            JS_THROW_ERROR(ReferenceError, isolate, "the wrapped context is already disposed");
+        }
+
+        JS_EXPRESSION_RETURN(module, Module::compile(context, target_context, info[0].As<v8::Object>()));
+        info.GetReturnValue().Set(module);
+    }
+
     v8::Local<v8::Context> Context::get_value(v8::Isolate* isolate) const {
         return _value.Get(isolate);
     }
 
+    void Context::prototype_transfer(const v8::FunctionCallbackInfo<v8::Value>& info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Context", ".", "prototype", ".", "transfer", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+
+        std::vector<v8::Local<v8::ArrayBuffer>> transfer_list;
+        if (!info[1]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[1]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "argument 2 is not an object.");
+            }
+            auto options = info[1].As<v8::Object>();
+            auto name = StringTable::Get(isolate, "transfer");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if (!js_value->IsNullOrUndefined()) {
+                if V8_UNLIKELY(!js_value->IsArray()) {
+                    JS_THROW_ERROR(TypeError, isolate, "option `transfer`: not an array");
+                }
+                auto transfer = js_value.As<v8::Array>();
+                auto transfer_length = transfer->Length();
+                transfer_list.reserve(transfer_length);
+                for (decltype(transfer_length) i = 0; i < transfer_length; ++i) {
+                    JS_EXPRESSION_RETURN(value, transfer->Get(context, i));
+                    if V8_UNLIKELY(!value->IsArrayBuffer()) {
+                        JS_THROW_ERROR(TypeError, isolate, "option `transfer[", i, "]`: not an ArrayBuffer");
+                    }
+                    transfer_list.push_back(value.As<v8::ArrayBuffer>());
+                }
+            }
+        }
+
+        auto target_context = implementation->get_value(isolate);
+        if V8_UNLIKELY(target_context.IsEmpty()) {
+            JS_THROW_ERROR(ReferenceError, isolate, "the wrapped context is already disposed");
+        }
+        JS_EXPRESSION_RETURN(result, transfer_value(context, target_context, info[0], transfer_list));
+        info.GetReturnValue().Set(result);
+    }
+
+    void Context::prototype_dispose(const v8::FunctionCallbackInfo<v8::Value>& info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Context", ".", "prototype", ".", "dispose", " called on incompatible receiver ", receiver);
+        }
+
+        bool notify = true;
+        std::string label;
+        if (!info[0]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object, if specified.");
+            }
+            auto options = info[0].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "notify");
+                JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+                if (!js_value->IsUndefined()) {
+                    notify = js_value->BooleanValue(isolate);
+                }
+            }
+            {
+                auto name = StringTable::Get(isolate, "label");
+                JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+                if (!js_value->IsUndefined()) {
+                    JS_EXPRESSION_RETURN(js_label, js_value->ToString(context));
+                    v8::String::Utf8Value utf8_label(isolate, js_label);
+                    label.assign(*utf8_label, utf8_label.length());
+                }
+            }
+        }
+
+        auto target_context = implementation->get_value(isolate);
+        if (target_context.IsEmpty()) {
+            // Already disposed.
+            return;
+        }
+        if V8_UNLIKELY(target_context == context || target_context == isolate->GetEnteredOrMicrotaskContext() || has_frames_on_stack(isolate, context, target_context)) {
+            JS_THROW_ERROR(TypeError, isolate, "Cannot dispose a context while it is running");
+        }
+
+        // Cut every link the addon holds to the context: the wrapper from its global, the membranes, and the wrapper itself.
+        auto global = target_context->Global();
+        JS_EXPRESSION_IGNORE(global->DeletePrivate(target_context, get_class_symbol(isolate)));
+        Membrane::revoke_context(isolate, target_context);
+        target_context->DetachGlobal();
+        implementation->_value.Reset();
+
+        auto& disposed_contexts = per_isolate_disposed_contexts[isolate];
+        remove_collected_contexts(disposed_contexts);
+        disposed_contexts.push_back({ Shared<v8::Context>(isolate, target_context), std::move(label) });
+        disposed_contexts.back().context.SetWeak();
+
+        if (notify) {
+            isolate->ContextDisposedNotification();
+        }
+    }
+
+    void Context::static_leak_check(const v8::FunctionCallbackInfo<v8::Value>& info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        bool collect = true;
+        if (!info[0]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object, if specified.");
+            }
+            auto name = StringTable::Get(isolate, "collect");
+            JS_EXPRESSION_RETURN(js_value, info[0].As<v8::Object>()->Get(context, name));
+            if (!js_value->IsUndefined()) {
+                collect = js_value->BooleanValue(isolate);
+            }
+        }
+        if (collect) {
+            // A full, compacting garbage collection; only what is really reachable survives.
+            isolate->LowMemoryNotification();
+        }
+
+        auto& disposed_contexts = per_isolate_disposed_contexts[isolate];
+        remove_collected_contexts(disposed_contexts);
+        auto result = v8::Array::New(isolate, static_cast<int>(disposed_contexts.size()));
+        for (uint32_t i = 0; i < disposed_contexts.size(); ++i) {
+            auto& label = disposed_contexts[i].label;
+            JS_EXPRESSION_RETURN(js_label, v8::String::NewFromUtf8(isolate, label.data(), v8::NewStringType::kNormal, static_cast<int>(label.size())));
+            JS_EXPRESSION_IGNORE(result->Set(context, i, js_label));
+        }
+        info.GetReturnValue().Set(result);
+    }
+
+    void Context::static_compile_statistics(const v8::FunctionCallbackInfo<v8::Value>& info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        JS_EXPRESSION_RETURN(statistics, CompilePolicy::statistics(context));
+        info.GetReturnValue().Set(statistics);
+    }
+
     Context::Context(v8::Isolate* isolate, v8::Local<v8::Context> value) : 
         _value(isolate, value) {}
 };
\ No newline at end of file
@@ -22,8 +22,13 @@ namespace dragiyski::node_ext {
         static void static_get_incumbent(const v8::FunctionCallbackInfo<v8::Value>& info);
         static void static_get_entered(const v8::FunctionCallbackInfo<v8::Value>& info);
         static void static_for(const v8::FunctionCallbackInfo<v8::Value>& info);
+        static void static_leak_check(const v8::FunctionCallbackInfo<v8::Value>& info);
+        static void static_compile_statistics(const v8::FunctionCallbackInfo<v8::Value>& info);
         static void prototype_get_global(const v8::FunctionCallbackInfo<v8::Value>& info);
         static void prototype_compile_function(const v8::FunctionCallbackInfo<v8::Value>& info);
+        static void prototype_compile_module(const v8::FunctionCallbackInfo<v8::Value>& info);
+        static void prototype_transfer(const v8::FunctionCallbackInfo<v8::Value>& info);
+        static void prototype_dispose(const v8::FunctionCallbackInfo<v8::Value>& info);
     private:
         Shared<v8::Context> _value;
     public:
@@ -0,0 +1,254 @@
+#include "error-stack.hxx"
+
+#include <cassert>
+#include <map>
+#include <string>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::ObjectTemplate>> per_isolate_holder_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::Private>> per_isolate_error_function_symbol;
+
+        const constexpr int default_stack_limit = 10;
+        // The frame details read when the stack is formatted.
+        const constexpr auto stack_trace_options = static_cast<v8::StackTrace::StackTraceOptions>(
+            v8::StackTrace::kOverview | v8::StackTrace::kIsConstructor | v8::StackTrace::kScriptNameOrSourceURL
+        );
+
+        struct ErrorType {
+            const char *name;
+            v8::Local<v8::Value> (*create)(v8::Local<v8::String> message, v8::Local<v8::Value> options);
+        };
+
+        const ErrorType error_types[] = {
+            { "Error", &v8::Exception::Error },
+            { "RangeError", &v8::Exception::RangeError },
+            { "ReferenceError", &v8::Exception::ReferenceError },
+            { "SyntaxError", &v8::Exception::SyntaxError },
+            { "TypeError", &v8::Exception::TypeError }
+        };
+    }
+
+    void ErrorStack::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto function_template = v8::FunctionTemplate::New(isolate, create_error, {}, {}, 2, v8::ConstructorBehavior::kThrow);
+        function_template->SetClassName(StringTable::Get(isolate, "createError"));
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, function_template)
+        );
+
+        auto holder_template = v8::ObjectTemplate::New(isolate);
+        holder_template->SetInternalFieldCount(1);
+        per_isolate_holder_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, holder_template)
+        );
+
+        auto error_function_symbol = v8::Private::New(isolate, StringTable::Get(isolate, "Error"));
+        per_isolate_error_function_symbol.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, error_function_symbol)
+        );
+
+        Object<ErrorStack>::initialize(isolate);
+    }
+
+    void ErrorStack::uninitialize(v8::Isolate *isolate) {
+        Object<ErrorStack>::uninitialize(isolate);
+        per_isolate_error_function_symbol.erase(isolate);
+        per_isolate_holder_template.erase(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> ErrorStack::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    v8::Local<v8::ObjectTemplate> ErrorStack::get_holder_template(v8::Isolate *isolate) {
+        assert(per_isolate_holder_template.contains(isolate));
+        return per_isolate_holder_template[isolate].Get(isolate);
+    }
+
+    v8::Local<v8::Object> ErrorStack::get_error_function(v8::Local<v8::Context> context) {
+        auto isolate = context->GetIsolate();
+        auto symbol = per_isolate_error_function_symbol[isolate].Get(isolate);
+        auto global = context->Global();
+        // Without the Error function the errors are only created with the stack trace of V8, so the lookup never throws.
+        v8::TryCatch try_catch(isolate);
+        v8::Local<v8::Value> cached;
+        if (global->GetPrivate(context, symbol).ToLocal(&cached) && cached->IsFunction()) {
+            return cached.As<v8::Object>();
+        }
+        // The prototype of a new error is the intrinsic Error.prototype of the context.
+        auto error = v8::Exception::Error(v8::String::Empty(isolate)).As<v8::Object>();
+        v8::Local<v8::Value> constructor;
+        if (!error->GetPrototype().As<v8::Object>()->Get(context, StringTable::Get(isolate, "constructor")).ToLocal(&constructor) || !constructor->IsFunction()) {
+            return v8::Local<v8::Object>();
+        }
+        if (global->SetPrivate(context, symbol, constructor).IsNothing()) {
+            return v8::Local<v8::Object>();
+        }
+        return constructor.As<v8::Object>();
+    }
+
+    void ErrorStack::create_error(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        const ErrorType *type = nullptr;
+        if (info[0]->IsString()) {
+            auto name = info[0].As<v8::String>();
+            for (const auto &error_type : error_types) {
+                if (name->StringEquals(StringTable::Get(isolate, std::string_view(error_type.name)).ToLocalChecked())) {
+                    type = &error_type;
+                    break;
+                }
+            }
+        }
+        if (type == nullptr) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be one of \"Error\", \"RangeError\", \"ReferenceError\", \"SyntaxError\" or \"TypeError\".");
+        }
+
+        v8::Local<v8::String> message = v8::String::Empty(isolate);
+        if (!info[1]->IsUndefined()) {
+            JS_EXPRESSION_RETURN(message_string, info[1]->ToString(context));
+            message = message_string;
+        }
+
+        v8::Local<v8::Function> constructor_opt;
+        int limit = default_stack_limit;
+        if (!info[2]->IsNullOrUndefined()) {
+            if (!info[2]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[2] to be an object, if specified.");
+            }
+            auto options = info[2].As<v8::Object>();
+            {
+                JS_EXPRESSION_RETURN(value, options->Get(context, StringTable::Get(isolate, "constructorOpt")));
+                if (!value->IsNullOrUndefined()) {
+                    if (!value->IsFunction()) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"constructorOpt\": not a function.");
+                    }
+                    constructor_opt = value.As<v8::Function>();
+                }
+            }
+            {
+                JS_EXPRESSION_RETURN(value, options->Get(context, StringTable::Get(isolate, "stackLimit")));
+                if (!value->IsUndefined()) {
+                    JS_EXPRESSION_RETURN_WITH_ERROR_PREFIX(number, value->NumberValue(context), context, "Option \"stackLimit\"");
+                    if (!(number >= 0)) {
+                        JS_THROW_ERROR(RangeError, isolate, "Option \"stackLimit\": expected a non-negative number.");
+                    }
+                    limit = number < 1000 ? static_cast<int>(number) : 1000;
+                }
+            }
+        }
+
+        // V8 captures a stack trace for every error it creates, unless Error.stackTraceLimit is not a number. The frames of
+        // the error are captured below, so the capture of V8 is disabled while the error is created.
+        auto stack_trace_limit_name = StringTable::Get(isolate, "stackTraceLimit");
+        auto error_function = get_error_function(context);
+        v8::Local<v8::Value> stack_trace_limit;
+        if (!error_function.IsEmpty()) {
+            JS_EXPRESSION_RETURN(value, error_function->Get(context, stack_trace_limit_name));
+            stack_trace_limit = value;
+            if (value->IsNumber()) {
+                JS_EXPRESSION_IGNORE(error_function->Set(context, stack_trace_limit_name, v8::Integer::New(isolate, 0)));
+            }
+        }
+        auto error = type->create(message, {}).As<v8::Object>();
+
+        // A frame of v8::StackTrace does not identify its function, so constructorOpt is delegated to Error.captureStackTrace(),
+        // which matches the function itself. V8 formats that stack lazily as well.
+        v8::Local<v8::Value> capture_stack_trace;
+        if (limit > 0 && !constructor_opt.IsEmpty() && !error_function.IsEmpty()) {
+            JS_EXPRESSION_RETURN(value, error_function->Get(context, StringTable::Get(isolate, "captureStackTrace")));
+            capture_stack_trace = value;
+        }
+        if (!capture_stack_trace.IsEmpty() && capture_stack_trace->IsFunction()) {
+            JS_EXPRESSION_IGNORE(error_function->Set(context, stack_trace_limit_name, v8::Integer::New(isolate, limit)));
+            v8::Local<v8::Value> args[] = { error, constructor_opt };
+            auto result = capture_stack_trace.As<v8::Function>()->Call(context, error_function, sizeof(args) / sizeof(v8::Local<v8::Value>), args);
+            JS_EXPRESSION_IGNORE(error_function->Set(context, stack_trace_limit_name, stack_trace_limit));
+            if (!result.IsEmpty()) {
+                info.GetReturnValue().Set(error);
+            }
+            return;
+        }
+        if (!stack_trace_limit.IsEmpty() && stack_trace_limit->IsNumber()) {
+            JS_EXPRESSION_IGNORE(error_function->Set(context, stack_trace_limit_name, stack_trace_limit));
+        }
+
+        auto implementation = std::unique_ptr<ErrorStack>(new ErrorStack());
+        implementation->_limit = limit;
+        if (limit > 0) {
+            implementation->_stack_trace.Reset(isolate, v8::StackTrace::CurrentStackTrace(isolate, limit, stack_trace_options));
+        }
+        JS_EXPRESSION_RETURN(holder, get_holder_template(isolate)->NewInstance(context));
+        implementation.release()->set_interface(isolate, holder);
+
+        // The holder is the data of the property, so the frames are kept until the property is read.
+        JS_EXPRESSION_IGNORE(error->SetLazyDataProperty(context, StringTable::Get(isolate, "stack"), stack_getter, holder, v8::DontEnum));
+        info.GetReturnValue().Set(error);
+    }
+
+    void ErrorStack::stack_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_own_implementation(isolate, info.Data().As<v8::Object>());
+        if V8_UNLIKELY(implementation == nullptr) {
+            info.GetReturnValue().SetUndefined();
+            return;
+        }
+
+        // The header is formatted as by V8: the result of Error.prototype.toString() when the stack is read.
+        JS_EXPRESSION_RETURN(header, info.Holder()->ToString(context));
+        StringBuilder stack(context);
+        stack.Append(header);
+
+        if (!implementation->_stack_trace.IsEmpty()) {
+            auto stack_trace = implementation->_stack_trace.Get(isolate);
+            auto frame_count = stack_trace->GetFrameCount();
+            for (int index = 0; index < frame_count && index < implementation->_limit; ++index) {
+                auto frame = stack_trace->GetFrame(isolate, index);
+                stack.Append("\n    at ");
+                auto function_name = frame->GetFunctionName();
+                bool has_name = !function_name.IsEmpty() && function_name->Length() > 0;
+                if (has_name) {
+                    if (frame->IsConstructor()) {
+                        stack.Append("new ");
+                    }
+                    stack.Append(function_name);
+                    stack.Append(" (");
+                }
+                auto script_name = frame->GetScriptNameOrSourceURL();
+                if (!script_name.IsEmpty() && script_name->Length() > 0) {
+                    stack.Append(script_name);
+                } else {
+                    stack.Append("<anonymous>");
+                }
+                stack.AppendAll(":", frame->GetLineNumber(), ":", frame->GetColumn());
+                if (has_name) {
+                    stack.Append(")");
+                }
+            }
+        }
+
+        JS_EXPRESSION_RETURN(value, stack.Build());
+        info.GetReturnValue().Set(value);
+    }
+}
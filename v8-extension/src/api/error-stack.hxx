@@ -0,0 +1,51 @@
+#ifndef NODE_EXT_API_ERROR_STACK_HXX
+#define NODE_EXT_API_ERROR_STACK_HXX
+
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief The stack of an error created by createError(type, message, { constructorOpt, stackLimit }).
+     *
+     * The type is the name of a native error constructor: "Error", "RangeError", "ReferenceError", "SyntaxError" or "TypeError".
+     * The frames are captured by v8::StackTrace::CurrentStackTrace(), which omits the frames of functions whose context has
+     * a security token different from the current one. At most stackLimit frames (10 by default) are kept.
+     *
+     * With constructorOpt the stack is captured by Error.captureStackTrace(error, constructorOpt) instead: the frames up to
+     * and including the topmost call of that exact function are omitted, and the stack is formatted by V8.
+     *
+     * The "stack" property is a lazy data property: it is formatted from the captured frames when it is first read, so an
+     * error that is caught and discarded never pays for the formatting.
+     */
+    class ErrorStack : public Object<ErrorStack> {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void create_error(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void stack_getter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+    private:
+        static v8::Local<v8::ObjectTemplate> get_holder_template(v8::Isolate *isolate);
+        /**
+         * @brief The Error function of the context, whose "stackTraceLimit" controls the stack trace captured by V8; may be empty.
+         */
+        static v8::Local<v8::Object> get_error_function(v8::Local<v8::Context> context);
+    private:
+        Shared<v8::StackTrace> _stack_trace;
+        int _limit = 0;
+    protected:
+        ErrorStack() = default;
+        ErrorStack(const ErrorStack &) = delete;
+        ErrorStack(ErrorStack &&) = delete;
+    public:
+        virtual ~ErrorStack() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_ERROR_STACK_HXX */
@@ -7,8 +7,8 @@
 namespace dragiyski::node_ext {
     using namespace js;
     namespace {
-        std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
-        std::map<v8::Isolate*, Shared<v8::ObjectTemplate>> per_isolate_iterator_template;
+        thread_local std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate*, Shared<v8::ObjectTemplate>> per_isolate_iterator_template;
     }
 
     void FrozenMap::initialize(v8::Isolate* isolate) {
@@ -3,17 +3,19 @@
 #include "template.hxx"
 #include "frozen-map.hxx"
 #include "object-template.hxx"
+#include "function-template/native-callback.hxx"
 
 #include "../js-string-table.hxx"
 #include "../error-message.hxx"
+#include "../trace.hxx"
 #include <map>
 #include <vector>
 
 namespace dragiyski::node_ext {
     using namespace js;
     namespace {
-        std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
-        std::map<v8::Isolate*, Shared<v8::Private>> per_isolate_template_symbol;
+        thread_local std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate*, Shared<v8::Private>> per_isolate_template_symbol;
     }
 
     void FunctionTemplate::initialize(v8::Isolate* isolate) {
@@ -23,6 +25,7 @@ namespace dragiyski::node_ext {
         auto class_name = ::js::StringTable::Get(isolate, "FunctionTemplate");
         auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 1);
         class_template->SetClassName(class_name);
+        class_template->Inherit(Template::get_template(isolate));
 
         auto signature = v8::Signature::New(isolate, class_template);
         auto prototype_template = class_template->PrototypeTemplate();
@@ -54,9 +57,12 @@ namespace dragiyski::node_ext {
             std::forward_as_tuple(isolate),
             std::forward_as_tuple(isolate, class_template)
         );
+
+        Object<FunctionTemplate>::initialize(isolate);
     }
 
     void FunctionTemplate::uninitialize(v8::Isolate* isolate) {
+        Object<FunctionTemplate>::uninitialize(isolate);
         per_isolate_template.erase(isolate);
         per_isolate_template_symbol.erase(isolate);
     }
@@ -94,6 +100,7 @@ namespace dragiyski::node_ext {
     }
 
     void FunctionTemplate::callback(const v8::FunctionCallbackInfo<v8::Value>& info) {
+        JS_TRACE_SCOPE("function-template", "FunctionTemplate::callback");
         using __function_return_type__ = void;
         auto isolate = info.GetIsolate();
         v8::HandleScope scope(isolate);
@@ -180,18 +187,38 @@ namespace dragiyski::node_ext {
 
         auto target = std::unique_ptr<FunctionTemplate>(new FunctionTemplate());
 
+        {
+            auto name = StringTable::Get(isolate, "native");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if (!js_value->IsNullOrUndefined()) {
+                if (!js_value->IsString()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Option \"native\": not a string.");
+                }
+                v8::String::Utf8Value value(isolate, js_value);
+                target->_native = NativeCallback::find(std::string_view(*value, value.length()));
+                if (target->_native == nullptr) {
+                    JS_THROW_ERROR(TypeError, context, "Option \"native\": unknown native callback \"", js_value, "\".");
+                }
+            }
+        }
         {
             v8::Local<v8::Value> callee;
             auto name = StringTable::Get(isolate, "function");
             JS_EXPRESSION_RETURN(value, options->Get(context, name));
-            if (value->IsFunction()) {
+            if (target->_native != nullptr) {
+                if (!value->IsNullOrUndefined()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Invalid options: \"function\" and \"native\" options cannot be used together");
+                }
+            } else if (value->IsFunction()) {
                 callee = value;
             } else if (value->IsObject() && value.As<v8::Object>()->IsCallable()) {
                 callee = value;
             } else {
                 JS_THROW_ERROR(TypeError, isolate, "Required option \"function\": not a function.");
             }
-            target->_callee.Reset(isolate, callee);
+            if (!callee.IsEmpty()) {
+                target->_callee.Reset(isolate, callee);
+            }
         }
         v8::Local<v8::FunctionTemplate> receiver_template;
         {
@@ -210,7 +237,7 @@ namespace dragiyski::node_ext {
                 receiver_template = receiver_implementation->get_value(isolate);
             }
         }
-        target->_length = 0;
+        target->_length = target->_native != nullptr ? target->_native->get_length() : 0;
         {
             auto name = StringTable::Get(isolate, "length");
             JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
@@ -219,19 +246,26 @@ namespace dragiyski::node_ext {
                 target->_length = value;
             }
         }
-        target->_allow_construct = true;
+        // Native callbacks are plain functions, they do not construct objects.
+        target->_allow_construct = target->_native == nullptr;
+        target->_remove_prototype = !target->_allow_construct;
         {
             auto name = StringTable::Get(isolate, "constructor");
+            // Only an own "constructor" counts, every plain options object inherits Object.prototype.constructor.
+            JS_EXPRESSION_RETURN(has_own, options->HasOwnProperty(context, name));
             JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
-            if (!js_value->IsNullOrUndefined()) {
+            if (has_own && !js_value->IsNullOrUndefined()) {
                 target->_allow_construct = js_value->BooleanValue(isolate);
+                if (target->_allow_construct && target->_native != nullptr) {
+                    JS_THROW_ERROR(TypeError, isolate, "Invalid options: \"constructor\" cannot be used with \"native\"");
+                }
                 if (!target->_allow_construct) {
                     // This change only the "default" value, option "removePrototype" can still be set to false
                     target->_remove_prototype = true;
                 }
             }
         }
-        target->_side_effect_type = v8::SideEffectType::kHasSideEffect;
+        target->_side_effect_type = target->_native != nullptr ? target->_native->get_side_effect_type() : v8::SideEffectType::kHasSideEffect;
         {
             auto name = StringTable::Get(isolate, "sideEffect");
             JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
@@ -327,7 +361,14 @@ namespace dragiyski::node_ext {
         if (!receiver_template.IsEmpty()) {
             signature = v8::Signature::New(isolate, receiver_template);
         }
-        auto function_template = v8::FunctionTemplate::New(isolate, callback, interface, signature, target->_length, target->_allow_construct ? v8::ConstructorBehavior::kAllow : v8::ConstructorBehavior::kThrow, target->_side_effect_type);
+        auto constructor_behavior = target->_allow_construct ? v8::ConstructorBehavior::kAllow : v8::ConstructorBehavior::kThrow;
+        v8::Local<v8::FunctionTemplate> function_template;
+        if (target->_native != nullptr) {
+            function_template = target->_native->create_template(isolate, signature, target->_length, constructor_behavior, target->_side_effect_type);
+        } else {
+            function_template = v8::FunctionTemplate::New(isolate, callback, interface, signature, target->_length, constructor_behavior, target->_side_effect_type);
+        }
+        target->_value.Reset(isolate, function_template);
         {
             auto name = StringTable::Get(isolate, "properties");
             JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
@@ -393,4 +434,7 @@ namespace dragiyski::node_ext {
     v8::Local<v8::Value> FunctionTemplate::get_callee(v8::Isolate* isolate) const {
         return _callee.Get(isolate);
     }
+    const FunctionTemplate::NativeCallback *FunctionTemplate::get_native() const {
+        return _native;
+    }
 }
@@ -29,10 +29,13 @@
      * instanceof TemplateValue (allow specifying holders of Accessor/Lazy object as a simple value)
      * instanceof Template
      *
+     * Instead of a JavaScript "function", the option "native" can name a C++ callback from the FunctionTemplate::NativeCallback
+     * registry. Such functions do not call JavaScript.
      */
     class FunctionTemplate : public Object<FunctionTemplate> {
     public:
         using js_type = v8::FunctionTemplate;
+        class NativeCallback;
     public:
         static void initialize(v8::Isolate* isolate);
         static void uninitialize(v8::Isolate* isolate);
@@ -57,9 +60,11 @@
         v8::SideEffectType _side_effect_type;
         int _length; 
         Shared<v8::String> _class_name; 
+        const NativeCallback *_native = nullptr;
     public:
         v8::Local<v8::FunctionTemplate> get_value(v8::Isolate *isolate) const;
         v8::Local<v8::Value> get_callee(v8::Isolate *isolate) const;
+        const NativeCallback *get_native() const;
     protected:
         FunctionTemplate() = default;
         FunctionTemplate(const FunctionTemplate&) = delete;
@@ -0,0 +1,135 @@
+#include "native-callback.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <compare>
+
+
+#include "../../error-message.hxx"
+#include "../../js-string-table.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    namespace {
+        int32_t ordering_to_int(std::strong_ordering ordering) {
+            return ordering < 0 ? -1 : ordering > 0 ? 1 : 0;
+        }
+
+        double clamp(double value, double min, double max) {
+            if V8_UNLIKELY(std::isnan(value) || std::isnan(min) || std::isnan(max)) {
+                return std::nan("");
+            }
+            return std::min(std::max(value, min), max);
+        }
+
+        // stringCompare(a, b): -1, 0 or 1 comparing the UTF-16 code units, like a < b and a > b do.
+        void string_compare_callback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            using __function_return_type__ = void;
+            auto isolate = info.GetIsolate();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            if V8_UNLIKELY(info.Length() < 2) {
+                JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+            }
+            if V8_UNLIKELY(!info[0]->IsString()) {
+                JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be a [string], got ", type_of(context, info[0]));
+            }
+            if V8_UNLIKELY(!info[1]->IsString()) {
+                JS_THROW_ERROR(TypeError, context, "Expected arguments[1] to be a [string], got ", type_of(context, info[1]));
+            }
+            auto a = info[0].As<v8::String>();
+            auto b = info[1].As<v8::String>();
+            if (a->StringEquals(b)) {
+                info.GetReturnValue().Set(0);
+                return;
+            }
+            v8::String::Value a_value(isolate, a), b_value(isolate, b);
+            auto ordering = std::lexicographical_compare_three_way(*a_value, *a_value + a_value.length(), *b_value, *b_value + b_value.length());
+            info.GetReturnValue().Set(ordering_to_int(ordering));
+        }
+
+        // stringEquals(a, b): a === b for two strings.
+        void string_equals_callback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            using __function_return_type__ = void;
+            auto isolate = info.GetIsolate();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            if V8_UNLIKELY(info.Length() < 2) {
+                JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+            }
+            if V8_UNLIKELY(!info[0]->IsString()) {
+                JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be a [string], got ", type_of(context, info[0]));
+            }
+            if V8_UNLIKELY(!info[1]->IsString()) {
+                JS_THROW_ERROR(TypeError, context, "Expected arguments[1] to be a [string], got ", type_of(context, info[1]));
+            }
+            info.GetReturnValue().Set(info[0].As<v8::String>()->StringEquals(info[1].As<v8::String>()));
+        }
+
+        // clamp(value, min, max): Math.min(Math.max(value, min), max), NaN if any argument is NaN.
+        void clamp_callback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            using __function_return_type__ = void;
+            auto isolate = info.GetIsolate();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            JS_EXPRESSION_RETURN(value, info[0]->NumberValue(context));
+            JS_EXPRESSION_RETURN(min, info[1]->NumberValue(context));
+            JS_EXPRESSION_RETURN(max, info[2]->NumberValue(context));
+            info.GetReturnValue().Set(clamp(value, min, max));
+        }
+
+        // hasFlags(flags, mask): true if all bits of mask are set in flags.
+        void has_flags_callback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+            using __function_return_type__ = void;
+            auto isolate = info.GetIsolate();
+            v8::HandleScope scope(isolate);
+            auto context = isolate->GetCurrentContext();
+
+            JS_EXPRESSION_RETURN(flags, info[0]->Uint32Value(context));
+            JS_EXPRESSION_RETURN(mask, info[1]->Uint32Value(context));
+            info.GetReturnValue().Set((flags & mask) == mask);
+        }
+
+        const FunctionTemplate::NativeCallback registry[] = {
+            { "stringCompare", string_compare_callback, 2, v8::SideEffectType::kHasNoSideEffect },
+            { "stringEquals", string_equals_callback, 2, v8::SideEffectType::kHasNoSideEffect },
+            { "clamp", clamp_callback, 3, v8::SideEffectType::kHasNoSideEffect },
+            { "hasFlags", has_flags_callback, 2, v8::SideEffectType::kHasNoSideEffect }
+        };
+    }
+
+    const FunctionTemplate::NativeCallback *FunctionTemplate::NativeCallback::find(std::string_view name) {
+        for (const auto &entry : registry) {
+            if (entry._name == name) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    v8::Local<v8::FunctionTemplate> FunctionTemplate::NativeCallback::create_template(
+        v8::Isolate *isolate,
+        v8::Local<v8::Signature> signature,
+        int length,
+        v8::ConstructorBehavior behavior,
+        v8::SideEffectType side_effect_type
+    ) const {
+        return v8::FunctionTemplate::New(isolate, _callback, {}, signature, length, behavior, side_effect_type);
+    }
+
+    std::string_view FunctionTemplate::NativeCallback::get_name() const {
+        return _name;
+    }
+
+    int FunctionTemplate::NativeCallback::get_length() const {
+        return _length;
+    }
+
+    v8::SideEffectType FunctionTemplate::NativeCallback::get_side_effect_type() const {
+        return _side_effect_type;
+    }
+}
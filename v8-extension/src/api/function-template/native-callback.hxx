@@ -0,0 +1,53 @@
+#ifndef NODE_EXT_API_FUNCTION_TEMPLATE_NATIVE_CALLBACK_HXX
+#define NODE_EXT_API_FUNCTION_TEMPLATE_NATIVE_CALLBACK_HXX
+
+#include <string_view>
+#include <v8.h>
+#include "../function-template.hxx"
+
+namespace dragiyski::node_ext {
+    /**
+     * @brief A C++ implementation of a function, selected by name through the option "native" of FunctionTemplate.
+     *
+     * Each callback is a v8::FunctionCallback that handles any arguments and declares its side effects, so the inspector may
+     * evaluate it eagerly. There are no v8::CFunction fast paths: Node.js does not ship <v8-fast-api-calls.h> with its headers.
+     *
+     * The callbacks are not wrappers: they are static entries of a fixed registry in native-callback.cxx.
+     */
+    class FunctionTemplate::NativeCallback {
+    public:
+        static const NativeCallback *find(std::string_view name);
+    public:
+        v8::Local<v8::FunctionTemplate> create_template(
+            v8::Isolate *isolate,
+            v8::Local<v8::Signature> signature,
+            int length,
+            v8::ConstructorBehavior behavior,
+            v8::SideEffectType side_effect_type
+        ) const;
+    public:
+        std::string_view get_name() const;
+        int get_length() const;
+        v8::SideEffectType get_side_effect_type() const;
+    public:
+        constexpr NativeCallback(
+            std::string_view name,
+            v8::FunctionCallback callback,
+            int length,
+            v8::SideEffectType side_effect_type
+        ) :
+            _name(name),
+            _callback(callback),
+            _length(length),
+            _side_effect_type(side_effect_type) {}
+        NativeCallback(const NativeCallback &) = delete;
+        NativeCallback(NativeCallback &&) = delete;
+    private:
+        std::string_view _name;
+        v8::FunctionCallback _callback;
+        int _length;
+        v8::SideEffectType _side_effect_type;
+    };
+}
+
+#endif /* NODE_EXT_API_FUNCTION_TEMPLATE_NATIVE_CALLBACK_HXX */
@@ -0,0 +1,454 @@
+#include "idl-converter.hxx"
+
+#include <cassert>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../js-string-table.hxx"
+#include "../webidl.hxx"
+#include "webidl.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::ObjectTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::Private>> per_isolate_holder_symbol;
+
+        using webidl::Converter;
+        using webidl::IntegerConversion;
+
+        struct IntegerType {
+            const char *name;
+            webidl::ConvertFunction convert[3];
+        };
+
+        template<typename T>
+        constexpr IntegerType integer_type(const char *name) {
+            return { name, {
+                &webidl::convert<T>,
+                &webidl::convert<webidl::idl::EnforceRange<T>>,
+                &webidl::convert<webidl::idl::Clamp<T>>
+            } };
+        }
+
+        // The conversions of each type are indexed by IntegerConversion.
+        const IntegerType integer_types[] = {
+            integer_type<webidl::idl::Byte>("byte"),
+            integer_type<webidl::idl::Octet>("octet"),
+            integer_type<webidl::idl::Short>("short"),
+            integer_type<webidl::idl::UnsignedShort>("unsigned short"),
+            integer_type<webidl::idl::Long>("long"),
+            integer_type<webidl::idl::UnsignedLong>("unsigned long"),
+            integer_type<webidl::idl::LongLong>("long long"),
+            integer_type<webidl::idl::UnsignedLongLong>("unsigned long long")
+        };
+
+        struct SimpleType {
+            const char *name;
+            Converter::Category category;
+            webidl::ConvertFunction convert;
+        };
+
+        const SimpleType simple_types[] = {
+            { "any", Converter::Any, &webidl::convert<webidl::idl::Any> },
+            { "boolean", Converter::Boolean, &webidl::convert<webidl::idl::Boolean> },
+            { "float", Converter::Numeric, &webidl::convert<webidl::idl::Float> },
+            { "unrestricted float", Converter::Numeric, &webidl::convert<webidl::idl::UnrestrictedFloat> },
+            { "double", Converter::Numeric, &webidl::convert<webidl::idl::Double> },
+            { "unrestricted double", Converter::Numeric, &webidl::convert<webidl::idl::UnrestrictedDouble> },
+            { "DOMString", Converter::String, &webidl::convert<webidl::idl::DOMString> },
+            { "ByteString", Converter::String, &webidl::convert<webidl::idl::ByteString> },
+            { "USVString", Converter::String, &webidl::convert<webidl::idl::USVString> },
+            { "object", Converter::Object, &webidl::convert<webidl::idl::Object> }
+        };
+
+        // The site of the values converted by a converter called from JavaScript: the errors have no prefix.
+        const constexpr webidl::Site value_site = { "", "", webidl::Site::Value };
+
+        /**
+         * @brief The converter of arguments[index] of a factory; throws if the argument is not a converter.
+         */
+        IDLConverter *get_argument_converter(const v8::FunctionCallbackInfo<v8::Value> &info, int index) {
+            static const constexpr auto __function_return_type__ = []() { return nullptr; };
+            auto isolate = info.GetIsolate();
+            auto converter = IDLConverter::get_converter(isolate->GetCurrentContext(), info[index]);
+            if (converter == nullptr) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[", index, "] to be a converter of the idl namespace.");
+            }
+            return converter;
+        }
+    }
+
+    void IDLConverter::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto holder_template = v8::ObjectTemplate::New(isolate);
+        holder_template->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, holder_template)
+        );
+
+        auto holder_symbol = v8::Private::New(isolate, StringTable::Get(isolate, "IDLConverter"));
+        per_isolate_holder_symbol.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, holder_symbol)
+        );
+
+        Object<IDLConverter>::initialize(isolate);
+    }
+
+    void IDLConverter::uninitialize(v8::Isolate *isolate) {
+        Object<IDLConverter>::uninitialize(isolate);
+        per_isolate_holder_symbol.erase(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::ObjectTemplate> IDLConverter::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    v8::Local<v8::Private> IDLConverter::get_holder_symbol(v8::Isolate *isolate) {
+        assert(per_isolate_holder_symbol.contains(isolate));
+        return per_isolate_holder_symbol[isolate].Get(isolate);
+    }
+
+    const std::shared_ptr<const webidl::Converter> &IDLConverter::converter() const {
+        return _converter;
+    }
+
+    v8::MaybeLocal<v8::Function> IDLConverter::Create(v8::Local<v8::Context> context, std::shared_ptr<const webidl::Converter> converter, int integer_type) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Function>(); };
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_RETURN(holder, get_template(isolate)->NewInstance(context));
+        auto implementation = new IDLConverter();
+        implementation->_converter = std::move(converter);
+        implementation->_integer_type = integer_type;
+        implementation->set_interface(isolate, holder);
+        // The function keeps the holder alive, so the implementation outlives every call receiving it in the data.
+        auto data = v8::External::New(isolate, implementation);
+        JS_EXPRESSION_RETURN(function, v8::Function::New(context, call, data, 1, v8::ConstructorBehavior::kThrow));
+        JS_EXPRESSION_RETURN(name, v8::String::NewFromUtf8(isolate, implementation->_converter->name().c_str()));
+        function->SetName(name);
+        JS_EXPRESSION_IGNORE(function->SetPrivate(context, get_holder_symbol(isolate), holder));
+        return function;
+    }
+
+    IDLConverter *IDLConverter::get_converter(v8::Local<v8::Context> context, v8::Local<v8::Value> value) {
+        auto isolate = context->GetIsolate();
+        if (!value->IsFunction()) {
+            return nullptr;
+        }
+        v8::Local<v8::Value> holder;
+        if (!value.As<v8::Object>()->GetPrivate(context, get_holder_symbol(isolate)).ToLocal(&holder) || !holder->IsObject()) {
+            return nullptr;
+        }
+        return get_own_implementation(isolate, holder.As<v8::Object>());
+    }
+
+    void IDLConverter::call(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = static_cast<IDLConverter *>(info.Data().As<v8::External>()->Value());
+        JS_EXPRESSION_RETURN(result, implementation->_converter->convert(context, info[0], value_site, -1));
+        info.GetReturnValue().Set(result);
+    }
+
+    v8::MaybeLocal<v8::Object> IDLConverter::create_namespace(v8::Local<v8::Context> context) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Object>(); };
+        auto isolate = context->GetIsolate();
+        auto value = v8::Object::New(isolate, v8::Null(isolate), nullptr, nullptr, 0);
+
+        for (const auto &type : simple_types) {
+            auto converter = std::make_shared<webidl::FunctionConverter>(type.category, type.name, type.convert);
+            JS_EXPRESSION_RETURN(function, Create(context, converter));
+            JS_EXPRESSION_RETURN(name, v8::String::NewFromUtf8(isolate, type.name, v8::NewStringType::kInternalized));
+            JS_EXPRESSION_IGNORE(value->DefineOwnProperty(context, name, function, JS_PROPERTY_ATTRIBUTE_CONST));
+        }
+        for (std::size_t index = 0; index < std::size(integer_types); ++index) {
+            const auto &type = integer_types[index];
+            auto converter = std::make_shared<webidl::FunctionConverter>(Converter::Numeric, type.name, type.convert[static_cast<int>(IntegerConversion::Modulo)]);
+            JS_EXPRESSION_RETURN(function, Create(context, converter, static_cast<int>(index)));
+            JS_EXPRESSION_RETURN(name, v8::String::NewFromUtf8(isolate, type.name, v8::NewStringType::kInternalized));
+            JS_EXPRESSION_IGNORE(value->DefineOwnProperty(context, name, function, JS_PROPERTY_ATTRIBUTE_CONST));
+        }
+
+        struct Factory {
+            const char *name;
+            v8::FunctionCallback callback;
+            int length;
+        };
+        const Factory factories[] = {
+            { "nullable", static_nullable, 1 },
+            { "sequence", static_sequence, 1 },
+            { "union", static_union, 2 },
+            { "enumeration", static_enumeration, 2 },
+            { "interface", static_interface, 1 },
+            { "callbackFunction", static_callback_function, 1 },
+            { "callbackInterface", static_callback_interface, 1 },
+            { "enforceRange", static_enforce_range, 1 },
+            { "clamp", static_clamp, 1 },
+            { "dictionary", static_dictionary, 1 }
+        };
+        for (const auto &factory : factories) {
+            JS_EXPRESSION_RETURN(name, v8::String::NewFromUtf8(isolate, factory.name, v8::NewStringType::kInternalized));
+            JS_EXPRESSION_RETURN(function, v8::Function::New(context, factory.callback, {}, factory.length, v8::ConstructorBehavior::kThrow));
+            function->SetName(name);
+            JS_EXPRESSION_IGNORE(value->DefineOwnProperty(context, name, function, JS_PROPERTY_ATTRIBUTE_CONST));
+        }
+        JS_EXPRESSION_IGNORE(value->SetIntegrityLevel(context, v8::IntegrityLevel::kFrozen));
+        return value;
+    }
+
+    void IDLConverter::static_nullable(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto inner = get_argument_converter(info, 0);
+        if (inner == nullptr) {
+            return;
+        }
+        if (inner->_converter->is_nullable() || inner->_converter->category() == Converter::Any) {
+            JS_THROW_ERROR(TypeError, isolate, "The type '", inner->_converter->name().c_str(), "' cannot be nullable.");
+        }
+        JS_EXPRESSION_RETURN(value, Create(context, std::make_shared<webidl::NullableConverter>(inner->_converter)));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_sequence(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto element = get_argument_converter(info, 0);
+        if (element == nullptr) {
+            return;
+        }
+        JS_EXPRESSION_RETURN(value, Create(context, std::make_shared<webidl::SequenceConverter>(element->_converter)));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_union(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (info.Length() < 2) {
+            JS_THROW_ERROR(TypeError, isolate, "A union requires at least 2 member types.");
+        }
+        std::vector<std::shared_ptr<const Converter>> members;
+        for (int index = 0; index < info.Length(); ++index) {
+            auto member = get_argument_converter(info, index);
+            if (member == nullptr) {
+                return;
+            }
+            if (member->_converter->category() == Converter::Any) {
+                JS_THROW_ERROR(TypeError, isolate, "A union cannot have a member of type 'any'.");
+            }
+            members.push_back(member->_converter);
+        }
+        JS_EXPRESSION_RETURN(value, Create(context, std::make_shared<webidl::UnionConverter>(std::move(members))));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_enumeration(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (!info[0]->IsString()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be a string.");
+        }
+        if (!info[1]->IsArray()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an array of strings.");
+        }
+        auto array = info[1].As<v8::Array>();
+        std::vector<std::string> values;
+        for (uint32_t index = 0; index < array->Length(); ++index) {
+            JS_EXPRESSION_RETURN(item, array->Get(context, index));
+            if (!item->IsString()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an array of strings.");
+            }
+            v8::String::Utf8Value text(isolate, item);
+            values.emplace_back(*text, text.length());
+        }
+        v8::String::Utf8Value name(isolate, info[0]);
+        auto converter = std::make_shared<webidl::EnumerationConverter>(isolate, std::string(*name, name.length()), values);
+        JS_EXPRESSION_RETURN(value, Create(context, converter));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_interface(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        JS_EXPRESSION_RETURN(index, WebIDL::get_interface_template(context, info[0], "arguments[0]"));
+        auto definition = webidl::get_template_definition(isolate, index);
+        JS_EXPRESSION_RETURN(value, Create(context, std::make_shared<webidl::InterfaceConverter>(definition)));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_callback_function(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (!info[0]->IsString()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be a string.");
+        }
+        v8::String::Utf8Value name(isolate, info[0]);
+        auto converter = std::make_shared<webidl::CallbackConverter>(Converter::CallbackFunction, std::string(*name, name.length()));
+        JS_EXPRESSION_RETURN(value, Create(context, converter));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_callback_interface(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (!info[0]->IsString()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be a string.");
+        }
+        v8::String::Utf8Value name(isolate, info[0]);
+        auto converter = std::make_shared<webidl::CallbackConverter>(Converter::CallbackInterface, std::string(*name, name.length()));
+        JS_EXPRESSION_RETURN(value, Create(context, converter));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_enforce_range(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto inner = get_argument_converter(info, 0);
+        if (inner == nullptr) {
+            return;
+        }
+        if (inner->_integer_type < 0) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be the converter of an integer type.");
+        }
+        const auto &type = integer_types[inner->_integer_type];
+        auto converter = std::make_shared<webidl::FunctionConverter>(Converter::Numeric, std::string("[EnforceRange] ") + type.name, type.convert[static_cast<int>(IntegerConversion::EnforceRange)]);
+        JS_EXPRESSION_RETURN(value, Create(context, converter));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_clamp(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto inner = get_argument_converter(info, 0);
+        if (inner == nullptr) {
+            return;
+        }
+        if (inner->_integer_type < 0) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be the converter of an integer type.");
+        }
+        const auto &type = integer_types[inner->_integer_type];
+        auto converter = std::make_shared<webidl::FunctionConverter>(Converter::Numeric, std::string("[Clamp] ") + type.name, type.convert[static_cast<int>(IntegerConversion::Clamp)]);
+        JS_EXPRESSION_RETURN(value, Create(context, converter));
+        info.GetReturnValue().Set(value);
+    }
+
+    void IDLConverter::static_dictionary(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object.");
+        }
+        auto members_object = info[0].As<v8::Object>();
+
+        std::string name = "Dictionary";
+        std::shared_ptr<const webidl::DictionaryConverter> parent;
+        if (!info[1]->IsNullOrUndefined()) {
+            if (!info[1]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an object, if specified.");
+            }
+            auto options = info[1].As<v8::Object>();
+            JS_EXPRESSION_RETURN(name_value, options->Get(context, StringTable::Get(isolate, "name")));
+            if (!name_value->IsUndefined()) {
+                if (!name_value->IsString()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Expected options.name to be a string, if specified.");
+                }
+                v8::String::Utf8Value text(isolate, name_value);
+                name.assign(*text, text.length());
+            }
+            JS_EXPRESSION_RETURN(parent_value, options->Get(context, StringTable::Get(isolate, "parent")));
+            if (!parent_value->IsUndefined()) {
+                auto parent_converter = get_converter(context, parent_value);
+                if (parent_converter == nullptr || parent_converter->_converter->category() != Converter::Dictionary || parent_converter->_converter->is_nullable()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Expected options.parent to be a dictionary converter, if specified.");
+                }
+                parent = std::static_pointer_cast<const webidl::DictionaryConverter>(parent_converter->_converter);
+            }
+        }
+
+        JS_EXPRESSION_RETURN(keys, members_object->GetOwnPropertyNames(context, static_cast<v8::PropertyFilter>(v8::PropertyFilter::ONLY_ENUMERABLE | v8::PropertyFilter::SKIP_SYMBOLS), v8::KeyConversionMode::kConvertToString));
+        std::vector<webidl::DictionaryConverter::Member> members;
+        members.reserve(keys->Length());
+        for (uint32_t index = 0; index < keys->Length(); ++index) {
+            JS_EXPRESSION_RETURN(key, keys->Get(context, index));
+            JS_EXPRESSION_RETURN(member_value, members_object->Get(context, key));
+            v8::String::Utf8Value key_text(isolate, key);
+            webidl::DictionaryConverter::Member member;
+            member.name.assign(*key_text, key_text.length());
+
+            auto type = get_converter(context, member_value);
+            v8::Local<v8::Value> default_value;
+            if (type == nullptr && member_value->IsObject()) {
+                auto descriptor = member_value.As<v8::Object>();
+                JS_EXPRESSION_RETURN(type_value, descriptor->Get(context, StringTable::Get(isolate, "type")));
+                type = get_converter(context, type_value);
+                JS_EXPRESSION_RETURN(required, descriptor->Get(context, StringTable::Get(isolate, "required")));
+                member.required = required->BooleanValue(isolate);
+                JS_EXPRESSION_RETURN(default_property, descriptor->Get(context, StringTable::Get(isolate, "default")));
+                default_value = default_property;
+            }
+            if (type == nullptr) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected member '", key.As<v8::String>(), "' to be a converter or { type, default, required }.");
+            }
+            member.type = type->_converter;
+            if (!default_value.IsEmpty() && !default_value->IsUndefined()) {
+                if (member.required) {
+                    JS_THROW_ERROR(TypeError, isolate, "Required member '", key.As<v8::String>(), "' cannot have a default value.");
+                }
+                if (default_value->IsObject()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Expected the default value of member '", key.As<v8::String>(), "' to be a primitive value.");
+                }
+                // The default value is an IDL value, converted once here.
+                const webidl::Site member_site = { name.c_str(), member.name.c_str(), webidl::Site::DictionaryMember };
+                JS_EXPRESSION_RETURN(converted, member.type->convert(context, default_value, member_site, -1));
+                member.default_kind = webidl::DictionaryConverter::Member::DefaultValue;
+                member.default_value.Reset(isolate, converted);
+            }
+            members.push_back(std::move(member));
+        }
+
+        auto converter = std::make_shared<webidl::DictionaryConverter>(isolate, name, parent, std::move(members));
+        JS_EXPRESSION_RETURN(value, Create(context, converter));
+        info.GetReturnValue().Set(value);
+    }
+}
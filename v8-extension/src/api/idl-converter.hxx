@@ -0,0 +1,71 @@
+#ifndef NODE_EXT_API_IDL_CONVERTER_HXX
+#define NODE_EXT_API_IDL_CONVERTER_HXX
+
+#include <memory>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+#include "../webidl-converter.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief A precompiled WebIDL type conversion, callable from JavaScript.
+     *
+     * The "idl" namespace of the module holds a converter function per scalar type (idl.boolean, idl['unsigned long'],
+     * idl.DOMString, ...) and the factories of the composite types:
+     * idl.nullable(type), idl.sequence(type), idl.union(...types), idl.enumeration(name, values), idl.interface(interface),
+     * idl.callbackFunction(name), idl.callbackInterface(name), idl.enforceRange(type), idl.clamp(type) and
+     * idl.dictionary(members, { name, parent }), where each member is a converter or { type, default, required }.
+     *
+     * A converter called with a value returns the value converted to the IDL type, or throws a TypeError. The composite types
+     * are compiled when the factory is called: a dictionary sorts its members and keeps their names as internalized strings.
+     */
+    class IDLConverter : public Object<IDLConverter> {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::ObjectTemplate> get_template(v8::Isolate *isolate);
+        /**
+         * @brief The "idl" namespace object.
+         */
+        static v8::MaybeLocal<v8::Object> create_namespace(v8::Local<v8::Context> context);
+        static v8::MaybeLocal<v8::Function> Create(v8::Local<v8::Context> context, std::shared_ptr<const webidl::Converter> converter, int integer_type = -1);
+        /**
+         * @brief The converter of a function returned by Create(), or nullptr.
+         */
+        static IDLConverter *get_converter(v8::Local<v8::Context> context, v8::Local<v8::Value> value);
+    protected:
+        static void call(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_nullable(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_sequence(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_union(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_enumeration(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_interface(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_callback_function(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_callback_interface(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_enforce_range(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_clamp(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_dictionary(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static v8::Local<v8::Private> get_holder_symbol(v8::Isolate *isolate);
+    private:
+        std::shared_ptr<const webidl::Converter> _converter;
+        /**
+         * @brief The index of the integer type in the integer converter table, for enforceRange() and clamp(); -1 otherwise.
+         */
+        int _integer_type = -1;
+    public:
+        const std::shared_ptr<const webidl::Converter> &converter() const;
+    protected:
+        IDLConverter() = default;
+        IDLConverter(const IDLConverter &) = delete;
+        IDLConverter(IDLConverter &&) = delete;
+    public:
+        virtual ~IDLConverter() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_IDL_CONVERTER_HXX */
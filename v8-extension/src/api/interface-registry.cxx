@@ -0,0 +1,269 @@
+#include "interface-registry.hxx"
+
+#include <cassert>
+#include <map>
+#include <memory>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+#include "../trace.hxx"
+#include "context.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        // The data of the lazy data property of an interface: the registry and the index of the entry.
+        enum InterfaceDataField : int {
+            INTERFACE_DATA_REGISTRY = 0,
+            INTERFACE_DATA_INDEX = 1,
+            INTERFACE_DATA_FIELD_COUNT = 2
+        };
+
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::ObjectTemplate>> per_isolate_data_template;
+    }
+
+    void InterfaceRegistry::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "InterfaceRegistry");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "register");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_register, {}, signature, 2, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "materialized");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_materialized, {}, signature, 1, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "statistics");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_statistics, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        auto data_template = v8::ObjectTemplate::New(isolate);
+        data_template->SetInternalFieldCount(INTERFACE_DATA_FIELD_COUNT);
+        per_isolate_data_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, data_template)
+        );
+
+        Object<InterfaceRegistry>::initialize(isolate);
+    }
+
+    void InterfaceRegistry::uninitialize(v8::Isolate *isolate) {
+        Object<InterfaceRegistry>::uninitialize(isolate);
+        per_isolate_data_template.erase(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> InterfaceRegistry::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void InterfaceRegistry::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "InterfaceRegistry", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        auto implementation = std::unique_ptr<InterfaceRegistry>(new InterfaceRegistry());
+        implementation->_global_template.Reset(isolate, v8::ObjectTemplate::New(isolate));
+        implementation->_materialized_symbol.Reset(isolate, v8::Private::New(isolate, StringTable::Get(isolate, "InterfaceRegistry")));
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void InterfaceRegistry::prototype_register(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "InterfaceRegistry", ".", "prototype", ".", "register", " called on incompatible receiver ", receiver);
+        }
+
+        if V8_UNLIKELY(info.Length() < 2) {
+            JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsString() && !info[0]->IsSymbol()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be a [string] or a [symbol], got ", type_of(context, info[0]));
+        }
+        auto name = info[0].As<v8::Name>();
+        if V8_UNLIKELY(!JS_IS_CALLABLE(info[1])) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be a function.");
+        }
+        auto attributes = JS_PROPERTY_ATTRIBUTE_DYNAMIC;
+        if (!info[2]->IsNullOrUndefined()) {
+            JS_EXPRESSION_RETURN_WITH_ERROR_PREFIX(value, info[2]->Uint32Value(context), context, "In arguments[2]");
+            attributes = static_cast<v8::PropertyAttribute>(value & static_cast<uint32_t>(JS_PROPERTY_ATTRIBUTE_ALL));
+        }
+
+        if V8_UNLIKELY(implementation->_instantiated) {
+            JS_THROW_ERROR(TypeError, isolate, "Cannot register an interface after a context has been created from the registry.");
+        }
+        for (const auto &entry : implementation->_entries) {
+            if V8_UNLIKELY(entry.name.Get(isolate)->StrictEquals(name)) {
+                JS_THROW_ERROR(TypeError, context, "Interface ", name, " is already registered.");
+            }
+        }
+
+        assert(per_isolate_data_template.contains(isolate));
+        JS_EXPRESSION_RETURN(data, per_isolate_data_template[isolate].Get(isolate)->NewInstance(context));
+        data->SetInternalField(INTERFACE_DATA_REGISTRY, info.This());
+        data->SetInternalField(INTERFACE_DATA_INDEX, v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(implementation->_entries.size())));
+
+        auto &entry = implementation->_entries.emplace_back();
+        entry.name.Reset(isolate, name);
+        entry.installer.Reset(isolate, info[1]);
+        implementation->_global_template.Get(isolate)->SetLazyDataProperty(name, getter_callback, data, attributes);
+    }
+
+    void InterfaceRegistry::getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        JS_TRACE_SCOPE("interface-registry", "InterfaceRegistry::getter_callback");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto data = info.Data().As<v8::Object>();
+        auto registry = data->GetInternalField(INTERFACE_DATA_REGISTRY).As<v8::Value>().As<v8::Object>();
+        auto implementation = get_own_implementation(isolate, registry);
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: InterfaceRegistry::getter_callback");
+        }
+        auto index = data->GetInternalField(INTERFACE_DATA_INDEX).As<v8::Value>().As<v8::Uint32>()->Value();
+        assert(index < implementation->_entries.size());
+
+        // The holder is the global object of the realm; the installer receives its global proxy.
+        JS_EXPRESSION_RETURN(holder_context, info.Holder()->GetCreationContext());
+        auto global = holder_context->Global();
+        v8::Local<v8::Value> call_args[] = { global, property };
+        JS_EXPRESSION_RETURN(value, object_or_function_call(context, implementation->_entries[index].installer.Get(isolate), v8::Undefined(isolate), sizeof(call_args) / sizeof(v8::Local<v8::Value>), call_args));
+
+        ++implementation->_entries[index].materialized;
+        {
+            v8::Context::Scope context_scope(holder_context);
+            auto symbol = implementation->_materialized_symbol.Get(isolate);
+            JS_EXPRESSION_RETURN(record, global->GetPrivate(holder_context, symbol));
+            if (!record->IsArray()) {
+                record = v8::Array::New(isolate);
+                JS_EXPRESSION_IGNORE(global->SetPrivate(holder_context, symbol, record));
+            }
+            auto array = record.As<v8::Array>();
+            JS_EXPRESSION_IGNORE(array->Set(holder_context, array->Length(), property));
+        }
+
+        info.GetReturnValue().Set(value);
+    }
+
+    void InterfaceRegistry::prototype_materialized(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "InterfaceRegistry", ".", "prototype", ".", "materialized", " called on incompatible receiver ", receiver);
+        }
+
+        auto context_wrapper = info[0]->IsObject() ? Context::get_implementation(isolate, info[0].As<v8::Object>()) : nullptr;
+        if V8_UNLIKELY(context_wrapper == nullptr) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be a Context.");
+        }
+        auto target_context = context_wrapper->get_value(isolate);
+        if V8_UNLIKELY(target_context.IsEmpty()) {
+            JS_THROW_ERROR(ReferenceError, isolate, "the wrapped context is already disposed");
+        }
+
+        JS_EXPRESSION_RETURN(record, target_context->Global()->GetPrivate(target_context, implementation->_materialized_symbol.Get(isolate)));
+        if (!record->IsArray()) {
+            info.GetReturnValue().Set(v8::Array::New(isolate));
+            return;
+        }
+        auto source = record.As<v8::Array>();
+        auto length = source->Length();
+        auto result = v8::Array::New(isolate, static_cast<int>(length));
+        for (uint32_t i = 0; i < length; ++i) {
+            JS_EXPRESSION_RETURN(name, source->Get(target_context, i));
+            JS_EXPRESSION_IGNORE(result->Set(context, i, name));
+        }
+        info.GetReturnValue().Set(result);
+    }
+
+    void InterfaceRegistry::prototype_statistics(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "InterfaceRegistry", ".", "prototype", ".", "statistics", " called on incompatible receiver ", receiver);
+        }
+
+        auto interfaces = v8::Array::New(isolate, static_cast<int>(implementation->_entries.size()));
+        for (std::size_t i = 0; i < implementation->_entries.size(); ++i) {
+            const auto &entry = implementation->_entries[i];
+            v8::Local<v8::Name> names[] = {
+                StringTable::Get(isolate, "name"),
+                StringTable::Get(isolate, "materialized")
+            };
+            v8::Local<v8::Value> values[] = {
+                entry.name.Get(isolate),
+                v8::Number::New(isolate, static_cast<double>(entry.materialized))
+            };
+            auto value = v8::Object::New(isolate, v8::Null(isolate), names, values, 2);
+            JS_EXPRESSION_IGNORE(interfaces->Set(context, static_cast<uint32_t>(i), value));
+        }
+        v8::Local<v8::Name> names[] = {
+            StringTable::Get(isolate, "contexts"),
+            StringTable::Get(isolate, "interfaces")
+        };
+        v8::Local<v8::Value> values[] = {
+            v8::Number::New(isolate, static_cast<double>(implementation->_contexts)),
+            interfaces
+        };
+        info.GetReturnValue().Set(v8::Object::New(isolate, v8::Null(isolate), names, values, 2));
+    }
+
+    v8::Local<v8::ObjectTemplate> InterfaceRegistry::instantiate(v8::Isolate *isolate) {
+        _instantiated = true;
+        return _global_template.Get(isolate);
+    }
+
+    void InterfaceRegistry::on_context_created() {
+        ++_contexts;
+    }
+}
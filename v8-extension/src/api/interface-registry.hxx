@@ -0,0 +1,64 @@
+#ifndef NODE_EXT_API_INTERFACE_REGISTRY_HXX
+#define NODE_EXT_API_INTERFACE_REGISTRY_HXX
+
+#include <cstddef>
+#include <vector>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief The interfaces of a global, materialized by each realm on first access.
+     *
+     * register(name, installer, attributes) adds a lazy data property (DONT_ENUM by default) to the global template of the
+     * registry, which new Context({ globalTemplate: registry }) instantiates. The first access of the name on the global of a
+     * context calls installer(global, name) and V8 replaces the property with the result; an interface that is never used is
+     * never built. Interfaces cannot be registered once a context has been created from the registry.
+     *
+     * materialized(context) lists the names installed in the context, in the order of their first access; statistics() returns
+     * the number of contexts created from the registry and, for each interface, how many of them have materialized it.
+     */
+    class InterfaceRegistry : public Object<InterfaceRegistry> {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_register(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_materialized(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_statistics(const v8::FunctionCallbackInfo<v8::Value> &info);
+    public:
+        static void getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+    private:
+        struct Entry {
+            Shared<v8::Name> name;
+            Shared<v8::Value> installer;
+            std::size_t materialized = 0;
+        };
+        Shared<v8::ObjectTemplate> _global_template;
+        // On the global (proxy) of each context: the array of the materialized names.
+        Shared<v8::Private> _materialized_symbol;
+        std::vector<Entry> _entries;
+        std::size_t _contexts = 0;
+        bool _instantiated = false;
+    public:
+        /**
+         * @brief The global template for a new context; no interface can be registered after this.
+         */
+        v8::Local<v8::ObjectTemplate> instantiate(v8::Isolate *isolate);
+        void on_context_created();
+    protected:
+        InterfaceRegistry() = default;
+        InterfaceRegistry(const InterfaceRegistry &) = delete;
+        InterfaceRegistry(InterfaceRegistry &&) = delete;
+    public:
+        virtual ~InterfaceRegistry() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_INTERFACE_REGISTRY_HXX */
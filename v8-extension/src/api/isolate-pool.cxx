@@ -0,0 +1,582 @@
+#include "isolate-pool.hxx"
+
+#include <cassert>
+#include <condition_variable>
+#include <cstdlib>
+#include <map>
+#include <memory>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+#include "../main.hxx"
+#include "../trace.hxx"
+#include "script.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        struct State {
+            Shared<v8::FunctionTemplate> class_template;
+            // The threads joining the workers of the destroyed pools.
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::size_t reapers = 0;
+        };
+
+        thread_local std::map<v8::Isolate *, State> per_isolate_state;
+    }
+
+    void IsolatePool::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_state.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "IsolatePool");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "run");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_run, {}, signature, 1, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "close");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_close, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "size");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_size, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_state[isolate].class_template.Reset(isolate, class_template);
+
+        Object<IsolatePool>::initialize(isolate);
+    }
+
+    void IsolatePool::uninitialize(v8::Isolate *isolate) {
+        // Destroys the remaining pools, then waits for every worker to be joined before the addon is unloaded.
+        Object<IsolatePool>::uninitialize(isolate);
+        auto &state = per_isolate_state[isolate];
+        {
+            std::unique_lock lock(state.mutex);
+            state.condition.wait(lock, [&state]() { return state.reapers == 0; });
+        }
+        per_isolate_state.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> IsolatePool::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_state.contains(isolate));
+        return per_isolate_state[isolate].class_template.Get(isolate);
+    }
+
+    IsolatePool::Task::~Task() {
+        // Allocated by v8::ValueSerializer::Release() through the default delegate, i.e. realloc().
+        std::free(data);
+    }
+
+    void IsolatePool::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "IsolatePool", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        uint32_t size = std::thread::hardware_concurrency();
+        if (size < 1) {
+            size = 1;
+        }
+        std::string exports_name;
+        if (!info[0]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object, if specified.");
+            }
+            auto options = info[0].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "size");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsUndefined()) {
+                    if V8_UNLIKELY(!value->IsUint32() || value.As<v8::Uint32>()->Value() < 1) {
+                        JS_THROW_ERROR(RangeError, isolate, "Option \"size\": expected a positive integer.");
+                    }
+                    size = value.As<v8::Uint32>()->Value();
+                }
+            }
+            {
+                auto name = StringTable::Get(isolate, "exports");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsUndefined()) {
+                    if V8_UNLIKELY(!value->IsString()) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"exports\": not a string.");
+                    }
+                    v8::String::Utf8Value string(isolate, value);
+                    exports_name.assign(*string, string.length());
+                }
+            }
+        }
+
+        auto environment = node::GetCurrentEnvironment(context);
+        auto platform = environment != nullptr ? node::GetMultiIsolatePlatform(environment) : nullptr;
+        if V8_UNLIKELY(platform == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "IsolatePool requires a Node.js environment");
+        }
+
+        auto implementation = std::unique_ptr<IsolatePool>(new IsolatePool());
+        implementation->_isolate = isolate;
+        implementation->_context.Reset(isolate, context);
+        implementation->_async = new uv_async_t();
+        uv_async_init(node::GetCurrentEventLoop(isolate), implementation->_async, on_result);
+        implementation->_async->data = implementation.get();
+        implementation->_channel->async = implementation->_async;
+        // Only keep the event loop alive while there are unsettled promises.
+        uv_unref(reinterpret_cast<uv_handle_t *>(implementation->_async));
+
+        implementation->_size = size;
+        for (uint32_t i = 0; i < size; ++i) {
+            auto worker = std::make_unique<Worker>(implementation->_channel, platform, exports_name);
+            auto started = worker->start();
+            implementation->_workers.push_back(std::move(worker));
+            if V8_UNLIKELY(!started) {
+                JS_THROW_ERROR(Error, isolate, "Failed to start a worker isolate");
+            }
+        }
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void IsolatePool::prototype_run(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "IsolatePool", ".", "prototype", ".", "run", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsString()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be a [string], got ", type_of(context, info[0]));
+        }
+        if V8_UNLIKELY(implementation->_closed) {
+            JS_THROW_ERROR(Error, isolate, "The isolate pool is closed");
+        }
+
+        auto task = std::make_unique<Task>();
+        {
+            v8::String::Utf8Value source(isolate, info[0]);
+            task->source.assign(*source, source.length());
+        }
+        if (!info[1]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[1]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an object, if specified.");
+            }
+            auto options = info[1].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "filename");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsUndefined()) {
+                    if V8_UNLIKELY(!value->IsString()) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"filename\": not a string.");
+                    }
+                    v8::String::Utf8Value filename(isolate, value);
+                    task->filename.assign(*filename, filename.length());
+                }
+            }
+            {
+                auto name = StringTable::Get(isolate, "timeout");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsUndefined()) {
+                    if V8_UNLIKELY(!value->IsNumber() || !(value.As<v8::Number>()->Value() > 0)) {
+                        JS_THROW_ERROR(RangeError, isolate, "Option \"timeout\": expected a positive number of milliseconds.");
+                    }
+                    task->timeout = value.As<v8::Number>()->Value();
+                }
+            }
+        }
+
+        JS_EXPRESSION_RETURN(resolver, v8::Promise::Resolver::New(context));
+        task->id = ++implementation->_next_id;
+        implementation->_pending.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(task->id),
+            std::forward_as_tuple(isolate, resolver)
+        );
+        if (implementation->_pending.size() == 1) {
+            implementation->_self.Reset(isolate, implementation->get_interface(isolate));
+            uv_ref(reinterpret_cast<uv_handle_t *>(implementation->_async));
+        }
+
+        Worker *target = nullptr;
+        for (auto &worker : implementation->_workers) {
+            if (target == nullptr || worker->get_load() < target->get_load()) {
+                target = worker.get();
+            }
+        }
+        target->post(std::move(task));
+
+        info.GetReturnValue().Set(resolver->GetPromise());
+    }
+
+    void IsolatePool::prototype_close(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "IsolatePool", ".", "prototype", ".", "close", " called on incompatible receiver ", receiver);
+        }
+        // The tasks not started yet are rejected; the promises are settled asynchronously, as any other result.
+        implementation->stop();
+    }
+
+    void IsolatePool::prototype_get_size(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "IsolatePool", ".", "prototype", ".", "size", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(v8::Integer::NewFromUnsigned(isolate, implementation->_size));
+    }
+
+    void IsolatePool::Channel::complete(std::unique_ptr<Task> task) {
+        // Called on the worker threads.
+        std::lock_guard lock(mutex);
+        if (async == nullptr) {
+            return;
+        }
+        results.push(std::move(task));
+        uv_async_send(async);
+    }
+
+    void IsolatePool::on_result(uv_async_t *handle) {
+        auto pool = static_cast<IsolatePool *>(handle->data);
+        auto isolate = pool->_isolate;
+        v8::HandleScope scope(isolate);
+        auto context = pool->_context.Get(isolate);
+        v8::Context::Scope context_scope(context);
+
+        auto resource = pool->get_interface(isolate);
+        if (resource.IsEmpty()) {
+            resource = v8::Object::New(isolate);
+        }
+        {
+            // Runs the microtasks (promise reactions) when the scope is left.
+            node::CallbackScope callback_scope(isolate, resource, { 0, 0 });
+            while (auto task = pool->_channel->results.pop()) {
+                pool->settle(context, **task);
+            }
+        }
+        if (pool->_pending.empty() && !pool->_self.IsEmpty()) {
+            pool->_self.Reset();
+            uv_unref(reinterpret_cast<uv_handle_t *>(handle));
+        }
+    }
+
+    void IsolatePool::settle(v8::Local<v8::Context> context, Task &task) {
+        auto isolate = context->GetIsolate();
+        v8::HandleScope scope(isolate);
+
+        auto pending = _pending.find(task.id);
+        if (pending == _pending.end()) {
+            return;
+        }
+        auto resolver = pending->second.Get(isolate);
+        _pending.erase(pending);
+
+        v8::Local<v8::Value> value;
+        auto fulfilled = task.fulfilled;
+        if (task.error.empty()) {
+            v8::TryCatch try_catch(isolate);
+            v8::ValueDeserializer deserializer(isolate, task.data, task.size);
+            if (!deserializer.ReadHeader(context).FromMaybe(false) || !deserializer.ReadValue(context).ToLocal(&value)) {
+                fulfilled = false;
+                if (try_catch.HasCaught() && try_catch.CanContinue()) {
+                    value = try_catch.Exception();
+                } else {
+                    value = v8::Exception::Error(StringTable::Get(isolate, "Cannot deserialize the result"));
+                }
+            }
+        } else {
+            fulfilled = false;
+            v8::Local<v8::String> message;
+            if (!v8::String::NewFromUtf8(isolate, task.error.data(), v8::NewStringType::kNormal, task.error.size()).ToLocal(&message)) {
+                message = StringTable::Get(isolate, "Cannot deserialize the result");
+            }
+            value = v8::Exception::Error(message);
+        }
+        if (fulfilled) {
+            resolver->Resolve(context, value).Check();
+        } else {
+            resolver->Reject(context, value).Check();
+        }
+    }
+
+    void IsolatePool::stop() {
+        if (_closed) {
+            return;
+        }
+        _closed = true;
+        for (auto &worker : _workers) {
+            worker->stop();
+        }
+        if (_workers.empty()) {
+            return;
+        }
+        // Called by close() and by the destructor, which may run in a weak callback: joining the workers waits for the running
+        // scripts to terminate and for the isolates to be disposed, which must block neither the caller nor the GC of this
+        // isolate, so the workers are destroyed on another thread.
+        auto &state = per_isolate_state[_isolate];
+        {
+            std::lock_guard lock(state.mutex);
+            ++state.reapers;
+        }
+        std::thread([&state, workers = std::move(_workers)]() mutable {
+            workers.clear();
+            std::lock_guard lock(state.mutex);
+            --state.reapers;
+            state.condition.notify_all();
+        }).detach();
+    }
+
+    IsolatePool::~IsolatePool() {
+        stop();
+        {
+            std::lock_guard lock(_channel->mutex);
+            _channel->async = nullptr;
+        }
+        if (_async != nullptr) {
+            uv_close(reinterpret_cast<uv_handle_t *>(_async), [](uv_handle_t *handle) {
+                delete reinterpret_cast<uv_async_t *>(handle);
+            });
+        }
+    }
+
+    IsolatePool::Worker::Worker(std::shared_ptr<Channel> channel, node::MultiIsolatePlatform *platform, const std::string &exports_name) :
+        _channel(std::move(channel)),
+        _platform(platform),
+        _exports_name(exports_name) {}
+
+    IsolatePool::Worker::~Worker() {
+        stop();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
+
+    bool IsolatePool::Worker::start() {
+        _thread = std::thread(&Worker::run, this);
+        _state.wait(0, std::memory_order_acquire);
+        return _state.load(std::memory_order_acquire) > 0;
+    }
+
+    void IsolatePool::Worker::stop() {
+        // Only signals the worker: the thread is joined by the destructor. The isolate is null unless the loop is running.
+        std::lock_guard lock(_mutex);
+        if (_isolate == nullptr || _stopping.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        uv_async_send(&_async);
+        // The script being executed (if any) is terminated; its promise is rejected.
+        _isolate->TerminateExecution();
+    }
+
+    void IsolatePool::Worker::post(std::unique_ptr<Task> task) {
+        _load.fetch_add(1, std::memory_order_relaxed);
+        _queue.push(std::move(task));
+        uv_async_send(&_async);
+    }
+
+    uint32_t IsolatePool::Worker::get_load() const {
+        return _load.load(std::memory_order_relaxed);
+    }
+
+    void IsolatePool::Worker::run() {
+        if (uv_loop_init(&_loop) != 0) {
+            _state.store(-1, std::memory_order_release);
+            _state.notify_all();
+            return;
+        }
+        std::shared_ptr<node::ArrayBufferAllocator> allocator = node::ArrayBufferAllocator::Create();
+        auto isolate = node::NewIsolate(allocator, &_loop, _platform);
+        if (isolate == nullptr) {
+            uv_loop_close(&_loop);
+            _state.store(-1, std::memory_order_release);
+            _state.notify_all();
+            return;
+        }
+
+        {
+            v8::Locker locker(isolate);
+            v8::Isolate::Scope isolate_scope(isolate);
+            bool initialized;
+            {
+                v8::HandleScope scope(isolate);
+                auto context = v8::Context::New(isolate);
+                v8::Context::Scope context_scope(context);
+                initialized = dragiyski::node_ext::initialize(context).IsJust();
+            }
+            if (initialized) {
+                uv_async_init(&_loop, &_async, on_task);
+                _async.data = this;
+                {
+                    std::lock_guard lock(_mutex);
+                    _isolate = isolate;
+                }
+                _state.store(1, std::memory_order_release);
+                _state.notify_all();
+                uv_run(&_loop, UV_RUN_DEFAULT);
+                {
+                    // After this, stop() neither wakes the loop nor terminates the isolate being disposed.
+                    std::lock_guard lock(_mutex);
+                    _isolate = nullptr;
+                }
+                // stop() may have terminated the isolate after the last script.
+                isolate->CancelTerminateExecution();
+            }
+            {
+                v8::HandleScope scope(isolate);
+                dragiyski::node_ext::uninitialize(isolate);
+            }
+        }
+
+        bool finished = false;
+        _platform->AddIsolateFinishedCallback(isolate, [](void *data) {
+            *static_cast<bool *>(data) = true;
+        }, &finished);
+        _platform->UnregisterIsolate(isolate);
+        isolate->Dispose();
+        while (!finished) {
+            uv_run(&_loop, UV_RUN_ONCE);
+        }
+        uv_loop_close(&_loop);
+
+        if (_state.load(std::memory_order_acquire) == 0) {
+            _state.store(-1, std::memory_order_release);
+            _state.notify_all();
+        }
+    }
+
+    void IsolatePool::Worker::on_task(uv_async_t *handle) {
+        auto worker = static_cast<Worker *>(handle->data);
+        while (!worker->_stopping.load(std::memory_order_acquire)) {
+            auto task = worker->_queue.pop();
+            if (!task.has_value()) {
+                return;
+            }
+            worker->execute(**task);
+            worker->_load.fetch_sub(1, std::memory_order_relaxed);
+            worker->_channel->complete(std::move(*task));
+        }
+        while (auto task = worker->_queue.pop()) {
+            (*task)->error = "The isolate pool is closed";
+            worker->_load.fetch_sub(1, std::memory_order_relaxed);
+            worker->_channel->complete(std::move(*task));
+        }
+        // The loop exits once the handle is closed.
+        uv_close(reinterpret_cast<uv_handle_t *>(handle), nullptr);
+    }
+
+    void IsolatePool::Worker::execute(Task &task) {
+        JS_TRACE_SCOPE("isolate-pool", "IsolatePool::Worker::execute");
+        auto isolate = _isolate;
+        v8::HandleScope scope(isolate);
+        auto context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        v8::TryCatch try_catch(isolate);
+
+        auto value = [&]() -> v8::MaybeLocal<v8::Value> {
+            using __function_return_type__ = v8::MaybeLocal<v8::Value>;
+            if (!_exports_name.empty()) {
+                auto exports = v8::Object::New(isolate);
+                JS_EXPRESSION_IGNORE(initialize_exports(context, exports));
+                JS_EXPRESSION_RETURN(name, v8::String::NewFromUtf8(isolate, _exports_name.data(), v8::NewStringType::kNormal, _exports_name.size()));
+                JS_EXPRESSION_IGNORE(context->Global()->DefineOwnProperty(context, name, exports, v8::PropertyAttribute::DontEnum));
+            }
+            JS_EXPRESSION_RETURN(source, v8::String::NewFromUtf8(isolate, task.source.data(), v8::NewStringType::kNormal, task.source.size()));
+            JS_EXPRESSION_RETURN(filename, v8::String::NewFromUtf8(isolate, task.filename.data(), v8::NewStringType::kNormal, task.filename.size()));
+            v8::ScriptOrigin origin(filename);
+            JS_EXPRESSION_RETURN(script, v8::Script::Compile(context, source, &origin));
+            bool timed_out;
+            auto run = Script::run(context, script, task.timeout, timed_out);
+            if (timed_out) {
+                JS_THROW_ERROR(Error, isolate, "Script execution timed out after ", task.timeout, "ms");
+            }
+            JS_EXPRESSION_RETURN(completion, run);
+            isolate->PerformMicrotaskCheckpoint();
+            if (!completion->IsPromise()) {
+                return completion;
+            }
+            auto promise = completion.As<v8::Promise>();
+            switch (promise->State()) {
+                case v8::Promise::PromiseState::kFulfilled:
+                    return promise->Result();
+                case v8::Promise::PromiseState::kRejected:
+                    promise->MarkAsHandled();
+                    isolate->ThrowException(promise->Result());
+                    return {};
+                default:
+                    JS_THROW_ERROR(Error, isolate, "The promise returned by the script did not settle");
+            }
+        }();
+
+        v8::Local<v8::Value> result;
+        if (value.ToLocal(&result)) {
+            task.fulfilled = true;
+        } else if (try_catch.HasCaught() && try_catch.CanContinue()) {
+            task.fulfilled = false;
+            result = try_catch.Exception();
+            try_catch.Reset();
+        } else {
+            task.error = "The script was terminated";
+            return;
+        }
+
+        if V8_UNLIKELY(serialize(context, task, result).IsNothing()) {
+            // Report why the value cannot be cloned (e.g. a function), instead of the value itself.
+            task.fulfilled = false;
+            task.error = "The result cannot be serialized";
+            if (try_catch.HasCaught() && try_catch.CanContinue()) {
+                v8::Local<v8::String> message;
+                if (try_catch.Exception()->ToString(context).ToLocal(&message)) {
+                    v8::String::Utf8Value string(isolate, message);
+                    task.error.assign(*string, string.length());
+                }
+            }
+        }
+    }
+
+    v8::Maybe<void> IsolatePool::Worker::serialize(v8::Local<v8::Context> context, Task &task, v8::Local<v8::Value> value) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        v8::ValueSerializer serializer(context->GetIsolate());
+        serializer.WriteHeader();
+        JS_EXPRESSION_IGNORE(serializer.WriteValue(context, value));
+        auto [data, size] = serializer.Release();
+        task.data = data;
+        task.size = size;
+        return v8::JustVoid();
+    }
+}
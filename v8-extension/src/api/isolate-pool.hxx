@@ -0,0 +1,146 @@
+#ifndef NODE_EXT_API_ISOLATE_POOL_HXX
+#define NODE_EXT_API_ISOLATE_POOL_HXX
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <node.h>
+#include <uv.h>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../mpsc-queue.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Run scripts on a fixed number of isolates, each on its own thread.
+     *
+     * Every worker isolate is created through node::NewIsolate() with the platform of the current Node.js environment and is
+     * initialized through the same initialize() sequence as the isolate loading the addon. run(source) queues the script to the worker
+     * with the fewest queued tasks and returns a promise. The worker compiles and runs the script in a new context, waits for the
+     * microtasks, and serializes the completion value (or the exception) with v8::ValueSerializer. The result is deserialized and
+     * the promise is settled on the thread of the pool, woken by uv_async_t. run(source, { filename, timeout }) runs the script
+     * through Script::run(), so a timeout (in milliseconds) is enforced by the watchdog of the worker isolate and rejects the
+     * promise without affecting the other tasks of the worker.
+     *
+     * Requests and results are passed through lock-free MPSC queues: one request queue per worker, one result queue per pool.
+     *
+     * close() stops the workers: the running scripts are terminated and the tasks not started yet are rejected. A pool collected
+     * by the GC stops its workers as well. In both cases the threads are joined by a separate thread, since disposing the worker
+     * isolates must block neither the caller nor the GC of this one. uninitialize() waits for those threads.
+     *
+     * Options (all optional):
+     * size - the number of worker isolates; by default the number of hardware threads;
+     * exports - the name of a global property through which the scripts can access the classes of the addon.
+     */
+    class IsolatePool : public Object<IsolatePool> {
+    public:
+        struct Task {
+            uint64_t id = 0;
+            std::string source;
+            std::string filename;
+            double timeout = 0;
+            // Set by the worker: the serialized completion value (or exception), or a message if it cannot be serialized.
+            bool fulfilled = false;
+            uint8_t *data = nullptr;
+            std::size_t size = 0;
+            std::string error;
+        public:
+            Task() = default;
+            Task(const Task &) = delete;
+            Task(Task &&) = delete;
+            ~Task();
+        };
+        class Worker;
+        /**
+         * @brief The results of the workers, shared with them: a worker may still complete tasks after the pool is destroyed.
+         */
+        struct Channel {
+            std::mutex mutex;
+            // Closed (nullptr) by the destructor of the pool; the results completed later are discarded.
+            uv_async_t *async = nullptr;
+            MpscQueue<std::unique_ptr<Task>> results;
+        public:
+            void complete(std::unique_ptr<Task> task);
+        };
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_run(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_close(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_size(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static void on_result(uv_async_t *handle);
+    private:
+        v8::Isolate *_isolate = nullptr;
+        Shared<v8::Context> _context;
+        // Strong reference to the interface while tasks are pending, so the pool is not collected with unsettled promises.
+        Shared<v8::Object> _self;
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::shared_ptr<Channel> _channel = std::make_shared<Channel>();
+        uv_async_t *_async = nullptr;
+        std::map<uint64_t, Shared<v8::Promise::Resolver>> _pending;
+        uint64_t _next_id = 0;
+        uint32_t _size = 0;
+        bool _closed = false;
+    private:
+        void settle(v8::Local<v8::Context> context, Task &task);
+        void stop();
+    protected:
+        IsolatePool() = default;
+        IsolatePool(const IsolatePool &) = delete;
+        IsolatePool(IsolatePool &&) = delete;
+    public:
+        virtual ~IsolatePool() override;
+    };
+
+    /**
+     * @brief A thread owning an isolate and a uv loop; tasks are posted to it from any thread.
+     */
+    class IsolatePool::Worker {
+    public:
+        Worker(std::shared_ptr<Channel> channel, node::MultiIsolatePlatform *platform, const std::string &exports_name);
+        Worker(const Worker &) = delete;
+        Worker(Worker &&) = delete;
+        ~Worker();
+    public:
+        bool start();
+        void stop();
+        void post(std::unique_ptr<Task> task);
+        uint32_t get_load() const;
+    private:
+        static void on_task(uv_async_t *handle);
+        void run();
+        void execute(Task &task);
+        v8::Maybe<void> serialize(v8::Local<v8::Context> context, Task &task, v8::Local<v8::Value> value);
+    private:
+        std::shared_ptr<Channel> _channel;
+        node::MultiIsolatePlatform *_platform;
+        std::string _exports_name;
+        std::thread _thread;
+        uv_loop_t _loop;
+        uv_async_t _async;
+        MpscQueue<std::unique_ptr<Task>> _queue;
+        std::atomic<uint32_t> _load = 0;
+        std::atomic<bool> _stopping = false;
+        // 0 - starting, 1 - running, -1 - failed to start; written once by the worker thread.
+        std::atomic<int> _state = 0;
+        // Guards _isolate, set while the loop of the worker runs, against stop() called from the thread of the pool.
+        std::mutex _mutex;
+        v8::Isolate *_isolate = nullptr;
+    };
+}
+
+#endif /* NODE_EXT_API_ISOLATE_POOL_HXX */
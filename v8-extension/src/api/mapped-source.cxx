@@ -0,0 +1,514 @@
+#include "mapped-source.hxx"
+
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+
+        enum class Encoding {
+            UTF8,
+            LATIN1,
+            UTF16LE
+        };
+
+        // Smaller files are copied: reading them costs about as much as mapping them, and a copy cannot fault later.
+        constexpr const std::size_t copy_threshold = 1 << 20;
+
+        // Reads from the current offset until the end of the file; the size is only a hint, the file may change meanwhile.
+        int read_all(int fd, std::size_t size, std::vector<char> &buffer) {
+            buffer.resize(size > 0 ? size : 4096);
+            std::size_t offset = 0;
+            while (true) {
+                if (offset == buffer.size()) {
+                    buffer.resize(buffer.size() * 2);
+                }
+                auto count = read(fd, buffer.data() + offset, buffer.size() - offset);
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count < 0) {
+                    return errno;
+                }
+                if (count == 0) {
+                    break;
+                }
+                offset += static_cast<std::size_t>(count);
+            }
+            buffer.resize(offset);
+            return 0;
+        }
+
+        // Either the mapping of a file or a copy of its content.
+        class MappedFile {
+        public:
+            MappedFile() = default;
+            MappedFile(const MappedFile &) = delete;
+            MappedFile(MappedFile &&other) noexcept : _address(other._address), _size(other._size), _buffer(std::move(other._buffer)) {
+                other._address = nullptr;
+                other._size = 0;
+            }
+            ~MappedFile() {
+                if (_address != nullptr) {
+                    munmap(_address, _size);
+                }
+            }
+        public:
+            /**
+             * @brief Maps or copies the file; returns the errno of the failed call.
+             *
+             * When the file is mapped, the descriptor stays open and is returned in descriptor (the caller closes it),
+             * otherwise descriptor is -1. An empty file is neither mapped nor copied.
+             */
+            int open(const char *path, int &descriptor, struct stat &status) {
+                descriptor = -1;
+                auto fd = ::open(path, O_RDONLY | O_CLOEXEC);
+                if (fd < 0) {
+                    return errno;
+                }
+                if (fstat(fd, &status) != 0) {
+                    auto error = errno;
+                    close(fd);
+                    return error;
+                }
+                if (!S_ISREG(status.st_mode)) {
+                    close(fd);
+                    return S_ISDIR(status.st_mode) ? EISDIR : EINVAL;
+                }
+                auto size = static_cast<std::size_t>(status.st_size);
+                if (size < copy_threshold) {
+                    auto error = copy(fd, size);
+                    close(fd);
+                    return error;
+                }
+                auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (address == MAP_FAILED) {
+                    auto error = errno;
+                    close(fd);
+                    return error;
+                }
+                _address = address;
+                _size = size;
+                descriptor = fd;
+                return 0;
+            }
+
+            /**
+             * @brief Copies the content of the file from the start.
+             */
+            int copy(int fd, std::size_t size_hint) {
+                if (lseek(fd, 0, SEEK_SET) < 0) {
+                    return errno;
+                }
+                if (auto error = read_all(fd, size_hint, _buffer); error != 0) {
+                    return error;
+                }
+                _size = _buffer.size();
+                return 0;
+            }
+
+            const void *data() const {
+                return _address != nullptr ? _address : _buffer.data();
+            }
+
+            std::size_t size() const {
+                return _size;
+            }
+
+            bool is_mapped() const {
+                return _address != nullptr;
+            }
+        private:
+            void *_address = nullptr;
+            std::size_t _size = 0;
+            std::vector<char> _buffer;
+        };
+
+        // The resource owns the mapping (or the copy); V8 disposes the resource (deleting it) when the external string dies.
+        template<class Base, typename Char>
+        class MappedResource final : public Base {
+        public:
+            explicit MappedResource(MappedFile &&file) : _file(std::move(file)) {}
+        public:
+            const Char *data() const override {
+                return static_cast<const Char *>(_file.data());
+            }
+
+            std::size_t length() const override {
+                return _file.size() / sizeof(Char);
+            }
+        private:
+            MappedFile _file;
+        };
+
+        template<class Base, typename Char>
+        class OwnedResource final : public Base {
+        public:
+            explicit OwnedResource(std::vector<Char> &&data) : _data(std::move(data)) {}
+        public:
+            const Char *data() const override {
+                return _data.data();
+            }
+
+            std::size_t length() const override {
+                return _data.size();
+            }
+        private:
+            std::vector<Char> _data;
+        };
+
+        v8::MaybeLocal<v8::String> new_external(v8::Isolate *isolate, v8::String::ExternalOneByteStringResource *resource) {
+            return v8::String::NewExternalOneByte(isolate, resource);
+        }
+
+        v8::MaybeLocal<v8::String> new_external(v8::Isolate *isolate, v8::String::ExternalStringResource *resource) {
+            return v8::String::NewExternalTwoByte(isolate, resource);
+        }
+
+        template<class Resource, typename Input>
+        v8::MaybeLocal<v8::String> create_string(v8::Isolate *isolate, Input &&input) {
+            using __function_return_type__ = v8::MaybeLocal<v8::String>;
+            auto resource = std::make_unique<Resource>(std::forward<Input>(input));
+            if V8_UNLIKELY(resource->length() > static_cast<std::size_t>(v8::String::kMaxLength)) {
+                JS_THROW_ERROR(RangeError, isolate, "Invalid string length");
+            }
+            if (resource->length() == 0) {
+                return v8::String::Empty(isolate);
+            }
+            // On success V8 owns the resource, on failure the exception is pending and the resource is ours to delete.
+            auto string = new_external(isolate, resource.get());
+            if V8_LIKELY(!string.IsEmpty()) {
+                resource.release();
+            }
+            return string;
+        }
+
+        /**
+         * @brief Decodes UTF-8 as TextDecoder does: each maximal invalid subsequence becomes U+FFFD.
+         *
+         * Returns whether every code point is below U+0100, so the result can be narrowed to Latin-1.
+         */
+        bool decode_utf8(const std::uint8_t *data, std::size_t length, std::vector<std::uint16_t> &output) {
+            output.reserve(length);
+            bool is_latin1 = true;
+            std::size_t i = 0;
+            while (i < length) {
+                auto byte = data[i];
+                if (byte < 0x80) {
+                    output.push_back(byte);
+                    ++i;
+                    continue;
+                }
+                std::uint32_t code_point;
+                int needed;
+                std::uint8_t lower = 0x80, upper = 0xBF;
+                if (byte >= 0xC2 && byte <= 0xDF) {
+                    needed = 1;
+                    code_point = byte & 0x1F;
+                } else if (byte >= 0xE0 && byte <= 0xEF) {
+                    needed = 2;
+                    code_point = byte & 0x0F;
+                    lower = byte == 0xE0 ? 0xA0 : lower;
+                    upper = byte == 0xED ? 0x9F : upper;
+                } else if (byte >= 0xF0 && byte <= 0xF4) {
+                    needed = 3;
+                    code_point = byte & 0x07;
+                    lower = byte == 0xF0 ? 0x90 : lower;
+                    upper = byte == 0xF4 ? 0x8F : upper;
+                } else {
+                    output.push_back(0xFFFD);
+                    is_latin1 = false;
+                    ++i;
+                    continue;
+                }
+                ++i;
+                bool is_valid = true;
+                for (int k = 0; k < needed; ++k, ++i) {
+                    // The offending byte is not consumed; it starts the next sequence.
+                    if (i >= length || data[i] < lower || data[i] > upper) {
+                        is_valid = false;
+                        break;
+                    }
+                    code_point = (code_point << 6) | (data[i] & 0x3F);
+                    lower = 0x80;
+                    upper = 0xBF;
+                }
+                if V8_UNLIKELY(!is_valid) {
+                    output.push_back(0xFFFD);
+                    is_latin1 = false;
+                } else if (code_point >= 0x10000) {
+                    code_point -= 0x10000;
+                    output.push_back(static_cast<std::uint16_t>(0xD800 + (code_point >> 10)));
+                    output.push_back(static_cast<std::uint16_t>(0xDC00 + (code_point & 0x3FF)));
+                    is_latin1 = false;
+                } else {
+                    output.push_back(static_cast<std::uint16_t>(code_point));
+                    is_latin1 = is_latin1 && code_point < 0x100;
+                }
+            }
+            return is_latin1;
+        }
+
+        using OneByteMappedResource = MappedResource<v8::String::ExternalOneByteStringResource, char>;
+        using TwoByteMappedResource = MappedResource<v8::String::ExternalStringResource, std::uint16_t>;
+        using OneByteOwnedResource = OwnedResource<v8::String::ExternalOneByteStringResource, char>;
+        using TwoByteOwnedResource = OwnedResource<v8::String::ExternalStringResource, std::uint16_t>;
+
+        // The string reads the file directly if the content can be represented as is (mapped is set if the file was mapped).
+        v8::MaybeLocal<v8::String> create_source(v8::Isolate *isolate, MappedFile &&file, Encoding encoding, bool &mapped) {
+            using __function_return_type__ = v8::MaybeLocal<v8::String>;
+            auto byte_length = file.size();
+            auto mapped_file = file.is_mapped();
+            auto bytes = static_cast<const std::uint8_t *>(file.data());
+            v8::Local<v8::String> source;
+            mapped = false;
+            if (byte_length == 0) {
+                source = v8::String::Empty(isolate);
+            } else if (encoding == Encoding::LATIN1 || (encoding == Encoding::UTF8 && is_ascii(static_cast<const char *>(file.data()), byte_length))) {
+                JS_EXPRESSION_RETURN(value, create_string<OneByteMappedResource>(isolate, std::move(file)));
+                source = value;
+                mapped = mapped_file;
+            } else if (encoding == Encoding::UTF16LE) {
+                // The mapping is page-aligned and the copy is aligned by operator new, so either can be read as char16_t as long as the byte order matches.
+                if (std::endian::native == std::endian::little && byte_length % 2 == 0) {
+                    JS_EXPRESSION_RETURN(value, create_string<TwoByteMappedResource>(isolate, std::move(file)));
+                    source = value;
+                    mapped = mapped_file;
+                } else {
+                    std::vector<std::uint16_t> data(byte_length / 2);
+                    for (std::size_t i = 0; i < data.size(); ++i) {
+                        data[i] = static_cast<std::uint16_t>(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+                    }
+                    if (byte_length % 2 != 0) {
+                        data.push_back(0xFFFD);
+                    }
+                    JS_EXPRESSION_RETURN(value, create_string<TwoByteOwnedResource>(isolate, std::move(data)));
+                    source = value;
+                }
+            } else {
+                std::vector<std::uint16_t> data;
+                if (decode_utf8(bytes, byte_length, data)) {
+                    std::vector<char> narrow(data.begin(), data.end());
+                    JS_EXPRESSION_RETURN(value, create_string<OneByteOwnedResource>(isolate, std::move(narrow)));
+                    source = value;
+                } else {
+                    JS_EXPRESSION_RETURN(value, create_string<TwoByteOwnedResource>(isolate, std::move(data)));
+                    source = value;
+                }
+            }
+            return source;
+        }
+    }
+
+    void MappedSource::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "MappedSource");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 1);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "source");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_source, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "byteLength");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_byte_length, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "mapped");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_mapped, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        Object<MappedSource>::initialize(isolate);
+    }
+
+    void MappedSource::uninitialize(v8::Isolate *isolate) {
+        Object<MappedSource>::uninitialize(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> MappedSource::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    MappedSource::~MappedSource() {
+        if (_descriptor >= 0) {
+            close(_descriptor);
+        }
+    }
+
+    v8::MaybeLocal<v8::String> MappedSource::get_source(v8::Isolate *isolate) {
+        using __function_return_type__ = v8::MaybeLocal<v8::String>;
+        if (_descriptor >= 0) {
+            struct stat status;
+            auto is_changed = fstat(_descriptor, &status) != 0 ||
+                status.st_size != _status.st_size ||
+                status.st_mtim.tv_sec != _status.st_mtim.tv_sec ||
+                status.st_mtim.tv_nsec != _status.st_mtim.tv_nsec;
+            if V8_UNLIKELY(is_changed) {
+                // The mapped pages past a new end of the file raise SIGBUS when read: continue with a copy of the file.
+                MappedFile file;
+                if (auto error = file.copy(_descriptor, _byte_length); error != 0) {
+                    JS_THROW_ERROR(Error, isolate, "Cannot read the changed mapped file: ", std::strerror(error));
+                }
+                close(_descriptor);
+                _descriptor = -1;
+                _byte_length = file.size();
+                bool mapped = false;
+                JS_EXPRESSION_RETURN(source, create_source(isolate, std::move(file), static_cast<Encoding>(_encoding), mapped));
+                _source.Reset(isolate, source);
+                _mapped = false;
+            }
+        }
+        return _source.Get(isolate);
+    }
+
+    void MappedSource::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "MappedSource", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsString()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be a string.");
+        }
+        auto path = info[0].As<v8::String>();
+
+        auto encoding = Encoding::UTF8;
+        if (!info[1]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[1]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an object, if specified.");
+            }
+            auto options = info[1].As<v8::Object>();
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, StringTable::Get(isolate, "encoding")));
+            if (!js_value->IsUndefined()) {
+                JS_EXPRESSION_RETURN(js_encoding, js_value->ToString(context));
+                v8::String::Utf8Value encoding_name(isolate, js_encoding);
+                std::string_view name(*encoding_name, encoding_name.length());
+                if (name == "utf-8" || name == "utf8") {
+                    encoding = Encoding::UTF8;
+                } else if (name == "latin1") {
+                    encoding = Encoding::LATIN1;
+                } else if (name == "utf-16le") {
+                    encoding = Encoding::UTF16LE;
+                } else {
+                    JS_THROW_ERROR(RangeError, isolate, "Option \"encoding\": expected \"utf-8\", \"latin1\" or \"utf-16le\", got \"", js_encoding, "\".");
+                }
+            }
+        }
+
+        MappedFile file;
+        int descriptor;
+        struct stat status;
+        {
+            v8::String::Utf8Value path_value(isolate, path);
+            if (auto error = file.open(*path_value, descriptor, status); error != 0) {
+                JS_THROW_ERROR(Error, isolate, "Cannot map \"", path, "\": ", std::strerror(error));
+            }
+        }
+
+        auto byte_length = file.size();
+        bool mapped = false;
+        auto maybe_source = create_source(isolate, std::move(file), encoding, mapped);
+        if (!mapped && descriptor >= 0) {
+            close(descriptor);
+            descriptor = -1;
+        }
+        JS_EXPRESSION_RETURN(source, maybe_source);
+
+        auto implementation = std::unique_ptr<MappedSource>(new MappedSource());
+        implementation->_source.Reset(isolate, source);
+        implementation->_byte_length = byte_length;
+        implementation->_encoding = static_cast<int>(encoding);
+        implementation->_mapped = mapped;
+        implementation->_descriptor = descriptor;
+        implementation->_status = status;
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void MappedSource::prototype_get_source(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "MappedSource", ".", "prototype", ".", "source", " called on incompatible receiver ", receiver);
+        }
+        JS_EXPRESSION_RETURN(source, implementation->get_source(isolate));
+        info.GetReturnValue().Set(source);
+    }
+
+    void MappedSource::prototype_get_byte_length(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "MappedSource", ".", "prototype", ".", "byteLength", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(static_cast<double>(implementation->_byte_length));
+    }
+
+    void MappedSource::prototype_get_mapped(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "MappedSource", ".", "prototype", ".", "mapped", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(implementation->_mapped);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef NODE_EXT_API_MAPPED_SOURCE_HXX
+#define NODE_EXT_API_MAPPED_SOURCE_HXX
+
+#include <cstddef>
+#include <sys/stat.h>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief A source file mapped read-only into memory and exposed to V8 as an external string.
+     *
+     * new MappedSource(path, { encoding }) maps the file with mmap() and creates a v8::String that reads the mapping directly
+     * when the content can be represented as is: any "latin1" file, a "utf-8" file that is pure ASCII (checked by a vectorized
+     * scan) or a "utf-16le" file. Otherwise the content is transcoded once into an owned buffer (Latin-1 if every code point
+     * fits, UTF-16 otherwise) and the file is unmapped immediately.
+     *
+     * The string is the "source" property; it can be passed as the "source" option of Context.prototype.compileFunction()
+     * (the MappedSource itself is accepted as well) and reused by any number of compiles in any context of the isolate. The
+     * mapping belongs to the external string resource, so it is unmapped when the last reference to the string dies, not when
+     * the MappedSource does.
+     *
+     * Files smaller than 1 MiB are read into memory instead: for those a copy costs about as much as the mapping.
+     *
+     * Hazard: reading a page of a mapping past the end of its file raises SIGBUS, so a mapped file must not be truncated while
+     * the string is in use (V8 reads the source of a script again for lazy compilation and Function.prototype.toString).
+     * The MappedSource keeps the file open and checks its size and modification time whenever the source is requested (by
+     * "source" or a compile); if the file changed, it switches to a copy of the current content ("mapped" becomes false).
+     * Strings and scripts obtained before the change still read the mapping.
+     */
+    class MappedSource : public Object<MappedSource> {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+        /**
+         * @brief The source string; throws if the file changed since it was mapped and cannot be read again.
+         */
+        v8::MaybeLocal<v8::String> get_source(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_source(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_byte_length(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_mapped(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        Shared<v8::String> _source;
+        std::size_t _byte_length = 0;
+        /**
+         * @brief Whether the string reads the mapped file (false if the content was transcoded).
+         */
+        bool _mapped = false;
+        int _encoding = 0;
+        // The mapped file and its status at the time it was mapped; -1 if the source does not read a mapping.
+        int _descriptor = -1;
+        struct stat _status = {};
+    protected:
+        MappedSource() = default;
+        MappedSource(const MappedSource &) = delete;
+        MappedSource(MappedSource &&) = delete;
+    public:
+        virtual ~MappedSource() override;
+    };
+}
+
+#endif /* NODE_EXT_API_MAPPED_SOURCE_HXX */
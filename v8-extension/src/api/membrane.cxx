@@ -0,0 +1,883 @@
+#include "membrane.hxx"
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::ObjectTemplate>> per_isolate_wrapper_template;
+
+        // Field 0 is left empty, so that Object<T>::get_implementation() never accepts a wrapper.
+        enum : int {
+            WRAPPER_FIELD_RESERVED,
+            WRAPPER_FIELD_MEMBRANE,
+            WRAPPER_FIELD_ORIGINAL,
+            WRAPPER_FIELD_SIDE,
+            WRAPPER_FIELD_COUNT
+        };
+
+        // Field 0 is the implementation (see Object<T>).
+        enum : int {
+            INTERFACE_FIELD_CONTEXT = 1,
+            INTERFACE_FIELD_ERROR_TABLE = INTERFACE_FIELD_CONTEXT + Membrane::SIDE_COUNT,
+            // WeakRef and WeakRef.prototype.deref of the context creating the membrane, or undefined.
+            INTERFACE_FIELD_WEAK_REF = INTERFACE_FIELD_ERROR_TABLE + Membrane::SIDE_COUNT,
+            INTERFACE_FIELD_DEREF,
+            INTERFACE_FIELD_COUNT
+        };
+    }
+
+    void Membrane::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "Membrane");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 2);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "wrap");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_wrap, {}, signature, 1, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "unwrap");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_unwrap, {}, signature, 1, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(INTERFACE_FIELD_COUNT);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        {
+            auto wrapper_template = v8::ObjectTemplate::New(isolate);
+            wrapper_template->SetInternalFieldCount(WRAPPER_FIELD_COUNT);
+            wrapper_template->SetHandler(v8::NamedPropertyHandlerConfiguration(
+                named_getter_callback,
+                named_setter_callback,
+                named_query_callback,
+                named_deleter_callback,
+                named_enumerator_callback,
+                named_definer_callback,
+                named_descriptor_callback
+            ));
+            wrapper_template->SetHandler(v8::IndexedPropertyHandlerConfiguration(
+                indexed_getter_callback,
+                indexed_setter_callback,
+                indexed_query_callback,
+                indexed_deleter_callback,
+                indexed_enumerator_callback,
+                indexed_definer_callback,
+                indexed_descriptor_callback
+            ));
+            per_isolate_wrapper_template.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(isolate),
+                std::forward_as_tuple(isolate, wrapper_template)
+            );
+        }
+
+        Object<Membrane>::initialize(isolate);
+    }
+
+    void Membrane::uninitialize(v8::Isolate *isolate) {
+        Object<Membrane>::uninitialize(isolate);
+        per_isolate_wrapper_template.erase(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> Membrane::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void Membrane::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "Membrane", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        if V8_UNLIKELY(info.Length() < 2) {
+            JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+        }
+        for (int side = 0; side < SIDE_COUNT; ++side) {
+            if V8_UNLIKELY(!info[side]->IsObject()) {
+                JS_THROW_ERROR(TypeError, context, "Expected arguments[", side, "] to be an [object], got ", type_of(context, info[side]));
+            }
+        }
+
+        auto self = info.This();
+        for (int side = 0; side < SIDE_COUNT; ++side) {
+            JS_EXPRESSION_RETURN(side_context, info[side].As<v8::Object>()->GetCreationContext());
+            self->SetInternalField(INTERFACE_FIELD_CONTEXT + side, side_context);
+            self->SetInternalField(INTERFACE_FIELD_ERROR_TABLE + side, v8::Map::New(isolate));
+        }
+
+        {
+            v8::Local<v8::Value> weak_ref = v8::Undefined(isolate), deref = v8::Undefined(isolate);
+            JS_EXPRESSION_RETURN(constructor, context->Global()->Get(context, StringTable::Get(isolate, "WeakRef")));
+            if (constructor->IsFunction()) {
+                JS_EXPRESSION_RETURN(prototype, constructor.As<v8::Object>()->Get(context, StringTable::Get(isolate, "prototype")));
+                if (prototype->IsObject()) {
+                    JS_EXPRESSION_RETURN(function, prototype.As<v8::Object>()->Get(context, StringTable::Get(isolate, "deref")));
+                    if (function->IsFunction()) {
+                        weak_ref = constructor;
+                        deref = function;
+                    }
+                }
+            }
+            self->SetInternalField(INTERFACE_FIELD_WEAK_REF, weak_ref);
+            self->SetInternalField(INTERFACE_FIELD_DEREF, deref);
+        }
+
+        auto implementation = std::unique_ptr<Membrane>(new Membrane());
+        for (int side = 0; side < SIDE_COUNT; ++side) {
+            implementation->_wrapper_key[side].Reset(isolate, v8::Private::New(isolate, StringTable::Get(isolate, "wrapper")));
+            implementation->_original_key[side].Reset(isolate, v8::Private::New(isolate, StringTable::Get(isolate, "original")));
+        }
+        auto membrane = implementation.get();
+        implementation.release()->set_interface(isolate, self);
+
+        {
+            auto context_a = membrane->get_context(isolate, 0);
+            auto context_b = membrane->get_context(isolate, 1);
+            v8::Local<v8::String> error_names[] = {
+                StringTable::Get(isolate, "Error"),
+                StringTable::Get(isolate, "EvalError"),
+                StringTable::Get(isolate, "RangeError"),
+                StringTable::Get(isolate, "ReferenceError"),
+                StringTable::Get(isolate, "SyntaxError"),
+                StringTable::Get(isolate, "TypeError"),
+                StringTable::Get(isolate, "URIError"),
+                StringTable::Get(isolate, "AggregateError")
+            };
+            for (auto name : error_names) {
+                JS_EXPRESSION_RETURN(constructor_a, context_a->Global()->Get(context_a, name));
+                JS_EXPRESSION_RETURN(constructor_b, context_b->Global()->Get(context_b, name));
+                JS_EXPRESSION_IGNORE(membrane->add_error(context, constructor_a, constructor_b, false));
+            }
+        }
+
+        if (!info[2]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[2]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[2] to be an object, if specified.");
+            }
+            auto options = info[2].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "errors");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (value->IsMap()) {
+                    auto entries = value.As<v8::Map>()->AsArray();
+                    for (uint32_t i = 0; i + 1 < entries->Length(); i += 2) {
+                        JS_EXPRESSION_RETURN(constructor_a, entries->Get(context, i));
+                        JS_EXPRESSION_RETURN(constructor_b, entries->Get(context, i + 1));
+                        JS_EXPRESSION_IGNORE(membrane->add_error(context, constructor_a, constructor_b, true));
+                    }
+                } else if (value->IsArray()) {
+                    auto entries = value.As<v8::Array>();
+                    for (uint32_t i = 0; i < entries->Length(); ++i) {
+                        JS_EXPRESSION_RETURN(entry, entries->Get(context, i));
+                        if V8_UNLIKELY(!entry->IsArray()) {
+                            JS_THROW_ERROR(TypeError, isolate, "Option \"errors\": expected an array of [constructorA, constructorB] pairs.");
+                        }
+                        JS_EXPRESSION_RETURN(constructor_a, entry.As<v8::Array>()->Get(context, 0));
+                        JS_EXPRESSION_RETURN(constructor_b, entry.As<v8::Array>()->Get(context, 1));
+                        JS_EXPRESSION_IGNORE(membrane->add_error(context, constructor_a, constructor_b, true));
+                    }
+                } else if (!value->IsNullOrUndefined()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Option \"errors\": expected a Map or an array of [constructorA, constructorB] pairs.");
+                }
+            }
+        }
+
+        info.GetReturnValue().Set(self);
+    }
+
+    void Membrane::prototype_wrap(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Membrane", ".", "prototype", ".", "wrap", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(implementation->_revoked) {
+            JS_THROW_ERROR(TypeError, isolate, "Cannot wrap with a revoked Membrane");
+        }
+        JS_EXPRESSION_RETURN(value, implementation->convert(isolate, 1, info[0]));
+        info.GetReturnValue().Set(value);
+    }
+
+    void Membrane::prototype_unwrap(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Membrane", ".", "prototype", ".", "unwrap", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(implementation->_revoked) {
+            JS_THROW_ERROR(TypeError, isolate, "Cannot unwrap with a revoked Membrane");
+        }
+        JS_EXPRESSION_RETURN(value, implementation->convert(isolate, 0, info[0]));
+        info.GetReturnValue().Set(value);
+    }
+
+    bool Membrane::get_target(v8::Isolate *isolate, v8::Local<v8::Object> wrapper, Target &target) {
+        static const constexpr auto __function_return_type__ = []() { return false; };
+        if V8_UNLIKELY(wrapper->InternalFieldCount() != WRAPPER_FIELD_COUNT) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal invocation");
+        }
+        auto membrane = wrapper->GetInternalField(WRAPPER_FIELD_MEMBRANE).As<v8::Value>();
+        if V8_UNLIKELY(!membrane->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "Cannot use a wrapper of a revoked Membrane");
+        }
+        target.membrane = get_own_implementation(isolate, membrane.As<v8::Object>());
+        if V8_UNLIKELY(target.membrane == nullptr) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal invocation");
+        }
+        if V8_UNLIKELY(target.membrane->_revoked) {
+            // Let the original object (and its context) go, even if the wrapper itself is still reachable.
+            wrapper->SetInternalField(WRAPPER_FIELD_MEMBRANE, v8::Undefined(isolate));
+            wrapper->SetInternalField(WRAPPER_FIELD_ORIGINAL, v8::Undefined(isolate));
+            JS_THROW_ERROR(TypeError, isolate, "Cannot use a wrapper of a revoked Membrane");
+        }
+        target.side = wrapper->GetInternalField(WRAPPER_FIELD_SIDE).As<v8::Value>().As<v8::Int32>()->Value();
+        target.original = wrapper->GetInternalField(WRAPPER_FIELD_ORIGINAL).As<v8::Value>().As<v8::Object>();
+        target.context = target.membrane->get_context(isolate, 1 - target.side);
+        return true;
+    }
+
+    template<typename F>
+    v8::Maybe<void> Membrane::forward(v8::Isolate *isolate, int side, F &&operation) {
+        v8::Local<v8::Value> exception;
+        {
+            v8::TryCatch try_catch(isolate);
+            if V8_LIKELY(operation()) {
+                return v8::JustVoid();
+            }
+            if (!try_catch.HasCaught() || !try_catch.CanContinue()) {
+                // Termination is re-thrown by the destructor of the v8::TryCatch.
+                return v8::Nothing<void>();
+            }
+            exception = try_catch.Exception();
+        }
+        // The exception crosses the membrane like any other value.
+        auto converted = convert(isolate, side, exception);
+        if (!converted.IsEmpty()) {
+            isolate->ThrowException(converted.ToLocalChecked());
+        }
+        return v8::Nothing<void>();
+    }
+
+    v8::Maybe<void> Membrane::convert_arguments(v8::Isolate *isolate, int side, int argc, v8::Local<v8::Value> argv[]) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        for (int i = 0; i < argc; ++i) {
+            JS_EXPRESSION_RETURN(value, convert(isolate, side, argv[i]));
+            argv[i] = value;
+        }
+        return v8::JustVoid();
+    }
+
+    v8::MaybeLocal<v8::Value> Membrane::convert(v8::Isolate *isolate, int side, v8::Local<v8::Value> value) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Value>;
+        if (!value->IsObject()) {
+            return value;
+        }
+        auto object = value.As<v8::Object>();
+        auto context = get_context(isolate, side);
+        {
+            // A wrapper returning to the side of its original object.
+            JS_EXPRESSION_RETURN(original, object->GetPrivate(context, _original_key[1 - side].Get(isolate)));
+            if (original->IsObject()) {
+                return original;
+            }
+        }
+        {
+            JS_EXPRESSION_RETURN(wrapper, get_wrapper(context, side, object));
+            if V8_LIKELY(wrapper->IsObject()) {
+                return wrapper;
+            }
+        }
+
+        v8::Local<v8::Object> wrapper;
+        if (object->IsNativeError()) {
+            JS_EXPRESSION_RETURN(prototype, find_error_prototype(isolate, 1 - side, object));
+            if (prototype->IsObject()) {
+                JS_EXPRESSION_RETURN(error, create_error(isolate, side, object, prototype.As<v8::Object>()));
+                wrapper = error;
+            }
+        }
+        if (wrapper.IsEmpty()) {
+            JS_EXPRESSION_RETURN(proxy, create_wrapper(isolate, side, object));
+            wrapper = proxy;
+        }
+        return wrapper;
+    }
+
+    v8::MaybeLocal<v8::Object> Membrane::create_wrapper(v8::Isolate *isolate, int side, v8::Local<v8::Object> original) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Object>;
+        auto context = get_context(isolate, side);
+        JS_EXPRESSION_RETURN(object_wrapper, per_isolate_wrapper_template[isolate].Get(isolate)->NewInstance(context));
+        object_wrapper->SetAlignedPointerInInternalField(WRAPPER_FIELD_RESERVED, nullptr);
+        object_wrapper->SetInternalField(WRAPPER_FIELD_MEMBRANE, get_interface(isolate));
+        object_wrapper->SetInternalField(WRAPPER_FIELD_ORIGINAL, original);
+        object_wrapper->SetInternalField(WRAPPER_FIELD_SIDE, v8::Integer::New(isolate, side));
+
+        // An object with a call handler receives itself as the receiver, so a callable object is wrapped by a real function instead.
+        // The function forwards the calls; its prototype is the interceptor wrapper, which forwards everything else that is read.
+        v8::Local<v8::Object> wrapper = object_wrapper;
+        if (original->IsCallable()) {
+            auto source_context = get_context(isolate, 1 - side);
+            int length = 0;
+            {
+                v8::Local<v8::Value> value;
+                JS_EXPRESSION_IGNORE(forward(isolate, side, [&]() {
+                    return original->Get(source_context, StringTable::Get(isolate, "length")).ToLocal(&value);
+                }));
+                if (value->IsInt32() && value.As<v8::Int32>()->Value() > 0) {
+                    length = value.As<v8::Int32>()->Value();
+                }
+            }
+            auto behavior = original->IsConstructor() ? v8::ConstructorBehavior::kAllow : v8::ConstructorBehavior::kThrow;
+            JS_EXPRESSION_RETURN(function, v8::Function::New(context, call_callback, object_wrapper, length, behavior));
+            if (original->IsFunction()) {
+                function->SetName(original.As<v8::Function>()->GetName().As<v8::String>());
+            }
+            wrapper = function;
+        }
+
+        // The identity map is written before the prototypes are converted, so they may refer back to the object. Every write to
+        // an interceptor wrapper reaches the original, so it is referenced weakly and recreated if it has been collected; a
+        // function wrapper keeps the properties written to it, so it lives as long as the original.
+        JS_EXPRESSION_IGNORE(set_wrapper(context, side, original, wrapper, wrapper == object_wrapper));
+        JS_EXPRESSION_IGNORE(wrapper->SetPrivate(context, _original_key[side].Get(isolate), original));
+
+        auto original_prototype = original->GetPrototype();
+        {
+            // The prototype of a global proxy is the global object, which is not visible to JavaScript.
+            JS_EXPRESSION_RETURN(creation_context, original->GetCreationContext());
+            if (original_prototype->IsObject() && creation_context->Global()->StrictEquals(original)) {
+                original_prototype = original_prototype.As<v8::Object>()->GetPrototype();
+            }
+        }
+        JS_EXPRESSION_RETURN(prototype, convert(isolate, side, original_prototype));
+        JS_EXPRESSION_IGNORE(object_wrapper->SetPrototype(context, prototype));
+        if (wrapper != object_wrapper) {
+            JS_EXPRESSION_IGNORE(wrapper->SetPrototype(context, object_wrapper));
+            if (original->IsConstructor()) {
+                auto name = StringTable::Get(isolate, "prototype");
+                auto source_context = get_context(isolate, 1 - side);
+                v8::Local<v8::Value> value;
+                JS_EXPRESSION_IGNORE(forward(isolate, side, [&]() {
+                    return original->Get(source_context, name).ToLocal(&value);
+                }));
+                JS_EXPRESSION_RETURN(converted, convert(isolate, side, value));
+                JS_EXPRESSION_IGNORE(wrapper->Set(context, name, converted));
+            }
+        }
+        return wrapper;
+    }
+
+    v8::MaybeLocal<v8::Value> Membrane::get_wrapper(v8::Local<v8::Context> context, int side, v8::Local<v8::Object> original) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Value>;
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_RETURN(wrapper, original->GetPrivate(context, _wrapper_key[side].Get(isolate)));
+        if (!wrapper->IsWeakRef()) {
+            return wrapper;
+        }
+        auto deref = get_interface(isolate)->GetInternalField(INTERFACE_FIELD_DEREF).As<v8::Value>().As<v8::Function>();
+        return deref->Call(context, wrapper, 0, nullptr);
+    }
+
+    v8::Maybe<void> Membrane::set_wrapper(v8::Local<v8::Context> context, int side, v8::Local<v8::Object> original, v8::Local<v8::Object> wrapper, bool weak) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        auto isolate = context->GetIsolate();
+        v8::Local<v8::Value> value = wrapper;
+        auto weak_ref = get_interface(isolate)->GetInternalField(INTERFACE_FIELD_WEAK_REF).As<v8::Value>();
+        if (weak && weak_ref->IsFunction()) {
+            v8::Local<v8::Value> args[] = { wrapper };
+            JS_EXPRESSION_RETURN(reference, weak_ref.As<v8::Function>()->NewInstance(context, 1, args));
+            if (reference->IsWeakRef()) {
+                value = reference;
+            }
+        }
+        JS_EXPRESSION_IGNORE(original->SetPrivate(context, _wrapper_key[side].Get(isolate), value));
+        return v8::JustVoid();
+    }
+
+    v8::MaybeLocal<v8::Object> Membrane::create_error(v8::Isolate *isolate, int side, v8::Local<v8::Object> original, v8::Local<v8::Object> prototype) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Object>;
+        auto context = get_context(isolate, side);
+        auto source_context = get_context(isolate, 1 - side);
+
+        v8::Local<v8::Value> message;
+        JS_EXPRESSION_IGNORE(forward(isolate, side, [&]() {
+            return original->Get(source_context, StringTable::Get(isolate, "message")).ToLocal(&message);
+        }));
+        if (!message->IsString()) {
+            message = v8::String::Empty(isolate);
+        }
+
+        // v8::Exception::Error() creates a native error without calling JavaScript; the class comes from the prototype.
+        v8::Local<v8::Object> error;
+        {
+            v8::Context::Scope context_scope(context);
+            error = v8::Exception::Error(message.As<v8::String>()).As<v8::Object>();
+        }
+        JS_EXPRESSION_IGNORE(error->SetPrototype(context, prototype));
+        JS_EXPRESSION_IGNORE(original->SetPrivate(context, _wrapper_key[side].Get(isolate), error));
+        JS_EXPRESSION_IGNORE(error->SetPrivate(context, _original_key[side].Get(isolate), original));
+
+        {
+            auto name = StringTable::Get(isolate, "stack");
+            v8::Local<v8::Value> stack;
+            JS_EXPRESSION_IGNORE(forward(isolate, side, [&]() {
+                return original->Get(source_context, name).ToLocal(&stack);
+            }));
+            if (stack->IsString()) {
+                JS_EXPRESSION_IGNORE(error->Set(context, name, stack));
+            }
+        }
+        for (auto name : { StringTable::Get(isolate, "cause"), StringTable::Get(isolate, "errors") }) {
+            bool has_property = false;
+            JS_EXPRESSION_IGNORE(forward(isolate, side, [&]() {
+                return original->HasOwnProperty(source_context, name).To(&has_property);
+            }));
+            if (!has_property) {
+                continue;
+            }
+            v8::Local<v8::Value> value;
+            JS_EXPRESSION_IGNORE(forward(isolate, side, [&]() {
+                return original->Get(source_context, name).ToLocal(&value);
+            }));
+            JS_EXPRESSION_RETURN(converted, convert(isolate, side, value));
+            JS_EXPRESSION_IGNORE(error->DefineOwnProperty(context, name, converted, v8::PropertyAttribute::DontEnum));
+        }
+        return error;
+    }
+
+    v8::MaybeLocal<v8::Value> Membrane::find_error_prototype(v8::Isolate *isolate, int side, v8::Local<v8::Object> original) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Value>;
+        auto context = get_context(isolate, side);
+        auto table = get_error_table(isolate, side);
+        // The nearest prototype in the table, so that an unknown subclass becomes its known base class.
+        auto prototype = original->GetPrototype();
+        while (prototype->IsObject()) {
+            JS_EXPRESSION_RETURN(value, table->Get(context, prototype));
+            if (value->IsObject()) {
+                return value;
+            }
+            prototype = prototype.As<v8::Object>()->GetPrototype();
+        }
+        return v8::Undefined(isolate);
+    }
+
+    v8::Maybe<void> Membrane::add_error(v8::Local<v8::Context> context, v8::Local<v8::Value> constructor_a, v8::Local<v8::Value> constructor_b, bool strict) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        auto isolate = context->GetIsolate();
+        v8::Local<v8::Value> constructor[SIDE_COUNT] = { constructor_a, constructor_b };
+        v8::Local<v8::Value> prototype[SIDE_COUNT];
+        for (int side = 0; side < SIDE_COUNT; ++side) {
+            if V8_UNLIKELY(!constructor[side]->IsFunction()) {
+                if (strict) {
+                    JS_THROW_ERROR(TypeError, context, "Option \"errors\": expected a constructor, got ", type_of(context, constructor[side]));
+                }
+                return v8::JustVoid();
+            }
+            JS_EXPRESSION_RETURN(value, constructor[side].As<v8::Function>()->Get(context, StringTable::Get(isolate, "prototype")));
+            if V8_UNLIKELY(!value->IsObject()) {
+                if (strict) {
+                    JS_THROW_ERROR(TypeError, context, "Option \"errors\": the prototype of a constructor is not an object.");
+                }
+                return v8::JustVoid();
+            }
+            prototype[side] = value;
+        }
+        for (int side = 0; side < SIDE_COUNT; ++side) {
+            JS_EXPRESSION_IGNORE(get_error_table(isolate, side)->Set(context, prototype[side], prototype[1 - side]));
+        }
+        return v8::JustVoid();
+    }
+
+    void Membrane::revoke_context(v8::Isolate *isolate, v8::Local<v8::Context> context) {
+        v8::HandleScope scope(isolate);
+        for (auto object : get_implementations(isolate)) {
+            auto membrane = static_cast<Membrane *>(object);
+            if (membrane->_revoked) {
+                continue;
+            }
+            for (int side = 0; side < SIDE_COUNT; ++side) {
+                if (membrane->get_context(isolate, side) == context) {
+                    membrane->revoke(isolate);
+                    break;
+                }
+            }
+        }
+    }
+
+    void Membrane::revoke(v8::Isolate *isolate) {
+        _revoked = true;
+        auto self = get_interface(isolate);
+        for (int side = 0; side < SIDE_COUNT; ++side) {
+            self->SetInternalField(INTERFACE_FIELD_CONTEXT + side, v8::Undefined(isolate));
+            self->SetInternalField(INTERFACE_FIELD_ERROR_TABLE + side, v8::Undefined(isolate));
+        }
+    }
+
+    v8::Local<v8::Context> Membrane::get_context(v8::Isolate *isolate, int side) const {
+        return get_interface(isolate)->GetInternalField(INTERFACE_FIELD_CONTEXT + side).As<v8::Context>();
+    }
+
+    v8::Local<v8::Map> Membrane::get_error_table(v8::Isolate *isolate, int side) const {
+        return get_interface(isolate)->GetInternalField(INTERFACE_FIELD_ERROR_TABLE + side).As<v8::Value>().As<v8::Map>();
+    }
+
+    v8::Intercepted Membrane::get_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        // On an exception, V8 ignores the result of an interceptor that did not intercept (kYes requires a return value).
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        auto isolate = info.GetIsolate();
+
+        Target target;
+        if V8_UNLIKELY(!get_target(isolate, info.Holder(), target)) {
+            return __function_return_type__();
+        }
+        v8::Local<v8::Value> value;
+        JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+            return target.original->Get(target.context, property).ToLocal(&value);
+        }));
+        JS_EXPRESSION_RETURN(result, target.membrane->convert(isolate, target.side, value));
+        info.GetReturnValue().Set(result);
+        return v8::Intercepted::kYes;
+    }
+
+    v8::Intercepted Membrane::set_property(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        auto isolate = info.GetIsolate();
+
+        Target target;
+        if V8_UNLIKELY(!get_target(isolate, info.Holder(), target)) {
+            return __function_return_type__();
+        }
+        JS_EXPRESSION_RETURN(converted, target.membrane->convert(isolate, 1 - target.side, value));
+        bool success = false;
+        JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+            return target.original->Set(target.context, property, converted).To(&success);
+        }));
+        if V8_UNLIKELY(!success && info.ShouldThrowOnError()) {
+            JS_THROW_ERROR(TypeError, isolate, "Cannot assign to property of the original object");
+        }
+        return v8::Intercepted::kYes;
+    }
+
+    v8::Intercepted Membrane::query_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        auto isolate = info.GetIsolate();
+
+        Target target;
+        if V8_UNLIKELY(!get_target(isolate, info.Holder(), target)) {
+            return __function_return_type__();
+        }
+        v8::Local<v8::Value> descriptor;
+        JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+            return target.original->GetOwnPropertyDescriptor(target.context, property).ToLocal(&descriptor);
+        }));
+        if (!descriptor->IsObject()) {
+            return v8::Intercepted::kNo;
+        }
+        // The descriptor is a fresh ordinary object, reading it cannot run JavaScript.
+        auto descriptor_object = descriptor.As<v8::Object>();
+        int attributes = v8::PropertyAttribute::None;
+        JS_EXPRESSION_RETURN(writable, descriptor_object->Get(target.context, StringTable::Get(isolate, "writable")));
+        JS_EXPRESSION_RETURN(enumerable, descriptor_object->Get(target.context, StringTable::Get(isolate, "enumerable")));
+        JS_EXPRESSION_RETURN(configurable, descriptor_object->Get(target.context, StringTable::Get(isolate, "configurable")));
+        if (writable->IsFalse()) {
+            attributes |= v8::PropertyAttribute::ReadOnly;
+        }
+        if (!enumerable->IsTrue()) {
+            attributes |= v8::PropertyAttribute::DontEnum;
+        }
+        if (!configurable->IsTrue()) {
+            attributes |= v8::PropertyAttribute::DontDelete;
+        }
+        info.GetReturnValue().Set(attributes);
+        return v8::Intercepted::kYes;
+    }
+
+    v8::Intercepted Membrane::delete_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        auto isolate = info.GetIsolate();
+
+        Target target;
+        if V8_UNLIKELY(!get_target(isolate, info.Holder(), target)) {
+            return __function_return_type__();
+        }
+        bool success = false;
+        JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+            return target.original->Delete(target.context, property).To(&success);
+        }));
+        info.GetReturnValue().Set(success);
+        return v8::Intercepted::kYes;
+    }
+
+    v8::Intercepted Membrane::define_property(v8::Local<v8::Name> property, const v8::PropertyDescriptor &descriptor, const v8::PropertyCallbackInfo<void> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        auto isolate = info.GetIsolate();
+
+        Target target;
+        if V8_UNLIKELY(!get_target(isolate, info.Holder(), target)) {
+            return __function_return_type__();
+        }
+        auto source_side = 1 - target.side;
+        std::optional<v8::PropertyDescriptor> source_descriptor;
+        if (descriptor.has_value()) {
+            JS_EXPRESSION_RETURN(value, target.membrane->convert(isolate, source_side, descriptor.value()));
+            if (descriptor.has_writable()) {
+                source_descriptor.emplace(value, descriptor.writable());
+            } else {
+                source_descriptor.emplace(value);
+            }
+        } else if (descriptor.has_get() || descriptor.has_set()) {
+            v8::Local<v8::Value> getter, setter;
+            if (descriptor.has_get()) {
+                JS_EXPRESSION_RETURN(value, target.membrane->convert(isolate, source_side, descriptor.get()));
+                getter = value;
+            }
+            if (descriptor.has_set()) {
+                JS_EXPRESSION_RETURN(value, target.membrane->convert(isolate, source_side, descriptor.set()));
+                setter = value;
+            }
+            source_descriptor.emplace(getter, setter);
+        } else {
+            source_descriptor.emplace();
+        }
+        if (descriptor.has_enumerable()) {
+            source_descriptor->set_enumerable(descriptor.enumerable());
+        }
+        if (descriptor.has_configurable()) {
+            source_descriptor->set_configurable(descriptor.configurable());
+        }
+
+        bool success = false;
+        JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+            return target.original->DefineProperty(target.context, property, *source_descriptor).To(&success);
+        }));
+        if V8_UNLIKELY(!success && info.ShouldThrowOnError()) {
+            JS_THROW_ERROR(TypeError, isolate, "Cannot define property of the original object");
+        }
+        return v8::Intercepted::kYes;
+    }
+
+    v8::Intercepted Membrane::describe_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        auto isolate = info.GetIsolate();
+
+        Target target;
+        if V8_UNLIKELY(!get_target(isolate, info.Holder(), target)) {
+            return __function_return_type__();
+        }
+        v8::Local<v8::Value> descriptor;
+        JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+            return target.original->GetOwnPropertyDescriptor(target.context, property).ToLocal(&descriptor);
+        }));
+        if (!descriptor->IsObject()) {
+            return v8::Intercepted::kNo;
+        }
+
+        auto context = target.membrane->get_context(isolate, target.side);
+        auto descriptor_object = descriptor.As<v8::Object>();
+        v8::Local<v8::Object> result;
+        {
+            v8::Context::Scope context_scope(context);
+            result = v8::Object::New(isolate);
+        }
+        v8::Local<v8::String> field_names[] = {
+            StringTable::Get(isolate, "value"),
+            StringTable::Get(isolate, "writable"),
+            StringTable::Get(isolate, "get"),
+            StringTable::Get(isolate, "set"),
+            StringTable::Get(isolate, "enumerable"),
+            StringTable::Get(isolate, "configurable")
+        };
+        for (auto name : field_names) {
+            JS_EXPRESSION_RETURN(has_field, descriptor_object->HasOwnProperty(target.context, name));
+            if (!has_field) {
+                continue;
+            }
+            JS_EXPRESSION_RETURN(value, descriptor_object->Get(target.context, name));
+            JS_EXPRESSION_RETURN(converted, target.membrane->convert(isolate, target.side, value));
+            JS_EXPRESSION_IGNORE(result->CreateDataProperty(context, name, converted));
+        }
+        info.GetReturnValue().Set(result);
+        return v8::Intercepted::kYes;
+    }
+
+    void Membrane::enumerate_properties(const v8::PropertyCallbackInfo<v8::Array> &info, bool indices) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+
+        Target target;
+        if V8_UNLIKELY(!get_target(isolate, info.Holder(), target)) {
+            return __function_return_type__();
+        }
+        v8::Local<v8::Array> keys;
+        JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+            return target.original->GetPropertyNames(
+                target.context,
+                v8::KeyCollectionMode::kOwnOnly,
+                v8::PropertyFilter::ALL_PROPERTIES,
+                indices ? v8::IndexFilter::kIncludeIndices : v8::IndexFilter::kSkipIndices,
+                v8::KeyConversionMode::kKeepNumbers
+            ).ToLocal(&keys);
+        }));
+        if (!indices) {
+            info.GetReturnValue().Set(keys);
+            return;
+        }
+        // Keys are primitives and need no conversion; only the indices are reported by the indexed enumerator.
+        std::vector<v8::Local<v8::Value>> index_keys;
+        for (uint32_t i = 0; i < keys->Length(); ++i) {
+            JS_EXPRESSION_RETURN(key, keys->Get(target.context, i));
+            if (key->IsNumber()) {
+                index_keys.push_back(key);
+            }
+        }
+        info.GetReturnValue().Set(v8::Array::New(isolate, index_keys.data(), index_keys.size()));
+    }
+
+    v8::Intercepted Membrane::named_getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        return get_property(property, info);
+    }
+
+    v8::Intercepted Membrane::named_setter_callback(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info) {
+        return set_property(property, value, info);
+    }
+
+    v8::Intercepted Membrane::named_query_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer> &info) {
+        return query_property(property, info);
+    }
+
+    v8::Intercepted Membrane::named_deleter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean> &info) {
+        return delete_property(property, info);
+    }
+
+    v8::Intercepted Membrane::named_definer_callback(v8::Local<v8::Name> property, const v8::PropertyDescriptor &descriptor, const v8::PropertyCallbackInfo<void> &info) {
+        return define_property(property, descriptor, info);
+    }
+
+    v8::Intercepted Membrane::named_descriptor_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        return describe_property(property, info);
+    }
+
+    void Membrane::named_enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info) {
+        enumerate_properties(info, false);
+    }
+
+    namespace {
+        v8::MaybeLocal<v8::Name> index_to_name(v8::Isolate *isolate, uint32_t index) {
+            using __function_return_type__ = v8::MaybeLocal<v8::Name>;
+            JS_EXPRESSION_RETURN(name, v8::Integer::NewFromUnsigned(isolate, index)->ToString(isolate->GetCurrentContext()));
+            return name;
+        }
+    }
+
+    v8::Intercepted Membrane::indexed_getter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        JS_EXPRESSION_RETURN(property, index_to_name(info.GetIsolate(), index));
+        return get_property(property, info);
+    }
+
+    v8::Intercepted Membrane::indexed_setter_callback(uint32_t index, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        JS_EXPRESSION_RETURN(property, index_to_name(info.GetIsolate(), index));
+        return set_property(property, value, info);
+    }
+
+    v8::Intercepted Membrane::indexed_query_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        JS_EXPRESSION_RETURN(property, index_to_name(info.GetIsolate(), index));
+        return query_property(property, info);
+    }
+
+    v8::Intercepted Membrane::indexed_deleter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Boolean> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        JS_EXPRESSION_RETURN(property, index_to_name(info.GetIsolate(), index));
+        return delete_property(property, info);
+    }
+
+    v8::Intercepted Membrane::indexed_definer_callback(uint32_t index, const v8::PropertyDescriptor &descriptor, const v8::PropertyCallbackInfo<void> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        JS_EXPRESSION_RETURN(property, index_to_name(info.GetIsolate(), index));
+        return define_property(property, descriptor, info);
+    }
+
+    v8::Intercepted Membrane::indexed_descriptor_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kNo; };
+        JS_EXPRESSION_RETURN(property, index_to_name(info.GetIsolate(), index));
+        return describe_property(property, info);
+    }
+
+    void Membrane::indexed_enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info) {
+        enumerate_properties(info, true);
+    }
+
+    void Membrane::call_callback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+
+        Target target;
+        if V8_UNLIKELY(!info.Data()->IsObject() || !get_target(isolate, info.Data().As<v8::Object>(), target)) {
+            return __function_return_type__();
+        }
+        auto source_side = 1 - target.side;
+        std::vector<v8::Local<v8::Value>> arguments;
+        arguments.reserve(info.Length());
+        for (int i = 0; i < info.Length(); ++i) {
+            arguments.push_back(info[i]);
+        }
+        JS_EXPRESSION_IGNORE(target.membrane->convert_arguments(isolate, source_side, static_cast<int>(arguments.size()), arguments.data()));
+
+        v8::Local<v8::Value> value;
+        if (info.IsConstructCall()) {
+            JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+                return target.original->CallAsConstructor(target.context, static_cast<int>(arguments.size()), arguments.data()).ToLocal(&value);
+            }));
+        } else {
+            JS_EXPRESSION_RETURN(receiver, target.membrane->convert(isolate, source_side, info.This()));
+            JS_EXPRESSION_IGNORE(target.membrane->forward(isolate, target.side, [&]() {
+                return target.original->CallAsFunction(target.context, receiver, static_cast<int>(arguments.size()), arguments.data()).ToLocal(&value);
+            }));
+        }
+        JS_EXPRESSION_RETURN(result, target.membrane->convert(isolate, target.side, value));
+        info.GetReturnValue().Set(result);
+    }
+}
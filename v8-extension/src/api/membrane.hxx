@@ -0,0 +1,132 @@
+#ifndef NODE_EXT_API_MEMBRANE_HXX
+#define NODE_EXT_API_MEMBRANE_HXX
+
+#include <cstdint>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Wrap objects crossing between two contexts.
+     *
+     * The contexts are resolved from the creation contexts of the two objects given to the constructor. wrap(value) converts a value of
+     * the first context into a value usable in the second context, unwrap(value) converts in the other direction. Primitives pass
+     * through; a wrapper converted back returns the original object.
+     *
+     * A wrapper is an instance of a per-isolate ObjectTemplate with C++ named and indexed interceptors that forward to the original
+     * object, converting keys, values, receivers and exceptions on the way. A callable object is wrapped by a function that forwards
+     * calls and has the interceptor wrapper as its prototype; properties written to such a function stay on the function.
+     *
+     * The identity map is stored on the original object under a private symbol unique to the membrane and direction, so the same
+     * object is converted to the same wrapper while that wrapper is reachable. An interceptor wrapper is held through a WeakRef
+     * (of the context creating the membrane), so it is collected once nothing refers to it and recreated on the next conversion;
+     * this is not observable, since everything written to it reaches the original object. Function wrappers and converted
+     * errors keep properties of their own, so they are held strongly and live as long as the original object.
+     *
+     * An array is wrapped like any other object: the wrapper is not an Array exotic object, so Array.isArray() returns false
+     * for it and JSON.stringify() serializes it as an object with index keys. Array.from() or spreading the wrapper copies
+     * the elements into a real array.
+     *
+     * Errors are not wrapped: an error whose prototype chain contains an entry of the error table is converted to a new error of the
+     * corresponding constructor in the other context, with the same message and stack. The table is computed once in the constructor
+     * from the native error constructors of both contexts (Error, TypeError, ...) and can be extended with the option "errors".
+     *
+     * A membrane is revoked when one of its contexts is disposed (Context.prototype.dispose()): it drops both contexts and error
+     * tables, wrap() and unwrap() throw, and a wrapper drops its original object the first time it is used afterwards.
+     *
+     * Options (all optional):
+     * errors - an iterable of [constructorA, constructorB] pairs added to the error table.
+     */
+    class Membrane : public Object<Membrane> {
+    public:
+        static constexpr const int SIDE_COUNT = 2;
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_wrap(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_unwrap(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static v8::Intercepted named_getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static v8::Intercepted named_setter_callback(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted named_query_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer> &info);
+        static v8::Intercepted named_deleter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean> &info);
+        static v8::Intercepted named_definer_callback(v8::Local<v8::Name> property, const v8::PropertyDescriptor &descriptor, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted named_descriptor_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static void named_enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info);
+        static v8::Intercepted indexed_getter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static v8::Intercepted indexed_setter_callback(uint32_t index, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted indexed_query_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer> &info);
+        static v8::Intercepted indexed_deleter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Boolean> &info);
+        static v8::Intercepted indexed_definer_callback(uint32_t index, const v8::PropertyDescriptor &descriptor, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted indexed_descriptor_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static void indexed_enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info);
+        static void call_callback(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static v8::Intercepted get_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static v8::Intercepted set_property(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted query_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer> &info);
+        static v8::Intercepted delete_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean> &info);
+        static v8::Intercepted define_property(v8::Local<v8::Name> property, const v8::PropertyDescriptor &descriptor, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted describe_property(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static void enumerate_properties(const v8::PropertyCallbackInfo<v8::Array> &info, bool indices);
+    private:
+        /**
+         * @brief The membrane, the side the wrapper lives in and the original object, read from the internal fields of a wrapper.
+         */
+        struct Target {
+            Membrane *membrane;
+            int side;
+            v8::Local<v8::Object> original;
+            v8::Local<v8::Context> context;
+        };
+        // Throws a TypeError and returns false if the object is not a wrapper of a membrane that is not revoked.
+        static bool get_target(v8::Isolate *isolate, v8::Local<v8::Object> wrapper, Target &target);
+    public:
+        /**
+         * @brief Revoke every membrane of the isolate with the context on either side.
+         */
+        static void revoke_context(v8::Isolate *isolate, v8::Local<v8::Context> context);
+    private:
+        // Key of the wrapper living in side N, stored on the original object (of the other side).
+        Shared<v8::Private> _wrapper_key[SIDE_COUNT];
+        // Key of the original object (of the other side), stored on a wrapper living in side N.
+        Shared<v8::Private> _original_key[SIDE_COUNT];
+        bool _revoked = false;
+    private:
+        // The contexts and the error tables are stored in the internal fields of the interface instead of here, so that the
+        // garbage collector can see through the cycle original -> wrapper -> membrane -> context -> original.
+        v8::Local<v8::Map> get_error_table(v8::Isolate *isolate, int side) const;
+        v8::MaybeLocal<v8::Object> create_wrapper(v8::Isolate *isolate, int side, v8::Local<v8::Object> original);
+        // The wrapper of the original object in the side, or undefined.
+        v8::MaybeLocal<v8::Value> get_wrapper(v8::Local<v8::Context> context, int side, v8::Local<v8::Object> original);
+        v8::Maybe<void> set_wrapper(v8::Local<v8::Context> context, int side, v8::Local<v8::Object> original, v8::Local<v8::Object> wrapper, bool weak);
+        v8::MaybeLocal<v8::Object> create_error(v8::Isolate *isolate, int side, v8::Local<v8::Object> original, v8::Local<v8::Object> prototype);
+        v8::MaybeLocal<v8::Value> find_error_prototype(v8::Isolate *isolate, int side, v8::Local<v8::Object> original);
+        v8::Maybe<void> add_error(v8::Local<v8::Context> context, v8::Local<v8::Value> constructor_a, v8::Local<v8::Value> constructor_b, bool strict);
+        v8::Maybe<void> convert_arguments(v8::Isolate *isolate, int side, int argc, v8::Local<v8::Value> argv[]);
+        template<typename F>
+        v8::Maybe<void> forward(v8::Isolate *isolate, int side, F &&operation);
+    public:
+        /**
+         * @brief Convert a value into a value usable in the specified side.
+         */
+        v8::MaybeLocal<v8::Value> convert(v8::Isolate *isolate, int side, v8::Local<v8::Value> value);
+        v8::Local<v8::Context> get_context(v8::Isolate *isolate, int side) const;
+        void revoke(v8::Isolate *isolate);
+    protected:
+        Membrane() = default;
+        Membrane(const Membrane &) = delete;
+        Membrane(Membrane &&) = delete;
+    public:
+        virtual ~Membrane() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_MEMBRANE_HXX */
@@ -0,0 +1,739 @@
+#include "module.hxx"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <node.h>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+#include "../trace.hxx"
+#include "mapped-source.hxx"
+
+namespace dragiyski::node_ext {
+    struct Module::Link {
+        v8::Isolate *isolate;
+        // The context link() was called in: the promise, the errors and the compiled modules belong to it.
+        Shared<v8::Context> caller_context;
+        // The context the graph is instantiated in.
+        Shared<v8::Context> context;
+        Shared<v8::Module> root;
+        Shared<v8::Object> holder;
+        Shared<v8::Promise::Resolver> resolver;
+        // The modules compiled for the graph, kept alive until the root is instantiated (after that V8 keeps them).
+        std::vector<Shared<v8::Module>> modules;
+        std::set<std::string> seen;
+        std::size_t pending = 0;
+        bool settled = false;
+    };
+
+    namespace {
+        struct Record {
+            Shared<v8::Module> module;
+            Shared<v8::Context> context;
+            std::string location;
+        };
+
+        struct CodeCache {
+            std::size_t hash;
+            std::vector<uint8_t> data;
+        };
+
+        struct Load {
+            uv_work_t request;
+            v8::Isolate *isolate;
+            // The links waiting for the file; all of them instantiate in the same context.
+            std::vector<std::shared_ptr<Module::Link>> links;
+            std::string location;
+            std::string content;
+            int error = 0;
+        };
+
+        struct State {
+            Shared<v8::FunctionTemplate> class_template;
+            // (referrer location, specifier) -> location.
+            std::map<std::pair<std::string, std::string>, std::string> resolutions;
+            // location -> the code cache of the last compiled source of that location.
+            std::map<std::string, CodeCache> code_caches;
+            // The module maps of all contexts; the handles are weak, the records are removed when either dies.
+            std::multimap<std::string, std::shared_ptr<Record>> records_by_location;
+            std::unordered_multimap<int, std::shared_ptr<Record>> records_by_hash;
+            // location -> the loads in progress; a link that needs a location already being loaded for its context waits for that load.
+            std::multimap<std::string, Load *> loads;
+        };
+
+        thread_local std::map<v8::Isolate *, State> per_isolate_state;
+
+        bool starts_with(std::string_view string, std::string_view prefix) {
+            return string.substr(0, prefix.size()) == prefix;
+        }
+
+        // Only file paths are supported: absolute paths, file: URLs (without percent-encoding) and paths relative to the referrer.
+        std::optional<std::string> resolve_location(const std::string &referrer, std::string_view specifier) {
+            std::filesystem::path path;
+            if (starts_with(specifier, "file://")) {
+                path = specifier.substr(7);
+            } else if (starts_with(specifier, "/")) {
+                path = specifier;
+            } else if (starts_with(specifier, "./") || starts_with(specifier, "../")) {
+                if (referrer.empty()) {
+                    return std::nullopt;
+                }
+                path = std::filesystem::path(referrer).parent_path() / specifier;
+            } else {
+                return std::nullopt;
+            }
+            return path.lexically_normal().string();
+        }
+
+        v8::Local<v8::Module> find_record(v8::Isolate *isolate, v8::Local<v8::Context> context, const std::string &location) {
+            auto &state = per_isolate_state[isolate];
+            auto [begin, end] = state.records_by_location.equal_range(location);
+            for (auto it = begin; it != end; ++it) {
+                auto &record = *it->second;
+                if (!record.module.IsEmpty() && record.context.Get(isolate) == context) {
+                    return record.module.Get(isolate);
+                }
+            }
+            return {};
+        }
+
+        void add_record(v8::Isolate *isolate, v8::Local<v8::Context> context, v8::Local<v8::Module> module, const std::string &location) {
+            auto &state = per_isolate_state[isolate];
+            auto is_dead = [](const auto &entry) {
+                return entry.second->module.IsEmpty() || entry.second->context.IsEmpty();
+            };
+            std::erase_if(state.records_by_location, is_dead);
+            std::erase_if(state.records_by_hash, is_dead);
+
+            auto record = std::make_shared<Record>();
+            record->module.Reset(isolate, module);
+            record->module.SetWeak();
+            record->context.Reset(isolate, context);
+            record->context.SetWeak();
+            record->location = location;
+            state.records_by_location.emplace(location, record);
+            state.records_by_hash.emplace(module->GetIdentityHash(), record);
+        }
+
+        const Record *find_referrer(v8::Isolate *isolate, v8::Local<v8::Module> module) {
+            auto &state = per_isolate_state[isolate];
+            auto [begin, end] = state.records_by_hash.equal_range(module->GetIdentityHash());
+            for (auto it = begin; it != end; ++it) {
+                if (!it->second->module.IsEmpty() && it->second->module.Get(isolate) == module) {
+                    return it->second.get();
+                }
+            }
+            return nullptr;
+        }
+
+        v8::MaybeLocal<v8::Module> compile_module(v8::Isolate *isolate, v8::Local<v8::String> source_string, const std::string &location, std::size_t hash, bool &cached) {
+            JS_TRACE_SCOPE("module", "compile_module");
+            using __function_return_type__ = v8::MaybeLocal<v8::Module>;
+            auto &state = per_isolate_state[isolate];
+            v8::Local<v8::String> resource_name = v8::String::Empty(isolate);
+            if (!location.empty()) {
+                JS_EXPRESSION_RETURN(name, v8::String::NewFromUtf8(isolate, location.data(), v8::NewStringType::kNormal, static_cast<int>(location.size())));
+                resource_name = name;
+            }
+            v8::ScriptOrigin origin(isolate, resource_name, 0, 0, false, -1, {}, false, false, true);
+
+            cached = false;
+            v8::Local<v8::Module> module;
+            auto entry = location.empty() ? state.code_caches.end() : state.code_caches.find(location);
+            if (entry != state.code_caches.end() && entry->second.hash == hash) {
+                // The source owns the CachedData, which does not own the buffer of the entry.
+                auto cached_data = new v8::ScriptCompiler::CachedData(entry->second.data.data(), static_cast<int>(entry->second.data.size()));
+                v8::ScriptCompiler::Source source(source_string, origin, cached_data);
+                JS_EXPRESSION_RETURN(value, v8::ScriptCompiler::CompileModule(isolate, &source, v8::ScriptCompiler::kConsumeCodeCache));
+                module = value;
+                cached = !source.GetCachedData()->rejected;
+            } else {
+                v8::ScriptCompiler::Source source(source_string, origin);
+                JS_EXPRESSION_RETURN(value, v8::ScriptCompiler::CompileModule(isolate, &source));
+                module = value;
+            }
+
+            if (!cached && !location.empty()) {
+                std::unique_ptr<v8::ScriptCompiler::CachedData> data(v8::ScriptCompiler::CreateCodeCache(module->GetUnboundModuleScript()));
+                if (data) {
+                    state.code_caches.insert_or_assign(location, CodeCache{ hash, std::vector<uint8_t>(data->data, data->data + data->length) });
+                }
+            }
+            return module;
+        }
+
+        int read_file(const std::string &path, std::string &content) {
+            auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                return errno;
+            }
+            struct stat status;
+            if (fstat(fd, &status) != 0) {
+                auto error = errno;
+                close(fd);
+                return error;
+            }
+            if (!S_ISREG(status.st_mode)) {
+                close(fd);
+                return S_ISDIR(status.st_mode) ? EISDIR : EINVAL;
+            }
+            content.resize(static_cast<std::size_t>(status.st_size));
+            std::size_t offset = 0;
+            while (offset < content.size()) {
+                auto count = read(fd, content.data() + offset, content.size() - offset);
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count <= 0) {
+                    auto error = count < 0 ? errno : 0;
+                    close(fd);
+                    if (error != 0) {
+                        return error;
+                    }
+                    break;
+                }
+                offset += static_cast<std::size_t>(count);
+            }
+            content.resize(offset);
+            close(fd);
+            return 0;
+        }
+
+        v8::Local<v8::String> status_name(v8::Isolate *isolate, v8::Module::Status status) {
+            switch (status) {
+                case v8::Module::kUninstantiated:
+                    return StringTable::Get(isolate, "unlinked");
+                case v8::Module::kInstantiating:
+                    return StringTable::Get(isolate, "linking");
+                case v8::Module::kInstantiated:
+                    return StringTable::Get(isolate, "linked");
+                case v8::Module::kEvaluating:
+                    return StringTable::Get(isolate, "evaluating");
+                case v8::Module::kEvaluated:
+                    return StringTable::Get(isolate, "evaluated");
+                case v8::Module::kErrored:
+                default:
+                    return StringTable::Get(isolate, "errored");
+            }
+        }
+
+        void settle(v8::Local<v8::Context> context, Module::Link &link, v8::Local<v8::Value> value, bool fulfilled) {
+            auto isolate = context->GetIsolate();
+            link.settled = true;
+            auto resolver = link.resolver.Get(isolate);
+            if (fulfilled) {
+                resolver->Resolve(context, value).Check();
+            } else {
+                resolver->Reject(context, value).Check();
+            }
+            // Break the cycle implementation -> link -> holder; the resolver stays to return the same promise again.
+            link.holder.Reset();
+            link.root.Reset();
+            link.modules.clear();
+        }
+    }
+
+    void Module::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_state.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "Module");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "link");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_link, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "evaluate");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_evaluate, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "status");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_status, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "namespace");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_namespace, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "location");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_location, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "requests");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_requests, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "cached");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_cached, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_state[isolate].class_template.Reset(isolate, class_template);
+
+        Object<Module>::initialize(isolate);
+    }
+
+    void Module::uninitialize(v8::Isolate *isolate) {
+        Object<Module>::uninitialize(isolate);
+        per_isolate_state.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> Module::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_state.contains(isolate));
+        return per_isolate_state[isolate].class_template.Get(isolate);
+    }
+
+    void Module::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+    }
+
+    v8::MaybeLocal<v8::Object> Module::compile(v8::Local<v8::Context> context, v8::Local<v8::Context> target_context, v8::Local<v8::Object> options) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Object>;
+        auto isolate = context->GetIsolate();
+
+        v8::Local<v8::String> source;
+        {
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, StringTable::Get(isolate, "source")));
+            if (js_value->IsString()) {
+                source = js_value.As<v8::String>();
+            } else if (auto mapped_source = js_value->IsObject() ? MappedSource::get_implementation(isolate, js_value.As<v8::Object>()) : nullptr; mapped_source != nullptr) {
+                JS_EXPRESSION_RETURN(value, mapped_source->get_source(isolate));
+                source = value;
+            } else {
+                JS_THROW_ERROR(TypeError, isolate, "Expected option 'source' to be a string or a MappedSource.");
+            }
+        }
+        std::string location;
+        {
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, StringTable::Get(isolate, "location")));
+            if (!js_value->IsNullOrUndefined()) {
+                JS_EXPRESSION_RETURN(js_location, js_value->ToString(context));
+                v8::String::Utf8Value location_value(isolate, js_location);
+                std::string_view value(*location_value, location_value.length());
+                if (starts_with(value, "file://")) {
+                    value.remove_prefix(7);
+                }
+                // The build has no exceptions: the throwing overload would abort on an empty or otherwise invalid path.
+                std::error_code error;
+                auto path = std::filesystem::absolute(value, error);
+                if V8_UNLIKELY(error) {
+                    JS_THROW_ERROR(TypeError, isolate, "Invalid option 'location' \"", js_location, "\": ", error.message().c_str());
+                }
+                location = path.lexically_normal().string();
+            }
+        }
+
+        // The code cache is only reused for a source with the same content.
+        std::size_t hash = 0;
+        if (!location.empty()) {
+            v8::String::Utf8Value source_value(isolate, source);
+            hash = std::hash<std::string_view>()(std::string_view(*source_value, source_value.length()));
+        }
+
+        bool cached = false;
+        JS_EXPRESSION_RETURN(module, compile_module(isolate, source, location, hash, cached));
+        if (!location.empty()) {
+            add_record(isolate, target_context, module, location);
+        }
+
+        JS_EXPRESSION_RETURN(holder, get_template(isolate)->InstanceTemplate()->NewInstance(context));
+        auto implementation = std::unique_ptr<Module>(new Module());
+        implementation->_module.Reset(isolate, module);
+        implementation->_context.Reset(isolate, target_context);
+        implementation->_location = std::move(location);
+        implementation->_cached = cached;
+        implementation.release()->set_interface(isolate, holder);
+        return holder;
+    }
+
+    v8::Maybe<void> Module::visit(v8::Local<v8::Context> context, const std::shared_ptr<Link> &link, v8::Local<v8::Module> module, const std::string &location) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        auto isolate = context->GetIsolate();
+        auto &state = per_isolate_state[isolate];
+        auto target_context = link->context.Get(isolate);
+
+        auto requests = module->GetModuleRequests();
+        for (int i = 0; i < requests->Length(); ++i) {
+            auto request = requests->Get(context, i).As<v8::ModuleRequest>();
+            auto js_specifier = request->GetSpecifier();
+            v8::String::Utf8Value specifier_value(isolate, js_specifier);
+            std::string specifier(*specifier_value, specifier_value.length());
+
+            auto key = std::make_pair(location, specifier);
+            auto resolution = state.resolutions.find(key);
+            if (resolution == state.resolutions.end()) {
+                auto resolved = resolve_location(location, specifier);
+                if V8_UNLIKELY(!resolved) {
+                    JS_THROW_ERROR(TypeError, isolate, "Cannot resolve module specifier \"", js_specifier, "\" from \"", location.c_str(), "\": only absolute paths, file: URLs and relative paths are supported.");
+                }
+                resolution = state.resolutions.emplace(std::move(key), std::move(*resolved)).first;
+            }
+            const auto &resolved = resolution->second;
+            if (link->seen.contains(resolved)) {
+                continue;
+            }
+            link->seen.insert(resolved);
+
+            if (auto existing = find_record(isolate, target_context, resolved); !existing.IsEmpty()) {
+                link->modules.emplace_back(isolate, existing);
+                JS_EXPRESSION_IGNORE(visit(context, link, existing, resolved));
+                continue;
+            }
+
+            // Another graph in the same context is loading the module: compile it once, for both.
+            Load *pending = nullptr;
+            auto [begin, end] = state.loads.equal_range(resolved);
+            for (auto it = begin; it != end; ++it) {
+                if (it->second->links.front()->context.Get(isolate) == target_context) {
+                    pending = it->second;
+                    break;
+                }
+            }
+            if (pending != nullptr) {
+                pending->links.push_back(link);
+                ++link->pending;
+                continue;
+            }
+
+            auto load = new Load();
+            load->request.data = load;
+            load->isolate = isolate;
+            load->links.push_back(link);
+            load->location = resolved;
+            if (auto error = uv_queue_work(node::GetCurrentEventLoop(isolate), &load->request, Module::load, Module::on_load); error != 0) {
+                delete load;
+                JS_THROW_ERROR(Error, isolate, "Cannot load module \"", resolved.c_str(), "\": ", uv_strerror(error));
+            }
+            state.loads.emplace(resolved, load);
+            ++link->pending;
+        }
+        return v8::JustVoid();
+    }
+
+    void Module::load(uv_work_t *request) {
+        // Runs on the threadpool: no V8 here.
+        auto load = static_cast<Load *>(request->data);
+        load->error = read_file(load->location, load->content);
+    }
+
+    void Module::on_load(uv_work_t *request, int status) {
+        auto load = std::unique_ptr<Load>(static_cast<Load *>(request->data));
+        auto isolate = load->isolate;
+        if (auto state = per_isolate_state.find(isolate); state != per_isolate_state.end()) {
+            std::erase_if(state->second.loads, [&](const auto &entry) {
+                return entry.second == load.get();
+            });
+        }
+        std::vector<std::shared_ptr<Link>> links;
+        for (auto &link : load->links) {
+            --link->pending;
+            if (!link->settled) {
+                links.push_back(link);
+            }
+        }
+        if (links.empty()) {
+            return;
+        }
+        v8::HandleScope scope(isolate);
+
+        v8::Local<v8::Module> module;
+        v8::Local<v8::Value> exception;
+        {
+            auto &link = links.front();
+            auto context = link->caller_context.Get(isolate);
+            v8::Context::Scope context_scope(context);
+            v8::TryCatch try_catch(isolate);
+            auto compiled = [&]() -> v8::MaybeLocal<v8::Module> {
+                using __function_return_type__ = v8::MaybeLocal<v8::Module>;
+                if (status != 0 || load->error != 0) {
+                    auto message = status != 0 ? uv_strerror(status) : std::strerror(load->error);
+                    JS_THROW_ERROR(Error, isolate, "Cannot load module \"", load->location.c_str(), "\": ", message);
+                }
+                const auto &content = load->content;
+                if V8_UNLIKELY(content.size() > static_cast<std::size_t>(v8::String::kMaxLength)) {
+                    JS_THROW_ERROR(RangeError, isolate, "Cannot load module \"", load->location.c_str(), "\": the file is too large.");
+                }
+                v8::Local<v8::String> source;
+                if (is_ascii(content.data(), content.size())) {
+                    JS_EXPRESSION_RETURN(value, v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t *>(content.data()), v8::NewStringType::kNormal, static_cast<int>(content.size())));
+                    source = value;
+                } else {
+                    JS_EXPRESSION_RETURN(value, v8::String::NewFromUtf8(isolate, content.data(), v8::NewStringType::kNormal, static_cast<int>(content.size())));
+                    source = value;
+                }
+                bool cached = false;
+                JS_EXPRESSION_RETURN(module, compile_module(isolate, source, load->location, std::hash<std::string_view>()(content), cached));
+                add_record(isolate, link->context.Get(isolate), module, load->location);
+                return module;
+            }();
+            if V8_UNLIKELY(!compiled.ToLocal(&module)) {
+                if (!try_catch.HasCaught() || !try_catch.CanContinue()) {
+                    return;
+                }
+                exception = try_catch.Exception();
+                try_catch.Reset();
+            }
+        }
+
+        for (auto &link : links) {
+            auto context = link->caller_context.Get(isolate);
+            v8::Context::Scope context_scope(context);
+            // Runs the microtasks (promise reactions) when the scope is left.
+            node::CallbackScope callback_scope(isolate, link->holder.Get(isolate), { 0, 0 });
+            if (module.IsEmpty()) {
+                settle(context, *link, exception, false);
+                continue;
+            }
+            link->modules.emplace_back(isolate, module);
+            v8::TryCatch try_catch(isolate);
+            if V8_UNLIKELY(visit(context, link, module, load->location).IsNothing()) {
+                if (try_catch.HasCaught() && try_catch.CanContinue()) {
+                    auto error = try_catch.Exception();
+                    try_catch.Reset();
+                    settle(context, *link, error, false);
+                }
+                continue;
+            }
+            if (link->pending == 0) {
+                finish(context, *link);
+            }
+        }
+    }
+
+    void Module::finish(v8::Local<v8::Context> context, Link &link) {
+        JS_TRACE_SCOPE("module", "Module::finish");
+        auto isolate = context->GetIsolate();
+        v8::HandleScope scope(isolate);
+        if V8_UNLIKELY(link.context.IsEmpty()) {
+            settle(context, link, v8::Exception::ReferenceError(StringTable::Get(isolate, "the context of the module is already disposed")), false);
+            return;
+        }
+        auto target_context = link.context.Get(isolate);
+        auto root = link.root.Get(isolate);
+        v8::TryCatch try_catch(isolate);
+        if (root->InstantiateModule(target_context, resolve).IsNothing()) {
+            if (try_catch.HasCaught() && try_catch.CanContinue()) {
+                auto exception = try_catch.Exception();
+                try_catch.Reset();
+                settle(context, link, exception, false);
+            }
+            return;
+        }
+        settle(context, link, link.holder.Get(isolate), true);
+    }
+
+    v8::MaybeLocal<v8::Module> Module::resolve(v8::Local<v8::Context> context, v8::Local<v8::String> specifier, v8::Local<v8::FixedArray> import_attributes, v8::Local<v8::Module> referrer) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Module>;
+        auto isolate = context->GetIsolate();
+        auto &state = per_isolate_state[isolate];
+        auto record = find_referrer(isolate, referrer);
+        if V8_LIKELY(record != nullptr) {
+            v8::String::Utf8Value specifier_value(isolate, specifier);
+            auto resolution = state.resolutions.find(std::make_pair(record->location, std::string(*specifier_value, specifier_value.length())));
+            if V8_LIKELY(resolution != state.resolutions.end()) {
+                if (auto module = find_record(isolate, context, resolution->second); !module.IsEmpty()) {
+                    return module;
+                }
+            }
+        }
+        JS_THROW_ERROR(ReferenceError, isolate, "Module \"", specifier, "\" is not loaded; call link() on the root module of the graph.");
+    }
+
+    void Module::prototype_link(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        JS_TRACE_SCOPE("module", "Module::prototype_link");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Module", ".", "prototype", ".", "link", " called on incompatible receiver ", receiver);
+        }
+        if (implementation->_link) {
+            auto promise = implementation->_link->resolver.Get(isolate)->GetPromise();
+            // A failed link is not cached: calling link() again retries (e.g. after the missing file is created).
+            if (promise->State() != v8::Promise::kRejected) {
+                info.GetReturnValue().Set(promise);
+                return;
+            }
+            implementation->_link.reset();
+        }
+        if V8_UNLIKELY(implementation->_context.IsEmpty()) {
+            JS_THROW_ERROR(ReferenceError, isolate, "the context of the module is already disposed");
+        }
+
+        JS_EXPRESSION_RETURN(resolver, v8::Promise::Resolver::New(context));
+        auto link = std::make_shared<Link>();
+        link->isolate = isolate;
+        link->caller_context.Reset(isolate, context);
+        link->context = implementation->_context;
+        link->root = implementation->_module;
+        link->holder.Reset(isolate, info.This().As<v8::Object>());
+        link->resolver.Reset(isolate, resolver);
+        link->seen.insert(implementation->_location);
+        implementation->_link = link;
+        info.GetReturnValue().Set(resolver->GetPromise());
+
+        auto module = implementation->_module.Get(isolate);
+        if (module->GetStatus() != v8::Module::kUninstantiated) {
+            settle(context, *link, info.This(), true);
+            return;
+        }
+        {
+            v8::TryCatch try_catch(isolate);
+            if (visit(context, link, module, implementation->_location).IsNothing()) {
+                if (try_catch.HasCaught() && try_catch.CanContinue()) {
+                    auto exception = try_catch.Exception();
+                    try_catch.Reset();
+                    settle(context, *link, exception, false);
+                } else {
+                    try_catch.ReThrow();
+                }
+                return;
+            }
+        }
+        if (link->pending == 0) {
+            finish(context, *link);
+        }
+    }
+
+    void Module::prototype_evaluate(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        JS_TRACE_SCOPE("module", "Module::prototype_evaluate");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Module", ".", "prototype", ".", "evaluate", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(implementation->_context.IsEmpty()) {
+            JS_THROW_ERROR(ReferenceError, isolate, "the context of the module is already disposed");
+        }
+        auto module = implementation->_module.Get(isolate);
+        if V8_UNLIKELY(module->GetStatus() < v8::Module::kInstantiated) {
+            JS_THROW_ERROR(Error, isolate, "The module must be linked before it is evaluated.");
+        }
+        auto target_context = implementation->_context.Get(isolate);
+        v8::Context::Scope context_scope(target_context);
+        JS_EXPRESSION_RETURN(result, module->Evaluate(target_context));
+        info.GetReturnValue().Set(result);
+    }
+
+    void Module::prototype_get_status(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Module", ".", "prototype", ".", "status", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(status_name(isolate, implementation->_module.Get(isolate)->GetStatus()));
+    }
+
+    void Module::prototype_get_namespace(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Module", ".", "prototype", ".", "namespace", " called on incompatible receiver ", receiver);
+        }
+        auto module = implementation->_module.Get(isolate);
+        if V8_UNLIKELY(module->GetStatus() < v8::Module::kInstantiated) {
+            JS_THROW_ERROR(Error, isolate, "The module must be linked before its namespace is accessed.");
+        }
+        info.GetReturnValue().Set(module->GetModuleNamespace());
+    }
+
+    void Module::prototype_get_location(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Module", ".", "prototype", ".", "location", " called on incompatible receiver ", receiver);
+        }
+        if (implementation->_location.empty()) {
+            info.GetReturnValue().SetUndefined();
+            return;
+        }
+        const auto &location = implementation->_location;
+        JS_EXPRESSION_RETURN(value, v8::String::NewFromUtf8(isolate, location.data(), v8::NewStringType::kNormal, static_cast<int>(location.size())));
+        info.GetReturnValue().Set(value);
+    }
+
+    void Module::prototype_get_requests(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Module", ".", "prototype", ".", "requests", " called on incompatible receiver ", receiver);
+        }
+        auto requests = implementation->_module.Get(isolate)->GetModuleRequests();
+        std::vector<v8::Local<v8::Value>> specifiers;
+        specifiers.reserve(requests->Length());
+        for (int i = 0; i < requests->Length(); ++i) {
+            specifiers.push_back(requests->Get(context, i).As<v8::ModuleRequest>()->GetSpecifier());
+        }
+        info.GetReturnValue().Set(v8::Array::New(isolate, specifiers.data(), specifiers.size()));
+    }
+
+    void Module::prototype_get_cached(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Module", ".", "prototype", ".", "cached", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(implementation->_cached);
+    }
+}
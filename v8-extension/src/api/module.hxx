@@ -0,0 +1,74 @@
+#ifndef NODE_EXT_API_MODULE_HXX
+#define NODE_EXT_API_MODULE_HXX
+
+#include <memory>
+#include <string>
+#include <uv.h>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief An ECMAScript module compiled by Context.prototype.compileModule({ source, location }).
+     *
+     * link() returns a promise for the module: it loads the module graph and instantiates it in the context of the module.
+     * The files of the requested modules are read concurrently on the libuv threadpool, one wave per level of the graph,
+     * and compiled on the thread of the isolate as they arrive. Specifiers are resolved natively: absolute paths, file: URLs
+     * and paths relative to the location of the referrer; the result is cached per isolate by (referrer, specifier).
+     * Graphs linked concurrently in the same context share the loads in progress, so each file is compiled once. link() returns
+     * the same promise until it is rejected; after a failure it starts over.
+     *
+     * Each context has a module map: a module compiled for a location is reused by every graph linked later in the same
+     * context. The code cache of every compiled module is kept per isolate by location and source hash, so compiling the same
+     * graph into another context consumes it instead of parsing the sources again (the "cached" property tells whether the
+     * code cache was accepted).
+     *
+     * evaluate() returns the promise of v8::Module::Evaluate(); "status", "namespace", "location" and "requests" reflect the
+     * underlying v8::Module.
+     */
+    class Module : public Object<Module> {
+    public:
+        struct Link;
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+        /**
+         * @brief Compile the root module of a graph for target_context; the holder is created in context.
+         */
+        static v8::MaybeLocal<v8::Object> compile(v8::Local<v8::Context> context, v8::Local<v8::Context> target_context, v8::Local<v8::Object> options);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_link(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_evaluate(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_status(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_namespace(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_location(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_requests(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_cached(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static v8::MaybeLocal<v8::Module> resolve(v8::Local<v8::Context> context, v8::Local<v8::String> specifier, v8::Local<v8::FixedArray> import_attributes, v8::Local<v8::Module> referrer);
+        static v8::Maybe<void> visit(v8::Local<v8::Context> context, const std::shared_ptr<Link> &link, v8::Local<v8::Module> module, const std::string &location);
+        static void load(uv_work_t *request);
+        static void on_load(uv_work_t *request, int status);
+        static void finish(v8::Local<v8::Context> context, Link &link);
+    private:
+        Shared<v8::Module> _module;
+        Shared<v8::Context> _context;
+        std::string _location;
+        bool _cached = false;
+        std::shared_ptr<Link> _link;
+    protected:
+        Module() = default;
+        Module(const Module &) = delete;
+        Module(Module &&) = delete;
+    public:
+        virtual ~Module() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_MODULE_HXX */
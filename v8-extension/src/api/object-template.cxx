@@ -3,12 +3,16 @@
 #include "object-template/accessor-property.hxx"
 #include "object-template/named-property-handler-configuration.hxx"
 #include "object-template/indexed-property-handler-configuration.hxx"
+#include "object-template/named-property-storage.hxx"
+#include "object-template/indexed-property-storage.hxx"
 #include "template.hxx"
+#include "template/internal-field-property.hxx"
 #include "frozen-map.hxx"
 #include "context.hxx"
 
 #include "../error-message.hxx"
 #include "../js-string-table.hxx"
+#include "../trace.hxx"
 
 #include <map>
 #include <vector>
@@ -17,15 +21,21 @@ namespace dragiyski::node_ext {
     using namespace js;
 
     namespace {
-        std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
-        std::map<v8::Isolate*, Shared<v8::Private>> per_isolate_class_symbol;
+        thread_local std::map<v8::Isolate*, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate*, Shared<v8::Private>> per_isolate_class_symbol;
     }
 
     void ObjectTemplate::initialize(v8::Isolate* isolate) {
         assert(!per_isolate_template.contains(isolate));
         assert(!per_isolate_class_symbol.contains(isolate));
 
-        auto class_name = ::js::StringTable::Get(isolate, "FunctionTemplate");
+        AccessorProperty::initialize(isolate);
+        NamedPropertyHandlerConfiguration::initialize(isolate);
+        IndexedPropertyHandlerConfiguration::initialize(isolate);
+        NamedPropertyStorage::initialize(isolate);
+        IndexedPropertyStorage::initialize(isolate);
+
+        auto class_name = ::js::StringTable::Get(isolate, "ObjectTemplate");
         auto class_cache = v8::Private::New(isolate, class_name);
         auto class_template = v8::FunctionTemplate::NewWithCache(
             isolate,
@@ -33,12 +43,15 @@ namespace dragiyski::node_ext {
             class_cache
         );
         class_template->SetClassName(class_name);
-
-        auto signature = v8::Signature::New(isolate, class_template);
-        auto prototype_template = class_template->PrototypeTemplate();
+        class_template->Inherit(Template::get_template(isolate));
 
         class_template->ReadOnlyPrototype();
         class_template->InstanceTemplate()->SetInternalFieldCount(1);
+        class_template->Set(StringTable::Get(isolate, "AccessorProperty"), AccessorProperty::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+        class_template->Set(StringTable::Get(isolate, "NamedPropertyHandlerConfiguration"), NamedPropertyHandlerConfiguration::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+        class_template->Set(StringTable::Get(isolate, "IndexedPropertyHandlerConfiguration"), IndexedPropertyHandlerConfiguration::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+        class_template->Set(StringTable::Get(isolate, "NamedPropertyStorage"), NamedPropertyStorage::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+        class_template->Set(StringTable::Get(isolate, "IndexedPropertyStorage"), IndexedPropertyStorage::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
 
         per_isolate_class_symbol.emplace(
             std::piecewise_construct,
@@ -51,11 +64,19 @@ namespace dragiyski::node_ext {
             std::forward_as_tuple(isolate),
             std::forward_as_tuple(isolate, class_template)
         );
+
+        Object<ObjectTemplate>::initialize(isolate);
     }
 
     void ObjectTemplate::uninitialize(v8::Isolate* isolate) {
+        Object<ObjectTemplate>::uninitialize(isolate);
         per_isolate_template.erase(isolate);
         per_isolate_class_symbol.erase(isolate);
+        IndexedPropertyStorage::uninitialize(isolate);
+        NamedPropertyStorage::uninitialize(isolate);
+        IndexedPropertyHandlerConfiguration::uninitialize(isolate);
+        NamedPropertyHandlerConfiguration::uninitialize(isolate);
+        AccessorProperty::uninitialize(isolate);
     }
 
     v8::Local<v8::FunctionTemplate> ObjectTemplate::get_template(v8::Isolate* isolate) {
@@ -106,7 +127,6 @@ namespace dragiyski::node_ext {
         // Usage of unique_ptr here, so in case function returns early (due to error) this is destroyed.
         // We (should) call .release() at the end of this function.
         auto target = std::unique_ptr<ObjectTemplate>(new ObjectTemplate());
-        target->set_interface(isolate, interface);
         target->_value.Reset(isolate, js_target);
 
         target->_undetectable = false;
@@ -145,59 +165,95 @@ namespace dragiyski::node_ext {
             }
         }
 
+        // Fields for Template.InternalFieldProperty (and for the embedder); the objects created from the template are not wrappers.
+        target->_internal_field_count = 0;
+        {
+            auto name = StringTable::Get(isolate, "internalFieldCount");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if (!js_value->IsNullOrUndefined()) {
+                JS_EXPRESSION_RETURN_WITH_ERROR_PREFIX(value, js_value->Uint32Value(context), context, "In option \"internalFieldCount\"");
+                if V8_UNLIKELY(value > Template::InternalFieldProperty::MAX_INDEX) {
+                    JS_THROW_ERROR(RangeError, isolate, "Option \"internalFieldCount\": expected at most ", Template::InternalFieldProperty::MAX_INDEX, " fields.");
+                }
+                target->_internal_field_count = static_cast<int>(value);
+                js_target->SetInternalFieldCount(target->_internal_field_count);
+                if (target->_internal_field_count > 0) {
+                    js_target->SetPrivate(Template::InternalFieldProperty::get_field_symbol(isolate), v8::True(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+                }
+            }
+        }
+
         {
             auto name = StringTable::Get(isolate, "namedHandler");
             JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
             if (!js_value->IsNullOrUndefined()) {
                 if (!js_value->IsObject()) {
-                    JS_THROW_ERROR(TypeError, isolate, "Option \"namedHandler\" is not an [object NamedPropertyHandlerConfiguration]");
+                    JS_THROW_ERROR(TypeError, isolate, "Option \"namedHandler\" is not an [object NamedPropertyHandlerConfiguration] or [object NamedPropertyStorage]");
                 }
                 auto js_object = js_value.As<v8::Object>();
-                auto named_handler = Object<NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_object);
-                if (named_handler == nullptr) {
-                    JS_THROW_ERROR(TypeError, isolate, "Option \"namedHandler\" is not an [object NamedPropertyHandlerConfiguration]");
-                }
-                target->_name_handler.Reset(isolate, js_object);
-                v8::NamedPropertyGetterCallback configuration_getter = NamedPropertyGetterCallback;
-                v8::NamedPropertySetterCallback configuration_setter = nullptr;
-                v8::NamedPropertyQueryCallback configuration_query = nullptr;
-                v8::NamedPropertyDeleterCallback configuration_deleter = nullptr;
-                v8::NamedPropertyEnumeratorCallback configuration_enumerator = nullptr;
-                v8::NamedPropertyDefinerCallback configuration_definer = nullptr;
-                v8::NamedPropertyDescriptorCallback configuration_descriptor = nullptr;
-                if (!named_handler->get_getter(isolate).IsEmpty()) {
-                    JS_THROW_ERROR(TypeError, isolate, "Missing required option: namedHandler.getter");
-                }
-                if (!named_handler->get_setter(isolate).IsEmpty()) {
-                    configuration_setter = NamedPropertySetterCallback;
-                }
-                if (!named_handler->get_query(isolate).IsEmpty()) {
-                    configuration_query = NamedPropertyQueryCallback;
-                }
-                if (!named_handler->get_deleter(isolate).IsEmpty()) {
-                    configuration_deleter = NamedPropertyDeleterCallback;
-                }
-                if (!named_handler->get_enumerator(isolate).IsEmpty()) {
-                    configuration_enumerator = NamedPropertyEnumeratorCallback;
-                }
-                if (!named_handler->get_definer(isolate).IsEmpty()) {
-                    configuration_definer = NamedPropertyDefinerCallback;
-                }
-                if (!named_handler->get_descriptor(isolate).IsEmpty()) {
-                    configuration_descriptor = NamedPropertyDescriptorCallback;
+                auto named_storage = Object<NamedPropertyStorage>::get_implementation(isolate, js_object);
+                if (named_storage != nullptr) {
+                    // The fallback (if any) is invoked through the regular callbacks, so it takes the place of the handler configuration.
+                    target->_name_storage.Reset(isolate, js_object);
+                    target->_name_storage_implementation = named_storage;
+                    target->_name_handler.Reset(isolate, named_storage->get_fallback(isolate));
+                    v8::NamedPropertyHandlerConfiguration configuration(
+                        NamedPropertyStorage::getter_callback,
+                        NamedPropertyStorage::setter_callback,
+                        NamedPropertyStorage::query_callback,
+                        NamedPropertyStorage::deleter_callback,
+                        NamedPropertyStorage::enumerator_callback,
+                        interface,
+                        named_storage->get_flags(isolate)
+                    );
+                    js_target->SetHandler(configuration);
+                } else {
+                    auto named_handler = Object<NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_object);
+                    if (named_handler == nullptr) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"namedHandler\" is not an [object NamedPropertyHandlerConfiguration] or [object NamedPropertyStorage]");
+                    }
+                    target->_name_handler.Reset(isolate, js_object);
+                    v8::NamedPropertyGetterCallback configuration_getter = NamedPropertyGetterCallback;
+                    v8::NamedPropertySetterCallback configuration_setter = nullptr;
+                    v8::NamedPropertyQueryCallback configuration_query = nullptr;
+                    v8::NamedPropertyDeleterCallback configuration_deleter = nullptr;
+                    v8::NamedPropertyEnumeratorCallback configuration_enumerator = nullptr;
+                    v8::NamedPropertyDefinerCallback configuration_definer = nullptr;
+                    v8::NamedPropertyDescriptorCallback configuration_descriptor = nullptr;
+                    if (named_handler->get_getter(isolate).IsEmpty()) {
+                        JS_THROW_ERROR(TypeError, isolate, "Missing required option: namedHandler.getter");
+                    }
+                    if (!named_handler->get_setter(isolate).IsEmpty()) {
+                        configuration_setter = NamedPropertySetterCallback;
+                    }
+                    if (!named_handler->get_query(isolate).IsEmpty()) {
+                        configuration_query = NamedPropertyQueryCallback;
+                    }
+                    if (!named_handler->get_deleter(isolate).IsEmpty()) {
+                        configuration_deleter = NamedPropertyDeleterCallback;
+                    }
+                    if (!named_handler->get_enumerator(isolate).IsEmpty()) {
+                        configuration_enumerator = NamedPropertyEnumeratorCallback;
+                    }
+                    if (!named_handler->get_definer(isolate).IsEmpty()) {
+                        configuration_definer = NamedPropertyDefinerCallback;
+                    }
+                    if (!named_handler->get_descriptor(isolate).IsEmpty()) {
+                        configuration_descriptor = NamedPropertyDescriptorCallback;
+                    }
+                    v8::NamedPropertyHandlerConfiguration configuration(
+                        configuration_getter,
+                        configuration_setter,
+                        configuration_query,
+                        configuration_deleter,
+                        configuration_enumerator,
+                        configuration_definer,
+                        configuration_descriptor,
+                        interface,
+                        named_handler->get_flags()
+                    );
+                    js_target->SetHandler(configuration);
                 }
-                v8::NamedPropertyHandlerConfiguration configuration(
-                    configuration_getter,
-                    configuration_setter,
-                    configuration_query,
-                    configuration_deleter,
-                    configuration_enumerator,
-                    configuration_definer,
-                    configuration_descriptor,
-                    interface,
-                    named_handler->get_flags()
-                );
-                js_target->SetHandler(configuration);
             }
         }
 
@@ -206,54 +262,72 @@ namespace dragiyski::node_ext {
             JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
             if (!js_value->IsNullOrUndefined()) {
                 if (!js_value->IsObject()) {
-                    JS_THROW_ERROR(TypeError, isolate, "Option \"indexedHandler\" is not an [object IndexedPropertyHandlerConfiguration]");
+                    JS_THROW_ERROR(TypeError, isolate, "Option \"indexedHandler\" is not an [object IndexedPropertyHandlerConfiguration] or [object IndexedPropertyStorage]");
                 }
                 auto js_object = js_value.As<v8::Object>();
-                auto indexed_handler = Object<IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_object);
-                if (indexed_handler == nullptr) {
-                    JS_THROW_ERROR(TypeError, isolate, "Option \"indexedHandler\" is not an [object IndexedPropertyHandlerConfiguration]");
-                }
-                target->_index_handler.Reset(isolate, js_object);
-                v8::IndexedPropertyGetterCallbackV2 configuration_getter = nullptr;
-                v8::IndexedPropertySetterCallbackV2 configuration_setter = nullptr;
-                v8::IndexedPropertyQueryCallbackV2 configuration_query = nullptr;
-                v8::IndexedPropertyDeleterCallbackV2 configuration_deleter = nullptr;
-                v8::IndexedPropertyEnumeratorCallback configuration_enumerator = nullptr;
-                v8::IndexedPropertyDefinerCallbackV2 configuration_definer = nullptr;
-                v8::IndexedPropertyDescriptorCallbackV2 configuration_descriptor = nullptr;
-                if (!indexed_handler->get_getter(isolate).IsEmpty()) {
-                    configuration_getter = IndexedPropertyGetterCallback;
-                }
-                if (!indexed_handler->get_setter(isolate).IsEmpty()) {
-                    configuration_setter = IndexedPropertySetterCallback;
-                }
-                if (!indexed_handler->get_query(isolate).IsEmpty()) {
-                    configuration_query = IndexedPropertyQueryCallback;
-                }
-                if (!indexed_handler->get_deleter(isolate).IsEmpty()) {
-                    configuration_deleter = IndexedPropertyDeleterCallback;
-                }
-                if (!indexed_handler->get_enumerator(isolate).IsEmpty()) {
-                    configuration_enumerator = IndexedPropertyEnumeratorCallback;
-                }
-                if (!indexed_handler->get_definer(isolate).IsEmpty()) {
-                    configuration_definer = IndexedPropertyDefinerCallback;
-                }
-                if (!indexed_handler->get_descriptor(isolate).IsEmpty()) {
-                    configuration_descriptor = IndexedPropertyDescriptorCallback;
+                auto indexed_storage = Object<IndexedPropertyStorage>::get_implementation(isolate, js_object);
+                if (indexed_storage != nullptr) {
+                    // The fallback (if any) is invoked through the regular callbacks, so it takes the place of the handler configuration.
+                    target->_index_storage.Reset(isolate, js_object);
+                    target->_index_storage_implementation = indexed_storage;
+                    target->_index_handler.Reset(isolate, indexed_storage->get_fallback(isolate));
+                    v8::IndexedPropertyHandlerConfiguration configuration(
+                        IndexedPropertyStorage::getter_callback,
+                        IndexedPropertyStorage::setter_callback,
+                        IndexedPropertyStorage::query_callback,
+                        IndexedPropertyStorage::deleter_callback,
+                        IndexedPropertyStorage::enumerator_callback,
+                        interface,
+                        indexed_storage->get_flags(isolate)
+                    );
+                    js_target->SetHandler(configuration);
+                } else {
+                    auto indexed_handler = Object<IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_object);
+                    if (indexed_handler == nullptr) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"indexedHandler\" is not an [object IndexedPropertyHandlerConfiguration] or [object IndexedPropertyStorage]");
+                    }
+                    target->_index_handler.Reset(isolate, js_object);
+                    v8::IndexedPropertyGetterCallbackV2 configuration_getter = nullptr;
+                    v8::IndexedPropertySetterCallbackV2 configuration_setter = nullptr;
+                    v8::IndexedPropertyQueryCallbackV2 configuration_query = nullptr;
+                    v8::IndexedPropertyDeleterCallbackV2 configuration_deleter = nullptr;
+                    v8::IndexedPropertyEnumeratorCallback configuration_enumerator = nullptr;
+                    v8::IndexedPropertyDefinerCallbackV2 configuration_definer = nullptr;
+                    v8::IndexedPropertyDescriptorCallbackV2 configuration_descriptor = nullptr;
+                    if (!indexed_handler->get_getter(isolate).IsEmpty()) {
+                        configuration_getter = IndexedPropertyGetterCallback;
+                    }
+                    if (!indexed_handler->get_setter(isolate).IsEmpty()) {
+                        configuration_setter = IndexedPropertySetterCallback;
+                    }
+                    if (!indexed_handler->get_query(isolate).IsEmpty()) {
+                        configuration_query = IndexedPropertyQueryCallback;
+                    }
+                    if (!indexed_handler->get_deleter(isolate).IsEmpty()) {
+                        configuration_deleter = IndexedPropertyDeleterCallback;
+                    }
+                    if (!indexed_handler->get_enumerator(isolate).IsEmpty()) {
+                        configuration_enumerator = IndexedPropertyEnumeratorCallback;
+                    }
+                    if (!indexed_handler->get_definer(isolate).IsEmpty()) {
+                        configuration_definer = IndexedPropertyDefinerCallback;
+                    }
+                    if (!indexed_handler->get_descriptor(isolate).IsEmpty()) {
+                        configuration_descriptor = IndexedPropertyDescriptorCallback;
+                    }
+                    v8::IndexedPropertyHandlerConfiguration configuration(
+                        configuration_getter,
+                        configuration_setter,
+                        configuration_query,
+                        configuration_deleter,
+                        configuration_enumerator,
+                        configuration_definer,
+                        configuration_descriptor,
+                        interface,
+                        indexed_handler->get_flags()
+                    );
+                    js_target->SetHandler(configuration);
                 }
-                v8::IndexedPropertyHandlerConfiguration configuration(
-                    configuration_getter,
-                    configuration_setter,
-                    configuration_query,
-                    configuration_deleter,
-                    configuration_enumerator,
-                    configuration_definer,
-                    configuration_descriptor,
-                    interface,
-                    indexed_handler->get_flags()
-                );
-                js_target->SetHandler(configuration);
             }
         }
 
@@ -272,7 +346,10 @@ namespace dragiyski::node_ext {
             }
         }
 
-        return v8::Just(target.release());
+        // Registered only once complete: an implementation destroyed by an early return must not remain in the object set.
+        auto implementation = target.release();
+        implementation->set_interface(isolate, interface);
+        return v8::Just(implementation);
     }
 
     v8::Maybe<void> ObjectTemplate::SetupProperty(v8::Local<v8::Context> context, v8::Local<v8::Object> interface, v8::Local<v8::ObjectTemplate> target, v8::Local<v8::Map> map, v8::Local<v8::Value> key, v8::Local<v8::Value> value) {
@@ -293,18 +370,7 @@ namespace dragiyski::node_ext {
                 auto key_name = key.As<v8::Name>();
                 auto setter = value_accessor_property->get_setter(isolate);
                 JS_EXPRESSION_IGNORE(map->Set(context, key, value));
-                v8::Local<v8::Object> data;
-                {
-                    v8::Local<v8::Name> names[] = {
-                        StringTable::Get(isolate, "descriptor"),
-                        StringTable::Get(isolate, "template")
-                    };
-                    v8::Local<v8::Value> values[] = {
-                        value,
-                        interface
-                    };
-                    data = v8::Object::New(isolate, v8::Null(isolate), names, values, sizeof(names) / sizeof(v8::Local<v8::Name>));
-                }
+                JS_EXPRESSION_RETURN(data, Template::NewPropertyData(context, value_object, value_accessor_property, interface));
                 target->SetAccessor(
                     key_name,
                     AccessorProperty::getter_callback,
@@ -316,6 +382,32 @@ namespace dragiyski::node_ext {
                 );
                 return v8::JustVoid();
             }
+            // The accessor data is an integer, the callbacks never call JavaScript and the getter has no side effects.
+            auto value_internal_field_property = Object<Template::InternalFieldProperty>::get_implementation(isolate, value_object);
+            if (value_internal_field_property != nullptr) {
+                if V8_UNLIKELY(key->IsObject() || key->IsExternal()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Template native data property key must be a primitive");
+                } else if V8_UNLIKELY(!key->IsName()) {
+                    JS_EXPRESSION_RETURN(key_string, key->ToString(context));
+                    key = key_string;
+                }
+                auto index = value_internal_field_property->get_index();
+                if V8_UNLIKELY(static_cast<uint32_t>(target->InternalFieldCount()) <= index) {
+                    JS_THROW_ERROR(TypeError, isolate, "Template.InternalFieldProperty with index ", index, " requires option \"internalFieldCount\" of at least ", index + 1, ", got ", target->InternalFieldCount());
+                }
+                auto key_name = key.As<v8::Name>();
+                JS_EXPRESSION_IGNORE(map->Set(context, key, value));
+                target->SetNativeDataProperty(
+                    key_name,
+                    Template::InternalFieldProperty::getter_callback,
+                    !value_internal_field_property->is_readonly() ? Template::InternalFieldProperty::setter_callback : nullptr,
+                    value_internal_field_property->get_data(isolate),
+                    value_internal_field_property->get_attributes(),
+                    v8::SideEffectType::kHasNoSideEffect,
+                    v8::SideEffectType::kHasSideEffectToReceiver
+                );
+                return v8::JustVoid();
+            }
         }
 
         return Template::SetupProperty(context, interface, target, map, key, value);
@@ -344,6 +436,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::NamedPropertyGetterCallback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyGetterCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -424,6 +517,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::NamedPropertySetterCallback(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertySetterCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -501,6 +595,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::NamedPropertyQueryCallback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyQueryCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -587,6 +682,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::NamedPropertyDeleterCallback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyDeleterCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -666,6 +762,7 @@ namespace dragiyski::node_ext {
     }
 
     void ObjectTemplate::NamedPropertyEnumeratorCallback(const v8::PropertyCallbackInfo<v8::Array>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyEnumeratorCallback");
         using __function_return_type__ = void;
         auto isolate = info.GetIsolate();
         v8::HandleScope scope(isolate);
@@ -690,7 +787,7 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (named_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyEnumeratorCallback");
         }
-        auto callback = named_handler->get_definer(isolate);
+        auto callback = named_handler->get_enumerator(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return;
         }
@@ -739,6 +836,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::NamedPropertyDefinerCallback(v8::Local<v8::Name> property, const v8::PropertyDescriptor& descriptor, const v8::PropertyCallbackInfo<void>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyDefinerCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -816,6 +914,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::NamedPropertyDescriptorCallback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyDescriptorCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -983,6 +1082,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::IndexedPropertyGetterCallback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyGetterCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -997,18 +1097,18 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (js_template == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyGetterCallback");
         }
-        auto js_descriptor = js_template->get_name_handler(isolate);
+        auto js_descriptor = js_template->get_index_handler(isolate);
         if V8_UNLIKELY (!js_descriptor->IsObject()) {
             if (js_descriptor->IsNullOrUndefined()) {
                 return __return_value__;
             }
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyGetterCallback");
         }
-        auto named_handler = Object<ObjectTemplate::NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
-        if V8_UNLIKELY (named_handler == nullptr) {
+        auto indexed_handler = Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
+        if V8_UNLIKELY (indexed_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyGetterCallback");
         }
-        auto callback = named_handler->get_getter(isolate);
+        auto callback = indexed_handler->get_getter(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return __return_value__;
         }
@@ -1063,6 +1163,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::IndexedPropertySetterCallback(uint32_t index, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertySetterCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -1077,18 +1178,18 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (js_template == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertySetterCallback");
         }
-        auto js_descriptor = js_template->get_name_handler(isolate);
+        auto js_descriptor = js_template->get_index_handler(isolate);
         if V8_UNLIKELY (!js_descriptor->IsObject()) {
             if (js_descriptor->IsNullOrUndefined()) {
                 return __return_value__;
             }
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertySetterCallback");
         }
-        auto named_handler = Object<ObjectTemplate::NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
-        if V8_UNLIKELY (named_handler == nullptr) {
+        auto indexed_handler = Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
+        if V8_UNLIKELY (indexed_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertySetterCallback");
         }
-        auto callback = named_handler->get_setter(isolate);
+        auto callback = indexed_handler->get_setter(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return __return_value__;
         }
@@ -1140,6 +1241,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::IndexedPropertyQueryCallback(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyQueryCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -1154,18 +1256,18 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (js_template == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyQueryCallback");
         }
-        auto js_descriptor = js_template->get_name_handler(isolate);
+        auto js_descriptor = js_template->get_index_handler(isolate);
         if V8_UNLIKELY (!js_descriptor->IsObject()) {
             if (js_descriptor->IsNullOrUndefined()) {
                 return __return_value__;
             }
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyQueryCallback");
         }
-        auto named_handler = Object<ObjectTemplate::NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
-        if V8_UNLIKELY (named_handler == nullptr) {
+        auto indexed_handler = Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
+        if V8_UNLIKELY (indexed_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyQueryCallback");
         }
-        auto callback = named_handler->get_query(isolate);
+        auto callback = indexed_handler->get_query(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return __return_value__;
         }
@@ -1226,6 +1328,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::IndexedPropertyDeleterCallback(uint32_t index, const v8::PropertyCallbackInfo<v8::Boolean>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyDeleterCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -1240,18 +1343,18 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (js_template == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDeleterCallback");
         }
-        auto js_descriptor = js_template->get_name_handler(isolate);
+        auto js_descriptor = js_template->get_index_handler(isolate);
         if V8_UNLIKELY (!js_descriptor->IsObject()) {
             if (js_descriptor->IsNullOrUndefined()) {
                 return __return_value__;
             }
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDeleterCallback");
         }
-        auto named_handler = Object<ObjectTemplate::NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
-        if V8_UNLIKELY (named_handler == nullptr) {
+        auto indexed_handler = Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
+        if V8_UNLIKELY (indexed_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDeleterCallback");
         }
-        auto callback = named_handler->get_deleter(isolate);
+        auto callback = indexed_handler->get_deleter(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return __return_value__;
         }
@@ -1305,6 +1408,7 @@ namespace dragiyski::node_ext {
     }
 
     void ObjectTemplate::IndexedPropertyEnumeratorCallback(const v8::PropertyCallbackInfo<v8::Array>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyEnumeratorCallback");
         using __function_return_type__ = void;
         auto isolate = info.GetIsolate();
         v8::HandleScope scope(isolate);
@@ -1318,18 +1422,18 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (js_template == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyEnumeratorCallback");
         }
-        auto js_descriptor = js_template->get_name_handler(isolate);
+        auto js_descriptor = js_template->get_index_handler(isolate);
         if V8_UNLIKELY (!js_descriptor->IsObject()) {
             if (js_descriptor->IsNullOrUndefined()) {
                 return;
             }
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyEnumeratorCallback");
         }
-        auto named_handler = Object<ObjectTemplate::NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
-        if V8_UNLIKELY (named_handler == nullptr) {
+        auto indexed_handler = Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
+        if V8_UNLIKELY (indexed_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyEnumeratorCallback");
         }
-        auto callback = named_handler->get_definer(isolate);
+        auto callback = indexed_handler->get_enumerator(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return;
         }
@@ -1378,6 +1482,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::IndexedPropertyDefinerCallback(uint32_t index, const v8::PropertyDescriptor& descriptor, const v8::PropertyCallbackInfo<void>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyDefinerCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -1392,18 +1497,18 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (js_template == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDefinerCallback");
         }
-        auto js_descriptor = js_template->get_name_handler(isolate);
+        auto js_descriptor = js_template->get_index_handler(isolate);
         if V8_UNLIKELY (!js_descriptor->IsObject()) {
             if (js_descriptor->IsNullOrUndefined()) {
                 return __return_value__;
             }
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDefinerCallback");
         }
-        auto named_handler = Object<ObjectTemplate::NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
-        if V8_UNLIKELY (named_handler == nullptr) {
+        auto indexed_handler = Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
+        if V8_UNLIKELY (indexed_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDefinerCallback");
         }
-        auto callback = named_handler->get_definer(isolate);
+        auto callback = indexed_handler->get_definer(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return __return_value__;
         }
@@ -1455,6 +1560,7 @@ namespace dragiyski::node_ext {
     }
 
     v8::Intercepted ObjectTemplate::IndexedPropertyDescriptorCallback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value>& info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyDescriptorCallback");
         auto __return_value__ = v8::Intercepted::kNo;
         static const auto __function_return_type__ = [&__return_value__](){ return __return_value__; };
         auto isolate = info.GetIsolate();
@@ -1469,18 +1575,18 @@ namespace dragiyski::node_ext {
         if V8_UNLIKELY (js_template == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDeleterCallback");
         }
-        auto js_descriptor = js_template->get_name_handler(isolate);
+        auto js_descriptor = js_template->get_index_handler(isolate);
         if V8_UNLIKELY (!js_descriptor->IsObject()) {
             if (js_descriptor->IsNullOrUndefined()) {
                 return __return_value__;
             }
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDeleterCallback");
         }
-        auto named_handler = Object<ObjectTemplate::NamedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
-        if V8_UNLIKELY (named_handler == nullptr) {
+        auto indexed_handler = Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::get_implementation(isolate, js_descriptor);
+        if V8_UNLIKELY (indexed_handler == nullptr) {
             JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyDeleterCallback");
         }
-        auto callback = named_handler->get_descriptor(isolate);
+        auto callback = indexed_handler->get_descriptor(isolate);
         if (!JS_IS_CALLABLE(callback)) {
             return __return_value__;
         }
@@ -1621,6 +1727,30 @@ namespace dragiyski::node_ext {
         return __return_value__;
     }
 
+    v8::Local<v8::ObjectTemplate> ObjectTemplate::get_value(v8::Isolate *isolate) const {
+        return _value.Get(isolate);
+    }
+
+    v8::Local<v8::Object> ObjectTemplate::get_name_handler(v8::Isolate *isolate) const {
+        return _name_handler.Get(isolate);
+    }
+
+    v8::Local<v8::Object> ObjectTemplate::get_index_handler(v8::Isolate *isolate) const {
+        return _index_handler.Get(isolate);
+    }
+
+    int ObjectTemplate::get_internal_field_count() const {
+        return _internal_field_count;
+    }
+
+    v8::Local<v8::Object> ObjectTemplate::get_name_storage(v8::Isolate *isolate) const {
+        return _name_storage.Get(isolate);
+    }
+
+    v8::Local<v8::Object> ObjectTemplate::get_index_storage(v8::Isolate *isolate) const {
+        return _index_storage.Get(isolate);
+    }
+
     void ObjectTemplate::InterceptReturn(const v8::FunctionCallbackInfo<v8::Value>& info) {
         using __function_return_type__ = void;
         auto isolate = info.GetIsolate();
@@ -20,6 +20,11 @@ namespace dragiyski::node_ext {
         friend class FunctionTemplate;
     public:
         using js_type = v8::ObjectTemplate;
+        class NamedPropertyHandlerConfiguration;
+        class IndexedPropertyHandlerConfiguration;
+        class NamedPropertyStorage;
+        class IndexedPropertyStorage;
+        class AccessorProperty;
     public:
         static void initialize(v8::Isolate* isolate);
         static void uninitialize(v8::Isolate* isolate);
@@ -54,14 +59,22 @@ namespace dragiyski::node_ext {
         bool _undetectable;
         bool _code_like;
         bool _immutable_prototype;
+        int _internal_field_count;
         Shared<v8::Object> _name_handler, _index_handler, _constructor, _properties;
+        Shared<v8::Object> _name_storage, _index_storage;
+        // The implementations of _name_storage and _index_storage, read by the storage interceptors on every access.
+        NamedPropertyStorage *_name_storage_implementation = nullptr;
+        IndexedPropertyStorage *_index_storage_implementation = nullptr;
         Shared<v8::Function> _function, _access_check;
     public:
         v8::Local<v8::ObjectTemplate> get_value(v8::Isolate *isolate) const;
         bool is_undetectable() const;
         bool is_immutable_prototype() const;
+        int get_internal_field_count() const;
         v8::Local<v8::Object> get_name_handler(v8::Isolate *isolate) const;
         v8::Local<v8::Object> get_index_handler(v8::Isolate *isolate) const;
+        v8::Local<v8::Object> get_name_storage(v8::Isolate *isolate) const;
+        v8::Local<v8::Object> get_index_storage(v8::Isolate *isolate) const;
         v8::Local<v8::Object> get_constructor(v8::Isolate *isolate) const;
         v8::Local<v8::Object> get_properties(v8::Isolate *isolate) const;
     protected:
@@ -70,10 +83,6 @@ namespace dragiyski::node_ext {
         ObjectTemplate(ObjectTemplate&&) = delete;
     public:
         virtual ~ObjectTemplate() override = default;
-    public:
-        class NamedPropertyHandlerConfiguration;
-        class IndexedPropertyHandlerConfiguration;
-        class AccessorProperty;
     };
 }
 
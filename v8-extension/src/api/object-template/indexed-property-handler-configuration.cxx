@@ -9,7 +9,7 @@
 
 namespace dragiyski::node_ext {
     namespace {
-        std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
     }
 
     void ObjectTemplate::IndexedPropertyHandlerConfiguration::initialize(v8::Isolate *isolate) {
@@ -18,8 +18,6 @@ namespace dragiyski::node_ext {
         auto class_name = StringTable::Get(isolate, "IndexedPropertyHandlerConfiguration");
         auto class_template = v8::FunctionTemplate::New(isolate, constructor);
         class_template->SetClassName(class_name);
-        auto prototype_template = class_template->PrototypeTemplate();
-        auto signature = v8::Signature::New(isolate, class_template);
 
         // Makes prototype *property* (not object) immutable similar to class X {}; syntax;
         class_template->ReadOnlyPrototype();
@@ -31,9 +29,12 @@ namespace dragiyski::node_ext {
             std::forward_as_tuple(isolate),
             std::forward_as_tuple(isolate, class_template)
         );
+
+        Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::initialize(isolate);
     }
 
     void ObjectTemplate::IndexedPropertyHandlerConfiguration::uninitialize(v8::Isolate* isolate) {
+        Object<ObjectTemplate::IndexedPropertyHandlerConfiguration>::uninitialize(isolate);
         per_isolate_template.erase(isolate);
     }
 
@@ -150,6 +151,7 @@ namespace dragiyski::node_ext {
                 target->_descriptor.Reset(isolate, value);
             }
         }
+        target.release()->set_interface(isolate, info.This());
         info.GetReturnValue().Set(info.This());
     }
 
@@ -0,0 +1,380 @@
+#include "indexed-property-storage.hxx"
+
+#include "indexed-property-handler-configuration.hxx"
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "../../error-message.hxx"
+#include "../../js-string-table.hxx"
+#include "../../trace.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+    }
+
+    void ObjectTemplate::IndexedPropertyStorage::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "IndexedPropertyStorage");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+        auto prototype_template = class_template->PrototypeTemplate();
+        auto signature = v8::Signature::New(isolate, class_template);
+        {
+            auto name = StringTable::Get(isolate, "assign");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_assign,
+                {},
+                signature,
+                2,
+                v8::ConstructorBehavior::kThrow
+            );
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "clear");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_clear,
+                {},
+                signature,
+                1,
+                v8::ConstructorBehavior::kThrow
+            );
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        Object<ObjectTemplate::IndexedPropertyStorage>::initialize(isolate);
+    }
+
+    void ObjectTemplate::IndexedPropertyStorage::uninitialize(v8::Isolate *isolate) {
+        Object<ObjectTemplate::IndexedPropertyStorage>::uninitialize(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> ObjectTemplate::IndexedPropertyStorage::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void ObjectTemplate::IndexedPropertyStorage::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "IndexedPropertyStorage", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        auto implementation = std::unique_ptr<IndexedPropertyStorage>(new IndexedPropertyStorage());
+        implementation->_storage_symbol.Reset(isolate, v8::Private::New(isolate, StringTable::Get(isolate, "IndexedPropertyStorage")));
+
+        if (!info[0]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object, if specified.");
+            }
+            auto options = info[0].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "fallback");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsNullOrUndefined()) {
+                    if V8_UNLIKELY(!value->IsObject() || Object<IndexedPropertyHandlerConfiguration>::get_implementation(isolate, value.As<v8::Object>()) == nullptr) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"fallback\" is not an [object IndexedPropertyHandlerConfiguration]");
+                    }
+                    implementation->_fallback.Reset(isolate, value.As<v8::Object>());
+                }
+            }
+            {
+                auto name = StringTable::Get(isolate, "readonly");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                implementation->_readonly = value->BooleanValue(isolate);
+            }
+        }
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void ObjectTemplate::IndexedPropertyStorage::prototype_assign(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "IndexedPropertyStorage", ".", "prototype", ".", "assign", " called on incompatible receiver ", receiver);
+        }
+
+        if V8_UNLIKELY(info.Length() < 2) {
+            JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+        if V8_UNLIKELY(!info[1]->IsArray()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[1] to be an [object Array], got ", type_of(context, info[1]));
+        }
+
+        // Always copy: the storage must stay packed and must not be shared with the caller.
+        auto source = info[1].As<v8::Array>();
+        std::vector<v8::Local<v8::Value>> values(source->Length());
+        for (uint32_t i = 0; i < values.size(); ++i) {
+            JS_EXPRESSION_RETURN(value, source->Get(context, i));
+            values[i] = value;
+        }
+        auto storage = v8::Array::New(isolate, values.data(), values.size());
+        JS_EXPRESSION_IGNORE(implementation->set_storage(context, info[0].As<v8::Object>(), storage));
+    }
+
+    void ObjectTemplate::IndexedPropertyStorage::prototype_clear(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "IndexedPropertyStorage", ".", "prototype", ".", "clear", " called on incompatible receiver ", receiver);
+        }
+
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+
+        JS_EXPRESSION_IGNORE(implementation->set_storage(context, info[0].As<v8::Object>(), v8::Array::New(isolate)));
+    }
+
+    ObjectTemplate::IndexedPropertyStorage *ObjectTemplate::IndexedPropertyStorage::from_data(v8::Isolate *isolate, v8::Local<v8::Value> data) {
+        // The data is the interface of the ObjectTemplate that installed the interceptors (see ObjectTemplate::Create) and the
+        // template keeps the storage alive, so the pointers are read without looking them up in the implementation sets.
+        auto js_template = static_cast<ObjectTemplate *>(data.As<v8::Object>()->GetAlignedPointerFromInternalField(0));
+        assert(Object<ObjectTemplate>::is_implementation(isolate, js_template));
+        return js_template->_index_storage_implementation;
+    }
+
+    v8::Intercepted ObjectTemplate::IndexedPropertyStorage::getter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyStorage::getter_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::IndexedPropertyStorage::getter_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder()));
+        if V8_LIKELY(storage->IsArray() && index < storage.As<v8::Array>()->Length()) {
+            JS_EXPRESSION_RETURN(value, storage.As<v8::Array>()->Get(context, index));
+            info.GetReturnValue().Set(value);
+            return v8::Intercepted::kYes;
+        }
+
+        if (!implementation->_fallback.IsEmpty()) {
+            return ObjectTemplate::IndexedPropertyGetterCallback(index, info);
+        }
+        return v8::Intercepted::kNo;
+    }
+
+    v8::Intercepted ObjectTemplate::IndexedPropertyStorage::setter_callback(uint32_t index, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyStorage::setter_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::IndexedPropertyStorage::setter_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder()));
+        uint32_t length = storage->IsArray() ? storage.As<v8::Array>()->Length() : 0;
+        if (index >= length && !implementation->_fallback.IsEmpty()) {
+            auto intercepted = ObjectTemplate::IndexedPropertySetterCallback(index, value, info);
+            if (intercepted == v8::Intercepted::kYes) {
+                return intercepted;
+            }
+        }
+        // Only overwriting or appending keeps the storage dense.
+        if (index > length) {
+            return v8::Intercepted::kNo;
+        }
+
+        if (implementation->_readonly) {
+            if (index == length) {
+                return v8::Intercepted::kNo;
+            }
+            if (info.ShouldThrowOnError()) {
+                JS_THROW_ERROR(TypeError, isolate, "Cannot assign to read only property '", index, "' of object");
+            }
+            return v8::Intercepted::kYes;
+        }
+
+        if (!storage->IsArray()) {
+            auto created = v8::Array::New(isolate);
+            JS_EXPRESSION_IGNORE(implementation->set_storage(context, info.Holder(), created));
+            storage = created;
+        }
+        JS_EXPRESSION_IGNORE(storage.As<v8::Array>()->Set(context, index, value));
+        return v8::Intercepted::kYes;
+    }
+
+    v8::Intercepted ObjectTemplate::IndexedPropertyStorage::query_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyStorage::query_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::IndexedPropertyStorage::query_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder()));
+        if (storage->IsArray() && index < storage.As<v8::Array>()->Length()) {
+            int32_t attributes = v8::PropertyAttribute::DontDelete;
+            if (implementation->_readonly) {
+                attributes |= v8::PropertyAttribute::ReadOnly;
+            }
+            info.GetReturnValue().Set(v8::Integer::New(isolate, attributes));
+            return v8::Intercepted::kYes;
+        }
+
+        if (!implementation->_fallback.IsEmpty()) {
+            return ObjectTemplate::IndexedPropertyQueryCallback(index, info);
+        }
+        return v8::Intercepted::kNo;
+    }
+
+    v8::Intercepted ObjectTemplate::IndexedPropertyStorage::deleter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Boolean> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyStorage::deleter_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::IndexedPropertyStorage::deleter_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder()));
+        if (storage->IsArray() && index < storage.As<v8::Array>()->Length()) {
+            info.GetReturnValue().Set(false);
+            if (info.ShouldThrowOnError()) {
+                JS_THROW_ERROR(TypeError, isolate, "Cannot delete property '", index, "' of object");
+            }
+            return v8::Intercepted::kYes;
+        }
+
+        if (!implementation->_fallback.IsEmpty()) {
+            return ObjectTemplate::IndexedPropertyDeleterCallback(index, info);
+        }
+        return v8::Intercepted::kNo;
+    }
+
+    void ObjectTemplate::IndexedPropertyStorage::enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::IndexedPropertyStorage::enumerator_callback");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::IndexedPropertyStorage::enumerator_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder()));
+        v8::Local<v8::Array> fallback_indices;
+        if (!implementation->_fallback.IsEmpty()) {
+            v8::TryCatch try_catch(isolate);
+            ObjectTemplate::IndexedPropertyEnumeratorCallback(info);
+            if (try_catch.HasCaught()) {
+                try_catch.ReThrow();
+                return;
+            }
+            auto value = info.GetReturnValue().Get();
+            if (value->IsArray()) {
+                fallback_indices = value.As<v8::Array>();
+            }
+        }
+        uint32_t length = storage->IsArray() ? storage.As<v8::Array>()->Length() : 0;
+        if (length == 0) {
+            return;
+        }
+
+        std::vector<v8::Local<v8::Value>> indices;
+        indices.reserve(length + (fallback_indices.IsEmpty() ? 0 : fallback_indices->Length()));
+        for (uint32_t i = 0; i < length; ++i) {
+            indices.push_back(v8::Integer::NewFromUnsigned(isolate, i));
+        }
+        if (!fallback_indices.IsEmpty()) {
+            for (uint32_t i = 0; i < fallback_indices->Length(); ++i) {
+                JS_EXPRESSION_RETURN(index, fallback_indices->Get(context, i));
+                if (index->IsUint32() && index.As<v8::Uint32>()->Value() >= length) {
+                    indices.push_back(index);
+                }
+            }
+        }
+        info.GetReturnValue().Set(v8::Array::New(isolate, indices.data(), indices.size()));
+    }
+
+    v8::MaybeLocal<v8::Value> ObjectTemplate::IndexedPropertyStorage::get_storage(v8::Local<v8::Context> context, v8::Local<v8::Object> target) {
+        auto isolate = context->GetIsolate();
+        return target->GetPrivate(context, _storage_symbol.Get(isolate));
+    }
+
+    v8::Maybe<void> ObjectTemplate::IndexedPropertyStorage::set_storage(v8::Local<v8::Context> context, v8::Local<v8::Object> target, v8::Local<v8::Array> storage) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_IGNORE(target->SetPrivate(context, _storage_symbol.Get(isolate), storage));
+        return v8::JustVoid();
+    }
+
+    v8::Local<v8::Object> ObjectTemplate::IndexedPropertyStorage::get_fallback(v8::Isolate *isolate) const {
+        return _fallback.Get(isolate);
+    }
+
+    v8::PropertyHandlerFlags ObjectTemplate::IndexedPropertyStorage::get_flags(v8::Isolate *isolate) const {
+        // Without fallback the getter, query and enumerator only read the storage.
+        if (_fallback.IsEmpty()) {
+            return v8::PropertyHandlerFlags::kHasNoSideEffect;
+        }
+        auto fallback = Object<IndexedPropertyHandlerConfiguration>::get_implementation(isolate, _fallback.Get(isolate));
+        assert(fallback != nullptr);
+        return static_cast<v8::PropertyHandlerFlags>(static_cast<unsigned int>(fallback->get_flags()) & static_cast<unsigned int>(v8::PropertyHandlerFlags::kHasNoSideEffect));
+    }
+
+    bool ObjectTemplate::IndexedPropertyStorage::is_readonly() const {
+        return _readonly;
+    }
+}
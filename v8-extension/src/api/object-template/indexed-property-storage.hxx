@@ -0,0 +1,63 @@
+#ifndef NODE_EXT_API_OBJECT_TEMPLATE_INDEXED_PROPERTY_STORAGE_HXX
+#define NODE_EXT_API_OBJECT_TEMPLATE_INDEXED_PROPERTY_STORAGE_HXX
+
+#include <v8.h>
+#include "../object-template.hxx"
+#include "../../js-helper.hxx"
+#include "../../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Indexed property handler served from a native dense vector owned by each object created from the template.
+     *
+     * The storage is a packed array held in a private of the holder. Indices [0, length) are served by the interceptors without
+     * calling JavaScript; writing at index length appends. Other indices go to the fallback
+     * [object IndexedPropertyHandlerConfiguration], if specified. The stored elements cannot be deleted one by one, the
+     * embedder replaces the storage in bulk through assign(object, values) and clear(object).
+     *
+     * The vector is a v8::Array for the same reason as in NamedPropertyStorage: the garbage collector must trace the values.
+     *
+     * Options (all optional):
+     * fallback - [object IndexedPropertyHandlerConfiguration] invoked for indices outside of the storage;
+     * readonly - the interceptors do not modify the storage (only the bulk API does).
+     */
+    class ObjectTemplate::IndexedPropertyStorage : public Object<ObjectTemplate::IndexedPropertyStorage> {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_assign(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_clear(const v8::FunctionCallbackInfo<v8::Value> &info);
+    public:
+        static v8::Intercepted getter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static v8::Intercepted setter_callback(uint32_t index, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted query_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Integer> &info);
+        static v8::Intercepted deleter_callback(uint32_t index, const v8::PropertyCallbackInfo<v8::Boolean> &info);
+        static void enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info);
+    private:
+        static IndexedPropertyStorage *from_data(v8::Isolate *isolate, v8::Local<v8::Value> data);
+    private:
+        Shared<v8::Private> _storage_symbol;
+        Shared<v8::Object> _fallback;
+        bool _readonly = false;
+    public:
+        v8::MaybeLocal<v8::Value> get_storage(v8::Local<v8::Context> context, v8::Local<v8::Object> target);
+        v8::Maybe<void> set_storage(v8::Local<v8::Context> context, v8::Local<v8::Object> target, v8::Local<v8::Array> storage);
+        v8::Local<v8::Object> get_fallback(v8::Isolate *isolate) const;
+        v8::PropertyHandlerFlags get_flags(v8::Isolate *isolate) const;
+        bool is_readonly() const;
+    protected:
+        IndexedPropertyStorage() = default;
+        IndexedPropertyStorage(const IndexedPropertyStorage &) = delete;
+        IndexedPropertyStorage(IndexedPropertyStorage &&) = delete;
+    public:
+        virtual ~IndexedPropertyStorage() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_OBJECT_TEMPLATE_INDEXED_PROPERTY_STORAGE_HXX */
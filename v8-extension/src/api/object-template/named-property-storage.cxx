@@ -0,0 +1,474 @@
+#include "named-property-storage.hxx"
+
+#include "named-property-handler-configuration.hxx"
+
+#include <cassert>
+#include <map>
+#include <memory>
+
+#include "../../error-message.hxx"
+#include "../../js-string-table.hxx"
+#include "../../trace.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+
+        v8::Maybe<void> storage_set(v8::Local<v8::Context> context, v8::Local<v8::Map> storage, v8::Local<v8::Value> key, v8::Local<v8::Value> value) {
+            static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+            if V8_UNLIKELY(!key->IsString()) {
+                JS_EXPRESSION_RETURN(key_string, key->ToString(context));
+                key = key_string;
+            }
+            JS_EXPRESSION_IGNORE(storage->Set(context, key, value));
+            return v8::JustVoid();
+        }
+    }
+
+    void ObjectTemplate::NamedPropertyStorage::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "NamedPropertyStorage");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+        auto prototype_template = class_template->PrototypeTemplate();
+        auto signature = v8::Signature::New(isolate, class_template);
+        {
+            auto name = StringTable::Get(isolate, "assign");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_assign,
+                {},
+                signature,
+                2,
+                v8::ConstructorBehavior::kThrow
+            );
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "remove");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_remove,
+                {},
+                signature,
+                2,
+                v8::ConstructorBehavior::kThrow
+            );
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "clear");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_clear,
+                {},
+                signature,
+                1,
+                v8::ConstructorBehavior::kThrow
+            );
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        Object<ObjectTemplate::NamedPropertyStorage>::initialize(isolate);
+    }
+
+    void ObjectTemplate::NamedPropertyStorage::uninitialize(v8::Isolate *isolate) {
+        Object<ObjectTemplate::NamedPropertyStorage>::uninitialize(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> ObjectTemplate::NamedPropertyStorage::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void ObjectTemplate::NamedPropertyStorage::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "NamedPropertyStorage", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        auto implementation = std::unique_ptr<NamedPropertyStorage>(new NamedPropertyStorage());
+        implementation->_storage_symbol.Reset(isolate, v8::Private::New(isolate, StringTable::Get(isolate, "NamedPropertyStorage")));
+
+        if (!info[0]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object, if specified.");
+            }
+            auto options = info[0].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "fallback");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsNullOrUndefined()) {
+                    if V8_UNLIKELY(!value->IsObject() || Object<NamedPropertyHandlerConfiguration>::get_implementation(isolate, value.As<v8::Object>()) == nullptr) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"fallback\" is not an [object NamedPropertyHandlerConfiguration]");
+                    }
+                    implementation->_fallback.Reset(isolate, value.As<v8::Object>());
+                }
+            }
+            {
+                auto name = StringTable::Get(isolate, "readonly");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                implementation->_readonly = value->BooleanValue(isolate);
+            }
+        }
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void ObjectTemplate::NamedPropertyStorage::prototype_assign(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "NamedPropertyStorage", ".", "prototype", ".", "assign", " called on incompatible receiver ", receiver);
+        }
+
+        if V8_UNLIKELY(info.Length() < 2) {
+            JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+        if V8_UNLIKELY(!info[1]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[1] to be an [object], got ", type_of(context, info[1]));
+        }
+
+        JS_EXPRESSION_RETURN(value, implementation->get_storage(context, info[0].As<v8::Object>(), true));
+        auto storage = value.As<v8::Map>();
+        if (info[1]->IsMap()) {
+            auto entries = info[1].As<v8::Map>()->AsArray();
+            for (uint32_t i = 0; i + 1 < entries->Length(); i += 2) {
+                JS_EXPRESSION_RETURN(entry_key, entries->Get(context, i));
+                JS_EXPRESSION_RETURN(entry_value, entries->Get(context, i + 1));
+                JS_EXPRESSION_IGNORE(storage_set(context, storage, entry_key, entry_value));
+            }
+            return;
+        }
+        auto source = info[1].As<v8::Object>();
+        JS_EXPRESSION_RETURN(keys, source->GetOwnPropertyNames(
+            context,
+            static_cast<v8::PropertyFilter>(v8::PropertyFilter::ONLY_ENUMERABLE | v8::PropertyFilter::SKIP_SYMBOLS),
+            v8::KeyConversionMode::kConvertToString
+        ));
+        for (uint32_t i = 0; i < keys->Length(); ++i) {
+            JS_EXPRESSION_RETURN(entry_key, keys->Get(context, i));
+            JS_EXPRESSION_RETURN(entry_value, source->Get(context, entry_key));
+            JS_EXPRESSION_IGNORE(storage_set(context, storage, entry_key, entry_value));
+        }
+    }
+
+    void ObjectTemplate::NamedPropertyStorage::prototype_remove(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "NamedPropertyStorage", ".", "prototype", ".", "remove", " called on incompatible receiver ", receiver);
+        }
+
+        if V8_UNLIKELY(info.Length() < 2) {
+            JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+        if V8_UNLIKELY(!info[1]->IsArray()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[1] to be an [object Array], got ", type_of(context, info[1]));
+        }
+
+        JS_EXPRESSION_RETURN(value, implementation->get_storage(context, info[0].As<v8::Object>(), false));
+        if (!value->IsMap()) {
+            return;
+        }
+        auto storage = value.As<v8::Map>();
+        auto names = info[1].As<v8::Array>();
+        for (uint32_t i = 0; i < names->Length(); ++i) {
+            JS_EXPRESSION_RETURN(name, names->Get(context, i));
+            JS_EXPRESSION_RETURN(name_string, name->ToString(context));
+            JS_EXPRESSION_IGNORE(storage->Delete(context, name_string));
+        }
+    }
+
+    void ObjectTemplate::NamedPropertyStorage::prototype_clear(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "NamedPropertyStorage", ".", "prototype", ".", "clear", " called on incompatible receiver ", receiver);
+        }
+
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+
+        JS_EXPRESSION_RETURN(value, implementation->get_storage(context, info[0].As<v8::Object>(), false));
+        if (value->IsMap()) {
+            value.As<v8::Map>()->Clear();
+        }
+    }
+
+    ObjectTemplate::NamedPropertyStorage *ObjectTemplate::NamedPropertyStorage::from_data(v8::Isolate *isolate, v8::Local<v8::Value> data) {
+        // The data is the interface of the ObjectTemplate that installed the interceptors (see ObjectTemplate::Create) and the
+        // template keeps the storage alive, so the pointers are read without looking them up in the implementation sets.
+        auto js_template = static_cast<ObjectTemplate *>(data.As<v8::Object>()->GetAlignedPointerFromInternalField(0));
+        assert(Object<ObjectTemplate>::is_implementation(isolate, js_template));
+        return js_template->_name_storage_implementation;
+    }
+
+    v8::Intercepted ObjectTemplate::NamedPropertyStorage::getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyStorage::getter_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyStorage::getter_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder(), false));
+        if V8_LIKELY(storage->IsMap()) {
+            JS_EXPRESSION_RETURN(value, storage.As<v8::Map>()->Get(context, property));
+            bool found = !value->IsUndefined();
+            if V8_UNLIKELY(!found) {
+                JS_EXPRESSION_RETURN(has, storage.As<v8::Map>()->Has(context, property));
+                found = has;
+            }
+            if (found) {
+                info.GetReturnValue().Set(value);
+                return v8::Intercepted::kYes;
+            }
+        }
+
+        if (!implementation->_fallback.IsEmpty()) {
+            return ObjectTemplate::NamedPropertyGetterCallback(property, info);
+        }
+        return v8::Intercepted::kNo;
+    }
+
+    v8::Intercepted ObjectTemplate::NamedPropertyStorage::setter_callback(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyStorage::setter_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyStorage::setter_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder(), false));
+        bool found = false;
+        if (storage->IsMap()) {
+            JS_EXPRESSION_RETURN(has, storage.As<v8::Map>()->Has(context, property));
+            found = has;
+        }
+
+        if (!found && !implementation->_fallback.IsEmpty()) {
+            auto intercepted = ObjectTemplate::NamedPropertySetterCallback(property, value, info);
+            if (intercepted == v8::Intercepted::kYes) {
+                return intercepted;
+            }
+        }
+
+        if (implementation->_readonly) {
+            if (!found) {
+                return v8::Intercepted::kNo;
+            }
+            if (info.ShouldThrowOnError()) {
+                JS_THROW_ERROR(TypeError, context, "Cannot assign to read only property '", property, "' of object");
+            }
+            return v8::Intercepted::kYes;
+        }
+
+        if (!storage->IsMap()) {
+            JS_EXPRESSION_RETURN(created, implementation->get_storage(context, info.Holder(), true));
+            storage = created;
+        }
+        JS_EXPRESSION_IGNORE(storage.As<v8::Map>()->Set(context, property, value));
+        return v8::Intercepted::kYes;
+    }
+
+    v8::Intercepted ObjectTemplate::NamedPropertyStorage::query_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyStorage::query_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyStorage::query_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder(), false));
+        if (storage->IsMap()) {
+            JS_EXPRESSION_RETURN(has, storage.As<v8::Map>()->Has(context, property));
+            if (has) {
+                int32_t attributes = v8::PropertyAttribute::None;
+                if (implementation->_readonly) {
+                    attributes = v8::PropertyAttribute::ReadOnly | v8::PropertyAttribute::DontDelete;
+                }
+                info.GetReturnValue().Set(v8::Integer::New(isolate, attributes));
+                return v8::Intercepted::kYes;
+            }
+        }
+
+        if (!implementation->_fallback.IsEmpty()) {
+            return ObjectTemplate::NamedPropertyQueryCallback(property, info);
+        }
+        return v8::Intercepted::kNo;
+    }
+
+    v8::Intercepted ObjectTemplate::NamedPropertyStorage::deleter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyStorage::deleter_callback");
+        static const constexpr auto __function_return_type__ = []() { return v8::Intercepted::kYes; };
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyStorage::deleter_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder(), false));
+        if (storage->IsMap()) {
+            JS_EXPRESSION_RETURN(has, storage.As<v8::Map>()->Has(context, property));
+            if (has) {
+                if (implementation->_readonly) {
+                    info.GetReturnValue().Set(false);
+                    if (info.ShouldThrowOnError()) {
+                        JS_THROW_ERROR(TypeError, context, "Cannot delete property '", property, "' of object");
+                    }
+                } else {
+                    JS_EXPRESSION_IGNORE(storage.As<v8::Map>()->Delete(context, property));
+                    info.GetReturnValue().Set(true);
+                }
+                return v8::Intercepted::kYes;
+            }
+        }
+
+        if (!implementation->_fallback.IsEmpty()) {
+            return ObjectTemplate::NamedPropertyDeleterCallback(property, info);
+        }
+        return v8::Intercepted::kNo;
+    }
+
+    void ObjectTemplate::NamedPropertyStorage::enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info) {
+        JS_TRACE_SCOPE("object-template", "ObjectTemplate::NamedPropertyStorage::enumerator_callback");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = from_data(isolate, info.Data());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Invalid invocation: ObjectTemplate::NamedPropertyStorage::enumerator_callback");
+        }
+
+        JS_EXPRESSION_RETURN(storage, implementation->get_storage(context, info.Holder(), false));
+        v8::Local<v8::Array> fallback_names;
+        if (!implementation->_fallback.IsEmpty()) {
+            v8::TryCatch try_catch(isolate);
+            ObjectTemplate::NamedPropertyEnumeratorCallback(info);
+            if (try_catch.HasCaught()) {
+                try_catch.ReThrow();
+                return;
+            }
+            auto value = info.GetReturnValue().Get();
+            if (value->IsArray()) {
+                fallback_names = value.As<v8::Array>();
+            }
+        }
+        if (!storage->IsMap()) {
+            return;
+        }
+
+        auto entries = storage.As<v8::Map>()->AsArray();
+        uint32_t fallback_length = fallback_names.IsEmpty() ? 0 : fallback_names->Length();
+        auto names = v8::Array::New(isolate, static_cast<int>(entries->Length() / 2 + fallback_length));
+        uint32_t length = 0;
+        for (uint32_t i = 0; i < entries->Length(); i += 2) {
+            JS_EXPRESSION_RETURN(name, entries->Get(context, i));
+            JS_EXPRESSION_IGNORE(names->Set(context, length++, name));
+        }
+        for (uint32_t i = 0; i < fallback_length; ++i) {
+            JS_EXPRESSION_RETURN(name, fallback_names->Get(context, i));
+            JS_EXPRESSION_IGNORE(names->Set(context, length++, name));
+        }
+        info.GetReturnValue().Set(names);
+    }
+
+    v8::MaybeLocal<v8::Value> ObjectTemplate::NamedPropertyStorage::get_storage(v8::Local<v8::Context> context, v8::Local<v8::Object> target, bool create) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Value>;
+        auto isolate = context->GetIsolate();
+        auto symbol = _storage_symbol.Get(isolate);
+
+        JS_EXPRESSION_RETURN(value, target->GetPrivate(context, symbol));
+        if (value->IsMap() || !create) {
+            return value;
+        }
+
+        auto storage = v8::Map::New(isolate);
+        JS_EXPRESSION_IGNORE(target->SetPrivate(context, symbol, storage));
+        return storage;
+    }
+
+    v8::Local<v8::Object> ObjectTemplate::NamedPropertyStorage::get_fallback(v8::Isolate *isolate) const {
+        return _fallback.Get(isolate);
+    }
+
+    v8::PropertyHandlerFlags ObjectTemplate::NamedPropertyStorage::get_flags(v8::Isolate *isolate) const {
+        // Symbols are never stored, and without fallback the getter, query and enumerator only read the storage.
+        auto flags = static_cast<unsigned int>(v8::PropertyHandlerFlags::kOnlyInterceptStrings);
+        if (_fallback.IsEmpty()) {
+            flags |= static_cast<unsigned int>(v8::PropertyHandlerFlags::kHasNoSideEffect);
+        } else {
+            auto fallback = Object<NamedPropertyHandlerConfiguration>::get_implementation(isolate, _fallback.Get(isolate));
+            assert(fallback != nullptr);
+            flags |= static_cast<unsigned int>(fallback->get_flags()) & static_cast<unsigned int>(v8::PropertyHandlerFlags::kHasNoSideEffect);
+        }
+        return static_cast<v8::PropertyHandlerFlags>(flags);
+    }
+
+    bool ObjectTemplate::NamedPropertyStorage::is_readonly() const {
+        return _readonly;
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef NODE_EXT_API_OBJECT_TEMPLATE_NAMED_PROPERTY_STORAGE_HXX
+#define NODE_EXT_API_OBJECT_TEMPLATE_NAMED_PROPERTY_STORAGE_HXX
+
+#include <v8.h>
+#include "../object-template.hxx"
+#include "../../js-helper.hxx"
+#include "../../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Named property handler served from a native string-keyed storage owned by each object created from the template.
+     *
+     * The storage is a map held in a private of the holder, created on the first write. The interceptors read and write that map
+     * directly and never call JavaScript, unless the name is not in the storage and a fallback
+     * [object NamedPropertyHandlerConfiguration] is specified. The embedder mutates the storage in bulk through
+     * assign(object, entries), remove(object, names) and clear(object).
+     *
+     * The map is a v8::Map rather than a C++ container: a stored value can reference its holder, and the garbage collector
+     * traces such a cycle only through heap objects. Persistent handles in a native map would be roots keeping every holder
+     * (and everything it references) alive.
+     *
+     * Options (all optional):
+     * fallback - [object NamedPropertyHandlerConfiguration] invoked for names not in the storage;
+     * readonly - the interceptors do not modify the storage (only the bulk API does).
+     */
+    class ObjectTemplate::NamedPropertyStorage : public Object<ObjectTemplate::NamedPropertyStorage> {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_assign(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_remove(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_clear(const v8::FunctionCallbackInfo<v8::Value> &info);
+    public:
+        static v8::Intercepted getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static v8::Intercepted setter_callback(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
+        static v8::Intercepted query_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer> &info);
+        static v8::Intercepted deleter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean> &info);
+        static void enumerator_callback(const v8::PropertyCallbackInfo<v8::Array> &info);
+    private:
+        static NamedPropertyStorage *from_data(v8::Isolate *isolate, v8::Local<v8::Value> data);
+    private:
+        Shared<v8::Private> _storage_symbol;
+        Shared<v8::Object> _fallback;
+        bool _readonly = false;
+    public:
+        v8::MaybeLocal<v8::Value> get_storage(v8::Local<v8::Context> context, v8::Local<v8::Object> target, bool create);
+        v8::Local<v8::Object> get_fallback(v8::Isolate *isolate) const;
+        v8::PropertyHandlerFlags get_flags(v8::Isolate *isolate) const;
+        bool is_readonly() const;
+    protected:
+        NamedPropertyStorage() = default;
+        NamedPropertyStorage(const NamedPropertyStorage &) = delete;
+        NamedPropertyStorage(NamedPropertyStorage &&) = delete;
+    public:
+        virtual ~NamedPropertyStorage() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_OBJECT_TEMPLATE_NAMED_PROPERTY_STORAGE_HXX */
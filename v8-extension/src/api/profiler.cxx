@@ -0,0 +1,419 @@
+#include "profiler.hxx"
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+#include "context.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+
+        // Just(false) if the option is specified, but not a positive number.
+        v8::Maybe<bool> read_positive_option(v8::Local<v8::Context> context, v8::Local<v8::Object> options, v8::Local<v8::String> name, double &value) {
+            static const constexpr auto __function_return_type__ = v8::Nothing<bool>;
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if (js_value->IsUndefined()) {
+                return v8::Just(true);
+            }
+            if (!js_value->IsNumber() || !(js_value.As<v8::Number>()->Value() > 0)) {
+                return v8::Just(false);
+            }
+            value = js_value.As<v8::Number>()->Value();
+            return v8::Just(true);
+        }
+    }
+
+    void Profiler::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "Profiler");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "start");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_start, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "stop");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_stop, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "clear");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_clear, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "collapse");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_collapse, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "running");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_running, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "samples");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_samples, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        Object<Profiler>::initialize(isolate);
+    }
+
+    void Profiler::uninitialize(v8::Isolate *isolate) {
+        Object<Profiler>::uninitialize(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> Profiler::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void Profiler::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "Profiler", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        double interval = 1, capacity = 65536, depth = 64;
+        if (!info[0]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object, if specified.");
+            }
+            auto options = info[0].As<v8::Object>();
+            {
+                JS_EXPRESSION_RETURN(valid, read_positive_option(context, options, StringTable::Get(isolate, "interval"), interval));
+                if V8_UNLIKELY(!valid) {
+                    JS_THROW_ERROR(RangeError, isolate, "Option \"interval\": expected a positive number of milliseconds.");
+                }
+            }
+            {
+                JS_EXPRESSION_RETURN(valid, read_positive_option(context, options, StringTable::Get(isolate, "capacity"), capacity));
+                if V8_UNLIKELY(!valid || capacity > 0x10000000) {
+                    JS_THROW_ERROR(RangeError, isolate, "Option \"capacity\": expected a positive number of samples.");
+                }
+            }
+            {
+                JS_EXPRESSION_RETURN(valid, read_positive_option(context, options, StringTable::Get(isolate, "depth"), depth));
+                if V8_UNLIKELY(!valid || depth > 1024) {
+                    JS_THROW_ERROR(RangeError, isolate, "Option \"depth\": expected a positive number of frames up to 1024.");
+                }
+            }
+        }
+
+        auto implementation = std::unique_ptr<Profiler>(new Profiler());
+        implementation->_state = std::make_shared<State>();
+        implementation->_state->isolate = isolate;
+        implementation->_state->interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(interval));
+        implementation->_state->depth = static_cast<int>(depth);
+        implementation->_state->ring.resize(static_cast<std::size_t>(capacity));
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void Profiler::prototype_start(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Profiler", ".", "prototype", ".", "start", " called on incompatible receiver ", receiver);
+        }
+        implementation->start();
+    }
+
+    void Profiler::prototype_stop(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Profiler", ".", "prototype", ".", "stop", " called on incompatible receiver ", receiver);
+        }
+        implementation->stop();
+    }
+
+    void Profiler::prototype_clear(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Profiler", ".", "prototype", ".", "clear", " called on incompatible receiver ", receiver);
+        }
+        auto &state = *implementation->_state;
+        state.ring_head = 0;
+        state.ring_size = 0;
+        state.contexts.clear();
+        state.stacks.clear();
+        state.stack_ids.clear();
+    }
+
+    void Profiler::prototype_collapse(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Profiler", ".", "prototype", ".", "collapse", " called on incompatible receiver ", receiver);
+        }
+        auto &state = *implementation->_state;
+
+        // Only the samples of this context, if a Context is specified.
+        std::optional<uint32_t> filter;
+        if (!info[0]->IsNullOrUndefined()) {
+            auto wrapper = info[0]->IsObject() ? Context::get_implementation(isolate, info[0].As<v8::Object>()) : nullptr;
+            if V8_UNLIKELY(wrapper == nullptr) {
+                JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be a Context, if specified, got ", type_of(context, info[0]));
+            }
+            auto target_context = wrapper->get_value(isolate);
+            filter = static_cast<uint32_t>(state.contexts.size());
+            for (std::size_t i = 0; i < state.contexts.size(); ++i) {
+                if (state.contexts[i] == target_context) {
+                    filter = static_cast<uint32_t>(i);
+                    break;
+                }
+            }
+        }
+
+        // context index -> stack id -> count
+        std::map<uint32_t, std::map<uint32_t, uint64_t>> counts;
+        auto capacity = state.ring.size();
+        for (std::size_t i = 0; i < state.ring_size; ++i) {
+            auto &sample = state.ring[(state.ring_head + capacity - state.ring_size + i) % capacity];
+            if (!filter.has_value() || sample.context == filter.value()) {
+                ++counts[sample.context][sample.stack];
+            }
+        }
+
+        auto collapse = [&](const std::map<uint32_t, uint64_t> &stacks) -> v8::MaybeLocal<v8::String> {
+            std::string text;
+            for (auto &[stack, count] : stacks) {
+                text += state.stacks[stack];
+                text += ' ';
+                text += std::to_string(count);
+                text += '\n';
+            }
+            return v8::String::NewFromUtf8(isolate, text.data(), v8::NewStringType::kNormal, static_cast<int>(text.size()));
+        };
+
+        if (filter.has_value()) {
+            static const std::map<uint32_t, uint64_t> empty;
+            auto entry = counts.find(filter.value());
+            JS_EXPRESSION_RETURN(text, collapse(entry != counts.end() ? entry->second : empty));
+            info.GetReturnValue().Set(text);
+            return;
+        }
+
+        auto result = v8::Map::New(isolate);
+        for (auto &[index, stacks] : counts) {
+            auto target_context = state.contexts[index].Get(isolate);
+            if (target_context.IsEmpty()) {
+                // The context was collected since it was sampled.
+                continue;
+            }
+            JS_EXPRESSION_RETURN(holder, Context::get_context_holder(context, target_context));
+            JS_EXPRESSION_RETURN(text, collapse(stacks));
+            JS_EXPRESSION_IGNORE(result->Set(context, holder, text));
+        }
+        info.GetReturnValue().Set(result);
+    }
+
+    void Profiler::prototype_get_running(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Profiler", ".", "prototype", ".", "running", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(implementation->_sampler.joinable());
+    }
+
+    void Profiler::prototype_get_samples(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Profiler", ".", "prototype", ".", "samples", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(static_cast<double>(implementation->_state->ring_size));
+    }
+
+    void Profiler::start() {
+        if (_sampler.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard lock(_state->mutex);
+            _state->running = true;
+        }
+        _sampler = std::thread(sampler, _state);
+    }
+
+    void Profiler::stop() {
+        if (!_sampler.joinable()) {
+            return;
+        }
+        {
+            std::lock_guard lock(_state->mutex);
+            _state->running = false;
+        }
+        _state->condition.notify_one();
+        _sampler.join();
+    }
+
+    void Profiler::sampler(std::shared_ptr<State> state) {
+        std::unique_lock lock(state->mutex);
+        auto next = std::chrono::steady_clock::now() + state->interval;
+        while (state->running) {
+            if (state->condition.wait_until(lock, next, [&state]() { return !state->running; })) {
+                break;
+            }
+            next += state->interval;
+            // Do not queue interrupts while the previous one has not run yet (e.g. while the isolate is idle).
+            if (!state->pending.exchange(true, std::memory_order_acq_rel)) {
+                state->isolate->RequestInterrupt(on_interrupt, new std::shared_ptr<State>(state));
+            }
+        }
+    }
+
+    void Profiler::on_interrupt(v8::Isolate *isolate, void *data) {
+        auto state = std::unique_ptr<std::shared_ptr<State>>(static_cast<std::shared_ptr<State> *>(data));
+        (*state)->pending.store(false, std::memory_order_release);
+        bool running;
+        {
+            std::lock_guard lock((*state)->mutex);
+            running = (*state)->running;
+        }
+        if (running) {
+            sample(isolate, **state);
+        }
+    }
+
+    void Profiler::sample(v8::Isolate *isolate, State &state) {
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetEnteredOrMicrotaskContext();
+        if (context.IsEmpty()) {
+            return;
+        }
+        auto stack_trace = v8::StackTrace::CurrentStackTrace(isolate, state.depth, v8::StackTrace::kOverview);
+        auto frame_count = stack_trace->GetFrameCount();
+        if (frame_count <= 0) {
+            return;
+        }
+
+        uint32_t context_index = static_cast<uint32_t>(state.contexts.size());
+        for (std::size_t i = 0; i < state.contexts.size(); ++i) {
+            if (state.contexts[i] == context) {
+                context_index = static_cast<uint32_t>(i);
+                break;
+            }
+        }
+        if (context_index == state.contexts.size()) {
+            state.contexts.emplace_back(isolate, context);
+            // Profiling must not keep tenant contexts alive.
+            state.contexts.back().SetWeak();
+        }
+
+        // Stacks are interned by the position of their frames; the text is built only for a new stack.
+        std::string key;
+        key.reserve(static_cast<std::size_t>(frame_count) * 3 * sizeof(int));
+        for (int i = 0; i < frame_count; ++i) {
+            auto frame = stack_trace->GetFrame(isolate, i);
+            int position[] = { frame->GetScriptId(), frame->GetLineNumber(), frame->GetColumn() };
+            key.append(reinterpret_cast<const char *>(position), sizeof(position));
+        }
+        auto [entry, inserted] = state.stack_ids.try_emplace(std::move(key), static_cast<uint32_t>(state.stacks.size()));
+        if (inserted) {
+            // Root frame first, as in the collapsed-stack format.
+            std::string stack;
+            for (int i = frame_count - 1; i >= 0; --i) {
+                auto frame = stack_trace->GetFrame(isolate, i);
+                auto function_name = frame->GetFunctionName();
+                auto script_name = frame->GetScriptName();
+                if (!function_name.IsEmpty() && function_name->Length() > 0) {
+                    v8::String::Utf8Value name(isolate, function_name);
+                    stack.append(*name, name.length());
+                } else {
+                    stack += "(anonymous)";
+                }
+                stack += " (";
+                if (!script_name.IsEmpty() && script_name->Length() > 0) {
+                    v8::String::Utf8Value name(isolate, script_name);
+                    stack.append(*name, name.length());
+                } else {
+                    stack += "(unknown)";
+                }
+                stack += ':';
+                stack += std::to_string(frame->GetLineNumber());
+                stack += ')';
+                if (i > 0) {
+                    stack += ';';
+                }
+            }
+            state.stacks.push_back(std::move(stack));
+        }
+
+        state.ring[state.ring_head] = { context_index, entry->second };
+        state.ring_head = (state.ring_head + 1) % state.ring.size();
+        if (state.ring_size < state.ring.size()) {
+            ++state.ring_size;
+        }
+    }
+
+    Profiler::~Profiler() {
+        if (_state) {
+            stop();
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef NODE_EXT_API_PROFILER_HXX
+#define NODE_EXT_API_PROFILER_HXX
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Sampling profiler attributing JavaScript stacks to the entered context.
+     *
+     * While started, a sampler thread calls v8::Isolate::RequestInterrupt() every interval (at most one interrupt is pending at a
+     * time, so an idle isolate is not flooded). The interrupt callback captures v8::StackTrace::CurrentStackTrace(), interns it by
+     * the positions of its frames (the folded text, root first and separated by ";", is built once per distinct stack), and
+     * writes {context, stack} into a fixed-size ring buffer; the oldest samples are overwritten. The context is
+     * GetEnteredOrMicrotaskContext(), held weakly.
+     *
+     * collapse() aggregates the ring buffer into collapsed-stack text ("frame;frame;frame count" lines), the input format of
+     * flamegraph.pl and compatible tools, either for a single Context or as a Map from Context to text. When stopped, there is no
+     * thread and no interrupt, so the cost is zero.
+     *
+     * Options (all optional):
+     * interval - the sampling interval in milliseconds; by default 1;
+     * capacity - the number of samples kept in the ring buffer; by default 65536;
+     * depth - the maximum number of frames captured per sample; by default 64.
+     */
+    class Profiler : public Object<Profiler> {
+    public:
+        struct Sample {
+            uint32_t context;
+            uint32_t stack;
+        };
+        /**
+         * @brief Shared between the profiler, its sampler thread and the interrupts requested by it.
+         *
+         * All members except the synchronization ones are only accessed on the thread of the isolate.
+         */
+        struct State {
+            v8::Isolate *isolate;
+            std::chrono::steady_clock::duration interval;
+            int depth;
+            std::mutex mutex;
+            std::condition_variable condition;
+            bool running = false;
+            std::atomic<bool> pending = false;
+            std::vector<Sample> ring;
+            std::size_t ring_head = 0;
+            std::size_t ring_size = 0;
+            std::vector<Shared<v8::Context>> contexts;
+            std::vector<std::string> stacks;
+            std::unordered_map<std::string, uint32_t> stack_ids;
+        };
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_start(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_stop(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_clear(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_collapse(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_running(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_samples(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static void on_interrupt(v8::Isolate *isolate, void *data);
+        static void sampler(std::shared_ptr<State> state);
+        static void sample(v8::Isolate *isolate, State &state);
+    private:
+        std::shared_ptr<State> _state;
+        std::thread _sampler;
+    private:
+        void start();
+        void stop();
+    protected:
+        Profiler() = default;
+        Profiler(const Profiler &) = delete;
+        Profiler(Profiler &&) = delete;
+    public:
+        virtual ~Profiler() override;
+    };
+}
+
+#endif /* NODE_EXT_API_PROFILER_HXX */
@@ -0,0 +1,403 @@
+#include "scheduler.hxx"
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <node.h>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+#include "../trace.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+
+        struct InterruptData {
+            std::shared_ptr<Scheduler::Clock> clock;
+            uint64_t slice;
+        };
+    }
+
+    void Scheduler::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "Scheduler");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "run");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_run, {}, signature, 1, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "stats");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_stats, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        Object<Scheduler>::initialize(isolate);
+    }
+
+    void Scheduler::uninitialize(v8::Isolate *isolate) {
+        Object<Scheduler>::uninitialize(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> Scheduler::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void Scheduler::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "Scheduler", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        double slice = 10;
+        if (!info[0]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[0]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object, if specified.");
+            }
+            auto options = info[0].As<v8::Object>();
+            auto name = StringTable::Get(isolate, "slice");
+            JS_EXPRESSION_RETURN(value, options->Get(context, name));
+            if (!value->IsUndefined()) {
+                if V8_UNLIKELY(!value->IsNumber() || !(value.As<v8::Number>()->Value() > 0)) {
+                    JS_THROW_ERROR(RangeError, isolate, "Option \"slice\": expected a positive number of milliseconds.");
+                }
+                slice = value.As<v8::Number>()->Value();
+            }
+        }
+
+        auto loop = node::GetCurrentEventLoop(isolate);
+        if V8_UNLIKELY(loop == nullptr) {
+            JS_THROW_ERROR(Error, isolate, "Scheduler requires a Node.js event loop");
+        }
+
+        auto implementation = std::unique_ptr<Scheduler>(new Scheduler());
+        implementation->_isolate = isolate;
+        implementation->_context.Reset(isolate, context);
+        implementation->_slice = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(slice));
+        implementation->_clock = std::make_shared<Clock>();
+        implementation->_clock->isolate = isolate;
+        implementation->_watchdog = std::thread(watchdog, implementation->_clock);
+        implementation->_idle = new uv_idle_t();
+        uv_idle_init(loop, implementation->_idle);
+        implementation->_idle->data = implementation.get();
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void Scheduler::prototype_run(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Scheduler", ".", "prototype", ".", "run", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsFunction()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be a [function], got ", type_of(context, info[0]));
+        }
+
+        // Calling a generator function only creates the generator; its body runs within the slices.
+        auto argc = info.Length() - 1;
+        v8::Local<v8::Value> argv[argc > 0 ? argc : 1];
+        for (decltype(argc) i = 0; i < argc; ++i) {
+            argv[i] = info[i + 1];
+        }
+        JS_EXPRESSION_RETURN(generator, info[0].As<v8::Function>()->Call(context, v8::Undefined(isolate), argc, argv));
+        if V8_UNLIKELY(!generator->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to return a generator");
+        }
+        JS_EXPRESSION_RETURN(next, generator.As<v8::Object>()->Get(context, StringTable::Get(isolate, "next")));
+        if V8_UNLIKELY(!next->IsFunction()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to return a generator");
+        }
+
+        JS_EXPRESSION_RETURN(resolver, v8::Promise::Resolver::New(context));
+        auto task = std::make_unique<Task>();
+        task->id = ++implementation->_next_id;
+        task->generator.Reset(isolate, generator.As<v8::Object>());
+        task->next.Reset(isolate, next.As<v8::Function>());
+        task->resolver.Reset(isolate, resolver);
+        task->resume_value.Reset(isolate, v8::Undefined(isolate));
+        if (implementation->_tasks.empty()) {
+            implementation->_self.Reset(isolate, implementation->get_interface(isolate));
+        }
+        auto task_pointer = task.get();
+        implementation->_tasks.emplace(task->id, std::move(task));
+        implementation->schedule(task_pointer);
+
+        info.GetReturnValue().Set(resolver->GetPromise());
+    }
+
+    void Scheduler::prototype_get_stats(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Scheduler", ".", "prototype", ".", "stats", " called on incompatible receiver ", receiver);
+        }
+        v8::Local<v8::Name> names[] = {
+            StringTable::Get(isolate, "tasks"),
+            StringTable::Get(isolate, "steps"),
+            StringTable::Get(isolate, "slices"),
+            StringTable::Get(isolate, "preemptions"),
+            StringTable::Get(isolate, "interrupts")
+        };
+        v8::Local<v8::Value> values[] = {
+            v8::Number::New(isolate, static_cast<double>(implementation->_tasks.size())),
+            v8::Number::New(isolate, static_cast<double>(implementation->_steps)),
+            v8::Number::New(isolate, static_cast<double>(implementation->_slices)),
+            v8::Number::New(isolate, static_cast<double>(implementation->_preemptions)),
+            v8::Number::New(isolate, static_cast<double>(implementation->_clock->interrupts.load(std::memory_order_relaxed)))
+        };
+        info.GetReturnValue().Set(v8::Object::New(isolate, v8::Null(isolate), names, values, 5));
+    }
+
+    void Scheduler::schedule(Task *task) {
+        _run_queue.push_back(task);
+        if (!uv_is_active(reinterpret_cast<uv_handle_t *>(_idle))) {
+            uv_idle_start(_idle, on_idle);
+        }
+    }
+
+    void Scheduler::on_idle(uv_idle_t *handle) {
+        auto scheduler = static_cast<Scheduler *>(handle->data);
+        auto isolate = scheduler->_isolate;
+        v8::HandleScope scope(isolate);
+        auto context = scheduler->_context.Get(isolate);
+        v8::Context::Scope context_scope(context);
+        {
+            // Runs the microtasks (promise reactions) when the scope is left.
+            node::CallbackScope callback_scope(isolate, scheduler->get_interface(isolate), { 0, 0 });
+            // Every task runnable at the start of the turn gets at most one slice.
+            for (auto count = scheduler->_run_queue.size(); count > 0 && !scheduler->_run_queue.empty(); --count) {
+                auto task = scheduler->_run_queue.front();
+                scheduler->_run_queue.pop_front();
+                scheduler->run_slice(context, task);
+            }
+            scheduler->stop_slice();
+        }
+        if (scheduler->_run_queue.empty()) {
+            uv_idle_stop(handle);
+        }
+        if (scheduler->_tasks.empty()) {
+            scheduler->_self.Reset();
+        }
+    }
+
+    void Scheduler::run_slice(v8::Local<v8::Context> context, Task *task) {
+        JS_TRACE_SCOPE("scheduler", "Scheduler::run_slice");
+        auto isolate = context->GetIsolate();
+        v8::HandleScope scope(isolate);
+        start_slice();
+        ++_slices;
+
+        auto generator = task->generator.Get(isolate);
+        auto next = task->next.Get(isolate);
+        while (true) {
+            v8::HandleScope step_scope(isolate);
+            v8::TryCatch try_catch(isolate);
+            ++_steps;
+            v8::Local<v8::Value> result;
+            {
+                v8::Local<v8::Value> argv[] = { task->resume_value.Get(isolate) };
+                v8::Local<v8::Value> method = next;
+                if (
+                    (task->resume_throw && !generator->Get(context, StringTable::Get(isolate, "throw")).ToLocal(&method)) ||
+                    !object_or_function_call(context, method, generator, 1, argv).ToLocal(&result)
+                ) {
+                    if (!try_catch.CanContinue()) {
+                        try_catch.ReThrow();
+                        return;
+                    }
+                    finish(context, task, try_catch.Exception(), false);
+                    return;
+                }
+            }
+            if V8_UNLIKELY(!result->IsObject()) {
+                finish(context, task, v8::Exception::TypeError(StringTable::Get(isolate, "Iterator result is not an object")), false);
+                return;
+            }
+            v8::Local<v8::Value> done, value;
+            if (!result.As<v8::Object>()->Get(context, StringTable::Get(isolate, "done")).ToLocal(&done) || !result.As<v8::Object>()->Get(context, StringTable::Get(isolate, "value")).ToLocal(&value)) {
+                finish(context, task, try_catch.Exception(), false);
+                return;
+            }
+            if (done->BooleanValue(isolate)) {
+                finish(context, task, value, true);
+                return;
+            }
+
+            auto is_thenable = value->IsPromise();
+            if (!is_thenable && value->IsObject()) {
+                v8::Local<v8::Value> then;
+                if (!value.As<v8::Object>()->Get(context, StringTable::Get(isolate, "then")).ToLocal(&then)) {
+                    task->resume_value.Reset(isolate, try_catch.Exception());
+                    task->resume_throw = true;
+                    continue;
+                }
+                is_thenable = then->IsFunction();
+            }
+            if (is_thenable) {
+                // The task leaves the run queue until the value settles; on_settled() schedules it again.
+                auto interface = get_interface(isolate);
+                auto id = v8::Number::New(isolate, static_cast<double>(task->id));
+                v8::Local<v8::Value> fulfilled_data[] = { interface, id, v8::False(isolate) };
+                v8::Local<v8::Value> rejected_data[] = { interface, id, v8::True(isolate) };
+                v8::Local<v8::Promise::Resolver> wait_resolver;
+                v8::Local<v8::Function> on_fulfilled, on_rejected;
+                if (
+                    !v8::Promise::Resolver::New(context).ToLocal(&wait_resolver) ||
+                    wait_resolver->Resolve(context, value).IsNothing() ||
+                    !v8::Function::New(context, on_settled, v8::Array::New(isolate, fulfilled_data, 3), 1).ToLocal(&on_fulfilled) ||
+                    !v8::Function::New(context, on_settled, v8::Array::New(isolate, rejected_data, 3), 1).ToLocal(&on_rejected) ||
+                    wait_resolver->GetPromise()->Then(context, on_fulfilled, on_rejected).IsEmpty()
+                ) {
+                    finish(context, task, try_catch.Exception(), false);
+                }
+                return;
+            }
+
+            task->resume_value.Reset(isolate, value);
+            task->resume_throw = false;
+            if (_clock->expired.load(std::memory_order_relaxed)) {
+                ++_preemptions;
+                _run_queue.push_back(task);
+                return;
+            }
+        }
+    }
+
+    void Scheduler::on_settled(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto data = info.Data().As<v8::Array>();
+        v8::Local<v8::Value> interface, id, rejected;
+        if (!data->Get(context, 0).ToLocal(&interface) || !data->Get(context, 1).ToLocal(&id) || !data->Get(context, 2).ToLocal(&rejected)) {
+            return;
+        }
+        auto scheduler = get_implementation(isolate, interface.As<v8::Object>());
+        if V8_UNLIKELY(scheduler == nullptr) {
+            return;
+        }
+        auto task = scheduler->_tasks.find(static_cast<uint64_t>(id.As<v8::Number>()->Value()));
+        if V8_UNLIKELY(task == scheduler->_tasks.end()) {
+            return;
+        }
+        task->second->resume_value.Reset(isolate, info[0]);
+        task->second->resume_throw = rejected->IsTrue();
+        scheduler->schedule(task->second.get());
+    }
+
+    void Scheduler::finish(v8::Local<v8::Context> context, Task *task, v8::Local<v8::Value> value, bool fulfilled) {
+        auto isolate = context->GetIsolate();
+        auto resolver = task->resolver.Get(isolate);
+        if (value.IsEmpty()) {
+            value = v8::Undefined(isolate);
+        }
+        if (fulfilled) {
+            resolver->Resolve(context, value).Check();
+        } else {
+            resolver->Reject(context, value).Check();
+        }
+        _tasks.erase(task->id);
+    }
+
+    void Scheduler::start_slice() {
+        _clock->slice.fetch_add(1, std::memory_order_relaxed);
+        _clock->expired.store(false, std::memory_order_relaxed);
+        {
+            std::lock_guard lock(_clock->mutex);
+            _clock->deadline = std::chrono::steady_clock::now() + _slice;
+        }
+        _clock->condition.notify_one();
+    }
+
+    void Scheduler::stop_slice() {
+        std::lock_guard lock(_clock->mutex);
+        _clock->deadline.reset();
+    }
+
+    void Scheduler::on_interrupt(v8::Isolate *isolate, void *data) {
+        auto interrupt = std::unique_ptr<InterruptData>(static_cast<InterruptData *>(data));
+        // An interrupt requested for a slice that already ended must not expire the current one.
+        if (interrupt->clock->slice.load(std::memory_order_relaxed) == interrupt->slice) {
+            interrupt->clock->expired.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void Scheduler::watchdog(std::shared_ptr<Clock> clock) {
+        std::unique_lock lock(clock->mutex);
+        while (!clock->stopping) {
+            if (!clock->deadline.has_value()) {
+                clock->condition.wait(lock);
+                continue;
+            }
+            auto deadline = clock->deadline.value();
+            if (std::chrono::steady_clock::now() < deadline) {
+                clock->condition.wait_until(lock, deadline);
+                continue;
+            }
+            clock->deadline.reset();
+            clock->interrupts.fetch_add(1, std::memory_order_relaxed);
+            clock->isolate->RequestInterrupt(on_interrupt, new InterruptData { clock, clock->slice.load(std::memory_order_relaxed) });
+        }
+    }
+
+    Scheduler::~Scheduler() {
+        if (_clock) {
+            {
+                std::lock_guard lock(_clock->mutex);
+                _clock->stopping = true;
+            }
+            _clock->condition.notify_one();
+        }
+        if (_watchdog.joinable()) {
+            _watchdog.join();
+        }
+        if (_idle != nullptr) {
+            uv_idle_stop(_idle);
+            uv_close(reinterpret_cast<uv_handle_t *>(_idle), [](uv_handle_t *handle) {
+                delete reinterpret_cast<uv_idle_t *>(handle);
+            });
+        }
+    }
+}
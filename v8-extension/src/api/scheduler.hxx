@@ -0,0 +1,109 @@
+#ifndef NODE_EXT_API_SCHEDULER_HXX
+#define NODE_EXT_API_SCHEDULER_HXX
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <uv.h>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Cooperative time-sliced execution of generators, round-robin between tasks.
+     *
+     * run(generatorFunction, ...args) creates a task from the generator and returns a promise for its return value. Each yield
+     * is a scheduling point: yielding a thenable waits for it (the generator is resumed with the value or the reason is thrown
+     * into it), yielding anything else resumes the generator immediately with the same value, unless the slice of the task has
+     * expired. An expired task goes to the back of the native run queue and the next task starts a new slice.
+     *
+     * A watchdog thread sleeps until the end of the current slice and calls v8::Isolate::RequestInterrupt(); the interrupt
+     * callback only records that the slice expired, so no work is lost. A task that does not yield cannot be preempted.
+     *
+     * The run queue is processed from an uv_idle_t handle: one turn gives at most one slice to every runnable task, then returns
+     * to the event loop.
+     *
+     * Options (all optional):
+     * slice - the length of a slice in milliseconds; by default 10.
+     */
+    class Scheduler : public Object<Scheduler> {
+    public:
+        struct Task {
+            uint64_t id;
+            Shared<v8::Object> generator;
+            // The "next" method, read once when the task is created (as for-of does).
+            Shared<v8::Function> next;
+            Shared<v8::Promise::Resolver> resolver;
+            // The value to resume the generator with, and whether to throw it into the generator instead.
+            Shared<v8::Value> resume_value;
+            bool resume_throw = false;
+        };
+        /**
+         * @brief Shared between the scheduler and its watchdog thread (and the interrupts requested by it).
+         */
+        struct Clock {
+            v8::Isolate *isolate;
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::optional<std::chrono::steady_clock::time_point> deadline;
+            bool stopping = false;
+            // Written by the interrupt callback on the thread of the isolate.
+            std::atomic<uint64_t> slice = 0;
+            std::atomic<bool> expired = false;
+            std::atomic<uint64_t> interrupts = 0;
+        };
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_run(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_stats(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static void on_idle(uv_idle_t *handle);
+        static void on_settled(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void on_interrupt(v8::Isolate *isolate, void *data);
+        static void watchdog(std::shared_ptr<Clock> clock);
+    private:
+        v8::Isolate *_isolate = nullptr;
+        Shared<v8::Context> _context;
+        // Strong reference to the interface while there are unfinished tasks.
+        Shared<v8::Object> _self;
+        std::chrono::steady_clock::duration _slice;
+        std::shared_ptr<Clock> _clock;
+        std::thread _watchdog;
+        uv_idle_t *_idle = nullptr;
+        std::map<uint64_t, std::unique_ptr<Task>> _tasks;
+        std::deque<Task *> _run_queue;
+        uint64_t _next_id = 0;
+        uint64_t _slices = 0;
+        uint64_t _preemptions = 0;
+        uint64_t _steps = 0;
+    private:
+        void schedule(Task *task);
+        void run_slice(v8::Local<v8::Context> context, Task *task);
+        void finish(v8::Local<v8::Context> context, Task *task, v8::Local<v8::Value> value, bool fulfilled);
+        void start_slice();
+        void stop_slice();
+    protected:
+        Scheduler() = default;
+        Scheduler(const Scheduler &) = delete;
+        Scheduler(Scheduler &&) = delete;
+    public:
+        virtual ~Scheduler() override;
+    };
+}
+
+#endif /* NODE_EXT_API_SCHEDULER_HXX */
@@ -0,0 +1,324 @@
+#include "script.hxx"
+
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../error-message.hxx"
+#include "../function.hxx"
+#include "../js-string-table.hxx"
+#include "../trace.hxx"
+#include "context.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        struct State {
+            Shared<v8::FunctionTemplate> class_template;
+            // Started by the first run() with a timeout.
+            std::shared_ptr<Script::Watchdog> watchdog;
+            std::thread thread;
+        };
+
+        thread_local std::map<v8::Isolate *, State> per_isolate_state;
+    }
+
+    void Script::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_state.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "Script");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 1);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "run");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_run, {}, signature, 1, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "createCachedData");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_create_cached_data, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "cachedDataRejected");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_cached_data_rejected, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_state[isolate].class_template.Reset(isolate, class_template);
+
+        Object<Script>::initialize(isolate);
+    }
+
+    void Script::uninitialize(v8::Isolate *isolate) {
+        Object<Script>::uninitialize(isolate);
+        auto &state = per_isolate_state[isolate];
+        if (state.watchdog) {
+            {
+                std::lock_guard lock(state.watchdog->mutex);
+                state.watchdog->stopping = true;
+            }
+            state.watchdog->condition.notify_one();
+        }
+        if (state.thread.joinable()) {
+            state.thread.join();
+        }
+        per_isolate_state.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> Script::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_state.contains(isolate));
+        return per_isolate_state[isolate].class_template.Get(isolate);
+    }
+
+    void Script::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        JS_TRACE_SCOPE("script", "Script::constructor");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "Script", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be an object.");
+        }
+        auto options = info[0].As<v8::Object>();
+
+        // Copied: the getters of the remaining options may detach or modify the buffer before the compilation.
+        std::vector<uint8_t> cached_data;
+        bool has_cached_data = false;
+        {
+            auto name = StringTable::Get(isolate, "cachedData");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if (js_value->IsArrayBufferView()) {
+                auto view = js_value.As<v8::ArrayBufferView>();
+                cached_data.resize(view->ByteLength());
+                view->CopyContents(cached_data.data(), cached_data.size());
+                has_cached_data = true;
+            } else if (js_value->IsArrayBuffer()) {
+                auto buffer = js_value.As<v8::ArrayBuffer>();
+                cached_data.resize(buffer->ByteLength());
+                if (!cached_data.empty()) {
+                    std::memcpy(cached_data.data(), buffer->Data(), cached_data.size());
+                }
+                has_cached_data = true;
+            } else if V8_UNLIKELY(!js_value->IsNullOrUndefined()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected option 'cachedData' to be an ArrayBuffer or an ArrayBufferView, if specified.");
+            }
+        }
+
+        v8::ScriptCompiler::CachedData *cached_data_value = nullptr;
+        if (has_cached_data) {
+            // The source owns the CachedData, which does not own the buffer.
+            cached_data_value = new v8::ScriptCompiler::CachedData(cached_data.data(), static_cast<int>(cached_data.size()));
+        }
+        auto source = source_from_object(context, options, cached_data_value);
+        if (!source) {
+            if (cached_data_value != nullptr) {
+                delete cached_data_value;
+            }
+            return;
+        }
+        auto compile_options = has_cached_data ? v8::ScriptCompiler::kConsumeCodeCache : v8::ScriptCompiler::kNoCompileOptions;
+        JS_EXPRESSION_RETURN(script, v8::ScriptCompiler::CompileUnboundScript(isolate, source.get(), compile_options));
+
+        auto implementation = std::unique_ptr<Script>(new Script());
+        implementation->_script.Reset(isolate, script);
+        implementation->_has_cached_data = has_cached_data;
+        implementation->_cached_data_rejected = has_cached_data && source->GetCachedData()->rejected;
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void Script::prototype_run(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        JS_TRACE_SCOPE("script", "Script::prototype_run");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Script", ".", "prototype", ".", "run", " called on incompatible receiver ", receiver);
+        }
+
+        auto context_wrapper = info[0]->IsObject() ? Context::get_implementation(isolate, info[0].As<v8::Object>()) : nullptr;
+        if V8_UNLIKELY(context_wrapper == nullptr) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be a Context.");
+        }
+        auto target_context = context_wrapper->get_value(isolate);
+        if V8_UNLIKELY(target_context.IsEmpty()) {
+            JS_THROW_ERROR(ReferenceError, isolate, "the wrapped context is already disposed");
+        }
+
+        double timeout = 0;
+        if (!info[1]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[1]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an object, if specified.");
+            }
+            auto options = info[1].As<v8::Object>();
+            auto name = StringTable::Get(isolate, "timeout");
+            JS_EXPRESSION_RETURN(value, options->Get(context, name));
+            if (!value->IsUndefined()) {
+                if V8_UNLIKELY(!value->IsNumber() || !(value.As<v8::Number>()->Value() > 0)) {
+                    JS_THROW_ERROR(RangeError, isolate, "Option \"timeout\": expected a positive number of milliseconds.");
+                }
+                timeout = value.As<v8::Number>()->Value();
+            }
+        }
+
+        v8::Local<v8::Script> script;
+        {
+            v8::Context::Scope context_scope(target_context);
+            script = implementation->_script.Get(isolate)->BindToCurrentContext();
+        }
+        bool timed_out;
+        auto result = run(target_context, script, timeout, timed_out);
+        if (timed_out) {
+            JS_THROW_ERROR(Error, isolate, "Script execution timed out after ", timeout, "ms");
+        }
+        if (result.IsEmpty()) {
+            return;
+        }
+        info.GetReturnValue().Set(result.ToLocalChecked());
+    }
+
+    v8::MaybeLocal<v8::Value> Script::run(v8::Local<v8::Context> context, v8::Local<v8::Script> script, double timeout, bool &timed_out) {
+        auto isolate = context->GetIsolate();
+        v8::EscapableHandleScope scope(isolate);
+        timed_out = false;
+
+        std::shared_ptr<Watchdog> watchdog;
+        Watchdog::Deadline deadline;
+        decltype(Watchdog::timeline)::iterator deadline_entry;
+        if (timeout > 0) {
+            auto &state = per_isolate_state[isolate];
+            if (!state.watchdog) {
+                state.watchdog = std::make_shared<Watchdog>();
+                state.watchdog->isolate = isolate;
+                state.thread = std::thread(Script::watchdog, state.watchdog);
+            }
+            watchdog = state.watchdog;
+            auto at = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(timeout));
+            {
+                std::lock_guard lock(watchdog->mutex);
+                deadline_entry = watchdog->timeline.emplace(at, &deadline);
+            }
+            watchdog->condition.notify_one();
+        }
+
+        v8::Local<v8::Value> result;
+        v8::TryCatch try_catch(isolate);
+        {
+            v8::Context::Scope context_scope(context);
+            result = script->Run(context).FromMaybe(v8::Local<v8::Value>());
+        }
+        if (watchdog) {
+            bool expired, last = false;
+            {
+                std::lock_guard lock(watchdog->mutex);
+                expired = deadline.expired;
+                if (expired) {
+                    last = --watchdog->expired == 0;
+                } else {
+                    watchdog->timeline.erase(deadline_entry);
+                }
+            }
+            if (expired && !last) {
+                // An enclosing run has expired as well: the destructor of the v8::TryCatch re-throws the termination.
+                return {};
+            }
+            // The deadline may expire after the script has returned: the pending termination is cancelled all the same.
+            if (expired) {
+                isolate->CancelTerminateExecution();
+                try_catch.Reset();
+                timed_out = true;
+                return {};
+            }
+        }
+        if (result.IsEmpty()) {
+            if (!try_catch.HasTerminated()) {
+                try_catch.ReThrow();
+            }
+            return {};
+        }
+        return scope.Escape(result);
+    }
+
+    void Script::prototype_create_cached_data(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Script", ".", "prototype", ".", "createCachedData", " called on incompatible receiver ", receiver);
+        }
+
+        std::unique_ptr<v8::ScriptCompiler::CachedData> data(v8::ScriptCompiler::CreateCodeCache(implementation->_script.Get(isolate)));
+        auto length = data ? static_cast<std::size_t>(data->length) : 0;
+        auto buffer = v8::ArrayBuffer::New(isolate, length);
+        if (length > 0) {
+            std::memcpy(buffer->Data(), data->data, length);
+        }
+        info.GetReturnValue().Set(buffer);
+    }
+
+    void Script::prototype_get_cached_data_rejected(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "Script", ".", "prototype", ".", "cachedDataRejected", " called on incompatible receiver ", receiver);
+        }
+        if (!implementation->_has_cached_data) {
+            return;
+        }
+        info.GetReturnValue().Set(implementation->_cached_data_rejected);
+    }
+
+    void Script::watchdog(std::shared_ptr<Watchdog> watchdog) {
+        std::unique_lock lock(watchdog->mutex);
+        while (!watchdog->stopping) {
+            if (watchdog->timeline.empty()) {
+                watchdog->condition.wait(lock);
+                continue;
+            }
+            auto first = watchdog->timeline.begin();
+            if (std::chrono::steady_clock::now() < first->first) {
+                watchdog->condition.wait_until(lock, first->first);
+                continue;
+            }
+            first->second->expired = true;
+            ++watchdog->expired;
+            watchdog->timeline.erase(first);
+            watchdog->isolate->TerminateExecution();
+        }
+    }
+}
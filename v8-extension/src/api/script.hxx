@@ -0,0 +1,71 @@
+#ifndef NODE_EXT_API_SCRIPT_HXX
+#define NODE_EXT_API_SCRIPT_HXX
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief A classic script compiled once, without a context, and run in any number of contexts of the isolate.
+     *
+     * new Script({ source, location, ..., cachedData }) compiles a v8::UnboundScript from the same source options as
+     * Context.prototype.compileFunction(); "cachedData" (an ArrayBuffer or a view) is consumed instead of parsing when V8
+     * accepts it, which "cachedDataRejected" reports. createCachedData() returns the code cache of the script as an ArrayBuffer.
+     *
+     * run(context, { timeout }) binds the script to the wrapped context and runs it there. With a timeout (in milliseconds),
+     * a per-isolate watchdog thread terminates the execution once it expires and run() throws an Error in the calling context.
+     * Runs can be nested; an expired outer run keeps unwinding through the inner ones.
+     */
+    class Script : public Object<Script> {
+    public:
+        struct Watchdog {
+            struct Deadline {
+                bool expired = false;
+            };
+            v8::Isolate *isolate;
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::multimap<std::chrono::steady_clock::time_point, Deadline *> timeline;
+            // The number of expired runs that have not returned yet; termination is cancelled only by the last of them.
+            int expired = 0;
+            bool stopping = false;
+        };
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+        /**
+         * @brief Run a bound script in its context, terminated by the watchdog of the isolate once timeout (in milliseconds, if
+         * positive) expires. A timed out run returns nothing with timed_out set and no exception pending.
+         */
+        static v8::MaybeLocal<v8::Value> run(v8::Local<v8::Context> context, v8::Local<v8::Script> script, double timeout, bool &timed_out);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_run(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_create_cached_data(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_cached_data_rejected(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static void watchdog(std::shared_ptr<Watchdog> watchdog);
+    private:
+        Shared<v8::UnboundScript> _script;
+        bool _has_cached_data = false;
+        bool _cached_data_rejected = false;
+    protected:
+        Script() = default;
+        Script(const Script &) = delete;
+        Script(Script &&) = delete;
+    public:
+        virtual ~Script() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_SCRIPT_HXX */
@@ -0,0 +1,377 @@
+#include "security-scope.hxx"
+
+#include <cassert>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "../error-message.hxx"
+#include "../js-string-table.hxx"
+#include "../trace.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+    }
+
+    void SecurityScope::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "SecurityScope");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 1);
+        class_template->SetClassName(class_name);
+
+        auto signature = v8::Signature::New(isolate, class_template);
+        auto prototype_template = class_template->PrototypeTemplate();
+        {
+            auto name = StringTable::Get(isolate, "enterLock");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_enter_lock, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "leaveLock");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_leave_lock, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "enterUnlock");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_enter_unlock, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "leaveUnlock");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_leave_unlock, {}, signature, 0, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "invokeLocked");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_invoke_locked, {}, signature, 3, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "invokeUnlocked");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_invoke_unlocked, {}, signature, 3, v8::ConstructorBehavior::kThrow);
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "locked");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_locked, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "lockToken");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_lock_token, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "unlockToken");
+            auto value = v8::FunctionTemplate::New(isolate, prototype_get_unlock_token, {}, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            prototype_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        Object<SecurityScope>::initialize(isolate);
+    }
+
+    void SecurityScope::uninitialize(v8::Isolate *isolate) {
+        Object<SecurityScope>::uninitialize(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> SecurityScope::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void SecurityScope::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if V8_UNLIKELY(!info.IsConstructCall()) {
+            JS_THROW_ERROR(TypeError, isolate, "Class constructor ", "SecurityScope", " cannot be invoked without 'new'");
+        }
+
+        if (!get_template(isolate)->HasInstance(info.This())) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+        }
+
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+
+        auto implementation = std::unique_ptr<SecurityScope>(new SecurityScope());
+        {
+            JS_EXPRESSION_RETURN(target_context, info[0].As<v8::Object>()->GetCreationContext());
+            implementation->_context.Reset(isolate, target_context);
+            implementation->_unlock_token.Reset(isolate, target_context->GetSecurityToken());
+        }
+
+        v8::Local<v8::Value> lock_token;
+        if (!info[1]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[1]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an object, if specified.");
+            }
+            auto options = info[1].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "lockToken");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsUndefined()) {
+                    lock_token = value;
+                }
+            }
+            {
+                auto name = StringTable::Get(isolate, "stateError");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsNullOrUndefined()) {
+                    if V8_UNLIKELY(!value->IsFunction()) {
+                        JS_THROW_ERROR(TypeError, isolate, "Option \"stateError\": not a function.");
+                    }
+                    implementation->_state_error.Reset(isolate, value.As<v8::Object>());
+                }
+            }
+        }
+        if (lock_token.IsEmpty()) {
+            lock_token = v8::Object::New(isolate, v8::Null(isolate), nullptr, nullptr, 0);
+        }
+        implementation->_lock_token.Reset(isolate, lock_token);
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void SecurityScope::prototype_enter_lock(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "SecurityScope", ".", "prototype", ".", "enterLock", " called on incompatible receiver ", receiver);
+        }
+        implementation->enter(isolate, true);
+    }
+
+    void SecurityScope::prototype_enter_unlock(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "SecurityScope", ".", "prototype", ".", "enterUnlock", " called on incompatible receiver ", receiver);
+        }
+        implementation->enter(isolate, false);
+    }
+
+    void SecurityScope::prototype_leave_lock(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        leave_callback(info, true, "leaveLock");
+    }
+
+    void SecurityScope::prototype_leave_unlock(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        leave_callback(info, false, "leaveUnlock");
+    }
+
+    void SecurityScope::leave_callback(const v8::FunctionCallbackInfo<v8::Value> &info, bool lock, const char *method) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "SecurityScope", ".", "prototype", ".", method, " called on incompatible receiver ", receiver);
+        }
+        JS_EXPRESSION_IGNORE(implementation->leave(context, lock));
+        // The state after leaving, so the caller does not need another call to find it.
+        info.GetReturnValue().Set(implementation->is_locked());
+    }
+
+    void SecurityScope::prototype_invoke_locked(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        invoke_callback(info, true, "invokeLocked");
+    }
+
+    void SecurityScope::prototype_invoke_unlocked(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        invoke_callback(info, false, "invokeUnlocked");
+    }
+
+    void SecurityScope::invoke_callback(const v8::FunctionCallbackInfo<v8::Value> &info, bool lock, const char *method) {
+        JS_TRACE_SCOPE("security-scope", "SecurityScope::invoke_callback");
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "SecurityScope", ".", "prototype", ".", method, " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!JS_IS_CALLABLE(info[0])) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be a [function], got ", type_of(context, info[0]));
+        }
+
+        std::vector<v8::Local<v8::Value>> arguments;
+        if (!info[2]->IsNullOrUndefined()) {
+            if V8_UNLIKELY(!info[2]->IsArray()) {
+                JS_THROW_ERROR(TypeError, context, "Expected arguments[2] to be an [object Array], got ", type_of(context, info[2]));
+            }
+            auto source = info[2].As<v8::Array>();
+            arguments.reserve(source->Length());
+            // Iterate() reads packed arrays directly, without a property lookup per element.
+            // The element handle is only valid during the callback, so it is copied into a new handle.
+            JS_EXPRESSION_IGNORE(source->Iterate(context, [](uint32_t index, v8::Local<v8::Value> element, void *data) {
+                auto arguments = static_cast<std::vector<v8::Local<v8::Value>> *>(data);
+                arguments->push_back(v8::Local<v8::Value>::New(v8::Isolate::GetCurrent(), element));
+                return v8::Array::CallbackResult::kContinue;
+            }, &arguments));
+        }
+
+        JS_EXPRESSION_RETURN(return_value, implementation->invoke(context, lock, info[0], info[1], static_cast<int>(arguments.size()), arguments.data()));
+        info.GetReturnValue().Set(return_value);
+    }
+
+    void SecurityScope::prototype_get_locked(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "get ", "SecurityScope", ".", "prototype", ".", "locked", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(implementation->is_locked());
+    }
+
+    void SecurityScope::prototype_get_lock_token(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "get ", "SecurityScope", ".", "prototype", ".", "lockToken", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(implementation->get_lock_token(isolate));
+    }
+
+    void SecurityScope::prototype_get_unlock_token(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "get ", "SecurityScope", ".", "prototype", ".", "unlockToken", " called on incompatible receiver ", receiver);
+        }
+        info.GetReturnValue().Set(implementation->get_unlock_token(isolate));
+    }
+
+    bool SecurityScope::is_locked() const {
+        return !_stack.empty() && _stack.back().lock;
+    }
+
+    void SecurityScope::apply(v8::Isolate *isolate, bool lock) {
+        auto context = _context.Get(isolate);
+        context->SetSecurityToken(lock ? _lock_token.Get(isolate) : _unlock_token.Get(isolate));
+    }
+
+    void SecurityScope::enter(v8::Isolate *isolate, bool lock) {
+        if (!_stack.empty() && _stack.back().lock == lock) {
+            ++_stack.back().ref;
+            return;
+        }
+        auto was_locked = is_locked();
+        _stack.push_back({ lock, 1 });
+        if (was_locked != lock) {
+            apply(isolate, lock);
+        }
+    }
+
+    void SecurityScope::leave_unchecked(v8::Isolate *isolate) {
+        if V8_UNLIKELY(_stack.empty()) {
+            return;
+        }
+        auto lock = _stack.back().lock;
+        if (--_stack.back().ref > 0) {
+            return;
+        }
+        _stack.pop_back();
+        // When the stack is empty, the context is left unlocked.
+        auto now_locked = is_locked();
+        if (now_locked != lock) {
+            apply(isolate, now_locked);
+        }
+    }
+
+    v8::Maybe<void> SecurityScope::leave(v8::Local<v8::Context> context, bool lock) {
+        if V8_UNLIKELY(_stack.empty()) {
+            return throw_state_error(context, "Attempting to leave non-existent state");
+        }
+        if V8_UNLIKELY(_stack.back().lock != lock) {
+            return throw_state_error(context, lock ? "Attempting to leave locked state while unlocked" : "Attempting to leave unlocked state while locked");
+        }
+        leave_unchecked(context->GetIsolate());
+        return v8::JustVoid();
+    }
+
+    v8::MaybeLocal<v8::Value> SecurityScope::invoke(v8::Local<v8::Context> context, bool lock, v8::Local<v8::Value> callee, v8::Local<v8::Value> receiver, int argc, v8::Local<v8::Value> argv[]) {
+        Enter enter(context->GetIsolate(), this, lock);
+        return object_or_function_call(context, callee, receiver, argc, argv);
+    }
+
+    v8::Maybe<void> SecurityScope::throw_state_error(v8::Local<v8::Context> context, const char *message) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        auto isolate = context->GetIsolate();
+        if (_state_error.IsEmpty()) {
+            JS_THROW_ERROR(Error, isolate, message);
+        }
+        JS_EXPRESSION_RETURN(js_message, String::Create(isolate, message));
+        v8::Local<v8::Value> args[] = { js_message };
+        JS_EXPRESSION_RETURN(error, _state_error.Get(isolate).As<v8::Function>()->NewInstance(context, 1, args));
+        isolate->ThrowException(error);
+        return v8::Nothing<void>();
+    }
+
+    v8::Local<v8::Value> SecurityScope::get_lock_token(v8::Isolate *isolate) const {
+        return _lock_token.Get(isolate);
+    }
+
+    v8::Local<v8::Value> SecurityScope::get_unlock_token(v8::Isolate *isolate) const {
+        return _unlock_token.Get(isolate);
+    }
+
+    SecurityScope::Enter::Enter(v8::Isolate *isolate, SecurityScope *scope, bool lock) : _isolate(isolate), _scope(scope) {
+        _scope->enter(_isolate, lock);
+    }
+
+    SecurityScope::Enter::~Enter() {
+        _scope->leave_unchecked(_isolate);
+    }
+}
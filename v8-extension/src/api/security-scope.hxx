@@ -0,0 +1,90 @@
+#ifndef NODE_EXT_API_SECURITY_SCOPE_HXX
+#define NODE_EXT_API_SECURITY_SCOPE_HXX
+
+#include <cstdint>
+#include <vector>
+#include <v8.h>
+#include "../js-helper.hxx"
+#include "../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Switch the security token of a context between a "lock" and an "unlock" token.
+     *
+     * The context is resolved once (from the creation context of the object given to the constructor). The unlock token is the
+     * security token of the context at that time. The lock token is a fresh object unless specified. The scope keeps a stack of
+     * nested lock/unlock states natively; the token of the context is written only when the state on top of the stack changes.
+     *
+     * invokeLocked(fn, thisArg, args) and invokeUnlocked(fn, thisArg, args) enter the state, call the function and leave the state
+     * in a single native call, restoring the token even if the function throws.
+     *
+     * Options (all optional):
+     * lockToken - the security token used in the locked state;
+     * stateError - constructor for the error thrown on unbalanced leaveLock()/leaveUnlock(); by default Error.
+     */
+    class SecurityScope : public Object<SecurityScope> {
+    public:
+        struct Frame {
+            bool lock;
+            uint32_t ref;
+        };
+        /**
+         * @brief RAII enter/leave of a lock or unlock state.
+         */
+        class Enter {
+        public:
+            Enter(v8::Isolate *isolate, SecurityScope *scope, bool lock);
+            ~Enter();
+            Enter(const Enter &) = delete;
+            Enter(Enter &&) = delete;
+        private:
+            v8::Isolate *_isolate;
+            SecurityScope *_scope;
+        };
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_enter_lock(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_leave_lock(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_enter_unlock(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_leave_unlock(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_invoke_locked(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_invoke_unlocked(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_locked(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_lock_token(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void prototype_get_unlock_token(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static void leave_callback(const v8::FunctionCallbackInfo<v8::Value> &info, bool lock, const char *method);
+        static void invoke_callback(const v8::FunctionCallbackInfo<v8::Value> &info, bool lock, const char *method);
+    private:
+        Shared<v8::Context> _context;
+        Shared<v8::Value> _lock_token, _unlock_token;
+        Shared<v8::Object> _state_error;
+        std::vector<Frame> _stack;
+    private:
+        void apply(v8::Isolate *isolate, bool lock);
+        void leave_unchecked(v8::Isolate *isolate);
+        v8::Maybe<void> throw_state_error(v8::Local<v8::Context> context, const char *message);
+    public:
+        bool is_locked() const;
+        void enter(v8::Isolate *isolate, bool lock);
+        v8::Maybe<void> leave(v8::Local<v8::Context> context, bool lock);
+        v8::MaybeLocal<v8::Value> invoke(v8::Local<v8::Context> context, bool lock, v8::Local<v8::Value> callee, v8::Local<v8::Value> receiver, int argc, v8::Local<v8::Value> argv[]);
+        v8::Local<v8::Value> get_lock_token(v8::Isolate *isolate) const;
+        v8::Local<v8::Value> get_unlock_token(v8::Isolate *isolate) const;
+    protected:
+        SecurityScope() = default;
+        SecurityScope(const SecurityScope &) = delete;
+        SecurityScope(SecurityScope &&) = delete;
+    public:
+        virtual ~SecurityScope() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_SECURITY_SCOPE_HXX */
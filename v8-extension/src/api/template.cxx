@@ -5,6 +5,7 @@
 #include "object-template.hxx"
 #include "template/native-data-property.hxx"
 #include "template/lazy-data-property.hxx"
+#include "template/internal-field-property.hxx"
 
 #include "../js-string-table.hxx"
 #include "../error-message.hxx"
@@ -16,7 +17,9 @@ namespace dragiyski::node_ext {
 
     namespace {
         // Used to hold a reference from an object (or function) created by ObjectTemplate or FunctionTemplate to the object wrapping that template.
-        std::map<v8::Isolate *, Shared<v8::Private>> per_isolate_template_symbol;
+        thread_local std::map<v8::Isolate *, Shared<v8::Private>> per_isolate_template_symbol;
+        thread_local std::map<v8::Isolate *, Shared<v8::ObjectTemplate>> per_isolate_property_data_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
     }
 
     void Template::initialize(v8::Isolate *isolate) {
@@ -30,17 +33,70 @@ namespace dragiyski::node_ext {
                 std::forward_as_tuple(isolate, symbol)
             );
         }
+        {
+            auto data_template = v8::ObjectTemplate::New(isolate);
+            data_template->SetInternalFieldCount(PROPERTY_DATA_FIELD_COUNT);
+            per_isolate_property_data_template.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(isolate),
+                std::forward_as_tuple(isolate, data_template)
+            );
+        }
+        NativeDataProperty::initialize(isolate);
+        LazyDataProperty::initialize(isolate);
+        InternalFieldProperty::initialize(isolate);
+        {
+            auto class_name = StringTable::Get(isolate, "Template");
+            auto class_template = v8::FunctionTemplate::New(isolate, constructor);
+            class_template->SetClassName(class_name);
+            class_template->ReadOnlyPrototype();
+            class_template->Set(StringTable::Get(isolate, "NativeDataProperty"), NativeDataProperty::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+            class_template->Set(StringTable::Get(isolate, "LazyDataProperty"), LazyDataProperty::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+            class_template->Set(StringTable::Get(isolate, "InternalFieldProperty"), InternalFieldProperty::get_template(isolate), JS_PROPERTY_ATTRIBUTE_STATIC);
+            per_isolate_template.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(isolate),
+                std::forward_as_tuple(isolate, class_template)
+            );
+        }
     }
 
     void Template::uninitialize(v8::Isolate *isolate) {
+        per_isolate_template.erase(isolate);
+        InternalFieldProperty::uninitialize(isolate);
+        LazyDataProperty::uninitialize(isolate);
+        NativeDataProperty::uninitialize(isolate);
+        per_isolate_property_data_template.erase(isolate);
         per_isolate_template_symbol.erase(isolate);
     }
 
+    v8::Local<v8::FunctionTemplate> Template::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void Template::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+    }
+
     v8::Local<v8::Private> Template::get_template_symbol(v8::Isolate *isolate) {
         assert(per_isolate_template_symbol.contains(isolate));
         return per_isolate_template_symbol[isolate].Get(isolate);
     }
 
+    v8::MaybeLocal<v8::Object> Template::NewPropertyData(v8::Local<v8::Context> context, v8::Local<v8::Object> descriptor, void *implementation, v8::Local<v8::Object> interface) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Object>(); };
+        auto isolate = context->GetIsolate();
+        assert(per_isolate_property_data_template.contains(isolate));
+        JS_EXPRESSION_RETURN(data, per_isolate_property_data_template[isolate].Get(isolate)->NewInstance(context));
+        data->SetInternalField(PROPERTY_DATA_DESCRIPTOR, descriptor);
+        data->SetInternalField(PROPERTY_DATA_TEMPLATE, interface);
+        data->SetAlignedPointerInInternalField(PROPERTY_DATA_IMPLEMENTATION, implementation);
+        return data;
+    }
+
     v8::Maybe<void> Template::SetupProperty(v8::Local<v8::Context> context, v8::Local<v8::Object> interface, v8::Local<v8::Template> target, v8::Local<v8::Map> map, v8::Local<v8::Value> key, v8::Local<v8::Value> value) {
         static const constexpr auto __function_return_type__ = v8::Nothing<void>;
         auto isolate = context->GetIsolate();
@@ -63,18 +119,7 @@ namespace dragiyski::node_ext {
             auto key_name = key.As<v8::Name>();
             auto setter = value_native_data_property->get_setter(isolate);
             JS_EXPRESSION_IGNORE(map->Set(context, key, value));
-            v8::Local<v8::Object> data;
-            {
-                v8::Local<v8::Name> names[] = {
-                    StringTable::Get(isolate, "descriptor"),
-                    StringTable::Get(isolate, "template")
-                };
-                v8::Local<v8::Value> values[] = {
-                    value,
-                    interface
-                };
-                data = v8::Object::New(isolate, v8::Null(isolate), names, values, sizeof(names) / sizeof(v8::Local<v8::Name>));
-            }
+            JS_EXPRESSION_RETURN(data, NewPropertyData(context, value_object, value_native_data_property, interface));
             target->SetNativeDataProperty(
                 key_name,
                 NativeDataProperty::getter_callback,
@@ -97,18 +142,7 @@ namespace dragiyski::node_ext {
             }
             auto key_name = key.As<v8::Name>();
             JS_EXPRESSION_IGNORE(map->Set(context, key, value));
-            v8::Local<v8::Object> data;
-            {
-                v8::Local<v8::Name> names[] = {
-                    StringTable::Get(isolate, "descriptor"),
-                    StringTable::Get(isolate, "template")
-                };
-                v8::Local<v8::Value> values[] = {
-                    value,
-                    interface
-                };
-                data = v8::Object::New(isolate, v8::Null(isolate), names, values, sizeof(names) / sizeof(v8::Local<v8::Name>));
-            }
+            JS_EXPRESSION_RETURN(data, NewPropertyData(context, value_object, value_lazy_data_property, interface));
             target->SetLazyDataProperty(
                 key_name,
                 LazyDataProperty::getter_callback,
@@ -119,7 +153,11 @@ namespace dragiyski::node_ext {
             );
             return v8::JustVoid();
         }
-        // 3. key is [string] or [symbol], value is [object Object] having:
+        // 3. [object InternalFieldProperty] is installed by ObjectTemplate::SetupProperty(), which knows the internal field count.
+        if V8_UNLIKELY(Object<InternalFieldProperty>::get_implementation(isolate, value_object) != nullptr) {
+            JS_THROW_ERROR(TypeError, isolate, "Template.InternalFieldProperty can only be installed on an ObjectTemplate with internal fields");
+        }
+        // 4. key is [string] or [symbol], value is [object Object] having:
         // [attributes]: property attributes integer
         // [accessControl]: property accessControl
         // [value]: the property value
@@ -188,7 +226,7 @@ namespace dragiyski::node_ext {
                 v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(property_attribute)),
                 {}, {}
             };
-            std::size_t size = 2;
+            std::size_t size = 1;
             if (property_getter != nullptr || property_setter != nullptr) {
                 if (property_getter != nullptr) {
                     map_value_keys[size] = StringTable::Get(isolate, "get");
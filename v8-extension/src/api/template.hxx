@@ -21,7 +21,7 @@ namespace dragiyski::node_ext {
      * ```javascript
      * new ObjectConstructor({
      *     properties: {
-     *         <name/symbol>: <Template.AccessorProperty/Template.NativeDataProperty/Template.LazyDataProperty/ObjectTemplate.Accessor/FunctionTemplate/ObjectTemplate/primitive
+     *         <name/symbol>: <Template.AccessorProperty/Template.NativeDataProperty/Template.LazyDataProperty/Template.InternalFieldProperty/ObjectTemplate.Accessor/FunctionTemplate/ObjectTemplate/primitive
      *     }
      * })
      * ```
@@ -45,6 +45,29 @@ namespace dragiyski::node_ext {
         static void uninitialize(v8::Isolate *isolate);
     public:
         static v8::Local<v8::Private> get_template_symbol(v8::Isolate *isolate);
+        /**
+         * @brief The class Template: not constructible, it holds the property kinds (Template.LazyDataProperty, etc.).
+         */
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+    public:
+        /**
+         * @brief The internal fields of the data object passed to the callbacks of a property backed by JavaScript functions
+         * (NativeDataProperty, LazyDataProperty, ObjectTemplate.AccessorProperty).
+         *
+         * The descriptor and the template interface keep the implementation alive for as long as the property exists, so the
+         * callbacks read the implementation pointer directly from the data.
+         */
+        enum PropertyDataField : int {
+            PROPERTY_DATA_DESCRIPTOR = 0,
+            PROPERTY_DATA_TEMPLATE = 1,
+            PROPERTY_DATA_IMPLEMENTATION = 2,
+            PROPERTY_DATA_FIELD_COUNT = 3
+        };
+        static v8::MaybeLocal<v8::Object> NewPropertyData(v8::Local<v8::Context> context, v8::Local<v8::Object> descriptor, void *implementation, v8::Local<v8::Object> interface);
+        template <typename Type>
+        static Type *GetPropertyImplementation(v8::Local<v8::Value> data);
     public:
         template <typename Type>
         static v8::Maybe<void> Setup(v8::Local<v8::Context> context, v8::Local<v8::Object> interface, v8::Local<typename Type::js_type> target, v8::Local<v8::Map> map, v8::Local<v8::Value> properties);
@@ -57,8 +80,14 @@ namespace dragiyski::node_ext {
     public:
         class NativeDataProperty;
         class LazyDataProperty;
+        class InternalFieldProperty;
     };
 
+    template<class Type>
+    inline Type *Template::GetPropertyImplementation(v8::Local<v8::Value> data) {
+        return static_cast<Type *>(data.As<v8::Object>()->GetAlignedPointerFromInternalField(PROPERTY_DATA_IMPLEMENTATION));
+    }
+
     template<class Type>
     inline v8::Maybe<void> Template::Setup(v8::Local<v8::Context> context, v8::Local<v8::Object> interface, v8::Local<typename Type::js_type> target, v8::Local<v8::Map> map, v8::Local<v8::Value> source) {
         static const constexpr auto __function_return_type__ = v8::Nothing<void>;
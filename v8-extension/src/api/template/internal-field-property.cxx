@@ -0,0 +1,356 @@
+#include "internal-field-property.hxx"
+
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <memory>
+
+#include "../../error-message.hxx"
+#include "../../js-string-table.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::Private>> per_isolate_field_symbol;
+    }
+
+    void Template::InternalFieldProperty::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "InternalFieldProperty");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor);
+        class_template->SetClassName(class_name);
+        auto prototype_template = class_template->PrototypeTemplate();
+        auto signature = v8::Signature::New(isolate, class_template);
+        {
+            auto name = StringTable::Get(isolate, "get");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_get,
+                {},
+                signature,
+                1,
+                v8::ConstructorBehavior::kThrow,
+                v8::SideEffectType::kHasNoSideEffect
+            );
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "set");
+            auto value = v8::FunctionTemplate::New(
+                isolate,
+                prototype_set,
+                {},
+                signature,
+                2,
+                v8::ConstructorBehavior::kThrow
+            );
+            prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        // Makes prototype *property* (not object) immutable similar to class X {}; syntax;
+        class_template->ReadOnlyPrototype();
+
+        class_template->InstanceTemplate()->SetInternalFieldCount(1);
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+
+        {
+            auto name = StringTable::Get(isolate, "internalFieldCount");
+            auto symbol = v8::Private::New(isolate, name);
+            per_isolate_field_symbol.emplace(
+                std::piecewise_construct,
+                std::forward_as_tuple(isolate),
+                std::forward_as_tuple(isolate, symbol)
+            );
+        }
+
+        Object<Template::InternalFieldProperty>::initialize(isolate);
+    }
+
+    void Template::InternalFieldProperty::uninitialize(v8::Isolate* isolate) {
+        Object<Template::InternalFieldProperty>::uninitialize(isolate);
+        per_isolate_field_symbol.erase(isolate);
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> Template::InternalFieldProperty::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    v8::Local<v8::Private> Template::InternalFieldProperty::get_field_symbol(v8::Isolate *isolate) {
+        assert(per_isolate_field_symbol.contains(isolate));
+        return per_isolate_field_symbol[isolate].Get(isolate);
+    }
+
+    bool Template::InternalFieldProperty::has_field(v8::Local<v8::Context> context, v8::Local<v8::Object> target, uint32_t index) {
+        auto isolate = context->GetIsolate();
+        if V8_UNLIKELY(static_cast<uint32_t>(target->InternalFieldCount()) <= index) {
+            return false;
+        }
+        // The fields of any other object belong to its embedder (node, another addon, or a wrapper of this addon).
+        v8::Local<v8::Value> mark;
+        return target->GetPrivate(context, get_field_symbol(isolate)).ToLocal(&mark) && mark->IsTrue();
+    }
+
+    void Template::InternalFieldProperty::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (!info.IsConstructCall()) {
+            v8::Local<v8::Value> args[] = { info[0] };
+            JS_EXPRESSION_RETURN(callee, get_template(isolate)->GetFunction(context));
+            JS_EXPRESSION_RETURN(return_value, callee->NewInstance(context, 1, args));
+            info.GetReturnValue().Set(return_value);
+            return;
+        }
+
+        if (info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if (!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "argument 1 is not an object.");
+        }
+        auto options = info[0].As<v8::Object>();
+        auto implementation = std::unique_ptr<InternalFieldProperty>(new InternalFieldProperty());
+
+        {
+            auto name = StringTable::Get(isolate, "index");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if V8_UNLIKELY(!js_value->IsNumber()) {
+                JS_THROW_ERROR(TypeError, isolate, "Required option \"index\": not a number.");
+            }
+            auto value = js_value.As<v8::Number>()->Value();
+            if V8_UNLIKELY(!(value >= 1 && value <= MAX_INDEX) || std::trunc(value) != value) {
+                JS_THROW_ERROR(RangeError, isolate, "Option \"index\": expected an integer in range [1, ", MAX_INDEX, "], field 0 is reserved.");
+            }
+            implementation->_index = static_cast<uint32_t>(value);
+        }
+
+        {
+            auto name = StringTable::Get(isolate, "type");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if V8_UNLIKELY(!js_value->IsString()) {
+                JS_THROW_ERROR(TypeError, isolate, "Required option \"type\": not a string.");
+            }
+            if (js_value->StrictEquals(StringTable::Get(isolate, "int32"))) {
+                implementation->_type = TYPE_INT32;
+            } else if (js_value->StrictEquals(StringTable::Get(isolate, "double"))) {
+                implementation->_type = TYPE_DOUBLE;
+            } else if (js_value->StrictEquals(StringTable::Get(isolate, "boolean")) || js_value->StrictEquals(StringTable::Get(isolate, "bool"))) {
+                implementation->_type = TYPE_BOOLEAN;
+            } else if (js_value->StrictEquals(StringTable::Get(isolate, "object"))) {
+                implementation->_type = TYPE_OBJECT;
+            } else {
+                JS_THROW_ERROR(TypeError, context, "Option \"type\": expected one of \"int32\", \"double\", \"boolean\", \"object\", got \"", js_value, "\".");
+            }
+        }
+
+        {
+            auto name = StringTable::Get(isolate, "readonly");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            implementation->_readonly = js_value->BooleanValue(isolate);
+        }
+
+        implementation->_attributes = JS_PROPERTY_ATTRIBUTE_DEFAULT;
+        {
+            auto name = StringTable::Get(isolate, "attributes");
+            JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+            if (!js_value->IsNullOrUndefined()) {
+                JS_EXPRESSION_RETURN_WITH_ERROR_PREFIX(value, js_value->Uint32Value(context), context, "In option \"attributes\"");
+                value = value & static_cast<uint32_t>(JS_PROPERTY_ATTRIBUTE_ALL);
+                implementation->_attributes = static_cast<v8::PropertyAttribute>(value);
+            }
+        }
+        if (implementation->_readonly) {
+            implementation->_attributes = static_cast<v8::PropertyAttribute>(implementation->_attributes | v8::PropertyAttribute::ReadOnly);
+        }
+
+        implementation.release()->set_interface(isolate, info.This());
+        info.GetReturnValue().Set(info.This());
+    }
+
+    void Template::InternalFieldProperty::prototype_get(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "InternalFieldProperty", ".", "prototype", ".", "get", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(info.Length() < 1) {
+            JS_THROW_ERROR(TypeError, isolate, "1 argument required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+        auto target = info[0].As<v8::Object>();
+        if V8_UNLIKELY(!has_field(context, target, implementation->_index)) {
+            JS_THROW_ERROR(TypeError, isolate, "The object was not created from a template with internal field ", implementation->_index, ".");
+        }
+        info.GetReturnValue().Set(read(isolate, target, implementation->_index, implementation->_type));
+    }
+
+    void Template::InternalFieldProperty::prototype_set(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto implementation = get_implementation(isolate, info.This());
+        if V8_UNLIKELY(implementation == nullptr) {
+            JS_EXPRESSION_RETURN(receiver, type_of(context, info.This()));
+            JS_THROW_ERROR(TypeError, isolate, "InternalFieldProperty", ".", "prototype", ".", "set", " called on incompatible receiver ", receiver);
+        }
+        if V8_UNLIKELY(info.Length() < 2) {
+            JS_THROW_ERROR(TypeError, isolate, "2 arguments required, but only ", info.Length(), " present.");
+        }
+        if V8_UNLIKELY(!info[0]->IsObject()) {
+            JS_THROW_ERROR(TypeError, context, "Expected arguments[0] to be an [object], got ", type_of(context, info[0]));
+        }
+        auto target = info[0].As<v8::Object>();
+        if V8_UNLIKELY(!has_field(context, target, implementation->_index)) {
+            JS_THROW_ERROR(TypeError, isolate, "The object was not created from a template with internal field ", implementation->_index, ".");
+        }
+        JS_EXPRESSION_IGNORE(write(context, target, implementation->_index, implementation->_type, info[1]));
+    }
+
+    v8::Local<v8::Value> Template::InternalFieldProperty::read(v8::Isolate *isolate, v8::Local<v8::Object> target, uint32_t index, Type type) {
+        // A field that was never written (or written by the embedder with another type) reads as the default of the type.
+        auto data = target->GetInternalField(static_cast<int>(index));
+        if V8_UNLIKELY(!data->IsValue()) {
+            data = v8::Undefined(isolate);
+        }
+        auto value = data.As<v8::Value>();
+        switch (type) {
+            case TYPE_INT32:
+                if V8_LIKELY(value->IsInt32()) {
+                    return value;
+                }
+                return v8::Integer::New(isolate, 0);
+            case TYPE_DOUBLE:
+                if V8_LIKELY(value->IsNumber()) {
+                    return value;
+                }
+                return v8::Number::New(isolate, 0);
+            case TYPE_BOOLEAN:
+                if V8_LIKELY(value->IsBoolean()) {
+                    return value;
+                }
+                return v8::False(isolate);
+            case TYPE_OBJECT:
+                if V8_LIKELY(value->IsObject()) {
+                    return value;
+                }
+                return v8::Null(isolate);
+        }
+        return v8::Undefined(isolate);
+    }
+
+    v8::Maybe<void> Template::InternalFieldProperty::write(v8::Local<v8::Context> context, v8::Local<v8::Object> target, uint32_t index, Type type, v8::Local<v8::Value> value) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        auto isolate = context->GetIsolate();
+        v8::Local<v8::Value> field;
+        // Objects are rejected for the primitive types: converting them would call valueOf()/toString().
+        switch (type) {
+            case TYPE_INT32:
+                if V8_UNLIKELY(value->IsObject()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Cannot convert object to int32.");
+                }
+                if V8_LIKELY(value->IsInt32()) {
+                    field = value;
+                } else {
+                    JS_EXPRESSION_RETURN(int32_value, value->Int32Value(context));
+                    field = v8::Integer::New(isolate, int32_value);
+                }
+                break;
+            case TYPE_DOUBLE:
+                if V8_UNLIKELY(value->IsObject()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Cannot convert object to double.");
+                }
+                if V8_LIKELY(value->IsNumber()) {
+                    field = value;
+                } else {
+                    JS_EXPRESSION_RETURN(double_value, value->NumberValue(context));
+                    field = v8::Number::New(isolate, double_value);
+                }
+                break;
+            case TYPE_BOOLEAN:
+                if V8_UNLIKELY(value->IsObject()) {
+                    JS_THROW_ERROR(TypeError, isolate, "Cannot convert object to boolean.");
+                }
+                field = v8::Boolean::New(isolate, value->BooleanValue(isolate));
+                break;
+            case TYPE_OBJECT:
+                if V8_UNLIKELY(!value->IsObject() && !value->IsNull()) {
+                    JS_THROW_ERROR(TypeError, context, "Expected an object or null, got ", type_of(context, value));
+                }
+                field = value;
+                break;
+        }
+        target->SetInternalField(static_cast<int>(index), field);
+        return v8::JustVoid();
+    }
+
+    void Template::InternalFieldProperty::getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+
+        // The holder is an instance of the ObjectTemplate that reserved the field (checked when the property was installed):
+        // a native data property cannot be copied to another object, it can only be reached through the prototype chain.
+        auto target = info.Holder();
+        auto data = info.Data().As<v8::Int32>()->Value();
+        auto index = static_cast<uint32_t>(data >> TYPE_BITS);
+        auto type = static_cast<Type>(data & TYPE_MASK);
+        if V8_UNLIKELY(static_cast<uint32_t>(target->InternalFieldCount()) <= index) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal invocation");
+        }
+        info.GetReturnValue().Set(read(isolate, target, index, type));
+    }
+
+    void Template::InternalFieldProperty::setter_callback(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto target = info.Holder();
+        auto data = info.Data().As<v8::Int32>()->Value();
+        auto index = static_cast<uint32_t>(data >> TYPE_BITS);
+        auto type = static_cast<Type>(data & TYPE_MASK);
+        if V8_UNLIKELY(static_cast<uint32_t>(target->InternalFieldCount()) <= index) {
+            JS_THROW_ERROR(TypeError, isolate, "Illegal invocation");
+        }
+        JS_EXPRESSION_IGNORE(write(context, target, index, type, value));
+    }
+
+    uint32_t Template::InternalFieldProperty::get_index() const {
+        return _index;
+    }
+
+    Template::InternalFieldProperty::Type Template::InternalFieldProperty::get_type() const {
+        return _type;
+    }
+
+    bool Template::InternalFieldProperty::is_readonly() const {
+        return _readonly;
+    }
+
+    v8::PropertyAttribute Template::InternalFieldProperty::get_attributes() const {
+        return _attributes;
+    }
+
+    v8::Local<v8::Value> Template::InternalFieldProperty::get_data(v8::Isolate *isolate) const {
+        return v8::Integer::New(isolate, static_cast<int32_t>((_index << TYPE_BITS) | static_cast<uint32_t>(_type)));
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef NODE_EXT_API_TEMPLATE_INTERNAL_FIELD_PROPERTY_HXX
+#define NODE_EXT_API_TEMPLATE_INTERNAL_FIELD_PROPERTY_HXX
+
+#include <cstdint>
+#include <v8.h>
+#include "../template.hxx"
+#include "../../js-helper.hxx"
+#include "../../object.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Native data property reading and writing an internal field of the receiver.
+     *
+     * The property can only be installed on an ObjectTemplate whose "internalFieldCount" covers the index, and the callbacks
+     * access the fields of the holder, an instance of that template. prototype.get()/set() accept only objects created from
+     * such a template (marked with a private symbol), so the fields of other embedders, like the aligned pointer of a wrapper,
+     * are never touched. Field 0 is reserved for the embedder and cannot be used.
+     *
+     * The getter and the setter are implemented in C++ and never call JavaScript. The field is typed: the setter converts
+     * primitives to the type of the field and rejects objects (except for "object" fields), so the conversion cannot invoke
+     * valueOf()/toString(). The getter returns the default of the type (0, false or null) for a field that was never written.
+     *
+     * Options:
+     * index - the internal field index, at least 1 (required);
+     * type - "int32", "double", "boolean" or "object" (required);
+     * readonly - no setter is installed, the field can still be written through InternalFieldProperty.prototype.set();
+     * attributes - the property attributes.
+     */
+    class Template::InternalFieldProperty : public Object<Template::InternalFieldProperty> {
+    public:
+        enum Type : int32_t {
+            TYPE_INT32 = 0,
+            TYPE_DOUBLE = 1,
+            TYPE_BOOLEAN = 2,
+            TYPE_OBJECT = 3
+        };
+        // The index and the type are packed in the (Smi) data of the accessor, so the callbacks do not need any lookup.
+        static const constexpr int32_t TYPE_BITS = 2;
+        static const constexpr int32_t TYPE_MASK = (1 << TYPE_BITS) - 1;
+        static const constexpr uint32_t MAX_INDEX = (1u << (30 - TYPE_BITS)) - 1;
+    public:
+        static void initialize(v8::Isolate* isolate);
+        static void uninitialize(v8::Isolate* isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate* isolate);
+        /**
+         * @brief Set to true on the instances of an ObjectTemplate that reserves internal fields.
+         */
+        static v8::Local<v8::Private> get_field_symbol(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value>& info);
+        static void prototype_get(const v8::FunctionCallbackInfo<v8::Value>& info);
+        static void prototype_set(const v8::FunctionCallbackInfo<v8::Value>& info);
+    public:
+        static void getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
+        static void setter_callback(v8::Local<v8::Name> property, v8::Local<v8::Value> value, const v8::PropertyCallbackInfo<void> &info);
+    private:
+        static bool has_field(v8::Local<v8::Context> context, v8::Local<v8::Object> target, uint32_t index);
+        static v8::Local<v8::Value> read(v8::Isolate *isolate, v8::Local<v8::Object> target, uint32_t index, Type type);
+        static v8::Maybe<void> write(v8::Local<v8::Context> context, v8::Local<v8::Object> target, uint32_t index, Type type, v8::Local<v8::Value> value);
+    private:
+        uint32_t _index;
+        Type _type;
+        bool _readonly;
+        v8::PropertyAttribute _attributes;
+    public:
+        uint32_t get_index() const;
+        Type get_type() const;
+        bool is_readonly() const;
+        v8::PropertyAttribute get_attributes() const;
+        v8::Local<v8::Value> get_data(v8::Isolate *isolate) const;
+    protected:
+        InternalFieldProperty() = default;
+        InternalFieldProperty(const InternalFieldProperty&) = delete;
+        InternalFieldProperty(InternalFieldProperty&&) = delete;
+    public:
+        virtual ~InternalFieldProperty() override = default;
+    };
+}
+
+#endif /* NODE_EXT_API_TEMPLATE_INTERNAL_FIELD_PROPERTY_HXX */
@@ -17,6 +17,9 @@ namespace dragiyski::node_ext {
     protected:
         static void constructor(const v8::FunctionCallbackInfo<v8::Value>& info);
     public:
+        /**
+         * @brief Calls getter(receiver, holder, name) with the data of Template::NewPropertyData().
+         */
         static void getter_callback(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value> &info);
         static void prototype_get_getter(const v8::FunctionCallbackInfo<v8::Value>& info);
         static void prototype_get_attributes(const v8::FunctionCallbackInfo<v8::Value>& info);
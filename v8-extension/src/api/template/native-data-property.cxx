@@ -8,7 +8,7 @@
 
 namespace dragiyski::node_ext {
     namespace {
-        std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
     }
 
     void Template::NativeDataProperty::initialize(v8::Isolate *isolate) {
@@ -28,9 +28,12 @@ namespace dragiyski::node_ext {
             std::forward_as_tuple(isolate),
             std::forward_as_tuple(isolate, class_template)
         );
+
+        Object<Template::NativeDataProperty>::initialize(isolate);
     }
 
     void Template::NativeDataProperty::uninitialize(v8::Isolate* isolate) {
+        Object<Template::NativeDataProperty>::uninitialize(isolate);
         per_isolate_template.erase(isolate);
     }
 
@@ -159,50 +162,9 @@ namespace dragiyski::node_ext {
         v8::HandleScope scope(isolate);
         auto context = isolate->GetCurrentContext();
 
-        auto data = info.Data().As<v8::Object>();
-        JS_EXPRESSION_RETURN(js_descriptor, data->Get(context, StringTable::Get(isolate, "descriptor")));
-        if V8_UNLIKELY(!js_descriptor->IsObject()) {
-            info.GetReturnValue().SetUndefined();
-            return;
-        }
-        auto descriptor = Object<NativeDataProperty>::get_implementation(isolate, js_descriptor.As<v8::Object>());
-        if V8_UNLIKELY(descriptor == nullptr) {
-            info.GetReturnValue().SetUndefined();
-            return;
-        }
-
-        JS_EXPRESSION_RETURN(js_template, data->Get(context, StringTable::Get(isolate, "template")));
-        if V8_UNLIKELY(!js_template->IsObject()) {
-            info.GetReturnValue().SetUndefined();
-            return;
-        }
-        auto data_strict = v8::Boolean::New(isolate, info.ShouldThrowOnError());
-
-        v8::Local<v8::Object> call_data;
-        {
-            // TODO: Obtain wrapper of v8::Context of the GetCurrentContext()
-            // Note: isolate->GetCurrentContext() might be different from the context of the getter call.
-            v8::Local<v8::Name> names[] = {
-                StringTable::Get(isolate, "this"),
-                StringTable::Get(isolate, "holder"),
-                StringTable::Get(isolate, "name"),
-                StringTable::Get(isolate, "descriptor"),
-                StringTable::Get(isolate, "template"),
-                StringTable::Get(isolate, "strict")
-            };
-            v8::Local<v8::Value> values[] = {
-                info.This(),
-                info.Holder(),
-                property,
-                js_descriptor,
-                js_template,
-                data_strict
-            };
-            static_assert(sizeof(names) / sizeof(v8::Local<v8::Name>) == sizeof(values) / sizeof(v8::Local<v8::Value>));
-            call_data = v8::Object::New(isolate, v8::Null(isolate), names, values, sizeof(names) / sizeof(v8::Local<v8::Name>));
-        }
+        auto descriptor = Template::GetPropertyImplementation<NativeDataProperty>(info.Data());
         auto getter = descriptor->get_getter(isolate);
-        v8::Local<v8::Value> call_args[] = {call_data};
+        v8::Local<v8::Value> call_args[] = {info.This(), info.Holder(), property};
         JS_EXPRESSION_RETURN(call_return, object_or_function_call(context, getter, v8::Undefined(isolate), sizeof(call_args) / sizeof(v8::Local<v8::Value>), call_args));
         info.GetReturnValue().Set(call_return);
     }
@@ -213,50 +175,9 @@ namespace dragiyski::node_ext {
         v8::HandleScope scope(isolate);
         auto context = isolate->GetCurrentContext();
 
-        auto data = info.Data().As<v8::Object>();
-        JS_EXPRESSION_RETURN(js_descriptor, data->Get(context, StringTable::Get(isolate, "descriptor")));
-        if V8_UNLIKELY(!js_descriptor->IsObject()) {
-            return;
-        }
-        auto descriptor = Object<NativeDataProperty>::get_implementation(isolate, js_descriptor.As<v8::Object>());
-        if V8_UNLIKELY(descriptor == nullptr) {
-            return;
-        }
-
-        JS_EXPRESSION_RETURN(js_template, data->Get(context, StringTable::Get(isolate, "template")));
-        if V8_UNLIKELY(!js_template->IsObject()) {
-            return;
-        }
-        auto data_strict = v8::Boolean::New(isolate, info.ShouldThrowOnError());
-
-        v8::Local<v8::Object> call_data;
-        {
-            // TODO: Obtain wrapper of v8::Context of the GetCurrentContext()
-            // Note: isolate->GetCurrentContext() might be different from the context of the getter call.
-            v8::Local<v8::Name> names[] = {
-                StringTable::Get(isolate, "this"),
-                StringTable::Get(isolate, "holder"),
-                StringTable::Get(isolate, "name"),
-                StringTable::Get(isolate, "value"),
-                StringTable::Get(isolate, "descriptor"),
-                StringTable::Get(isolate, "template"),
-                StringTable::Get(isolate, "strict")
-            };
-            v8::Local<v8::Value> values[] = {
-                info.This(),
-                info.Holder(),
-                property,
-                value,
-                js_descriptor,
-                js_template,
-                data_strict
-            };
-            static_assert(sizeof(names) / sizeof(v8::Local<v8::Name>) == sizeof(values) / sizeof(v8::Local<v8::Value>));
-            call_data = v8::Object::New(isolate, v8::Null(isolate), names, values, sizeof(names) / sizeof(v8::Local<v8::Name>));
-        }
+        auto descriptor = Template::GetPropertyImplementation<NativeDataProperty>(info.Data());
         auto setter = descriptor->get_setter(isolate);
-        v8::Local<v8::Value> call_args[] = {call_data};
-        JS_EXPRESSION_RETURN(call_return, object_or_function_call(context, setter, v8::Undefined(isolate), sizeof(call_args) / sizeof(v8::Local<v8::Value>), call_args));
-        info.GetReturnValue().Set(call_return);
+        v8::Local<v8::Value> call_args[] = {info.This(), info.Holder(), property, value};
+        JS_EXPRESSION_IGNORE(object_or_function_call(context, setter, v8::Undefined(isolate), sizeof(call_args) / sizeof(v8::Local<v8::Value>), call_args));
     }
 }
\ No newline at end of file
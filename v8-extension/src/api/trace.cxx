@@ -0,0 +1,106 @@
+#include "trace.hxx"
+
+#include <cassert>
+#include <map>
+
+#include "../js-string-table.hxx"
+#include "../object.hxx"
+#include "../trace.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+    }
+
+    void Trace::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        auto class_name = StringTable::Get(isolate, "Trace");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+        {
+            auto name = StringTable::Get(isolate, "start");
+            auto value = v8::FunctionTemplate::New(isolate, static_start, {}, {}, 0, v8::ConstructorBehavior::kThrow);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "stop");
+            auto value = v8::FunctionTemplate::New(isolate, static_stop, {}, {}, 0, v8::ConstructorBehavior::kThrow);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "clear");
+            auto value = v8::FunctionTemplate::New(isolate, static_clear, {}, {}, 0, v8::ConstructorBehavior::kThrow);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "export");
+            auto value = v8::FunctionTemplate::New(isolate, static_export, {}, {}, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "available");
+            auto value = v8::FunctionTemplate::New(isolate, static_get_available, {}, {}, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            class_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "enabled");
+            auto value = v8::FunctionTemplate::New(isolate, static_get_enabled, {}, {}, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            class_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+    }
+
+    void Trace::uninitialize(v8::Isolate *isolate) {
+        per_isolate_template.erase(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> Trace::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    void Trace::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+    }
+
+    void Trace::static_start(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        js::trace::enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void Trace::static_stop(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        js::trace::enabled.store(false, std::memory_order_relaxed);
+    }
+
+    void Trace::static_clear(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        js::trace::clear();
+    }
+
+    void Trace::static_export(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+
+        auto json = js::trace::to_json();
+        JS_EXPRESSION_RETURN(value, v8::String::NewFromUtf8(isolate, json.data(), v8::NewStringType::kNormal, static_cast<int>(json.size())));
+        info.GetReturnValue().Set(value);
+    }
+
+    void Trace::static_get_available(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        info.GetReturnValue().Set(js::trace::available());
+    }
+
+    void Trace::static_get_enabled(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        info.GetReturnValue().Set(js::trace::enabled.load(std::memory_order_relaxed));
+    }
+}
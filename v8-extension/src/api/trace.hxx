@@ -0,0 +1,37 @@
+#ifndef NODE_EXT_API_TRACE_HXX
+#define NODE_EXT_API_TRACE_HXX
+
+#include <v8.h>
+#include "../js-helper.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Control of the native trace instrumentation (see JS_TRACE_SCOPE in trace.hxx); static members only.
+     *
+     * Trace.start() and Trace.stop() switch recording for all threads of the process, including the worker isolates of
+     * IsolatePool. Trace.export() returns the recorded events as Chrome trace-event JSON, Trace.clear() discards them.
+     * Trace.available is false when the extension was built without NODE_EXT_TRACE (node-gyp -Dnode_ext_trace=0); then nothing
+     * is ever recorded.
+     */
+    class Trace {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_start(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_stop(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_clear(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_export(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_get_available(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_get_enabled(const v8::FunctionCallbackInfo<v8::Value> &info);
+    public:
+        Trace() = delete;
+    };
+}
+
+#endif /* NODE_EXT_API_TRACE_HXX */
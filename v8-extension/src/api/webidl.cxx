@@ -0,0 +1,183 @@
+#include "webidl.hxx"
+
+#include <cassert>
+#include <map>
+
+#include "../js-string-table.hxx"
+#include "../webidl.hxx"
+
+namespace dragiyski::node_ext {
+    namespace {
+        thread_local std::map<v8::Isolate *, Shared<v8::FunctionTemplate>> per_isolate_template;
+        thread_local std::map<v8::Isolate *, Shared<v8::Private>> per_isolate_template_symbol;
+    }
+
+    void WebIDL::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_template.contains(isolate));
+
+        webidl::initialize(isolate);
+
+        auto class_name = StringTable::Get(isolate, "WebIDL");
+        auto class_template = v8::FunctionTemplate::New(isolate, constructor, {}, {}, 0);
+        class_template->SetClassName(class_name);
+        {
+            auto name = StringTable::Get(isolate, "createInterface");
+            auto value = v8::FunctionTemplate::New(isolate, static_create_interface, {}, {}, 2, v8::ConstructorBehavior::kThrow);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "createInstance");
+            auto value = v8::FunctionTemplate::New(isolate, static_create_instance, {}, {}, 1, v8::ConstructorBehavior::kThrow);
+            class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+        {
+            auto name = StringTable::Get(isolate, "interfaces");
+            auto value = v8::FunctionTemplate::New(isolate, static_get_interfaces, {}, {}, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasNoSideEffect);
+            class_template->SetAccessorProperty(name, value, {}, JS_PROPERTY_ATTRIBUTE_STATIC);
+        }
+
+        class_template->ReadOnlyPrototype();
+
+        auto template_symbol = v8::Private::New(isolate, class_name);
+        per_isolate_template_symbol.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, template_symbol)
+        );
+
+        per_isolate_template.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(isolate),
+            std::forward_as_tuple(isolate, class_template)
+        );
+    }
+
+    void WebIDL::uninitialize(v8::Isolate *isolate) {
+        per_isolate_template.erase(isolate);
+        per_isolate_template_symbol.erase(isolate);
+        webidl::uninitialize(isolate);
+    }
+
+    v8::Local<v8::FunctionTemplate> WebIDL::get_template(v8::Isolate *isolate) {
+        assert(per_isolate_template.contains(isolate));
+        return per_isolate_template[isolate].Get(isolate);
+    }
+
+    v8::Local<v8::Private> WebIDL::get_template_symbol(v8::Isolate *isolate) {
+        assert(per_isolate_template_symbol.contains(isolate));
+        return per_isolate_template_symbol[isolate].Get(isolate);
+    }
+
+    v8::Maybe<std::size_t> WebIDL::get_interface_template(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const char *description) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<std::size_t>;
+        auto isolate = context->GetIsolate();
+        if (value->IsFunction()) {
+            JS_EXPRESSION_RETURN(index, value.As<v8::Object>()->GetPrivate(context, get_template_symbol(isolate)));
+            if (index->IsUint32()) {
+                return v8::Just<std::size_t>(index.As<v8::Uint32>()->Value());
+            }
+        }
+        JS_THROW_ERROR(TypeError, isolate, "Expected ", description, " to be an interface object created by WebIDL.createInterface().");
+    }
+
+    void WebIDL::constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+    }
+
+    void WebIDL::static_create_interface(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        if (!info[0]->IsString()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[0] to be a string.");
+        }
+        v8::String::Utf8Value interface_name(isolate, info[0]);
+        auto definition = webidl::find_definition(*interface_name);
+        if (definition < 0) {
+            JS_THROW_ERROR(TypeError, isolate, "Unknown interface '", info[0].As<v8::String>(), "'.");
+        }
+        if (!info[1]->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "Expected arguments[1] to be an object.");
+        }
+        auto implementation = info[1].As<v8::Object>();
+
+        v8::Local<v8::Value> parent_value = v8::Undefined(isolate);
+        auto target_context = context;
+        if (!info[2]->IsNullOrUndefined()) {
+            if (!info[2]->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected arguments[2] to be an object, if specified.");
+            }
+            auto options = info[2].As<v8::Object>();
+            {
+                auto name = StringTable::Get(isolate, "parent");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                parent_value = value;
+            }
+            {
+                auto name = StringTable::Get(isolate, "context");
+                JS_EXPRESSION_RETURN(value, options->Get(context, name));
+                if (!value->IsUndefined()) {
+                    if (!value->IsObject()) {
+                        JS_THROW_ERROR(TypeError, isolate, "Expected options.context to be an object, if specified.");
+                    }
+                    JS_EXPRESSION_RETURN(creation_context, value.As<v8::Object>()->GetCreationContext());
+                    target_context = creation_context;
+                }
+            }
+        }
+
+        auto parent_definition = webidl::definitions[definition].parent;
+        v8::Local<v8::FunctionTemplate> parent_template;
+        if (parent_definition >= 0) {
+            JS_EXPRESSION_RETURN(parent_index, get_interface_template(context, parent_value, "options.parent"));
+            if (webidl::get_template_definition(isolate, parent_index) != parent_definition) {
+                JS_THROW_ERROR(TypeError, isolate, "Expected options.parent to be the interface object of '", webidl::definitions[parent_definition].name, "'.");
+            }
+            parent_template = webidl::get_template(isolate, parent_index);
+        } else if (!parent_value->IsUndefined()) {
+            JS_THROW_ERROR(TypeError, isolate, "Interface '", webidl::definitions[definition].name, "' does not inherit from another interface.");
+        }
+
+        JS_EXPRESSION_RETURN(class_template, webidl::definitions[definition].create_template(context, implementation, parent_template));
+        auto index = webidl::register_template(isolate, definition, class_template);
+        JS_EXPRESSION_RETURN(value, class_template->GetFunction(target_context));
+        if (!parent_template.IsEmpty()) {
+            // Inherit() chains the prototype objects only; the interface object must inherit the parent interface object.
+            JS_EXPRESSION_IGNORE(value->SetPrototype(context, parent_value));
+        }
+        JS_EXPRESSION_IGNORE(value->SetPrivate(context, get_template_symbol(isolate), v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(index))));
+        info.GetReturnValue().Set(value);
+    }
+
+    void WebIDL::static_create_instance(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        JS_EXPRESSION_RETURN(index, get_interface_template(context, info[0], "arguments[0]"));
+        JS_EXPRESSION_RETURN(creation_context, info[0].As<v8::Object>()->GetCreationContext());
+        auto class_template = webidl::get_template(isolate, index);
+        JS_EXPRESSION_RETURN(value, class_template->InstanceTemplate()->NewInstance(creation_context));
+        info.GetReturnValue().Set(value);
+    }
+
+    void WebIDL::static_get_interfaces(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        auto context = isolate->GetCurrentContext();
+
+        auto value = v8::Array::New(isolate, static_cast<int>(webidl::definition_count));
+        for (std::size_t index = 0; index < webidl::definition_count; ++index) {
+            JS_EXPRESSION_RETURN(name, v8::String::NewFromUtf8(isolate, webidl::definitions[index].name, v8::NewStringType::kInternalized));
+            JS_EXPRESSION_IGNORE(value->Set(context, static_cast<uint32_t>(index), name));
+        }
+        info.GetReturnValue().Set(value);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef NODE_EXT_API_WEBIDL_HXX
+#define NODE_EXT_API_WEBIDL_HXX
+
+#include <v8.h>
+#include "../js-helper.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    /**
+     * @brief Instantiates the interfaces generated from webidl/ by tools/webidl-bindings.mjs.
+     *
+     * WebIDL.createInterface(name, implementation, options) returns the interface object of a generated interface. The
+     * implementation is an object with an own method per operation, an own accessor per attribute and an own "constructor"
+     * method, if the interface has a constructor. The native callbacks check the receiver and the argument count and convert
+     * the arguments, then call the implementation with the receiver as "this" and the converted arguments.
+     *
+     * Options (all optional):
+     * parent - the interface object of the inherited interface; required if the interface inherits another;
+     * context - an object whose creation context instantiates the interface object; by default the current context.
+     *
+     * WebIDL.createInstance(interface) returns a new object implementing an interface object returned by createInterface(),
+     * without calling the implementation; e.g. for the interfaces without a constructor.
+     */
+    class WebIDL {
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        static v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate);
+        /**
+         * @brief The index of the template of an interface object returned by createInterface(), or throws a TypeError.
+         */
+        static v8::Maybe<std::size_t> get_interface_template(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const char *description);
+    protected:
+        static void constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_create_interface(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_create_instance(const v8::FunctionCallbackInfo<v8::Value> &info);
+        static void static_get_interfaces(const v8::FunctionCallbackInfo<v8::Value> &info);
+    private:
+        static v8::Local<v8::Private> get_template_symbol(v8::Isolate *isolate);
+    };
+}
+
+#endif /* NODE_EXT_API_WEBIDL_HXX */
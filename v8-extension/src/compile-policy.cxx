@@ -0,0 +1,362 @@
+#include "compile-policy.hxx"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "js-string-table.hxx"
+#include "trace.hxx"
+
+namespace dragiyski::node_ext {
+    using namespace js;
+
+    namespace {
+        // Bucket k counts the compiles that took less than 2^k microseconds (and at least 2^(k-1)); the last one the rest.
+        constexpr std::size_t histogram_size = 22;
+
+        // The number of sources in the table (and of unmeasured observations of an isolate); the least recently compiled source is
+        // dropped first.
+        constexpr std::size_t max_sources = 1024;
+        // The number of conclusive observations a decision is based on.
+        constexpr uint64_t required_samples = 3;
+
+        enum class Decision {
+            OBSERVING,
+            HOT,
+            COLD
+        };
+
+        struct Entry {
+            uint64_t compiles = 0;
+            uint64_t eager = 0;
+            uint64_t lazy = 0;
+            std::chrono::steady_clock::duration time = std::chrono::steady_clock::duration::zero();
+            Decision decision = Decision::OBSERVING;
+            // Whether an isolate holds an observation of the source that is not measured yet.
+            bool observed = false;
+            uint64_t samples = 0;
+            // The smallest code cache measured right after a compile: what the lazy compile itself produced.
+            std::size_t lazy_bytes = 0;
+            // Summed over the samples.
+            std::size_t base_bytes = 0;
+            std::size_t executed_bytes = 0;
+            uint64_t last_use = 0;
+        };
+
+        // Shared by all isolates of the process (the workers of an IsolatePool included).
+        struct Telemetry {
+            std::mutex mutex;
+            std::array<uint64_t, histogram_size> eager_histogram = {};
+            std::array<uint64_t, histogram_size> lazy_histogram = {};
+            uint64_t eager = 0;
+            uint64_t lazy = 0;
+            uint64_t hot = 0;
+            uint64_t cold = 0;
+            uint64_t observing = 0;
+            uint64_t evicted = 0;
+            uint64_t clock = 0;
+            std::unordered_map<std::size_t, Entry> sources;
+        } telemetry;
+
+        struct Observation {
+            Shared<v8::Function> function;
+            std::size_t base_bytes;
+        };
+
+        thread_local std::map<v8::Isolate *, std::unordered_map<std::size_t, Observation>> per_isolate_observations;
+
+        // The entry of the source, created if necessary; telemetry.mutex must be held.
+        Entry &source_entry(std::size_t hash) {
+            auto entry = telemetry.sources.find(hash);
+            if (entry == telemetry.sources.end()) {
+                if (telemetry.sources.size() >= max_sources) {
+                    auto victim = telemetry.sources.end();
+                    for (auto candidate = telemetry.sources.begin(); candidate != telemetry.sources.end(); ++candidate) {
+                        if (victim == telemetry.sources.end() || candidate->second.last_use < victim->second.last_use) {
+                            victim = candidate;
+                        }
+                    }
+                    telemetry.sources.erase(victim);
+                    ++telemetry.evicted;
+                }
+                entry = telemetry.sources.emplace(hash, Entry()).first;
+            }
+            entry->second.last_use = ++telemetry.clock;
+            return entry->second;
+        }
+
+        std::size_t code_cache_size(v8::Local<v8::Function> function) {
+            std::unique_ptr<v8::ScriptCompiler::CachedData> data(v8::ScriptCompiler::CreateCodeCacheForFunction(function));
+            return data ? static_cast<std::size_t>(data->length) : 0;
+        }
+
+        std::size_t hash_string(v8::Isolate *isolate, v8::Local<v8::String> value) {
+            v8::String::Utf8Value utf8_value(isolate, value);
+            return std::hash<std::string_view>()(std::string_view(*utf8_value, utf8_value.length()));
+        }
+
+        std::size_t hash_source(v8::Isolate *isolate, v8::Local<v8::String> source_string, std::size_t arguments_length, v8::Local<v8::String> *arguments) {
+            auto hash = hash_string(isolate, source_string);
+            for (std::size_t i = 0; i < arguments_length; ++i) {
+                hash ^= hash_string(isolate, arguments[i]) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            }
+            return hash;
+        }
+
+        void measure(v8::Isolate *isolate, std::size_t hash, const Observation &observation) {
+            JS_TRACE_SCOPE("compile-policy", "measure");
+            auto function = observation.function.Get(isolate);
+            auto grown_bytes = function.IsEmpty() ? 0 : code_cache_size(function);
+            std::lock_guard lock(telemetry.mutex);
+            auto found = telemetry.sources.find(hash);
+            if (found == telemetry.sources.end()) {
+                return;
+            }
+            auto &entry = found->second;
+            entry.observed = false;
+            if (function.IsEmpty() || entry.decision != Decision::OBSERVING) {
+                return;
+            }
+            // A later compile in the same isolate may share the inner functions compiled for an earlier one (compilation cache),
+            // so the growth is measured from the smallest base. If nothing has grown, no function of the source has run yet
+            // (e.g. a batch of compiles of the same source): the observation is inconclusive.
+            entry.lazy_bytes = entry.lazy_bytes == 0 ? observation.base_bytes : std::min(entry.lazy_bytes, observation.base_bytes);
+            if (grown_bytes <= entry.lazy_bytes) {
+                return;
+            }
+            ++entry.samples;
+            entry.base_bytes += entry.lazy_bytes;
+            entry.executed_bytes += grown_bytes - entry.lazy_bytes;
+            if (entry.samples >= required_samples) {
+                entry.decision = entry.base_bytes > 0 && entry.executed_bytes >= entry.base_bytes ? Decision::HOT : Decision::COLD;
+            }
+        }
+
+        void measure_all(v8::Isolate *isolate) {
+            auto &observations = per_isolate_observations[isolate];
+            for (auto &[hash, observation] : observations) {
+                measure(isolate, hash, observation);
+            }
+            observations.clear();
+        }
+
+        v8::Local<v8::Object> new_object(v8::Isolate *isolate, std::initializer_list<std::pair<v8::Local<v8::Name>, v8::Local<v8::Value>>> properties) {
+            std::vector<v8::Local<v8::Name>> names;
+            std::vector<v8::Local<v8::Value>> values;
+            for (auto &[name, value] : properties) {
+                names.push_back(name);
+                values.push_back(value);
+            }
+            return v8::Object::New(isolate, v8::Null(isolate), names.data(), values.data(), names.size());
+        }
+
+        double to_milliseconds(std::chrono::steady_clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    }
+
+    void CompilePolicy::initialize(v8::Isolate *isolate) {
+        assert(!per_isolate_observations.contains(isolate));
+        per_isolate_observations.emplace(isolate, std::unordered_map<std::size_t, Observation>());
+    }
+
+    void CompilePolicy::uninitialize(v8::Isolate *isolate) {
+        auto observations = per_isolate_observations.find(isolate);
+        if (observations == per_isolate_observations.end()) {
+            return;
+        }
+        {
+            // Unmeasured observations are dropped: the sources are observed again by the next adaptive compile.
+            std::lock_guard lock(telemetry.mutex);
+            for (auto &[hash, observation] : observations->second) {
+                if (auto entry = telemetry.sources.find(hash); entry != telemetry.sources.end()) {
+                    entry->second.observed = false;
+                }
+            }
+        }
+        per_isolate_observations.erase(observations);
+    }
+
+    v8::Maybe<CompilePolicy::Mode> CompilePolicy::mode_from_object(v8::Local<v8::Context> context, v8::Local<v8::Object> options) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<Mode>;
+        auto isolate = context->GetIsolate();
+        auto name = StringTable::Get(isolate, "compileOptions");
+        JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
+        if (js_value->IsUndefined()) {
+            return v8::Just(Mode::EAGER);
+        }
+        JS_EXPRESSION_RETURN(js_mode, js_value->ToString(context));
+        v8::String::Utf8Value mode_name(isolate, js_mode);
+        std::string_view mode(*mode_name, mode_name.length());
+        if (mode == "eager") {
+            return v8::Just(Mode::EAGER);
+        } else if (mode == "lazy") {
+            return v8::Just(Mode::LAZY);
+        } else if (mode == "adaptive") {
+            return v8::Just(Mode::ADAPTIVE);
+        }
+        JS_THROW_ERROR(RangeError, isolate, "Option \"compileOptions\": expected \"eager\", \"lazy\" or \"adaptive\", got \"", js_mode, "\".");
+    }
+
+    v8::MaybeLocal<v8::Function> CompilePolicy::compile_function(
+        v8::Local<v8::Context> target_context,
+        v8::ScriptCompiler::Source *source,
+        v8::Local<v8::String> source_string,
+        std::size_t arguments_length,
+        v8::Local<v8::String> *arguments,
+        std::size_t scopes_length,
+        v8::Local<v8::Object> *scopes,
+        Mode mode
+    ) {
+        auto isolate = target_context->GetIsolate();
+
+        std::size_t hash = 0;
+        bool eager = mode == Mode::EAGER;
+        bool observe = false;
+        Decision decision = Decision::OBSERVING;
+        if (mode == Mode::ADAPTIVE) {
+            hash = hash_source(isolate, source_string, arguments_length, arguments);
+            auto &observations = per_isolate_observations[isolate];
+            if (auto observation = observations.find(hash); observation != observations.end()) {
+                measure(isolate, hash, observation->second);
+                observations.erase(observation);
+            } else if (observations.size() >= max_sources) {
+                measure_all(isolate);
+            }
+            std::lock_guard lock(telemetry.mutex);
+            auto &entry = source_entry(hash);
+            decision = entry.decision;
+            eager = decision == Decision::HOT;
+            if (decision == Decision::OBSERVING && !entry.observed) {
+                entry.observed = observe = true;
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto maybe_function = v8::ScriptCompiler::CompileFunction(
+            target_context,
+            source,
+            arguments_length,
+            arguments,
+            scopes_length,
+            scopes,
+            eager ? v8::ScriptCompiler::kEagerCompile : v8::ScriptCompiler::kNoCompileOptions
+        );
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        v8::Local<v8::Function> function;
+        auto compiled = maybe_function.ToLocal(&function);
+        auto base_bytes = compiled && observe ? code_cache_size(function) : 0;
+        {
+            std::lock_guard lock(telemetry.mutex);
+            if (!compiled) {
+                if (auto entry = telemetry.sources.find(hash); observe && entry != telemetry.sources.end()) {
+                    entry->second.observed = false;
+                }
+                return maybe_function;
+            }
+            auto microseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+            auto bucket = std::min<std::size_t>(std::bit_width(microseconds), histogram_size - 1);
+            ++(eager ? telemetry.eager_histogram : telemetry.lazy_histogram)[bucket];
+            if (mode == Mode::EAGER) {
+                ++telemetry.eager;
+            } else if (mode == Mode::LAZY) {
+                ++telemetry.lazy;
+            } else {
+                ++(decision == Decision::HOT ? telemetry.hot : decision == Decision::COLD ? telemetry.cold : telemetry.observing);
+                auto &entry = source_entry(hash);
+                ++entry.compiles;
+                ++(eager ? entry.eager : entry.lazy);
+                entry.time += elapsed;
+            }
+        }
+        if (observe) {
+            auto &observation = per_isolate_observations[isolate][hash];
+            observation.function.Reset(isolate, function);
+            observation.function.SetWeak();
+            observation.base_bytes = base_bytes;
+        }
+        return function;
+    }
+
+    v8::MaybeLocal<v8::Object> CompilePolicy::statistics(v8::Local<v8::Context> context) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Object>;
+        auto isolate = context->GetIsolate();
+        measure_all(isolate);
+
+        std::array<uint64_t, histogram_size> eager_histogram, lazy_histogram;
+        uint64_t eager, lazy, hot, cold, observing, evicted;
+        std::vector<std::pair<std::size_t, Entry>> sources;
+        {
+            std::lock_guard lock(telemetry.mutex);
+            eager_histogram = telemetry.eager_histogram;
+            lazy_histogram = telemetry.lazy_histogram;
+            eager = telemetry.eager;
+            lazy = telemetry.lazy;
+            hot = telemetry.hot;
+            cold = telemetry.cold;
+            observing = telemetry.observing;
+            evicted = telemetry.evicted;
+            sources.assign(telemetry.sources.begin(), telemetry.sources.end());
+        }
+
+        auto histogram = v8::Array::New(isolate, static_cast<int>(histogram_size));
+        for (std::size_t i = 0; i < histogram_size; ++i) {
+            auto below = i + 1 < histogram_size ? static_cast<double>(uint64_t(1) << i) : std::numeric_limits<double>::infinity();
+            auto bucket = new_object(isolate, {
+                { StringTable::Get(isolate, "below"), v8::Number::New(isolate, below) },
+                { StringTable::Get(isolate, "eager"), v8::Number::New(isolate, static_cast<double>(eager_histogram[i])) },
+                { StringTable::Get(isolate, "lazy"), v8::Number::New(isolate, static_cast<double>(lazy_histogram[i])) }
+            });
+            JS_EXPRESSION_IGNORE(histogram->Set(context, static_cast<uint32_t>(i), bucket));
+        }
+
+        auto decisions = new_object(isolate, {
+            { StringTable::Get(isolate, "eager"), v8::Number::New(isolate, static_cast<double>(eager)) },
+            { StringTable::Get(isolate, "lazy"), v8::Number::New(isolate, static_cast<double>(lazy)) },
+            { StringTable::Get(isolate, "hot"), v8::Number::New(isolate, static_cast<double>(hot)) },
+            { StringTable::Get(isolate, "cold"), v8::Number::New(isolate, static_cast<double>(cold)) },
+            { StringTable::Get(isolate, "observing"), v8::Number::New(isolate, static_cast<double>(observing)) }
+        });
+
+        auto source_list = v8::Array::New(isolate, static_cast<int>(sources.size()));
+        for (std::size_t i = 0; i < sources.size(); ++i) {
+            auto &[hash, entry] = sources[i];
+            char hash_buffer[2 * sizeof(std::size_t)];
+            auto hash_end = std::to_chars(hash_buffer, hash_buffer + sizeof(hash_buffer), hash, 16).ptr;
+            JS_EXPRESSION_RETURN(hash_string, v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t *>(hash_buffer), v8::NewStringType::kNormal, static_cast<int>(hash_end - hash_buffer)));
+            auto decision = entry.decision == Decision::HOT ? StringTable::Get(isolate, "hot") : entry.decision == Decision::COLD ? StringTable::Get(isolate, "cold") : StringTable::Get(isolate, "observing");
+            auto source_entry = new_object(isolate, {
+                { StringTable::Get(isolate, "hash"), hash_string },
+                { StringTable::Get(isolate, "decision"), decision },
+                { StringTable::Get(isolate, "compiles"), v8::Number::New(isolate, static_cast<double>(entry.compiles)) },
+                { StringTable::Get(isolate, "eager"), v8::Number::New(isolate, static_cast<double>(entry.eager)) },
+                { StringTable::Get(isolate, "lazy"), v8::Number::New(isolate, static_cast<double>(entry.lazy)) },
+                { StringTable::Get(isolate, "samples"), v8::Number::New(isolate, static_cast<double>(entry.samples)) },
+                { StringTable::Get(isolate, "time"), v8::Number::New(isolate, to_milliseconds(entry.time)) },
+                { StringTable::Get(isolate, "baseBytes"), v8::Number::New(isolate, static_cast<double>(entry.base_bytes)) },
+                { StringTable::Get(isolate, "executedBytes"), v8::Number::New(isolate, static_cast<double>(entry.executed_bytes)) }
+            });
+            JS_EXPRESSION_IGNORE(source_list->Set(context, static_cast<uint32_t>(i), source_entry));
+        }
+
+        return new_object(isolate, {
+            { StringTable::Get(isolate, "histogram"), histogram },
+            { StringTable::Get(isolate, "decisions"), decisions },
+            { StringTable::Get(isolate, "sources"), source_list },
+            { StringTable::Get(isolate, "evicted"), v8::Number::New(isolate, static_cast<double>(evicted)) }
+        });
+    }
+}
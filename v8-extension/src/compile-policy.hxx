@@ -0,0 +1,61 @@
+#ifndef NODE_EXT_COMPILE_POLICY_HXX
+#define NODE_EXT_COMPILE_POLICY_HXX
+
+#include <cstddef>
+#include <v8.h>
+#include "js-helper.hxx"
+
+namespace dragiyski::node_ext {
+    /**
+     * @brief The "compileOptions" of Context.prototype.compileFunction(): "eager" (the default), "lazy" or "adaptive".
+     *
+     * "eager" compiles the function and every inner function immediately; "lazy" leaves the inner functions to be compiled on
+     * their first call. "adaptive" decides per source (hashed together with the argument names) from what earlier compiles of
+     * the same source did, in any isolate of the process:
+     *
+     * An adaptive compile of a source is lazy and may be observed: the size of the code cache of the function is recorded. At the
+     * next adaptive compile of the same source in the same isolate (or when the statistics are read) the code cache of that
+     * function is measured again. What it has grown beyond the smallest lazy compile of the source is the code of the inner
+     * functions that were called (a later compile in the same isolate may share them through the compilation cache); if nothing
+     * has grown (no function of the source has run yet, e.g. in a batch of compiles) the observation is inconclusive and the
+     * source is observed again. Once three observations are conclusive, the source is "hot" and compiled eagerly from then on if their
+     * inner functions compiled at least as much code as their lazy compiles produced; otherwise it is "cold" and stays lazy.
+     * A source whose inner functions are never called is never decided and stays lazy, like a cold one.
+     *
+     * Every compile is timed; Context.compileStatistics() returns the compile time histogram, the number of decisions of each
+     * kind and the table of adaptive sources. The table holds at most 1024 sources; the least recently compiled one is dropped
+     * (and counted in "evicted") to make room for a new one.
+     */
+    class CompilePolicy {
+    public:
+        enum class Mode {
+            EAGER,
+            LAZY,
+            ADAPTIVE
+        };
+    public:
+        static void initialize(v8::Isolate *isolate);
+        static void uninitialize(v8::Isolate *isolate);
+    public:
+        /**
+         * @brief Read the "compileOptions" option; Mode::EAGER if it is not specified.
+         */
+        static v8::Maybe<Mode> mode_from_object(v8::Local<v8::Context> context, v8::Local<v8::Object> options);
+        static v8::MaybeLocal<v8::Function> compile_function(
+            v8::Local<v8::Context> target_context,
+            v8::ScriptCompiler::Source *source,
+            v8::Local<v8::String> source_string,
+            std::size_t arguments_length,
+            v8::Local<v8::String> *arguments,
+            std::size_t scopes_length,
+            v8::Local<v8::Object> *scopes,
+            Mode mode
+        );
+        /**
+         * @brief The telemetry of all compiles in the process; pending observations of the current isolate are measured first.
+         */
+        static v8::MaybeLocal<v8::Object> statistics(v8::Local<v8::Context> context);
+    };
+}
+
+#endif /* NODE_EXT_COMPILE_POLICY_HXX */
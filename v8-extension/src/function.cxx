@@ -1,10 +1,11 @@
 #include "function.hxx"
 #include "js-string-table.hxx"
+#include "api/mapped-source.hxx"
 
 namespace dragiyski::node_ext {
     using namespace js;
 
-    std::unique_ptr<v8::ScriptCompiler::Source> source_from_object(v8::Local<v8::Context> context, v8::Local<v8::Object> options) {
+    std::unique_ptr<v8::ScriptCompiler::Source> source_from_object(v8::Local<v8::Context> context, v8::Local<v8::Object> options, v8::ScriptCompiler::CachedData *cached_data, v8::Local<v8::String> *source_string) {
         using __function_return_type__ = std::unique_ptr<v8::ScriptCompiler::Source>;
         auto isolate = context->GetIsolate();
 
@@ -12,10 +13,17 @@ namespace dragiyski::node_ext {
         {
             auto name = StringTable::Get(isolate, "source");
             JS_EXPRESSION_RETURN(js_value, options->Get(context, name));
-            if (!js_value->IsString()) {
-                JS_THROW_ERROR(TypeError, isolate, "Expected option 'source' to be a string.");
+            if (js_value->IsString()) {
+                source = js_value.As<v8::String>();
+            } else if (auto mapped_source = js_value->IsObject() ? MappedSource::get_implementation(isolate, js_value.As<v8::Object>()) : nullptr; mapped_source != nullptr) {
+                JS_EXPRESSION_RETURN(value, mapped_source->get_source(isolate));
+                source = value;
+            } else {
+                JS_THROW_ERROR(TypeError, isolate, "Expected option 'source' to be a string or a MappedSource.");
             }
-            source = js_value.As<v8::String>();
+        }
+        if (source_string != nullptr) {
+            *source_string = source;
         }
         v8::Local<v8::Value> location;
         {
@@ -94,9 +102,9 @@ namespace dragiyski::node_ext {
             }
 
             v8::ScriptOrigin origin(isolate, location, line_offset, column_offset, is_shared_cross_origin, script_id, source_map_url, is_opaque, is_wasm, is_module);
-            return std::make_unique<v8::ScriptCompiler::Source>(source, origin);
+            return std::make_unique<v8::ScriptCompiler::Source>(source, origin, cached_data);
         } else {
-            return std::make_unique<v8::ScriptCompiler::Source>(source);
+            return std::make_unique<v8::ScriptCompiler::Source>(source, cached_data);
         }
     }
 }
\ No newline at end of file
@@ -5,7 +5,9 @@
 #include "js-helper.hxx"
 
 namespace dragiyski::node_ext {
-    std::unique_ptr<v8::ScriptCompiler::Source> source_from_object(v8::Local<v8::Context>, v8::Local<v8::Object>);
+    // The returned source owns cached_data; the caller keeps it if nothing is returned. The source string is stored in
+    // source_string, if specified.
+    std::unique_ptr<v8::ScriptCompiler::Source> source_from_object(v8::Local<v8::Context>, v8::Local<v8::Object>, v8::ScriptCompiler::CachedData *cached_data = nullptr, v8::Local<v8::String> *source_string = nullptr);
 }
 
 #endif /* NODE_EXT_FUNCTION_HXX */
\ No newline at end of file
@@ -1,15 +1,24 @@
 #ifndef JS_HELPER_HXX
 #define JS_HELPER_HXX
 
+#include <algorithm>
 #include <array>
 #include <charconv>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
 #include <typeinfo>
 #include <utility>
 #include <system_error>
 #include <type_traits>
+#include <vector>
 #include <v8.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /**
  * @brief C++ does not provide a way to get the return type of the current function.
  *
@@ -188,516 +197,262 @@ namespace js {
         return isolate_or_context_impl<T>::isolate(value);
     }
 
-    template<std::size_t N>
-    using string_literal_t = const char(&)[N];
-
-    template<typename T, typename = void>
-    struct string_type {
-        using type = T; // Everything else is kept as is.
-    };
-
-    template<typename T>
-    struct string_type<const v8::Local<T>&> {
-        using type = v8::Local<T>; // References to v8::Local are copied.
-    };
-
-    template<typename T>
-    struct string_type<const v8::MaybeLocal<T>&> {
-        using type = v8::MaybeLocal<T>; // References to v8::MaybeLocal are copied.
-    };
-
-    template<std::size_t N>
-    struct string_type<string_literal_t<N>> {
-        using type = string_literal_t<N>; // String literal references are kept as is.
-    };
-
-    template<typename T>
-    struct string_type<const T* const&> {
-        using type = const T*;
-    };
-
-    template<typename T>
-    struct string_type<T* const&> {
-        using type = T*;
-    };
-
-    template<typename T>
-    struct string_type<const T&, std::enable_if_t<std::is_integral_v<T>>> {
-        using type = T; // References to scalars are removed.
-    };
-
-    template<typename T>
-    struct string_type<const T&, std::enable_if_t<std::is_floating_point_v<T>>> {
-        using type = T; // References to scalars are removed.
-    };
-
-    template<typename T>
-    using string_type_t = typename string_type<T>::type;
-
-    template<typename T, typename = void>
-    struct string_value_impl;
-
-    template<std::size_t N>
-    struct string_value_impl<string_literal_t<N>> {
-        static inline v8::Local<v8::String> New(v8::Isolate* isolate, string_literal_t<N> value) {
-            return v8::String::NewFromUtf8Literal(isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, string_literal_t<N> value) {
-            return New(isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, string_literal_t<N> value) {
-            return New(context->GetIsolate(), value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, string_literal_t<N> value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, string_literal_t<N> value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, string_literal_t<N> value) {
-            return New(isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, string_literal_t<N> value) {
-            return Create(context, isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, string_literal_t<N> value) {
-            return Create(context, isolate, value);
-        }
-    };
-
-    template<>
-    struct string_value_impl<v8::Local<v8::String>> {
-        static inline v8::Local<v8::String> New(v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-    };
-
-    template<>
-    struct string_value_impl<v8::MaybeLocal<v8::String>> {
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, v8::MaybeLocal<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::MaybeLocal<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::MaybeLocal<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::MaybeLocal<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
-        }
-    };
-
-    template<>
-    struct string_value_impl<const char*> {
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, const char* value) {
-            return v8::String::NewFromUtf8(isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, const char* value) {
-            return Create(context->GetIsolate(), value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, const char* value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, const char* value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, const char* value) {
-            return Create(isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, const char* value) {
-            return Create(context, isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, const char* value) {
-            return Create(context, isolate, value);
-        }
-    };
-
-    template<>
-    struct string_value_impl<const std::string&> {
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, const std::string& value) {
-            return v8::String::NewFromUtf8(isolate, value.c_str());
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, const std::string& value) {
-            return Create(context->GetIsolate(), value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, const std::string& value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, const std::string& value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, const std::string& value) {
-            return Create(isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, const std::string& value) {
-            return Create(context, isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, const std::string& value) {
-            return Create(context, isolate, value);
-        }
-    };
-
-    template<>
-    struct string_value_impl<bool> {
-        static inline v8::Local<v8::String> New(v8::Isolate* isolate, bool value) {
-            if (value) {
-                return v8::String::NewFromUtf8Literal(isolate, "true");
-            } else {
-                return v8::String::NewFromUtf8Literal(isolate, "false");
+    /**
+     * @brief Whether all bytes are below 0x80; the scan is vectorized (SSE2 when available, 8 bytes per word otherwise).
+     */
+    inline bool is_ascii(const char* data, std::size_t length) {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        for (; i + 4 * sizeof(__m128i) <= length; i += 4 * sizeof(__m128i)) {
+            auto chunk = reinterpret_cast<const __m128i*>(data + i);
+            auto mask = _mm_or_si128(
+                _mm_or_si128(_mm_loadu_si128(chunk), _mm_loadu_si128(chunk + 1)),
+                _mm_or_si128(_mm_loadu_si128(chunk + 2), _mm_loadu_si128(chunk + 3))
+            );
+            if (_mm_movemask_epi8(mask) != 0) {
+                return false;
             }
         }
-
-        v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, bool value) {
-            return New(isolate, value);
-        }
-
-        v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, bool value) {
-            return New(context->GetIsolate(), value);
-        }
-
-        v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, bool value) {
-            return Create(context, value);
+#endif
+        for (; i + sizeof(std::uint64_t) <= length; i += sizeof(std::uint64_t)) {
+            std::uint64_t chunk;
+            std::memcpy(&chunk, data + i, sizeof(chunk));
+            if (chunk & UINT64_C(0x8080808080808080)) {
+                return false;
+            }
         }
-
-        v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, bool value) {
-            return Create(context, value);
+        for (; i < length; ++i) {
+            if (static_cast<unsigned char>(data[i]) & 0x80) {
+                return false;
+            }
         }
+        return true;
+    }
 
-        v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, bool value) {
-            return New(isolate, value);
+    /**
+     * @brief Accumulates the parts of a string and creates a single v8::String from them.
+     *
+     * The characters are kept as Latin-1 in a small inline buffer (spilling to the heap for long strings) until a part
+     * requires two bytes per character; then the buffer is widened to UTF-16 once. Numbers are formatted in place by
+     * std::to_chars(), so the only string allocated on the V8 heap is the result of Build().
+     *
+     * Values other than strings are converted with ToString() or ToDetailString(), depending on the conversion the
+     * builder was created with. If a conversion fails, the builder remembers it, ignores the remaining parts and Build()
+     * returns an empty handle with the exception left pending.
+     */
+    class StringBuilder {
+    public:
+        enum class Conversion {
+            kToString,
+            kToDetailString
+        };
+        static constexpr std::size_t inline_capacity = 256;
+    public:
+        explicit StringBuilder(v8::Isolate* isolate) : _isolate(isolate) {}
+        explicit StringBuilder(v8::Local<v8::Context> context, Conversion conversion = Conversion::kToString) :
+            _isolate(context->GetIsolate()),
+            _context(context),
+            _conversion(conversion) {}
+        StringBuilder(const StringBuilder&) = delete;
+        StringBuilder(StringBuilder&&) = delete;
+        StringBuilder& operator=(const StringBuilder&) = delete;
+        StringBuilder& operator=(StringBuilder&&) = delete;
+    public:
+        StringBuilder& Append(const char* value) {
+            return AppendUtf8(value, std::char_traits<char>::length(value));
         }
 
-        v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, bool value) {
-            return Create(context, isolate, value);
+        StringBuilder& Append(std::string_view value) {
+            return AppendUtf8(value.data(), value.size());
         }
 
-        v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, bool value) {
-            return Create(context, isolate, value);
+        StringBuilder& Append(bool value) {
+            return value ? AppendOneByte("true", 4) : AppendOneByte("false", 5);
         }
-    };
-
-    struct String {
-        template<typename ... T>
-        static constexpr v8::Local<v8::String> New(v8::Isolate* isolate, const T& ... args);
-
-        template<typename ... T>
-        static constexpr v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, const T& ... args);
-
-        template<typename ... T>
-        static constexpr v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, const T& ... args);
-
-        template<typename ... T>
-        static constexpr v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, const T& ... args);
-
-        template<typename ... T>
-        static constexpr v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, const T& ... args);
-    };
 
-    template<typename T>
-    struct string_value_impl<T, std::enable_if_t<std::is_integral_v<T>>> {
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, T value) {
+        template<typename T>
+        std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, StringBuilder&> Append(T value) {
             // 64 is sufficient for base-2 for the largest integral type
             std::array<char, 64> string;
-            if (auto [end, err] = std::to_chars(string.data(), string.data() + string.size(), value, 10); err == std::errc()) {
-                return v8::String::NewFromUtf8(isolate, string.data(), v8::NewStringType::kNormal, end - string.data());
-            } else {
-                return String::Create(isolate, "[", typeid(T).name(), ": ", std::make_error_code(err).message(), "]");
+            auto [end, err] = std::to_chars(string.data(), string.data() + string.size(), value, 10);
+            if V8_UNLIKELY(err != std::errc()) {
+                return AppendFormatError<T>(err);
             }
+            return AppendOneByte(string.data(), end - string.data());
         }
 
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, const T& value) {
-            return Create(context->GetIsolate(), value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, const T& value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, const T& value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, const T& value) {
-            return Create(isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, const T& value) {
-            return Create(context, isolate, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, const T& value) {
-            return Create(context, isolate, value);
-        }
-    };
-
-    template<typename T>
-    struct string_value_impl<T, std::enable_if_t<std::is_floating_point_v<T>>> {
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, T value) {
-            // 64 is sufficient for base-2 for the largest integral type
+        template<typename T>
+        std::enable_if_t<std::is_floating_point_v<T>, StringBuilder&> Append(T value) {
             std::array<char, 1024> string;
-            if (auto [end, err] = std::to_chars(string.data(), string.data() + string.size(), value, std::chars_format::fixed); err == std::errc()) {
-                return v8::String::NewFromUtf8(isolate, string.data(), v8::NewStringType::kNormal, end - string.data());
-            } else {
-                return String::Create(isolate, "[", typeid(T).name(), ": ", std::make_error_code(err).message(), "]");
+            auto [end, err] = std::to_chars(string.data(), string.data() + string.size(), value, std::chars_format::fixed);
+            if V8_UNLIKELY(err != std::errc()) {
+                return AppendFormatError<T>(err);
             }
+            return AppendOneByte(string.data(), end - string.data());
         }
 
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, const T& value) {
-            return Create(context->GetIsolate(), value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, const T& value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, const T& value) {
-            return Create(context, value);
+        StringBuilder& Append(v8::Local<v8::String> value) {
+            if V8_UNLIKELY(_failed) {
+                return *this;
+            }
+            auto length = value->Length();
+            if (length <= 0) {
+                return *this;
+            }
+            if (!_is_two_byte && value->IsOneByte()) {
+                value->WriteOneByte(_isolate, Extend(length), 0, length, v8::String::NO_NULL_TERMINATION);
+            } else {
+                Widen();
+                auto offset = _two_byte.size();
+                _two_byte.resize(offset + length);
+                value->Write(_isolate, _two_byte.data() + offset, 0, length, v8::String::NO_NULL_TERMINATION);
+            }
+            return *this;
         }
 
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, const T& value) {
-            return Create(isolate, value);
+        template<typename T>
+        std::enable_if_t<std::is_base_of_v<v8::Value, T>, StringBuilder&> Append(v8::Local<T> value) {
+            if V8_UNLIKELY(_failed) {
+                return *this;
+            }
+            if (value->IsString()) {
+                return Append(value.template As<v8::String>());
+            }
+            auto context = _context.IsEmpty() ? _isolate->GetCurrentContext() : _context;
+            auto maybe_string = _conversion == Conversion::kToDetailString ? value->ToDetailString(context) : value->ToString(context);
+            return Append(maybe_string);
         }
 
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, const T& value) {
-            return Create(context, isolate, value);
+        template<typename T>
+        StringBuilder& Append(v8::MaybeLocal<T> value) {
+            if V8_UNLIKELY(value.IsEmpty()) {
+                _failed = true;
+                return *this;
+            }
+            return Append(value.ToLocalChecked());
         }
 
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, const T& value) {
-            return Create(context, isolate, value);
+        template<typename ... T>
+        StringBuilder& AppendAll(const T& ... values) {
+            (Append(values), ...);
+            return *this;
         }
-    };
 
-    template<typename T>
-    struct string_value_impl<v8::MaybeLocal<T>, std::enable_if_t<std::is_base_of_v<v8::Primitive, T>>> {
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::MaybeLocal<T> value) {
-            if V8_UNLIKELY(value.IsEmpty()) {
+        v8::MaybeLocal<v8::String> Build() {
+            if V8_UNLIKELY(_failed) {
                 return {};
             }
-            return value.ToLocalChecked()->ToString(context);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::MaybeLocal<T> value) {
-            if V8_UNLIKELY(value.IsEmpty()) {
+            auto length = _is_two_byte ? _two_byte.size() : _size;
+            if V8_UNLIKELY(length > static_cast<std::size_t>(v8::String::kMaxLength)) {
+                _isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8Literal(_isolate, "Invalid string length")));
                 return {};
             }
-            return value.ToLocalChecked()->ToString(context);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::MaybeLocal<T> value) {
-            if V8_UNLIKELY(value.IsEmpty()) {
-                return {};
+            if (_is_two_byte) {
+                return v8::String::NewFromTwoByte(_isolate, _two_byte.data(), v8::NewStringType::kNormal, static_cast<int>(length));
             }
-            return value.ToLocalChecked()->ToDetailString(context);
-        }
-
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::MaybeLocal<T> value) {
-            return Create(context, value);
-        }
-
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::MaybeLocal<T> value) {
-            return ToString(context, value);
+            return v8::String::NewFromOneByte(_isolate, _data, v8::NewStringType::kNormal, static_cast<int>(length));
         }
-
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, v8::MaybeLocal<T> value) {
-            return ToDetailString(context, value);
+    private:
+        StringBuilder& AppendUtf8(const char* data, std::size_t length) {
+            if V8_LIKELY(is_ascii(data, length)) {
+                return AppendOneByte(data, length);
+            }
+            if V8_UNLIKELY(_failed) {
+                return *this;
+            }
+            if V8_UNLIKELY(length > static_cast<std::size_t>(v8::String::kMaxLength)) {
+                _isolate->ThrowException(v8::Exception::RangeError(v8::String::NewFromUtf8Literal(_isolate, "Invalid string length")));
+                _failed = true;
+                return *this;
+            }
+            // Non-ASCII UTF-8 is rare (messages are written in ASCII), let V8 decode it.
+            return Append(v8::String::NewFromUtf8(_isolate, data, v8::NewStringType::kNormal, static_cast<int>(length)));
         }
-    };
 
-    template<typename T>
-    struct string_value_impl<v8::Local<T>, std::enable_if_t<std::is_base_of_v<v8::Value, T>>> {
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, const v8::Local<T>& value) {
-            return value->ToString(context);
+        StringBuilder& AppendOneByte(const char* data, std::size_t length) {
+            if V8_UNLIKELY(_failed || length == 0) {
+                return *this;
+            }
+            auto bytes = reinterpret_cast<const std::uint8_t*>(data);
+            if V8_UNLIKELY(_is_two_byte) {
+                _two_byte.insert(_two_byte.end(), bytes, bytes + length);
+            } else {
+                std::memcpy(Extend(length), bytes, length);
+            }
+            return *this;
         }
 
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, const v8::Local<T>& value) {
-            return value->ToDetailString(context);
+        template<typename T>
+        StringBuilder& AppendFormatError(std::errc err) {
+            return AppendAll("[", typeid(T).name(), ": ", std::make_error_code(err).message(), "]");
         }
 
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, const v8::Local<T>& value) {
-            return ToString(context, value);
+        std::uint8_t* Extend(std::size_t length) {
+            if V8_UNLIKELY(_capacity - _size < length) {
+                auto capacity = std::max(_capacity * 2, _size + length);
+                auto heap = std::make_unique<std::uint8_t[]>(capacity);
+                std::memcpy(heap.get(), _data, _size);
+                _heap = std::move(heap);
+                _data = _heap.get();
+                _capacity = capacity;
+            }
+            auto position = _data + _size;
+            _size += length;
+            return position;
         }
 
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, const v8::Local<T>& value) {
-            return ToDetailString(context, value);
-        }
+        void Widen() {
+            if (_is_two_byte) {
+                return;
+            }
+            _two_byte.reserve(std::max(_size * 2, inline_capacity));
+            _two_byte.assign(_data, _data + _size);
+            _is_two_byte = true;
+        }
+    private:
+        v8::Isolate* _isolate;
+        v8::Local<v8::Context> _context;
+        Conversion _conversion = Conversion::kToString;
+        bool _failed = false;
+        bool _is_two_byte = false;
+        std::uint8_t* _data = _inline;
+        std::size_t _size = 0;
+        std::size_t _capacity = inline_capacity;
+        std::unique_ptr<std::uint8_t[]> _heap;
+        std::vector<std::uint16_t> _two_byte;
+        std::uint8_t _inline[inline_capacity];
     };
 
-    template<typename ... T>
-    struct string_concat_impl;
-
-    template<typename ... Rest>
-    struct string_concat_impl<v8::Local<v8::String>, v8::Local<v8::String>, Rest...> {
-        static inline v8::Local<v8::String> concat(v8::Isolate* isolate, v8::Local<v8::String> first, v8::Local<v8::String> second, Rest ... rest) {
-            return string_concat_impl<v8::Local<v8::String>, Rest...>::concat(isolate, v8::String::Concat(isolate, first, second), rest...);
+    struct String {
+        /**
+         * @brief Create a string from parts that cannot fail to convert (no values that require a context).
+         */
+        template<typename ... T>
+        static inline v8::Local<v8::String> New(v8::Isolate* isolate, const T& ... args) {
+            return StringBuilder(isolate).AppendAll(args...).Build().ToLocalChecked();
         }
-    };
 
-    template<typename ... Rest>
-    struct string_concat_impl<v8::MaybeLocal<v8::String>, v8::MaybeLocal<v8::String>, Rest...> {
-        static inline v8::MaybeLocal<v8::String> concat(v8::Isolate* isolate, v8::MaybeLocal<v8::String> first, v8::MaybeLocal<v8::String> second, Rest ... rest) {
-            if V8_UNLIKELY(first.IsEmpty() || second.IsEmpty()) {
-                return {};
-            }
-            return string_concat_impl<v8::Local<v8::String>, Rest...>::concat(isolate, v8::String::Concat(isolate, first.ToLocalChecked(), second.ToLocalChecked()), rest...);
+        template<typename ... T>
+        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, const T& ... args) {
+            return StringBuilder(isolate).AppendAll(args...).Build();
         }
-    };
 
-    template<typename ... Rest>
-    struct string_concat_impl<v8::Local<v8::String>, v8::MaybeLocal<v8::String>, Rest...> {
-        static inline v8::MaybeLocal<v8::String> concat(v8::Isolate* isolate, v8::Local<v8::String> first, v8::MaybeLocal<v8::String> second, Rest ... rest) {
-            if V8_UNLIKELY(second.IsEmpty()) {
-                return {};
-            }
-            return string_concat_impl<v8::Local<v8::String>, Rest...>::concat(isolate, v8::String::Concat(isolate, first, second.ToLocalChecked()), rest...);
+        template<typename ... T>
+        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, const T& ... args) {
+            return StringBuilder(context).AppendAll(args...).Build();
         }
-    };
 
-    template<>
-    struct string_concat_impl<v8::Local<v8::String>> {
-        static inline v8::Local<v8::String> concat(v8::Isolate* isolate, v8::Local<v8::String> value) {
-            return value;
+        template<typename ... T>
+        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, const T& ... args) {
+            return StringBuilder(context, StringBuilder::Conversion::kToString).AppendAll(args...).Build();
         }
-    };
 
-    template<>
-    struct string_concat_impl<v8::MaybeLocal<v8::String>> {
-        static inline v8::MaybeLocal<v8::String> concat(v8::Isolate* isolate, v8::MaybeLocal<v8::String> value) {
-            return value;
+        template<typename ... T>
+        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, const T& ... args) {
+            return StringBuilder(context, StringBuilder::Conversion::kToDetailString).AppendAll(args...).Build();
         }
     };
 
-    template<typename ...T>
-    struct string_impl_context_isolate {
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::Create(context, values))...>::concat(isolate, string_value_impl<T>::Create(context, values)...);
-        };
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::ToString(context, values))...>::concat(isolate, string_value_impl<T>::ToString(context, values)...);
-        };
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::ToDetailString(context, values))...>::concat(isolate, string_value_impl<T>::ToDetailString(context, values)...);
-        };
-    };
-
-    template<typename ... T>
-    struct string_impl {
-        static inline v8::Local<v8::String> New(v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::New(isolate, values))...>::concat(isolate, string_value_impl<T>::New(isolate, values)...);
-        };
-        static inline v8::MaybeLocal<v8::String> Create(v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::Create(isolate, values))...>::concat(isolate, string_value_impl<T>::Create(isolate, values)...);
-        };
-        static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, T... values) {
-            auto isolate = context->GetIsolate();
-            return string_impl_context_isolate<T...>::Create(context, isolate, values...);
-        };
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, T... values) {
-            auto isolate = context->GetIsolate();
-            return string_impl_context_isolate<T...>::ToString(context, isolate, values...);
-        };
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, T... values) {
-            auto isolate = context->GetIsolate();
-            return string_impl_context_isolate<T...>::ToDetailString(context, isolate, values...);
-        };
-        /* static inline v8::MaybeLocal<v8::String> Create(v8::Local<v8::Context> context, v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::Create(context, isolate, values))...>::concat(isolate, string_value_impl<T>::Create(context, isolate, values)...);
-        };
-        static inline v8::MaybeLocal<v8::String> ToString(v8::Local<v8::Context> context, v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::ToString(context, isolate, values))...>::concat(isolate, string_value_impl<T>::ToString(context, isolate, values)...);
-        };
-        static inline v8::MaybeLocal<v8::String> ToDetailString(v8::Local<v8::Context> context, v8::Isolate* isolate, T... values) {
-            return string_concat_impl<decltype(string_value_impl<T>::ToDetailString(context, isolate, values))...>::concat(isolate, string_value_impl<T>::ToDetailString(context, isolate, values)...);
-        }; */
-    };
-
-    template<typename ... T>
-    constexpr v8::Local<v8::String> String::New(v8::Isolate* isolate, const T& ... args) {
-        return string_impl<string_type_t<const T&>...>::New(isolate, static_cast<string_type_t<const T&>>(args)...);
-    }
-
-    template<typename ... T>
-    constexpr v8::MaybeLocal<v8::String> String::Create(v8::Isolate* isolate, const T& ... args) {
-        return string_impl<string_type_t<const T&>...>::Create(isolate, static_cast<string_type_t<const T&>>(args)...);
-    }
-
-    template<typename ... T>
-    constexpr v8::MaybeLocal<v8::String> String::Create(v8::Local<v8::Context> context, const T& ... args) {
-        return string_impl<string_type_t<const T&>...>::Create(context, static_cast<string_type_t<const T&>>(args)...);
-    }
-
-    template<typename ... T>
-    constexpr v8::MaybeLocal<v8::String> String::ToString(v8::Local<v8::Context> context, const T& ... args) {
-        return string_impl<string_type_t<const T&>...>::ToString(context, static_cast<string_type_t<const T&>>(args)...);
-    }
-
-    template<typename ... T>
-    constexpr v8::MaybeLocal<v8::String> String::ToDetailString(v8::Local<v8::Context> context, const T& ... args) {
-        return string_impl<string_type_t<const T&>...>::ToDetailString(context, static_cast<string_type_t<const T&>>(args)...);
-    }
-
     template<typename T, typename ... S>
     struct error_message_impl;
 
@@ -1,12 +1,15 @@
 #include "js-string-table.hxx"
 
 #include <map>
+#include <string>
 #include "js-helper.hxx"
 
 namespace js {
     using string_map_t = std::map<const char *, Shared<v8::String>>;
+    using named_string_map_t = std::map<std::string, Shared<v8::String>, std::less<>>;
     namespace {
-        std::map<v8::Isolate *, string_map_t> per_isolate_string_map;
+        thread_local std::map<v8::Isolate *, string_map_t> per_isolate_string_map;
+        thread_local std::map<v8::Isolate *, named_string_map_t> per_isolate_named_string_map;
     }
 
     void StringTable::initialize(v8::Isolate *isolate) {
@@ -20,10 +23,29 @@ namespace js {
 
     void StringTable::uninitialize(v8::Isolate *isolate) {
         per_isolate_string_map.erase(isolate);
+        per_isolate_named_string_map.erase(isolate);
+    }
+
+    v8::MaybeLocal<v8::String> StringTable::Get(v8::Isolate *isolate, std::string_view string) {
+        auto &string_map = per_isolate_named_string_map[isolate];
+        auto string_node = string_map.find(string);
+        if (string_node != string_map.end()) {
+            return string_node->second.Get(isolate);
+        }
+        v8::Local<v8::String> js_str;
+        if (!v8::String::NewFromUtf8(isolate, string.data(), v8::NewStringType::kInternalized, static_cast<int>(string.size())).ToLocal(&js_str)) {
+            return {};
+        }
+        string_map.emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(string),
+            std::forward_as_tuple(isolate, js_str)
+        );
+        return js_str;
     }
 
     v8::Local<v8::String> StringTable::find_in_map(v8::Isolate *isolate, const char *string) {
-        auto string_map = per_isolate_string_map[isolate];
+        auto &string_map = per_isolate_string_map[isolate];
         auto string_node = string_map.find(string);
         if (string_node == string_map.end()) {
             return {};
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <cstdint>
+#include <string_view>
 #include <v8.h>
 
 namespace js {
@@ -22,6 +23,14 @@ namespace js {
             return js_str;
         }
 
+        /**
+         * @brief The internalized string of a name known only at runtime (e.g. a member of a dictionary built from JavaScript).
+         *
+         * The strings are kept by content until uninitialize(), so this is meant for tables of names built once and used many
+         * times, not for arbitrary values.
+         */
+        static v8::MaybeLocal<v8::String> Get(v8::Isolate *isolate, std::string_view string);
+
     private:
         static v8::Local<v8::String> find_in_map(v8::Isolate *isolate, const char *string);
         static void insert_in_map(v8::Isolate *isolate, const char *c_str, v8::Local<v8::String> js_str);
@@ -1,35 +1,233 @@
+#include "main.hxx"
+
 #include <node.h>
 #include <v8.h>
 #include "js-helper.hxx"
 #include "js-string-table.hxx"
+#include "compile-policy.hxx"
 #include "api/private.hxx"
 #include "api/frozen-map.hxx"
 #include "api/context.hxx"
+#include "api/security-scope.hxx"
+#include "api/membrane.hxx"
+#include "api/isolate-pool.hxx"
+#include "api/scheduler.hxx"
+#include "api/profiler.hxx"
+#include "api/trace.hxx"
+#include "api/webidl.hxx"
+#include "api/idl-converter.hxx"
+#include "api/error-stack.hxx"
+#include "api/mapped-source.hxx"
+#include "api/module.hxx"
+#include "api/script.hxx"
+#include "api/template.hxx"
 #include "api/function-template.hxx"
 #include "api/object-template.hxx"
+#include "api/interface-registry.hxx"
 
 namespace {
     using callback_t = void (*)(void*);
+}
 
+namespace dragiyski::node_ext {
     v8::Maybe<void> initialize(v8::Local<v8::Context> context) {
         auto isolate = context->GetIsolate();
         js::StringTable::initialize(isolate);
+        dragiyski::node_ext::CompilePolicy::initialize(isolate);
         dragiyski::node_ext::Private::initialize(isolate);
         dragiyski::node_ext::Context::initialize(isolate);
         dragiyski::node_ext::FrozenMap::initialize(isolate);
+        dragiyski::node_ext::Template::initialize(isolate);
         dragiyski::node_ext::FunctionTemplate::initialize(isolate);
         dragiyski::node_ext::ObjectTemplate::initialize(isolate);
+        dragiyski::node_ext::SecurityScope::initialize(isolate);
+        dragiyski::node_ext::Membrane::initialize(isolate);
+        dragiyski::node_ext::IsolatePool::initialize(isolate);
+        dragiyski::node_ext::Scheduler::initialize(isolate);
+        dragiyski::node_ext::Profiler::initialize(isolate);
+        dragiyski::node_ext::Trace::initialize(isolate);
+        dragiyski::node_ext::WebIDL::initialize(isolate);
+        dragiyski::node_ext::IDLConverter::initialize(isolate);
+        dragiyski::node_ext::ErrorStack::initialize(isolate);
+        dragiyski::node_ext::MappedSource::initialize(isolate);
+        dragiyski::node_ext::Module::initialize(isolate);
+        dragiyski::node_ext::Script::initialize(isolate);
+        dragiyski::node_ext::InterfaceRegistry::initialize(isolate);
         return v8::JustVoid();
     }
 
     void uninitialize(v8::Isolate* isolate) {
+        dragiyski::node_ext::InterfaceRegistry::uninitialize(isolate);
+        dragiyski::node_ext::Script::uninitialize(isolate);
+        dragiyski::node_ext::Module::uninitialize(isolate);
+        dragiyski::node_ext::MappedSource::uninitialize(isolate);
+        dragiyski::node_ext::ErrorStack::uninitialize(isolate);
+        dragiyski::node_ext::IDLConverter::uninitialize(isolate);
+        dragiyski::node_ext::WebIDL::uninitialize(isolate);
+        dragiyski::node_ext::Trace::uninitialize(isolate);
+        dragiyski::node_ext::Profiler::uninitialize(isolate);
+        dragiyski::node_ext::Scheduler::uninitialize(isolate);
+        dragiyski::node_ext::IsolatePool::uninitialize(isolate);
+        dragiyski::node_ext::Membrane::uninitialize(isolate);
+        dragiyski::node_ext::SecurityScope::uninitialize(isolate);
         dragiyski::node_ext::ObjectTemplate::uninitialize(isolate);
         dragiyski::node_ext::FunctionTemplate::uninitialize(isolate);
+        dragiyski::node_ext::Template::uninitialize(isolate);
         dragiyski::node_ext::FrozenMap::uninitialize(isolate);
         dragiyski::node_ext::Context::uninitialize(isolate);
         dragiyski::node_ext::Private::uninitialize(isolate);
+        dragiyski::node_ext::CompilePolicy::uninitialize(isolate);
         js::StringTable::uninitialize(isolate);
     }
+
+    v8::Maybe<void> initialize_exports(v8::Local<v8::Context> context, v8::Local<v8::Object> exports) {
+        static const constexpr auto __function_return_type__ = v8::Nothing<void>;
+        auto isolate = context->GetIsolate();
+        {
+            auto name = js::StringTable::Get(isolate, "Private");
+            auto class_template = Private::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Context");
+            auto class_template = Context::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Template");
+            auto class_template = Template::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "FunctionTemplate");
+            auto class_template = FunctionTemplate::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "ObjectTemplate");
+            auto class_template = ObjectTemplate::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "SecurityScope");
+            auto class_template = SecurityScope::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Membrane");
+            auto class_template = Membrane::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "IsolatePool");
+            auto class_template = IsolatePool::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Scheduler");
+            auto class_template = Scheduler::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Profiler");
+            auto class_template = Profiler::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Trace");
+            auto class_template = Trace::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "WebIDL");
+            auto class_template = WebIDL::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "idl");
+            JS_EXPRESSION_RETURN(value, IDLConverter::create_namespace(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "createError");
+            auto function_template = ErrorStack::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, function_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "MappedSource");
+            auto class_template = MappedSource::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Module");
+            auto class_template = Module::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "Script");
+            auto class_template = Script::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            auto name = js::StringTable::Get(isolate, "InterfaceRegistry");
+            auto class_template = InterfaceRegistry::get_template(isolate);
+            JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+        {
+            v8::Local<v8::Name> names[] = {
+                StringTable::Get(isolate, "NONE"),
+                StringTable::Get(isolate, "DONT_DELETE"),
+                StringTable::Get(isolate, "DONT_ENUM"),
+                StringTable::Get(isolate, "READ_ONLY")
+            };
+            v8::Local<v8::Value> values[] = {
+                v8::Integer::New(isolate, v8::PropertyAttribute::None),
+                v8::Integer::New(isolate, v8::PropertyAttribute::DontDelete),
+                v8::Integer::New(isolate, v8::PropertyAttribute::DontEnum),
+                v8::Integer::New(isolate, v8::PropertyAttribute::ReadOnly)
+            };
+            auto value = v8::Object::New(isolate, v8::Null(isolate), names, values, 4);
+            JS_EXPRESSION_IGNORE(value->SetIntegrityLevel(context, v8::IntegrityLevel::kFrozen));
+            auto name = StringTable::Get(isolate, "propertyAttribute");
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+
+        {
+            v8::Local<v8::Name> names[] = {
+                StringTable::Get(isolate, "HAS_NO_SIDE_EFFECTS"),
+                StringTable::Get(isolate, "HAS_SIDE_EFFECTS"),
+                StringTable::Get(isolate, "HAS_SIDE_EFFECTS_TO_RECEIVER")
+            };
+            v8::Local<v8::Value> values[] = {
+                v8::Integer::New(isolate, static_cast<int32_t>(v8::SideEffectType::kHasNoSideEffect)),
+                v8::Integer::New(isolate, static_cast<int32_t>(v8::SideEffectType::kHasSideEffect)),
+                v8::Integer::New(isolate, static_cast<int32_t>(v8::SideEffectType::kHasSideEffectToReceiver))
+            };
+            auto value = v8::Object::New(isolate, v8::Null(isolate), names, values, 3);
+            JS_EXPRESSION_IGNORE(value->SetIntegrityLevel(context, v8::IntegrityLevel::kFrozen));
+            auto name = StringTable::Get(isolate, "sideEffectType");
+            JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
+        }
+
+        return v8::JustVoid();
+    }
 }
 
 #pragma GCC diagnostic push
@@ -50,57 +248,5 @@ NODE_MODULE_INIT() {
     auto node_env = node::GetCurrentEnvironment(context);
     node::AtExit(node_env, reinterpret_cast<callback_t>(uninitialize), isolate);
 
-    {
-        auto name = js::StringTable::Get(isolate, "Private");
-        auto class_template = Private::get_template(isolate);
-        JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
-        JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
-    }
-    {
-        auto name = js::StringTable::Get(isolate, "Context");
-        auto class_template = Context::get_template(isolate);
-        JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
-        JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
-    }
-    {
-        auto name = js::StringTable::Get(isolate, "FunctionTemplate");
-        auto class_template = FunctionTemplate::get_template(isolate);
-        JS_EXPRESSION_RETURN(value, class_template->GetFunction(context));
-        JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
-    }
-    {
-        v8::Local<v8::Name> names[] = {
-            StringTable::Get(isolate, "NONE"),
-            StringTable::Get(isolate, "DONT_DELETE"),
-            StringTable::Get(isolate, "DONT_ENUM"),
-            StringTable::Get(isolate, "READ_ONLY")
-        };
-        v8::Local<v8::Value> values[] = {
-            v8::Integer::New(isolate, v8::PropertyAttribute::None),
-            v8::Integer::New(isolate, v8::PropertyAttribute::DontDelete),
-            v8::Integer::New(isolate, v8::PropertyAttribute::DontEnum),
-            v8::Integer::New(isolate, v8::PropertyAttribute::ReadOnly)
-        };
-        auto value = v8::Object::New(isolate, v8::Null(isolate), names, values, 4);
-        JS_EXPRESSION_IGNORE(value->SetIntegrityLevel(context, v8::IntegrityLevel::kFrozen));
-        auto name = StringTable::Get(isolate, "propertyAttribute");
-        JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
-    }
-
-    {
-        v8::Local<v8::Name> names[] = {
-            StringTable::Get(isolate, "HAS_NO_SIDE_EFFECTS"),
-            StringTable::Get(isolate, "HAS_SIDE_EFFECTS"),
-            StringTable::Get(isolate, "HAS_SIDE_EFFECTS_TO_RECEIVER")
-        };
-        v8::Local<v8::Value> values[] = {
-            v8::Integer::New(isolate, static_cast<int32_t>(v8::SideEffectType::kHasNoSideEffect)),
-            v8::Integer::New(isolate, static_cast<int32_t>(v8::SideEffectType::kHasSideEffect)),
-            v8::Integer::New(isolate, static_cast<int32_t>(v8::SideEffectType::kHasSideEffectToReceiver))
-        };
-        auto value = v8::Object::New(isolate, v8::Null(isolate), names, values, 3);
-        JS_EXPRESSION_IGNORE(value->SetIntegrityLevel(context, v8::IntegrityLevel::kFrozen));
-        auto name = StringTable::Get(isolate, "sideEffectType");
-        JS_EXPRESSION_IGNORE(exports->DefineOwnProperty(context, name, value, JS_PROPERTY_ATTRIBUTE_STATIC));
-    }
-}
\ No newline at end of file
+    JS_EXPRESSION_IGNORE(initialize_exports(context, exports));
+}
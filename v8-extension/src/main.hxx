@@ -0,0 +1,23 @@
+#ifndef NODE_EXT_MAIN_HXX
+#define NODE_EXT_MAIN_HXX
+
+#include <v8.h>
+
+namespace dragiyski::node_ext {
+    /**
+     * @brief Initialize the per-isolate state (string table, templates, symbols) of all classes of the addon.
+     *
+     * Called once per isolate: for the isolate loading the module and for each isolate started by an IsolatePool.
+     */
+    v8::Maybe<void> initialize(v8::Local<v8::Context> context);
+    /**
+     * @brief Release the per-isolate state, in the reverse order of initialize().
+     */
+    void uninitialize(v8::Isolate *isolate);
+    /**
+     * @brief Define the classes and the constants of the addon as properties of exports.
+     */
+    v8::Maybe<void> initialize_exports(v8::Local<v8::Context> context, v8::Local<v8::Object> exports);
+}
+
+#endif /* NODE_EXT_MAIN_HXX */
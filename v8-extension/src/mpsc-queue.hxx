@@ -0,0 +1,62 @@
+#ifndef JS_MPSC_QUEUE_HXX
+#define JS_MPSC_QUEUE_HXX
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace js {
+    /**
+     * @brief Unbounded lock-free multi-producer single-consumer queue (intrusive linked list with a stub node).
+     *
+     * push() may be called from any thread and never blocks (one atomic exchange). pop() must be called from a single consumer thread
+     * at a time. A push in progress on another thread may not be visible to pop() yet; producers are expected to wake the consumer
+     * after push() returns (for example with uv_async_send()), so that the consumer checks the queue again.
+     */
+    template<typename T>
+    class MpscQueue {
+    private:
+        struct Node {
+            std::atomic<Node *> next = nullptr;
+            std::optional<T> value;
+        };
+    public:
+        void push(T value) {
+            auto node = new Node();
+            node->value.emplace(std::move(value));
+            auto previous = _head.exchange(node, std::memory_order_acq_rel);
+            previous->next.store(node, std::memory_order_release);
+        }
+
+        std::optional<T> pop() {
+            auto tail = _tail;
+            auto next = tail->next.load(std::memory_order_acquire);
+            if (next == nullptr) {
+                return std::nullopt;
+            }
+            // The next node becomes the stub; its value is moved out.
+            _tail = next;
+            std::optional<T> value(std::move(next->value));
+            next->value.reset();
+            delete tail;
+            return value;
+        }
+
+        bool empty() const {
+            return _tail->next.load(std::memory_order_acquire) == nullptr;
+        }
+    public:
+        MpscQueue() : _head(new Node()), _tail(_head.load(std::memory_order_relaxed)) {}
+        MpscQueue(const MpscQueue &) = delete;
+        MpscQueue(MpscQueue &&) = delete;
+        ~MpscQueue() {
+            while (pop().has_value()) {}
+            delete _tail;
+        }
+    private:
+        std::atomic<Node *> _head;
+        Node *_tail;
+    };
+}
+
+#endif /* JS_MPSC_QUEUE_HXX */
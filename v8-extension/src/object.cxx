@@ -1,4 +1,5 @@
 #include "object.hxx"
+#include "trace.hxx"
 
 namespace js {
     void ObjectBase::set_interface(v8::Isolate* isolate, v8::Local<v8::Object> target) {
@@ -18,6 +19,7 @@ namespace js {
     }
 
     void ObjectBase::weak_callback(const v8::WeakCallbackInfo<ObjectBase>& info) {
+        JS_TRACE_SCOPE("object", "ObjectBase::weak_callback");
         auto isolate = info.GetIsolate();
         auto object = info.GetParameter();
         object->on_interface_gc(isolate);
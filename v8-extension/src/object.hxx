@@ -39,7 +39,8 @@ namespace js {
     template<class Class>
     class Object : public virtual ObjectBase {
     private:
-        static std::map<v8::Isolate *, std::set<Object<Class> *>> per_isolate_object_set;
+        // Each isolate is used by a single thread, so the set of the isolate is thread-local.
+        static std::map<v8::Isolate *, std::set<Object<Class> *>> &per_isolate_object_set();
 
     public:
         static void initialize(v8::Isolate *isolate);
@@ -54,6 +55,8 @@ namespace js {
         static Class *get_implementation(v8::Isolate *isolate, v8::Local<v8::Object> target);
         static Class *get_own_implementation(v8::Isolate *isolate, v8::Local<v8::Object> target);
         static bool is_implementation(v8::Isolate *isolate, const Class *);
+        // The implementations attached to an interface in the isolate.
+        static const std::set<Object<Class> *> &get_implementations(v8::Isolate *isolate);
 
     protected:
         Object() = default;
@@ -65,12 +68,15 @@ namespace js {
     };
 
     template<class Class>
-    std::map<v8::Isolate *, std::set<Object<Class> *>> Object<Class>::per_isolate_object_set;
+    inline std::map<v8::Isolate *, std::set<Object<Class> *>> &Object<Class>::per_isolate_object_set() {
+        static thread_local std::map<v8::Isolate *, std::set<Object<Class> *>> object_set;
+        return object_set;
+    }
 
     template<class Class>
     inline void Object<Class>::initialize(v8::Isolate *isolate) {
-        assert(!per_isolate_object_set.contains(isolate));
-        per_isolate_object_set.emplace(
+        assert(!per_isolate_object_set().contains(isolate));
+        per_isolate_object_set().emplace(
             std::piecewise_construct,
             std::forward_as_tuple(isolate),
             std::forward_as_tuple()
@@ -79,34 +85,39 @@ namespace js {
 
     template<class Class>
     inline void Object<Class>::uninitialize(v8::Isolate *isolate) {
-        assert(per_isolate_object_set.contains(isolate));
-        for (auto *object : per_isolate_object_set[isolate]) {
+        assert(per_isolate_object_set().contains(isolate));
+        for (auto *object : per_isolate_object_set()[isolate]) {
             delete object;
         }
-        per_isolate_object_set.erase(isolate);
+        per_isolate_object_set().erase(isolate);
     }
 
     template<class Class>
     inline void Object<Class>::set_interface(v8::Isolate *isolate, v8::Local<v8::Object> target) {
         assert(!target.IsEmpty() && target->IsObject() && target->InternalFieldCount() >= 1);
-        assert(per_isolate_object_set.contains(isolate));
-        assert(!per_isolate_object_set[isolate].contains(this));
+        assert(per_isolate_object_set().contains(isolate));
+        assert(!per_isolate_object_set()[isolate].contains(this));
         target->SetAlignedPointerInInternalField(0, this);
-        per_isolate_object_set[isolate].insert(this);
+        per_isolate_object_set()[isolate].insert(this);
         ObjectBase::set_interface(isolate, target);
     }
 
     template<class Class>
     inline void Object<Class>::clear_interface(v8::Isolate *isolate) {
-        assert(per_isolate_object_set.contains(isolate));
-        per_isolate_object_set[isolate].erase(this);
+        assert(per_isolate_object_set().contains(isolate));
+        per_isolate_object_set()[isolate].erase(this);
+        // The interface may outlive the implementation, which must not be found through it if its memory is reused.
+        auto target = ObjectBase::get_interface(isolate);
+        if (!target.IsEmpty()) {
+            target->SetAlignedPointerInInternalField(0, nullptr);
+        }
         ObjectBase::clear_interface(isolate);
     }
 
     template<class Class>
     inline void Object<Class>::on_interface_gc(v8::Isolate *isolate) {
-        assert(per_isolate_object_set.contains(isolate));
-        per_isolate_object_set[isolate].erase(this);
+        assert(per_isolate_object_set().contains(isolate));
+        per_isolate_object_set()[isolate].erase(this);
         ObjectBase::on_interface_gc(isolate);
     }
 
@@ -119,7 +130,7 @@ namespace js {
                 value = object.As<v8::Proxy>()->GetTarget();
             } else if V8_LIKELY (object->InternalFieldCount() >= 1) {
                 auto interface = reinterpret_cast<Class *>(object->GetAlignedPointerFromInternalField(0));
-                if V8_LIKELY (per_isolate_object_set[isolate].contains(interface)) {
+                if V8_LIKELY (per_isolate_object_set()[isolate].contains(interface)) {
                     return interface;
                 }
                 // In case this is a wrapper of another type or from another library, we do not need to search the prototype anymore.
@@ -136,7 +147,7 @@ namespace js {
     inline Class *Object<Class>::get_own_implementation(v8::Isolate *isolate, v8::Local<v8::Object> target) {
         if V8_LIKELY (!target.IsEmpty() && target->IsObject() && target->InternalFieldCount() >= 1) {
             auto interface = reinterpret_cast<Class *>(target->GetAlignedPointerFromInternalField(0));
-            if V8_LIKELY (per_isolate_object_set[isolate].contains(interface)) {
+            if V8_LIKELY (per_isolate_object_set()[isolate].contains(interface)) {
                 return interface;
             }
         }
@@ -145,7 +156,13 @@ namespace js {
 
     template<class Class>
     inline bool Object<Class>::is_implementation(v8::Isolate *isolate, const Class *interface) {
-        return per_isolate_object_set[isolate].contains(interface);
+        return per_isolate_object_set()[isolate].contains(const_cast<Class *>(interface));
+    }
+
+    template<class Class>
+    inline const std::set<Object<Class> *> &Object<Class>::get_implementations(v8::Isolate *isolate) {
+        assert(per_isolate_object_set().contains(isolate));
+        return per_isolate_object_set()[isolate];
     }
 
     v8::MaybeLocal<v8::String> type_of(v8::Local<v8::Context> context, v8::Local<v8::Value> value);
@@ -0,0 +1,158 @@
+#include "trace.hxx"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <uv.h>
+
+namespace js::trace {
+    std::atomic<bool> enabled = false;
+
+    namespace {
+        /**
+         * @brief Single-producer ring buffer; only the owner thread writes, exporters read under a sequence lock per slot.
+         *
+         * A slot holding the event with index i has sequence 2 * i + 2; while it is being written, the sequence is odd.
+         */
+        class Buffer {
+        public:
+            static const constexpr uint64_t capacity = 1 << 16;
+            struct Slot {
+                std::atomic<uint64_t> sequence = 0;
+                std::atomic<const char *> category = nullptr;
+                std::atomic<const char *> name = nullptr;
+                std::atomic<uint64_t> begin = 0;
+                std::atomic<uint64_t> end = 0;
+            };
+        public:
+            explicit Buffer(uint32_t thread_id) : slots(new Slot[capacity]), thread_id(thread_id) {}
+        public:
+            std::unique_ptr<Slot[]> slots;
+            // Written by the owner thread only.
+            std::atomic<uint64_t> head = 0;
+            // Events before this index were cleared; accessed under the registry mutex only.
+            uint64_t tail = 0;
+            std::atomic<bool> alive = true;
+            const uint32_t thread_id;
+        public:
+            void push(const char *category, const char *name, uint64_t begin, uint64_t end) {
+                auto index = head.load(std::memory_order_relaxed);
+                auto &slot = slots[index & (capacity - 1)];
+                slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.category.store(category, std::memory_order_relaxed);
+                slot.name.store(name, std::memory_order_relaxed);
+                slot.begin.store(begin, std::memory_order_relaxed);
+                slot.end.store(end, std::memory_order_relaxed);
+                slot.sequence.store(2 * index + 2, std::memory_order_release);
+                head.store(index + 1, std::memory_order_release);
+            }
+        };
+
+        class BufferHolder {
+        public:
+            ~BufferHolder() {
+                if (buffer) {
+                    buffer->alive.store(false, std::memory_order_release);
+                }
+            }
+        public:
+            std::shared_ptr<Buffer> buffer;
+        };
+
+        std::mutex registry_mutex;
+        std::vector<std::shared_ptr<Buffer>> registry;
+        uint32_t next_thread_id = 1;
+        thread_local BufferHolder thread_buffer;
+
+        Buffer &get_thread_buffer() {
+            if V8_UNLIKELY(!thread_buffer.buffer) {
+                std::lock_guard lock(registry_mutex);
+                thread_buffer.buffer = std::make_shared<Buffer>(next_thread_id++);
+                registry.push_back(thread_buffer.buffer);
+            }
+            return *thread_buffer.buffer;
+        }
+
+        void append_json_string(std::string &output, const char *value) {
+            output += '"';
+            for (auto c = value; *c != '\0'; ++c) {
+                if (*c == '"' || *c == '\\') {
+                    output += '\\';
+                    output += *c;
+                } else if (static_cast<unsigned char>(*c) < 0x20) {
+                    output += ' ';
+                } else {
+                    output += *c;
+                }
+            }
+            output += '"';
+        }
+
+        void append_microseconds(std::string &output, uint64_t nanoseconds) {
+            auto fraction = std::to_string(nanoseconds % 1000);
+            output += std::to_string(nanoseconds / 1000);
+            output += '.';
+            output.append(3 - fraction.size(), '0');
+            output += fraction;
+        }
+    }
+
+    void record(const char *category, const char *name, uint64_t begin, uint64_t end) {
+        get_thread_buffer().push(category, name, begin, end);
+    }
+
+    std::string to_json() {
+        auto pid = std::to_string(uv_os_getpid());
+        std::string output = "{\"traceEvents\":[";
+        bool first = true;
+        std::lock_guard lock(registry_mutex);
+        for (auto &buffer : registry) {
+            auto tid = std::to_string(buffer->thread_id);
+            auto head = buffer->head.load(std::memory_order_acquire);
+            auto start = std::max(buffer->tail, head > Buffer::capacity ? head - Buffer::capacity : 0);
+            for (auto index = start; index < head; ++index) {
+                auto &slot = buffer->slots[index & (Buffer::capacity - 1)];
+                auto sequence = slot.sequence.load(std::memory_order_acquire);
+                auto category = slot.category.load(std::memory_order_relaxed);
+                auto name = slot.name.load(std::memory_order_relaxed);
+                auto begin = slot.begin.load(std::memory_order_relaxed);
+                auto end = slot.end.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence != 2 * index + 2 || slot.sequence.load(std::memory_order_relaxed) != sequence) {
+                    // Overwritten by the owner thread while reading.
+                    continue;
+                }
+                if (!first) {
+                    output += ',';
+                }
+                first = false;
+                output += "{\"name\":";
+                append_json_string(output, name);
+                output += ",\"cat\":";
+                append_json_string(output, category);
+                output += ",\"ph\":\"X\",\"ts\":";
+                append_microseconds(output, begin);
+                output += ",\"dur\":";
+                append_microseconds(output, end - begin);
+                output += ",\"pid\":";
+                output += pid;
+                output += ",\"tid\":";
+                output += tid;
+                output += '}';
+            }
+        }
+        output += "]}";
+        return output;
+    }
+
+    void clear() {
+        std::lock_guard lock(registry_mutex);
+        std::erase_if(registry, [](const std::shared_ptr<Buffer> &buffer) {
+            return !buffer->alive.load(std::memory_order_acquire);
+        });
+        for (auto &buffer : registry) {
+            buffer->tail = buffer->head.load(std::memory_order_acquire);
+        }
+    }
+}
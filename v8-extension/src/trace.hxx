@@ -0,0 +1,95 @@
+#ifndef JS_TRACE_HXX
+#define JS_TRACE_HXX
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <v8config.h>
+
+/**
+ * @brief Records the lifetime of the enclosing block as a trace event.
+ *
+ * The category and the name must be string literals (only the pointers are stored). When the extension is built without
+ * NODE_EXT_TRACE the macro expands to nothing. Otherwise, while tracing is stopped, the cost is one relaxed load and one
+ * predictable branch on entry and one on exit.
+ *
+ * Example Usage:
+ * void MyClass::callback(const v8::FunctionCallbackInfo<v8::Value> &info) {
+ *     JS_TRACE_SCOPE("my-category", "MyClass::callback");
+ *     // ... code goes here
+ * }
+ */
+#ifdef NODE_EXT_TRACE
+#define JS_TRACE_SCOPE(category, name) ::js::trace::Scope JS_TRACE_SCOPE_NAME(__trace_scope_, __LINE__)(category, name)
+#define JS_TRACE_SCOPE_NAME(prefix, line) JS_TRACE_SCOPE_NAME_CONCAT(prefix, line)
+#define JS_TRACE_SCOPE_NAME_CONCAT(prefix, line) prefix##line
+#else
+#define JS_TRACE_SCOPE(category, name)
+#endif
+
+namespace js::trace {
+    /**
+     * @brief Whether trace events are recorded; shared by all threads.
+     */
+    extern std::atomic<bool> enabled;
+
+    /**
+     * @brief Whether the extension was built with NODE_EXT_TRACE (JS_TRACE_SCOPE records anything at all).
+     */
+    constexpr bool available() {
+#ifdef NODE_EXT_TRACE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Append a complete event to the ring buffer of the calling thread.
+     *
+     * The buffer is allocated and registered on the first call on each thread; later calls do not lock or allocate. When the
+     * buffer is full, the oldest events are overwritten.
+     */
+    void record(const char *category, const char *name, uint64_t begin, uint64_t end);
+
+    /**
+     * @brief Serialize the events of all threads as Chrome trace-event JSON ({"traceEvents":[...]}).
+     *
+     * Suitable for chrome://tracing, Perfetto and speedscope. May be called while other threads are recording; an event being
+     * overwritten while it is read is skipped.
+     */
+    std::string to_json();
+
+    /**
+     * @brief Discard the recorded events and release the buffers of threads that have exited.
+     */
+    void clear();
+
+    class Scope {
+    public:
+        Scope(const char *category, const char *name) : _category(category), _name(name) {
+            if V8_UNLIKELY(enabled.load(std::memory_order_relaxed)) {
+                _begin = now();
+            }
+        }
+        ~Scope() {
+            if V8_UNLIKELY(_begin != 0) {
+                record(_category, _name, _begin, now());
+            }
+        }
+        Scope(const Scope &) = delete;
+        Scope(Scope &&) = delete;
+    private:
+        const char *_category;
+        const char *_name;
+        uint64_t _begin = 0;
+    };
+}
+
+#endif /* JS_TRACE_HXX */
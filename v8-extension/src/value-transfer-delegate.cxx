@@ -0,0 +1,102 @@
+#include "value-transfer-delegate.hxx"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace dragiyski::node_ext {
+    namespace {
+        // Larger buffers are released after use instead of being kept by the arena.
+        const constexpr std::size_t arena_retain_limit = 16 * 1024 * 1024;
+    }
+
+    struct TransferSerializerDelegate::Arena {
+        void *data = nullptr;
+        std::size_t capacity = 0;
+        bool in_use = false;
+    public:
+        ~Arena() {
+            std::free(data);
+        }
+    };
+
+    namespace {
+        // Serialization is synchronous, so a single buffer per thread suffices. A nested transfer (e.g. from a getter invoked
+        // by the serializer) finds the arena in use and falls back to realloc()/free().
+        thread_local TransferSerializerDelegate::Arena serializer_arena;
+    }
+
+    TransferSerializerDelegate::TransferSerializerDelegate(v8::Isolate *isolate) : _isolate(isolate) {
+        if (!serializer_arena.in_use) {
+            serializer_arena.in_use = true;
+            _arena = &serializer_arena;
+        }
+    }
+
+    TransferSerializerDelegate::~TransferSerializerDelegate() {
+        if (_arena != nullptr) {
+            if (_arena->capacity > arena_retain_limit) {
+                std::free(_arena->data);
+                _arena->data = nullptr;
+                _arena->capacity = 0;
+            }
+            _arena->in_use = false;
+        }
+    }
+
+    void TransferSerializerDelegate::ThrowDataCloneError(v8::Local<v8::String> message) {
+        _isolate->ThrowException(v8::Exception::TypeError(message));
+    }
+
+    v8::Maybe<uint32_t> TransferSerializerDelegate::GetSharedArrayBufferId(v8::Isolate *isolate, v8::Local<v8::SharedArrayBuffer> shared_array_buffer) {
+        for (std::size_t i = 0; i < _shared_buffers.size(); ++i) {
+            if (_shared_buffers[i] == shared_array_buffer) {
+                return v8::Just(static_cast<uint32_t>(i));
+            }
+        }
+        _shared_buffers.push_back(shared_array_buffer);
+        return v8::Just(static_cast<uint32_t>(_shared_buffers.size() - 1));
+    }
+
+    void *TransferSerializerDelegate::ReallocateBufferMemory(void *old_buffer, std::size_t size, std::size_t *actual_size) {
+        if (_arena == nullptr) {
+            auto buffer = std::realloc(old_buffer, size);
+            *actual_size = size;
+            return buffer;
+        }
+        if (size > _arena->capacity) {
+            auto capacity = std::max(size, _arena->capacity * 2);
+            auto buffer = std::realloc(_arena->data, capacity);
+            if (buffer == nullptr) {
+                return nullptr;
+            }
+            _arena->data = buffer;
+            _arena->capacity = capacity;
+        }
+        *actual_size = _arena->capacity;
+        return _arena->data;
+    }
+
+    void TransferSerializerDelegate::FreeBufferMemory(void *buffer) {
+        if (_arena == nullptr || buffer != _arena->data) {
+            std::free(buffer);
+        }
+    }
+
+    const std::vector<v8::Local<v8::SharedArrayBuffer>> &TransferSerializerDelegate::get_shared_buffers() const {
+        return _shared_buffers;
+    }
+
+    TransferDeserializerDelegate::TransferDeserializerDelegate(const std::vector<v8::Local<v8::SharedArrayBuffer>> &shared_buffers) :
+        _shared_buffers(shared_buffers) {}
+
+    TransferDeserializerDelegate::~TransferDeserializerDelegate() = default;
+
+    v8::MaybeLocal<v8::SharedArrayBuffer> TransferDeserializerDelegate::GetSharedArrayBufferFromId(v8::Isolate *isolate, uint32_t clone_id) {
+        if V8_UNLIKELY(clone_id >= _shared_buffers.size()) {
+            isolate->ThrowException(v8::Exception::TypeError(v8::String::NewFromUtf8Literal(isolate, "Invalid SharedArrayBuffer id")));
+            return {};
+        }
+        // A new SharedArrayBuffer of the target context over the same memory.
+        return v8::SharedArrayBuffer::New(isolate, _shared_buffers[clone_id]->GetBackingStore());
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef NODE_EXT_VALUE_TRANSFER_DELEGATE_HXX
+#define NODE_EXT_VALUE_TRANSFER_DELEGATE_HXX
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <v8.h>
+
+namespace dragiyski::node_ext {
+    /**
+     * @brief Serializer delegate of transfer_value(): writes into a per-thread arena and collects the SharedArrayBuffers.
+     *
+     * The delegates are compiled without RTTI (as V8 is), since V8 does not export the typeinfo of the delegate interfaces.
+     * All virtual members are defined in value-transfer-delegate.cxx, so that the vtables are emitted only there.
+     */
+    class TransferSerializerDelegate : public v8::ValueSerializer::Delegate {
+    public:
+        struct Arena;
+    public:
+        explicit TransferSerializerDelegate(v8::Isolate *isolate);
+        TransferSerializerDelegate(const TransferSerializerDelegate &) = delete;
+        TransferSerializerDelegate(TransferSerializerDelegate &&) = delete;
+        virtual ~TransferSerializerDelegate() override;
+    public:
+        virtual void ThrowDataCloneError(v8::Local<v8::String> message) override;
+        virtual v8::Maybe<uint32_t> GetSharedArrayBufferId(v8::Isolate *isolate, v8::Local<v8::SharedArrayBuffer> shared_array_buffer) override;
+        virtual void *ReallocateBufferMemory(void *old_buffer, std::size_t size, std::size_t *actual_size) override;
+        virtual void FreeBufferMemory(void *buffer) override;
+    public:
+        const std::vector<v8::Local<v8::SharedArrayBuffer>> &get_shared_buffers() const;
+    private:
+        v8::Isolate *_isolate;
+        Arena *_arena = nullptr;
+        std::vector<v8::Local<v8::SharedArrayBuffer>> _shared_buffers;
+    };
+
+    /**
+     * @brief Deserializer delegate of transfer_value(): maps SharedArrayBuffer ids back to their backing stores.
+     */
+    class TransferDeserializerDelegate : public v8::ValueDeserializer::Delegate {
+    public:
+        explicit TransferDeserializerDelegate(const std::vector<v8::Local<v8::SharedArrayBuffer>> &shared_buffers);
+        TransferDeserializerDelegate(const TransferDeserializerDelegate &) = delete;
+        TransferDeserializerDelegate(TransferDeserializerDelegate &&) = delete;
+        virtual ~TransferDeserializerDelegate() override;
+    public:
+        virtual v8::MaybeLocal<v8::SharedArrayBuffer> GetSharedArrayBufferFromId(v8::Isolate *isolate, uint32_t clone_id) override;
+    private:
+        const std::vector<v8::Local<v8::SharedArrayBuffer>> &_shared_buffers;
+    };
+}
+
+#endif /* NODE_EXT_VALUE_TRANSFER_DELEGATE_HXX */
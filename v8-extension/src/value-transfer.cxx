@@ -0,0 +1,63 @@
+#include "value-transfer.hxx"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "error-message.hxx"
+#include "value-transfer-delegate.hxx"
+
+namespace dragiyski::node_ext {
+    v8::MaybeLocal<v8::Value> transfer_value(
+        v8::Local<v8::Context> context,
+        v8::Local<v8::Context> target_context,
+        v8::Local<v8::Value> value,
+        const std::vector<v8::Local<v8::ArrayBuffer>> &transfer_list
+    ) {
+        using __function_return_type__ = v8::MaybeLocal<v8::Value>;
+        auto isolate = context->GetIsolate();
+        v8::EscapableHandleScope scope(isolate);
+
+        for (std::size_t i = 0; i < transfer_list.size(); ++i) {
+            if V8_UNLIKELY(transfer_list[i]->WasDetached() || !transfer_list[i]->IsDetachable()) {
+                JS_THROW_ERROR(TypeError, isolate, "ArrayBuffer at index ", i, " of the transfer list cannot be transferred");
+            }
+            for (std::size_t j = 0; j < i; ++j) {
+                if V8_UNLIKELY(transfer_list[i] == transfer_list[j]) {
+                    JS_THROW_ERROR(TypeError, isolate, "ArrayBuffer at index ", i, " is a duplicate of an earlier ArrayBuffer");
+                }
+            }
+        }
+
+        TransferSerializerDelegate serializer_delegate(isolate);
+        v8::ValueSerializer serializer(isolate, &serializer_delegate);
+        for (std::size_t i = 0; i < transfer_list.size(); ++i) {
+            serializer.TransferArrayBuffer(static_cast<uint32_t>(i), transfer_list[i]);
+        }
+        serializer.WriteHeader();
+        JS_EXPRESSION_IGNORE(serializer.WriteValue(context, value));
+        auto [data, size] = serializer.Release();
+        // The buffer is returned to the arena (or freed) on every exit path below.
+        auto buffer = std::unique_ptr<uint8_t, std::function<void(uint8_t *)>>(data, [&serializer_delegate](uint8_t *data) {
+            serializer_delegate.FreeBufferMemory(data);
+        });
+
+        // Hand the memory of the transferred buffers over; the source buffers are detached only once serialization succeeded.
+        std::vector<std::shared_ptr<v8::BackingStore>> backing_stores;
+        backing_stores.reserve(transfer_list.size());
+        for (auto &array_buffer : transfer_list) {
+            backing_stores.push_back(array_buffer->GetBackingStore());
+            JS_EXPRESSION_IGNORE(array_buffer->Detach(v8::Local<v8::Value>()));
+        }
+
+        v8::Context::Scope target_scope(target_context);
+        TransferDeserializerDelegate deserializer_delegate(serializer_delegate.get_shared_buffers());
+        v8::ValueDeserializer deserializer(isolate, data, size, &deserializer_delegate);
+        for (std::size_t i = 0; i < backing_stores.size(); ++i) {
+            deserializer.TransferArrayBuffer(static_cast<uint32_t>(i), v8::ArrayBuffer::New(isolate, std::move(backing_stores[i])));
+        }
+        JS_EXPRESSION_IGNORE(deserializer.ReadHeader(target_context));
+        JS_EXPRESSION_RETURN(result, deserializer.ReadValue(target_context));
+        return scope.Escape(result);
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef NODE_EXT_VALUE_TRANSFER_HXX
+#define NODE_EXT_VALUE_TRANSFER_HXX
+
+#include <vector>
+#include <v8.h>
+#include "js-helper.hxx"
+
+namespace dragiyski::node_ext {
+    /**
+     * @brief Structured-clone a value into another context of the same isolate.
+     *
+     * The value is serialized in the current context with v8::ValueSerializer and deserialized in the target context, so the
+     * result shares no objects with the input. The wire buffer comes from a per-thread arena reused between calls.
+     * ArrayBuffers in the transfer list are not copied: their backing stores are handed over to new ArrayBuffers in the
+     * target context and the source buffers are detached. SharedArrayBuffers always share their backing store.
+     */
+    v8::MaybeLocal<v8::Value> transfer_value(
+        v8::Local<v8::Context> context,
+        v8::Local<v8::Context> target_context,
+        v8::Local<v8::Value> value,
+        const std::vector<v8::Local<v8::ArrayBuffer>> &transfer_list
+    );
+}
+
+#endif /* NODE_EXT_VALUE_TRANSFER_HXX */
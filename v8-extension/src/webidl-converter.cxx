@@ -0,0 +1,404 @@
+#include "webidl-converter.hxx"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "js-string-table.hxx"
+
+namespace dragiyski::node_ext::webidl {
+    bool Converter::is_nullable() const {
+        return false;
+    }
+
+    const Converter &Converter::inner() const {
+        return *this;
+    }
+
+    FunctionConverter::FunctionConverter(Category category, std::string name, ConvertFunction function) :
+        _category(category),
+        _name(std::move(name)),
+        _function(function) {}
+
+    Converter::Category FunctionConverter::category() const {
+        return _category;
+    }
+
+    const std::string &FunctionConverter::name() const {
+        return _name;
+    }
+
+    v8::MaybeLocal<v8::Value> FunctionConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        return _function(context, value, site, argument);
+    }
+
+    NullableConverter::NullableConverter(std::shared_ptr<const Converter> inner) :
+        _inner(std::move(inner)),
+        _name(_inner->name() + "?") {}
+
+    Converter::Category NullableConverter::category() const {
+        return _inner->category();
+    }
+
+    const std::string &NullableConverter::name() const {
+        return _name;
+    }
+
+    bool NullableConverter::is_nullable() const {
+        return true;
+    }
+
+    const Converter &NullableConverter::inner() const {
+        return *_inner;
+    }
+
+    v8::MaybeLocal<v8::Value> NullableConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        if (value->IsNullOrUndefined()) {
+            return v8::Null(context->GetIsolate());
+        }
+        return _inner->convert(context, value, site, argument);
+    }
+
+    SequenceConverter::SequenceConverter(std::shared_ptr<const Converter> element) :
+        _element(std::move(element)),
+        _name("sequence<" + _element->name() + ">") {}
+
+    Converter::Category SequenceConverter::category() const {
+        return Sequence;
+    }
+
+    const std::string &SequenceConverter::name() const {
+        return _name;
+    }
+
+    v8::MaybeLocal<v8::Value> SequenceConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        auto convert_element = [](const void *data, v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            return static_cast<const Converter *>(data)->convert(context, value, site, argument);
+        };
+        return to_sequence(context, value, site, argument, convert_element, _element.get());
+    }
+
+    EnumerationConverter::EnumerationConverter(v8::Isolate *isolate, std::string name, const std::vector<std::string> &values) :
+        _name(std::move(name)) {
+        _values.reserve(values.size());
+        for (const auto &value : values) {
+            auto string = StringTable::Get(isolate, std::string_view(value)).ToLocalChecked();
+            _values.emplace_back(isolate, string);
+        }
+    }
+
+    Converter::Category EnumerationConverter::category() const {
+        return Enumeration;
+    }
+
+    const std::string &EnumerationConverter::name() const {
+        return _name;
+    }
+
+    v8::MaybeLocal<v8::Value> EnumerationConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_RETURN(string, value->ToString(context));
+        for (const auto &item : _values) {
+            if (string->StringEquals(item.Get(isolate))) {
+                return string;
+            }
+        }
+        JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), "The provided value '", string, "' is not a valid enum value of type ", _name.c_str(), ".");
+    }
+
+    InterfaceConverter::InterfaceConverter(int definition) :
+        _definition(definition),
+        _name(definitions[definition].name) {}
+
+    Converter::Category InterfaceConverter::category() const {
+        return Interface;
+    }
+
+    const std::string &InterfaceConverter::name() const {
+        return _name;
+    }
+
+    v8::MaybeLocal<v8::Value> InterfaceConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        return to_interface(context, value, site, argument, _definition);
+    }
+
+    bool InterfaceConverter::is_instance(v8::Isolate *isolate, v8::Local<v8::Value> value) const {
+        return webidl::is_instance(isolate, _definition, value);
+    }
+
+    CallbackConverter::CallbackConverter(Category category, std::string name) :
+        _category(category),
+        _name(std::move(name)) {
+        assert(category == CallbackFunction || category == CallbackInterface);
+    }
+
+    Converter::Category CallbackConverter::category() const {
+        return _category;
+    }
+
+    const std::string &CallbackConverter::name() const {
+        return _name;
+    }
+
+    v8::MaybeLocal<v8::Value> CallbackConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        if (_category == CallbackFunction) {
+            return to_callback_function(context, value, site, argument, _name.c_str());
+        }
+        return to_callback_interface(context, value, site, argument, _name.c_str());
+    }
+
+    DictionaryConverter::DictionaryConverter(v8::Isolate *isolate, std::string name, std::shared_ptr<const DictionaryConverter> parent, std::vector<Member> members) :
+        _name(std::move(name)) {
+        if (parent) {
+            _members = parent->_members;
+        }
+        // The members of each dictionary in the inheritance chain are converted in lexicographic order of their names.
+        std::sort(members.begin(), members.end(), [](const Member &a, const Member &b) {
+            return a.name < b.name;
+        });
+        _members.reserve(_members.size() + members.size());
+        for (auto &member : members) {
+            auto key = StringTable::Get(isolate, std::string_view(member.name)).ToLocalChecked();
+            _members.push_back({ std::move(member), Shared<v8::String>(isolate, key) });
+        }
+    }
+
+    Converter::Category DictionaryConverter::category() const {
+        return Dictionary;
+    }
+
+    const std::string &DictionaryConverter::name() const {
+        return _name;
+    }
+
+    v8::MaybeLocal<v8::Value> DictionaryConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        bool is_object = value->IsObject();
+        if (!is_object && !value->IsNullOrUndefined()) {
+            return throw_not_of_type(isolate, site, argument, _name.c_str());
+        }
+        // The converted members are collected and the result is created with all of its properties at once, which is
+        // considerably cheaper than defining them one by one. The usual dictionary fits in the buffers on the stack.
+        // The shape has a bit for each member present in the result.
+        v8::Local<v8::Name> inline_names[inline_capacity];
+        v8::Local<v8::Value> inline_values[inline_capacity];
+        std::vector<v8::Local<v8::Name>> heap_names;
+        std::vector<v8::Local<v8::Value>> heap_values;
+        auto names = inline_names;
+        auto values = inline_values;
+        if V8_UNLIKELY(_members.size() > inline_capacity) {
+            heap_names.resize(_members.size());
+            heap_values.resize(_members.size());
+            names = heap_names.data();
+            values = heap_values.data();
+        }
+        std::size_t count = 0;
+        uint64_t shape = 0;
+        for (std::size_t index = 0; index < _members.size(); ++index) {
+            const auto &[member, key] = _members[index];
+            auto name = key.Get(isolate);
+            v8::Local<v8::Value> member_value;
+            if (is_object) {
+                JS_EXPRESSION_RETURN(property, value.As<v8::Object>()->Get(context, name));
+                member_value = property;
+            }
+            if (!member_value.IsEmpty() && !member_value->IsUndefined()) {
+                const Site member_site = { _name.c_str(), member.name.c_str(), Site::DictionaryMember, &site };
+                JS_EXPRESSION_RETURN(converted, member.type->convert(context, member_value, member_site, -1));
+                member_value = converted;
+            } else if (member.required) {
+                const Site member_site = { _name.c_str(), member.name.c_str(), Site::DictionaryMember, &site };
+                JS_THROW_ERROR(TypeError, isolate, format_prefix(member_site).c_str(), "Required member is undefined.");
+            } else if (member.default_kind == Member::DefaultValue) {
+                member_value = member.default_value.Get(isolate);
+            } else if (member.default_kind == Member::DefaultEmpty) {
+                const Site member_site = { _name.c_str(), member.name.c_str(), Site::DictionaryMember, &site };
+                JS_EXPRESSION_RETURN(converted, member.type->convert(context, v8::Undefined(isolate), member_site, -1));
+                member_value = converted;
+            } else if (member.default_kind == Member::DefaultEmptySequence) {
+                member_value = v8::Array::New(isolate);
+            } else {
+                continue;
+            }
+            names[count] = name;
+            values[count] = member_value;
+            ++count;
+            if (index < max_factory_members) {
+                shape |= uint64_t(1) << index;
+            }
+        }
+        if V8_UNLIKELY(_members.size() > max_factory_members) {
+            auto prototype = v8::Object::New(isolate)->GetPrototype();
+            return v8::Object::New(isolate, prototype, names, values, count);
+        }
+        JS_EXPRESSION_RETURN(factory, get_factory(context, shape, names, count));
+        return factory->Call(context, v8::Undefined(isolate), static_cast<int>(count), values);
+    }
+
+    v8::MaybeLocal<v8::Function> DictionaryConverter::get_factory(v8::Local<v8::Context> context, uint64_t shape, const v8::Local<v8::Name> *names, std::size_t count) const {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Function>(); };
+        auto isolate = context->GetIsolate();
+        Factories *factories = nullptr;
+        for (auto entry = _factories.begin(); entry != _factories.end();) {
+            if (entry->context.IsEmpty()) {
+                entry = _factories.erase(entry);
+            } else if (entry->context.Get(isolate) == context) {
+                factories = &*entry;
+                break;
+            } else {
+                ++entry;
+            }
+        }
+        if (factories != nullptr) {
+            auto function = factories->functions.find(shape);
+            if V8_LIKELY(function != factories->functions.end()) {
+                return function->second.Get(isolate);
+            }
+        } else {
+            factories = &_factories.emplace_back();
+            factories->context.Reset(isolate, context);
+            factories->context.SetWeak();
+        }
+
+        // function (a0, a1, ...) { return { "name0": a0, "name1": a1, ... }; }
+        // The keys are string literals, except "__proto__", which must be a computed key to define an own property.
+        auto proto_key = StringTable::Get(isolate, "__proto__");
+        std::vector<v8::Local<v8::String>> parameters;
+        parameters.reserve(count);
+        auto source = StringTable::Get(isolate, "return {");
+        for (std::size_t index = 0; index < count; ++index) {
+            JS_EXPRESSION_RETURN(suffix, v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(index))->ToString(context));
+            auto parameter = v8::String::Concat(isolate, StringTable::Get(isolate, "a"), suffix);
+            parameters.push_back(parameter);
+            JS_EXPRESSION_RETURN(literal, v8::JSON::Stringify(context, names[index]));
+            if (names[index]->StrictEquals(proto_key)) {
+                literal = v8::String::Concat(isolate, v8::String::Concat(isolate, StringTable::Get(isolate, "["), literal), StringTable::Get(isolate, "]"));
+            }
+            if (index > 0) {
+                source = v8::String::Concat(isolate, source, StringTable::Get(isolate, ","));
+            }
+            source = v8::String::Concat(isolate, source, literal);
+            source = v8::String::Concat(isolate, source, StringTable::Get(isolate, ":"));
+            source = v8::String::Concat(isolate, source, parameter);
+        }
+        source = v8::String::Concat(isolate, source, StringTable::Get(isolate, "};"));
+        v8::ScriptCompiler::Source compiler_source(source);
+        JS_EXPRESSION_RETURN(function, v8::ScriptCompiler::CompileFunction(context, &compiler_source, parameters.size(), parameters.data()));
+
+        // The functions are kept alive by the context, not by the converter: a converter outlives the contexts it is used in.
+        auto holder = context->GetExtrasBindingObject();
+        auto holder_key = v8::Private::ForApi(isolate, StringTable::Get(isolate, "webidl::DictionaryConverter"));
+        JS_EXPRESSION_RETURN(functions, holder->GetPrivate(context, holder_key));
+        if (!functions->IsArray()) {
+            functions = v8::Array::New(isolate);
+            JS_EXPRESSION_IGNORE(holder->SetPrivate(context, holder_key, functions));
+        }
+        auto array = functions.As<v8::Array>();
+        JS_EXPRESSION_IGNORE(array->Set(context, array->Length(), function));
+
+        auto &entry = factories->functions[shape];
+        entry.Reset(isolate, function);
+        entry.SetWeak();
+        return function;
+    }
+
+    UnionConverter::UnionConverter(std::vector<std::shared_ptr<const Converter>> members) {
+        // Built in a local: GCC 12 reports a false -Wrestrict for the inlined assignments to the member.
+        std::string name("(");
+        for (std::size_t index = 0; index < members.size(); ++index) {
+            if (index > 0) {
+                name.append(" or ");
+            }
+            name.append(members[index]->name());
+        }
+        name.push_back(')');
+        _name = std::move(name);
+        // The flattened member types: the members of the nested unions are members of the union.
+        for (auto &member : members) {
+            _nullable = _nullable || member->is_nullable();
+            if (member->category() == Union) {
+                auto nested = std::static_pointer_cast<const UnionConverter>(member);
+                _members.insert(_members.end(), nested->_members.begin(), nested->_members.end());
+            } else {
+                _members.push_back(std::move(member));
+            }
+        }
+    }
+
+    Converter::Category UnionConverter::category() const {
+        return Union;
+    }
+
+    const std::string &UnionConverter::name() const {
+        return _name;
+    }
+
+    bool UnionConverter::is_nullable() const {
+        return _nullable;
+    }
+
+    const Converter *UnionConverter::find(Category category) const {
+        for (const auto &member : _members) {
+            if (member->category() == category) {
+                return &member->inner();
+            }
+        }
+        return nullptr;
+    }
+
+    v8::MaybeLocal<v8::Value> UnionConverter::convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        if (value->IsNullOrUndefined()) {
+            if (_nullable) {
+                return v8::Null(isolate);
+            }
+            if (auto dictionary = find(Dictionary)) {
+                return dictionary->convert(context, value, site, argument);
+            }
+        }
+        if (value->IsObject()) {
+            for (const auto &member : _members) {
+                if (member->category() == Interface && static_cast<const InterfaceConverter &>(member->inner()).is_instance(isolate, value)) {
+                    return value;
+                }
+            }
+            if (auto callback = find(CallbackFunction); callback != nullptr && JS_IS_CALLABLE(value)) {
+                return value;
+            }
+            if (auto sequence = find(Sequence)) {
+                JS_EXPRESSION_RETURN(method, value.As<v8::Object>()->Get(context, v8::Symbol::GetIterator(isolate)));
+                if (!method->IsUndefined()) {
+                    return sequence->convert(context, value, site, argument);
+                }
+            }
+            for (auto category : { Dictionary, CallbackInterface }) {
+                if (auto member = find(category)) {
+                    return member->convert(context, value, site, argument);
+                }
+            }
+            if (find(Object) != nullptr) {
+                return value;
+            }
+        }
+        if (value->IsBoolean()) {
+            if (auto member = find(Boolean)) {
+                return member->convert(context, value, site, argument);
+            }
+        }
+        if (value->IsNumber()) {
+            if (auto member = find(Numeric)) {
+                return member->convert(context, value, site, argument);
+            }
+        }
+        for (auto category : { String, Enumeration, Numeric, Boolean }) {
+            if (auto member = find(category)) {
+                return member->convert(context, value, site, argument);
+            }
+        }
+        return throw_not_of_type(isolate, site, argument, _name.c_str());
+    }
+}
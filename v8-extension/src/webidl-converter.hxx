@@ -0,0 +1,237 @@
+#ifndef NODE_EXT_WEBIDL_CONVERTER_HXX
+#define NODE_EXT_WEBIDL_CONVERTER_HXX
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <v8.h>
+#include "js-helper.hxx"
+#include "webidl.hxx"
+
+/**
+ * The IDL types known at runtime: the dictionaries, unions and the other composite types of the .webidl files and the
+ * converters built from JavaScript with the "idl" namespace.
+ *
+ * A converter is built once per isolate and precompiles what its conversion needs: a dictionary holds its members sorted in
+ * lexicographic order with their names as internalized strings, so converting a dictionary reads the members by handle
+ * without creating or looking up a string.
+ */
+namespace dragiyski::node_ext::webidl {
+    using namespace js;
+
+    class Converter {
+    public:
+        /**
+         * @brief The category of the type, as distinguished by the union conversion.
+         */
+        enum Category {
+            Any,
+            Boolean,
+            Numeric,
+            String,
+            Object,
+            Interface,
+            CallbackFunction,
+            CallbackInterface,
+            Sequence,
+            Dictionary,
+            Enumeration,
+            Union
+        };
+    public:
+        virtual Category category() const = 0;
+        /**
+         * @brief The name of the type in the error messages.
+         */
+        virtual const std::string &name() const = 0;
+        virtual bool is_nullable() const;
+        /**
+         * @brief The converter of the type without the nullable flag.
+         */
+        virtual const Converter &inner() const;
+        virtual v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const = 0;
+    public:
+        virtual ~Converter() = default;
+    };
+
+    /**
+     * @brief A type converted by a function of webidl.hxx, e.g. &convert<idl::Long>.
+     */
+    class FunctionConverter : public Converter {
+    private:
+        Category _category;
+        std::string _name;
+        ConvertFunction _function;
+    public:
+        FunctionConverter(Category category, std::string name, ConvertFunction function);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+    };
+
+    class NullableConverter : public Converter {
+    private:
+        std::shared_ptr<const Converter> _inner;
+        std::string _name;
+    public:
+        explicit NullableConverter(std::shared_ptr<const Converter> inner);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        bool is_nullable() const override;
+        const Converter &inner() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+    };
+
+    class SequenceConverter : public Converter {
+    private:
+        std::shared_ptr<const Converter> _element;
+        std::string _name;
+    public:
+        explicit SequenceConverter(std::shared_ptr<const Converter> element);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+    };
+
+    class EnumerationConverter : public Converter {
+    private:
+        std::string _name;
+        std::vector<Shared<v8::String>> _values;
+    public:
+        EnumerationConverter(v8::Isolate *isolate, std::string name, const std::vector<std::string> &values);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+    };
+
+    /**
+     * @brief An interface of definitions; accepts the platform objects of any realm.
+     */
+    class InterfaceConverter : public Converter {
+    private:
+        int _definition;
+        std::string _name;
+    public:
+        explicit InterfaceConverter(int definition);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+        bool is_instance(v8::Isolate *isolate, v8::Local<v8::Value> value) const;
+    };
+
+    /**
+     * @brief A callback function (category CallbackFunction) or a callback interface (category CallbackInterface).
+     */
+    class CallbackConverter : public Converter {
+    private:
+        Category _category;
+        std::string _name;
+    public:
+        CallbackConverter(Category category, std::string name);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+    };
+
+    class DictionaryConverter : public Converter {
+    public:
+        struct Member {
+            std::string name;
+            std::shared_ptr<const Converter> type;
+            enum {
+                NoDefault,
+                DefaultValue,
+                /**
+                 * @brief The default "{}" of a dictionary member: the conversion of undefined.
+                 */
+                DefaultEmpty,
+                /**
+                 * @brief The default "[]" of a sequence member: a new empty array.
+                 */
+                DefaultEmptySequence
+            } default_kind = NoDefault;
+            /**
+             * @brief The converted default value, if default_kind is DefaultValue; a primitive value.
+             */
+            Shared<v8::Value> default_value;
+            bool required = false;
+        };
+    private:
+        struct CompiledMember {
+            Member member;
+            Shared<v8::String> key;
+        };
+        /**
+         * @brief The functions creating the results in a context, by the shape of the result (the members present in it).
+         *
+         * A function returns an object literal, so the results of the same shape share a map, which a result created through
+         * the API with all of its properties at once does not: that is a dictionary-mode object. The handles are weak; the
+         * functions are kept alive by the context.
+         */
+        struct Factories {
+            Shared<v8::Context> context;
+            std::map<uint64_t, Shared<v8::Function>> functions;
+        };
+    private:
+        static const constexpr std::size_t inline_capacity = 16;
+        /**
+         * @brief A dictionary with more members (in its inheritance chain) creates dictionary-mode results.
+         */
+        static const constexpr std::size_t max_factory_members = 64;
+    private:
+        std::string _name;
+        std::vector<CompiledMember> _members;
+        mutable std::vector<Factories> _factories;
+    public:
+        /**
+         * @brief The members of the parent dictionary, if any, are converted before the own members.
+         */
+        DictionaryConverter(v8::Isolate *isolate, std::string name, std::shared_ptr<const DictionaryConverter> parent, std::vector<Member> members);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+    private:
+        v8::MaybeLocal<v8::Function> get_factory(v8::Local<v8::Context> context, uint64_t shape, const v8::Local<v8::Name> *names, std::size_t count) const;
+    };
+
+    /**
+     * @brief A union type, converted by the algorithm of the specification: the member type is selected by the kind of the
+     * JavaScript value, then the value is converted to it.
+     */
+    class UnionConverter : public Converter {
+    private:
+        std::vector<std::shared_ptr<const Converter>> _members;
+        std::string _name;
+        bool _nullable = false;
+    public:
+        explicit UnionConverter(std::vector<std::shared_ptr<const Converter>> members);
+    public:
+        Category category() const override;
+        const std::string &name() const override;
+        bool is_nullable() const override;
+        v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) const override;
+    private:
+        const Converter *find(Category category) const;
+    };
+
+    /**
+     * @brief Build the converters of the composite types used by the generated bindings; defined by the generated code.
+     */
+    void create_converters(v8::Isolate *isolate, std::vector<std::shared_ptr<const Converter>> &converters);
+
+    /**
+     * @brief A converter built by create_converters() for the isolate.
+     */
+    const Converter &get_converter(v8::Isolate *isolate, std::size_t index);
+}
+
+#endif /* NODE_EXT_WEBIDL_CONVERTER_HXX */
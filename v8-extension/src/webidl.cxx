@@ -0,0 +1,410 @@
+#include "webidl.hxx"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "js-string-table.hxx"
+#include "webidl-converter.hxx"
+
+namespace dragiyski::node_ext::webidl {
+    namespace {
+        struct PerIsolate {
+            std::vector<Shared<v8::FunctionTemplate>> templates;
+            std::vector<int> template_definitions;
+            std::vector<std::vector<std::size_t>> definition_templates;
+            std::vector<std::shared_ptr<const Converter>> converters;
+        };
+
+        thread_local std::map<v8::Isolate *, PerIsolate> per_isolate;
+
+        std::string subject(int argument) {
+            return argument < 0 ? std::string("The provided value") : "parameter " + std::to_string(argument + 1);
+        }
+
+        const char *integer_type_name(int bit_length, bool is_signed) {
+            switch (bit_length) {
+                case 8:
+                    return is_signed ? "byte" : "octet";
+                case 16:
+                    return is_signed ? "short" : "unsigned short";
+                case 32:
+                    return is_signed ? "long" : "unsigned long";
+                default:
+                    return is_signed ? "long long" : "unsigned long long";
+            }
+        }
+
+        v8::MaybeLocal<v8::Number> to_finite(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, const char *type) {
+            static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Number>(); };
+            JS_EXPRESSION_RETURN(number, value->ToNumber(context));
+            if (!std::isfinite(number->Value())) {
+                JS_THROW_ERROR(TypeError, context->GetIsolate(), format_prefix(site).c_str(), "The provided ", type, " value is non-finite.");
+            }
+            return number;
+        }
+
+        bool is_lead_surrogate(uint16_t c) {
+            return c >= 0xD800 && c <= 0xDBFF;
+        }
+
+        bool is_trail_surrogate(uint16_t c) {
+            return c >= 0xDC00 && c <= 0xDFFF;
+        }
+    }
+
+    void initialize(v8::Isolate *isolate) {
+        assert(!per_isolate.contains(isolate));
+        auto &state = per_isolate[isolate];
+        state.definition_templates.resize(definition_count);
+        create_converters(isolate, state.converters);
+    }
+
+    void uninitialize(v8::Isolate *isolate) {
+        per_isolate.erase(isolate);
+    }
+
+    const Converter &get_converter(v8::Isolate *isolate, std::size_t index) {
+        assert(per_isolate.contains(isolate));
+        return *per_isolate[isolate].converters[index];
+    }
+
+    int find_definition(const char *name) {
+        for (std::size_t index = 0; index < definition_count; ++index) {
+            if (std::strcmp(definitions[index].name, name) == 0) {
+                return static_cast<int>(index);
+            }
+        }
+        return -1;
+    }
+
+    std::size_t register_template(v8::Isolate *isolate, int definition, v8::Local<v8::FunctionTemplate> value) {
+        assert(per_isolate.contains(isolate));
+        auto &state = per_isolate[isolate];
+        auto index = state.templates.size();
+        state.templates.emplace_back(isolate, value);
+        state.template_definitions.push_back(definition);
+        state.definition_templates[definition].push_back(index);
+        return index;
+    }
+
+    v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate, std::size_t index) {
+        assert(per_isolate.contains(isolate));
+        return per_isolate[isolate].templates[index].Get(isolate);
+    }
+
+    int get_template_definition(v8::Isolate *isolate, std::size_t index) {
+        assert(per_isolate.contains(isolate));
+        return per_isolate[isolate].template_definitions[index];
+    }
+
+    bool is_instance(v8::Isolate *isolate, int definition, v8::Local<v8::Value> value) {
+        if (!value->IsObject()) {
+            return false;
+        }
+        auto &state = per_isolate[isolate];
+        for (auto index : state.definition_templates[definition]) {
+            if (state.templates[index].Get(isolate)->HasInstance(value)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    namespace {
+        /**
+         * @brief A function in the own property descriptor of the implementation, e.g. its "value" or "get".
+         */
+        v8::MaybeLocal<v8::Function> get_descriptor_function(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, const char *interface_name, const char *name, v8::Local<v8::String> field, const char *description) {
+            static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Function>(); };
+            auto isolate = context->GetIsolate();
+            JS_EXPRESSION_RETURN(key, v8::String::NewFromUtf8(isolate, name, v8::NewStringType::kInternalized));
+            JS_EXPRESSION_RETURN(descriptor, implementation->GetOwnPropertyDescriptor(context, key));
+            v8::Local<v8::Value> value;
+            if (descriptor->IsObject()) {
+                JS_EXPRESSION_RETURN(field_value, descriptor.As<v8::Object>()->Get(context, field));
+                value = field_value;
+            }
+            if (value.IsEmpty() || !value->IsFunction()) {
+                JS_THROW_ERROR(TypeError, isolate, "The implementation of '", interface_name, "' is missing the ", description, " '", name, "'.");
+            }
+            return value.As<v8::Function>();
+        }
+    }
+
+    v8::MaybeLocal<v8::Function> get_operation(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, const char *interface_name, const char *name) {
+        return get_descriptor_function(context, implementation, interface_name, name, StringTable::Get(context->GetIsolate(), "value"), "operation");
+    }
+
+    v8::MaybeLocal<v8::Function> get_getter(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, const char *interface_name, const char *name) {
+        return get_descriptor_function(context, implementation, interface_name, name, StringTable::Get(context->GetIsolate(), "get"), "getter of");
+    }
+
+    v8::MaybeLocal<v8::Function> get_setter(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, const char *interface_name, const char *name) {
+        return get_descriptor_function(context, implementation, interface_name, name, StringTable::Get(context->GetIsolate(), "set"), "setter of");
+    }
+
+    void illegal_constructor(const v8::FunctionCallbackInfo<v8::Value> &info) {
+        using __function_return_type__ = void;
+        auto isolate = info.GetIsolate();
+        v8::HandleScope scope(isolate);
+        JS_THROW_ERROR(TypeError, isolate, "Illegal constructor");
+    }
+
+    bool check_argument_count(const v8::FunctionCallbackInfo<v8::Value> &info, const Site &site, int required) {
+        static const constexpr auto __function_return_type__ = []() { return false; };
+        if V8_LIKELY(info.Length() >= required) {
+            return true;
+        }
+        auto isolate = info.GetIsolate();
+        JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), required, required == 1 ? " argument" : " arguments", " required, but only ", info.Length(), " present.");
+    }
+
+    v8::MaybeLocal<v8::Value> to_boolean(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        if V8_LIKELY(value->IsBoolean()) {
+            return value;
+        }
+        auto isolate = context->GetIsolate();
+        return v8::Boolean::New(isolate, value->BooleanValue(isolate));
+    }
+
+    v8::MaybeLocal<v8::Value> to_integer(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, int bit_length, bool is_signed, IntegerConversion conversion) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_RETURN(number, value->ToNumber(context));
+        auto x = number->Value();
+        double lower, upper;
+        if (bit_length == 64) {
+            // The 64-bit types are limited to the integers exactly representable by a double.
+            lower = is_signed ? -(std::ldexp(1.0, 53) - 1) : 0.0;
+            upper = std::ldexp(1.0, 53) - 1;
+        } else {
+            lower = is_signed ? -std::ldexp(1.0, bit_length - 1) : 0.0;
+            upper = is_signed ? std::ldexp(1.0, bit_length - 1) - 1 : std::ldexp(1.0, bit_length) - 1;
+        }
+        if (conversion == IntegerConversion::EnforceRange) {
+            if (!std::isfinite(x)) {
+                JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), "Value is ", std::isnan(x) ? "not a number" : "infinite", " and cannot be converted to ", integer_type_name(bit_length, is_signed), ".");
+            }
+            x = std::trunc(x);
+            if (x < lower || x > upper) {
+                JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), "Value is outside the '", integer_type_name(bit_length, is_signed), "' value range.");
+            }
+            return v8::Number::New(isolate, x == 0 ? 0.0 : x);
+        }
+        if (conversion == IntegerConversion::Clamp) {
+            if (std::isnan(x)) {
+                return v8::Integer::New(isolate, 0);
+            }
+            // Round half to even (the default rounding mode), as required by [Clamp].
+            x = std::nearbyint(std::min(std::max(x, lower), upper));
+            return v8::Number::New(isolate, x == 0 ? 0.0 : x);
+        }
+        if (!std::isfinite(x)) {
+            return v8::Integer::New(isolate, 0);
+        }
+        x = std::trunc(x);
+        if (x == 0) {
+            // Both +0 and -0 are converted to +0.
+            return v8::Integer::New(isolate, 0);
+        }
+        if (x >= lower && x <= upper) {
+            return v8::Number::New(isolate, x);
+        }
+        auto modulo = std::ldexp(1.0, bit_length);
+        x = std::fmod(x, modulo);
+        if (x < 0) {
+            x += modulo;
+        }
+        if (is_signed && x >= modulo / 2) {
+            x -= modulo;
+        }
+        return v8::Number::New(isolate, x);
+    }
+
+    v8::MaybeLocal<v8::Value> to_float(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_RETURN(number, to_finite(context, value, site, "float"));
+        auto y = static_cast<float>(number->Value());
+        if (std::isinf(y)) {
+            JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), "The provided float value is outside the range of float.");
+        }
+        return v8::Number::New(isolate, y);
+    }
+
+    v8::MaybeLocal<v8::Value> to_unrestricted_float(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        JS_EXPRESSION_RETURN(number, value->ToNumber(context));
+        return v8::Number::New(context->GetIsolate(), static_cast<float>(number->Value()));
+    }
+
+    v8::MaybeLocal<v8::Value> to_double(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        JS_EXPRESSION_RETURN(number, to_finite(context, value, site, "double"));
+        return number;
+    }
+
+    v8::MaybeLocal<v8::Value> to_unrestricted_double(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        if V8_LIKELY(value->IsNumber()) {
+            return value;
+        }
+        return value->ToNumber(context).FromMaybe(v8::Local<v8::Value>());
+    }
+
+    v8::MaybeLocal<v8::Value> to_dom_string(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        if V8_LIKELY(value->IsString()) {
+            return value;
+        }
+        return value->ToString(context).FromMaybe(v8::Local<v8::Value>());
+    }
+
+    v8::MaybeLocal<v8::Value> to_byte_string(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        JS_EXPRESSION_RETURN(string, value->ToString(context));
+        if (!string->ContainsOnlyOneByte()) {
+            JS_THROW_ERROR(TypeError, context->GetIsolate(), format_prefix(site).c_str(), subject(argument).c_str(), " is not a valid ByteString.");
+        }
+        return string;
+    }
+
+    v8::MaybeLocal<v8::Value> to_usv_string(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_RETURN(string, value->ToString(context));
+        if (string->ContainsOnlyOneByte()) {
+            return string;
+        }
+        // Replace the unpaired surrogates by U+FFFD.
+        auto length = string->Length();
+        std::vector<uint16_t> buffer(length);
+        string->Write(isolate, buffer.data(), 0, length, v8::String::NO_NULL_TERMINATION);
+        bool replaced = false;
+        for (int index = 0; index < length; ++index) {
+            if (is_lead_surrogate(buffer[index]) && index + 1 < length && is_trail_surrogate(buffer[index + 1])) {
+                ++index;
+            } else if (is_lead_surrogate(buffer[index]) || is_trail_surrogate(buffer[index])) {
+                buffer[index] = 0xFFFD;
+                replaced = true;
+            }
+        }
+        if (!replaced) {
+            return string;
+        }
+        JS_EXPRESSION_RETURN(result, v8::String::NewFromTwoByte(isolate, buffer.data(), v8::NewStringType::kNormal, length));
+        return result;
+    }
+
+    v8::MaybeLocal<v8::Value> to_object(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        if V8_LIKELY(value->IsObject()) {
+            return value;
+        }
+        return throw_not_of_type(context->GetIsolate(), site, argument, "object");
+    }
+
+    v8::MaybeLocal<v8::Value> to_interface(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, int definition) {
+        auto isolate = context->GetIsolate();
+        if V8_LIKELY(is_instance(isolate, definition, value)) {
+            return value;
+        }
+        return throw_not_of_type(isolate, site, argument, definitions[definition].name);
+    }
+
+    v8::MaybeLocal<v8::Value> to_callback_function(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, const char *type) {
+        if V8_LIKELY(JS_IS_CALLABLE(value)) {
+            return value;
+        }
+        return throw_not_of_type(context->GetIsolate(), site, argument, type);
+    }
+
+    v8::MaybeLocal<v8::Value> to_callback_interface(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, const char *type) {
+        if V8_LIKELY(value->IsObject()) {
+            return value;
+        }
+        return throw_not_of_type(context->GetIsolate(), site, argument, type);
+    }
+
+    v8::MaybeLocal<v8::Value> to_enumeration(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, const char *type, const char *const values[], std::size_t count) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        JS_EXPRESSION_RETURN(string, value->ToString(context));
+        v8::String::Utf8Value text(isolate, string);
+        for (std::size_t index = 0; index < count; ++index) {
+            if (std::strcmp(*text, values[index]) == 0) {
+                return string;
+            }
+        }
+        JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), "The provided value '", string, "' is not a valid enum value of type ", type, ".");
+    }
+
+    v8::MaybeLocal<v8::Value> to_sequence(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, ConvertElementFunction convert_element, const void *data) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        auto isolate = context->GetIsolate();
+        if (!value->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), subject(argument).c_str(), " cannot be converted to a sequence.");
+        }
+        auto object = value.As<v8::Object>();
+        if (value->IsArray()) {
+            // Fast path for the arrays whose iteration is not observable: read the elements by index.
+            auto array = value.As<v8::Array>();
+            auto length = array->Length();
+            auto result = v8::Array::New(isolate, static_cast<int>(length));
+            for (uint32_t index = 0; index < length; ++index) {
+                JS_EXPRESSION_RETURN(element, array->Get(context, index));
+                JS_EXPRESSION_RETURN(converted, convert_element(data, context, element, site, argument));
+                JS_EXPRESSION_IGNORE(result->CreateDataProperty(context, index, converted));
+            }
+            return result;
+        }
+        JS_EXPRESSION_RETURN(method, object->Get(context, v8::Symbol::GetIterator(isolate)));
+        if (!JS_IS_CALLABLE(method)) {
+            JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), "The object must have a callable @@iterator property.");
+        }
+        JS_EXPRESSION_RETURN(iterator, method.As<v8::Function>()->Call(context, object, 0, nullptr));
+        if (!iterator->IsObject()) {
+            JS_THROW_ERROR(TypeError, isolate, "Result of the Symbol.iterator method is not an object");
+        }
+        JS_EXPRESSION_RETURN(next, iterator.As<v8::Object>()->Get(context, StringTable::Get(isolate, "next")));
+        if (!JS_IS_CALLABLE(next)) {
+            JS_THROW_ERROR(TypeError, isolate, "The iterator's next method is not callable");
+        }
+        auto result = v8::Array::New(isolate);
+        uint32_t length = 0;
+        while (true) {
+            JS_EXPRESSION_RETURN(step, next.As<v8::Function>()->Call(context, iterator, 0, nullptr));
+            if (!step->IsObject()) {
+                JS_THROW_ERROR(TypeError, isolate, "Iterator result is not an object");
+            }
+            JS_EXPRESSION_RETURN(done, step.As<v8::Object>()->Get(context, StringTable::Get(isolate, "done")));
+            if (done->BooleanValue(isolate)) {
+                return result;
+            }
+            JS_EXPRESSION_RETURN(element, step.As<v8::Object>()->Get(context, StringTable::Get(isolate, "value")));
+            JS_EXPRESSION_RETURN(converted, convert_element(data, context, element, site, argument));
+            JS_EXPRESSION_IGNORE(result->CreateDataProperty(context, length++, converted));
+        }
+    }
+
+    std::string format_prefix(const Site &site) {
+        std::string outer = site.outer != nullptr ? format_prefix(*site.outer) : std::string();
+        switch (site.kind) {
+            case Site::Constructor:
+                return outer + "Failed to construct '" + site.interface_name + "': ";
+            case Site::Setter:
+                return outer + "Failed to set the '" + site.member_name + "' property on '" + site.interface_name + "': ";
+            case Site::Value:
+                return outer;
+            case Site::DictionaryMember:
+                return outer + "Failed to read the '" + site.member_name + "' property from '" + site.interface_name + "': ";
+            default:
+                return outer + "Failed to execute '" + site.member_name + "' on '" + site.interface_name + "': ";
+        }
+    }
+
+    v8::MaybeLocal<v8::Value> throw_not_of_type(v8::Isolate *isolate, const Site &site, int argument, const char *type) {
+        static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::Value>(); };
+        JS_THROW_ERROR(TypeError, isolate, format_prefix(site).c_str(), subject(argument).c_str(), " is not of type '", type, "'.");
+    }
+}
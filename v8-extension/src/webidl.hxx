@@ -0,0 +1,344 @@
+#ifndef NODE_EXT_WEBIDL_HXX
+#define NODE_EXT_WEBIDL_HXX
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+#include <v8.h>
+#include "js-helper.hxx"
+
+/**
+ * Runtime of the WebIDL bindings emitted by tools/webidl-bindings.mjs.
+ *
+ * The generated code builds one v8::FunctionTemplate per interface and per call of WebIDL.createInterface(); the callbacks of
+ * the template convert their arguments with the functions below and call the JavaScript implementation stored in the data
+ * of the template. The conversions return the converted IDL value as a JavaScript value, so the implementation receives a
+ * boolean for a boolean, a number within the range of the integer type for an integer, a string for a string type, etc.
+ */
+namespace dragiyski::node_ext::webidl {
+    using namespace js;
+
+    /**
+     * @brief The member converting a value, formatted into the prefix of the error messages the way browsers report them.
+     */
+    struct Site {
+        enum Kind {
+            Operation,
+            Constructor,
+            Setter,
+            /**
+             * @brief A value converted outside of an interface member, e.g. by a converter called from JavaScript; no prefix.
+             */
+            Value,
+            /**
+             * @brief A member of a dictionary; interface_name is the name of the dictionary, outer is the site converting the
+             * dictionary.
+             */
+            DictionaryMember
+        };
+        const char *interface_name;
+        const char *member_name;
+        Kind kind;
+        const Site *outer = nullptr;
+    };
+
+    struct InterfaceDefinition {
+        const char *name;
+        /**
+         * @brief The index of the inherited interface in definitions, or -1.
+         */
+        int parent;
+        /**
+         * @brief Build the template of the interface; parent is the template of the inherited interface, if any.
+         */
+        v8::MaybeLocal<v8::FunctionTemplate> (*create_template)(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, v8::Local<v8::FunctionTemplate> parent);
+    };
+
+    /**
+     * @brief The interfaces of the .webidl files, defined by the generated code.
+     */
+    extern const InterfaceDefinition definitions[];
+    extern const std::size_t definition_count;
+
+    void initialize(v8::Isolate *isolate);
+    void uninitialize(v8::Isolate *isolate);
+
+    /**
+     * @brief The index of the interface in definitions, or -1.
+     */
+    int find_definition(const char *name);
+
+    /**
+     * @brief Remember a template built for the definition; returns the index of the template within the isolate.
+     */
+    std::size_t register_template(v8::Isolate *isolate, int definition, v8::Local<v8::FunctionTemplate> value);
+    v8::Local<v8::FunctionTemplate> get_template(v8::Isolate *isolate, std::size_t index);
+    int get_template_definition(v8::Isolate *isolate, std::size_t index);
+
+    /**
+     * @brief Whether value implements the interface; true for the instances of any realm (any template built for the
+     * definition), as platform objects are branded by the interface and not by the realm.
+     */
+    bool is_instance(v8::Isolate *isolate, int definition, v8::Local<v8::Value> value);
+
+    /**
+     * @brief Own data property of the implementation that must be callable, e.g. an operation or "constructor".
+     */
+    v8::MaybeLocal<v8::Function> get_operation(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, const char *interface_name, const char *name);
+    /**
+     * @brief The getter of an own accessor property of the implementation.
+     */
+    v8::MaybeLocal<v8::Function> get_getter(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, const char *interface_name, const char *name);
+    /**
+     * @brief The setter of an own accessor property of the implementation.
+     */
+    v8::MaybeLocal<v8::Function> get_setter(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, const char *interface_name, const char *name);
+
+    void illegal_constructor(const v8::FunctionCallbackInfo<v8::Value> &info);
+    /**
+     * @brief Throw a TypeError and return false, if less than required arguments are passed.
+     */
+    bool check_argument_count(const v8::FunctionCallbackInfo<v8::Value> &info, const Site &site, int required);
+
+    /**
+     * @brief The conversion of ConvertToInt() of WebIDL: modulo 2^bit_length by default, [EnforceRange] or [Clamp].
+     */
+    enum class IntegerConversion {
+        Modulo,
+        EnforceRange,
+        Clamp
+    };
+
+    // The argument is the zero-based index of the argument; -1 for the value of a setter or a dictionary member.
+    v8::MaybeLocal<v8::Value> to_boolean(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_integer(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, int bit_length, bool is_signed, IntegerConversion conversion);
+    v8::MaybeLocal<v8::Value> to_float(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_unrestricted_float(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_double(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_unrestricted_double(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_dom_string(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_byte_string(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_usv_string(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_object(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    v8::MaybeLocal<v8::Value> to_interface(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, int definition);
+    v8::MaybeLocal<v8::Value> to_callback_function(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, const char *type);
+    v8::MaybeLocal<v8::Value> to_callback_interface(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, const char *type);
+    v8::MaybeLocal<v8::Value> to_enumeration(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, const char *type, const char *const values[], std::size_t count);
+
+    using ConvertFunction = v8::MaybeLocal<v8::Value> (*)(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+    using ConvertElementFunction = v8::MaybeLocal<v8::Value> (*)(const void *data, v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument);
+
+    /**
+     * @brief sequence<T>: iterate value with its @@iterator and convert each element with convert_element(data, ...) into a new
+     * array.
+     */
+    v8::MaybeLocal<v8::Value> to_sequence(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument, ConvertElementFunction convert_element, const void *data);
+
+    /**
+     * @brief The message prefix of the site, e.g. "Failed to execute 'op' on 'Interface': ".
+     */
+    std::string format_prefix(const Site &site);
+    /**
+     * @brief Throw "<prefix><subject> is not of type 'type'." and return an empty value.
+     */
+    v8::MaybeLocal<v8::Value> throw_not_of_type(v8::Isolate *isolate, const Site &site, int argument, const char *type);
+
+    /**
+     * The IDL types known at compile time. convert<T>() converts a JavaScript value to the IDL type T, so the generated
+     * bindings and the native code select the conversion by type rather than by name, e.g. convert<idl::Nullable<idl::Long>>.
+     */
+    namespace idl {
+        struct Any {};
+        struct Boolean {};
+        template<int BitLength, bool IsSigned, IntegerConversion Conversion = IntegerConversion::Modulo>
+        struct Integer {};
+        template<typename Type, bool IsRestricted>
+        struct FloatingPoint {};
+        struct DOMString {};
+        struct ByteString {};
+        struct USVString {};
+        struct Object {};
+        template<typename T>
+        struct Nullable {};
+        template<typename T>
+        struct Sequence {};
+        /**
+         * @brief [LegacyNullToEmptyString] DOMString: null is converted to the empty string instead of "null".
+         */
+        template<typename T>
+        struct LegacyNullToEmptyString {};
+
+        using Byte = Integer<8, true>;
+        using Octet = Integer<8, false>;
+        using Short = Integer<16, true>;
+        using UnsignedShort = Integer<16, false>;
+        using Long = Integer<32, true>;
+        using UnsignedLong = Integer<32, false>;
+        using LongLong = Integer<64, true>;
+        using UnsignedLongLong = Integer<64, false>;
+        using Float = FloatingPoint<float, true>;
+        using UnrestrictedFloat = FloatingPoint<float, false>;
+        using Double = FloatingPoint<double, true>;
+        using UnrestrictedDouble = FloatingPoint<double, false>;
+
+        template<typename T>
+        struct EnforceRangeOf;
+        template<int BitLength, bool IsSigned, IntegerConversion Conversion>
+        struct EnforceRangeOf<Integer<BitLength, IsSigned, Conversion>> {
+            using type = Integer<BitLength, IsSigned, IntegerConversion::EnforceRange>;
+        };
+        template<typename T>
+        struct ClampOf;
+        template<int BitLength, bool IsSigned, IntegerConversion Conversion>
+        struct ClampOf<Integer<BitLength, IsSigned, Conversion>> {
+            using type = Integer<BitLength, IsSigned, IntegerConversion::Clamp>;
+        };
+
+        template<typename T>
+        using EnforceRange = typename EnforceRangeOf<T>::type;
+        template<typename T>
+        using Clamp = typename ClampOf<T>::type;
+    }
+
+    template<typename T>
+    struct Conversion;
+
+    template<typename T>
+    inline v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+        return Conversion<T>::convert(context, value, site, argument);
+    }
+
+    template<>
+    struct Conversion<idl::Any> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context>, v8::Local<v8::Value> value, const Site &, int) {
+            return value;
+        }
+    };
+
+    template<>
+    struct Conversion<idl::Boolean> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if V8_LIKELY(value->IsBoolean()) {
+                return value;
+            }
+            return to_boolean(context, value, site, argument);
+        }
+    };
+
+    template<int BitLength, bool IsSigned, IntegerConversion Mode>
+    struct Conversion<idl::Integer<BitLength, IsSigned, Mode>> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if V8_LIKELY(value->IsInt32()) {
+                constexpr int64_t lower = IsSigned ? -(int64_t(1) << std::min(BitLength - 1, 62)) : 0;
+                constexpr int64_t upper = IsSigned ? (int64_t(1) << std::min(BitLength - 1, 62)) - 1 : (int64_t(1) << std::min(BitLength, 62)) - 1;
+                int64_t x = value.As<v8::Int32>()->Value();
+                if (x >= lower && x <= upper) {
+                    return value;
+                }
+            }
+            return to_integer(context, value, site, argument, BitLength, IsSigned, Mode);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::Float> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            return to_float(context, value, site, argument);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::UnrestrictedFloat> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            return to_unrestricted_float(context, value, site, argument);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::Double> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if V8_LIKELY(value->IsInt32()) {
+                return value;
+            }
+            return to_double(context, value, site, argument);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::UnrestrictedDouble> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if V8_LIKELY(value->IsNumber()) {
+                return value;
+            }
+            return to_unrestricted_double(context, value, site, argument);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::DOMString> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if V8_LIKELY(value->IsString()) {
+                return value;
+            }
+            return to_dom_string(context, value, site, argument);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::ByteString> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            return to_byte_string(context, value, site, argument);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::USVString> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            return to_usv_string(context, value, site, argument);
+        }
+    };
+
+    template<>
+    struct Conversion<idl::Object> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if V8_LIKELY(value->IsObject()) {
+                return value;
+            }
+            return to_object(context, value, site, argument);
+        }
+    };
+
+    template<typename T>
+    struct Conversion<idl::Nullable<T>> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if (value->IsNullOrUndefined()) {
+                return v8::Null(context->GetIsolate());
+            }
+            return Conversion<T>::convert(context, value, site, argument);
+        }
+    };
+
+    template<typename T>
+    struct Conversion<idl::Sequence<T>> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            auto convert_element = [](const void *, v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+                return Conversion<T>::convert(context, value, site, argument);
+            };
+            return to_sequence(context, value, site, argument, convert_element, nullptr);
+        }
+    };
+
+    template<typename T>
+    struct Conversion<idl::LegacyNullToEmptyString<T>> {
+        static v8::MaybeLocal<v8::Value> convert(v8::Local<v8::Context> context, v8::Local<v8::Value> value, const Site &site, int argument) {
+            if (value->IsNull()) {
+                return v8::String::Empty(context->GetIsolate());
+            }
+            return Conversion<T>::convert(context, value, site, argument);
+        }
+    };
+}
+
+#endif /* NODE_EXT_WEBIDL_HXX */
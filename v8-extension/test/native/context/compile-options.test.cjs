@@ -0,0 +1,72 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { Context } = native;
+    const context = new Context();
+
+    // Arguments and scopes are passed to the compiled function.
+    const sum = context.compileFunction({ source: 'return a + b + offset;', arguments: ['a', 'b'], scopes: [{ offset: 10 }] });
+    assert.strictEqual(sum(1, 2), 13);
+    assert.strictEqual(sum.length, 2);
+
+    for (const compileOptions of ['eager', 'lazy', 'adaptive']) {
+        const f = context.compileFunction({ source: 'function inner(x) { return x * 2; } return inner(value);', arguments: ['value'], compileOptions });
+        assert.strictEqual(f(21), 42, compileOptions);
+    }
+    assert.throws(() => context.compileFunction({ source: '', compileOptions: 'sometimes' }), RangeError);
+
+    // Every adaptive compile is observed until three observations are conclusive; the next one decides from the code the calls
+    // have compiled.
+    const helpers = Array.from({ length: 200 }, (_, i) => `function helper${i}(v) { return v * ${i} + ${i}; }`).join('\n');
+    const list = `const helpers = [${Array.from({ length: 200 }, (_, i) => `helper${i}`).join(', ')}];`;
+    const hot = `${helpers}\n${list}\nlet s = 0; for (const helper of helpers) s += helper(1); return s;`;
+    const cold = `${helpers}\n${list}\nreturn helpers[0](1);`;
+    const batch = `${helpers}\n${list}\nreturn helpers.length;`;
+    const hashes = new Map();
+    for (const source of [hot, cold, batch]) {
+        const before = new Set(Context.compileStatistics().sources.map(entry => entry.hash));
+        const compiled = [new Context().compileFunction({ source, compileOptions: 'adaptive' })];
+        const added = Context.compileStatistics().sources.filter(entry => !before.has(entry.hash));
+        assert.strictEqual(added.length, 1);
+        hashes.set(source, added[0].hash);
+        for (let i = 0; i < 4; ++i) {
+            if (source !== batch) {
+                compiled.at(-1)();
+            }
+            compiled.push(new Context().compileFunction({ source, compileOptions: 'adaptive' }));
+        }
+    }
+    const entryOf = (stats, source) => stats.sources.find(entry => entry.hash === hashes.get(source));
+
+    const stats = Context.compileStatistics();
+    assert.strictEqual(entryOf(stats, cold).decision, 'cold');
+    const hotEntry = entryOf(stats, hot);
+    assert.strictEqual(hotEntry.decision, 'hot');
+    assert.strictEqual(hotEntry.samples, 3);
+    assert.strictEqual(hotEntry.compiles, 5);
+    assert.strictEqual(hotEntry.lazy, 4);
+    assert.strictEqual(hotEntry.eager, 1);
+    assert.ok(hotEntry.executedBytes >= hotEntry.baseBytes);
+    // Compiles of a function that has not run are inconclusive.
+    const batchEntry = entryOf(stats, batch);
+    assert.strictEqual(batchEntry.decision, 'observing');
+    assert.strictEqual(batchEntry.samples, 0);
+    assert.strictEqual(batchEntry.lazy, 5);
+    assert.ok(stats.decisions.hot >= 1 && stats.decisions.cold >= 1 && stats.decisions.observing >= 2);
+    assert.ok(stats.decisions.eager >= 1 && stats.decisions.lazy >= 1);
+    assert.strictEqual(stats.histogram.at(-1).below, Infinity);
+    const compiles = stats.histogram.reduce((total, bucket) => total + bucket.eager + bucket.lazy, 0);
+    assert.strictEqual(compiles, stats.decisions.eager + stats.decisions.lazy + stats.decisions.hot + stats.decisions.cold + stats.decisions.observing);
+
+    // The table of sources is bounded.
+    for (let i = 0; i < 1100; ++i) {
+        context.compileFunction({ source: `return ${i};`, compileOptions: 'adaptive' });
+    }
+    const bounded = Context.compileStatistics();
+    assert.ok(bounded.sources.length <= 1024);
+    assert.ok(bounded.evicted > 0);
+})();
@@ -0,0 +1,52 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    assert.throws(() => native.Context.prototype.dispose.call({}), TypeError, `dispose.call(<Object>)`);
+    assert.throws(() => native.Context.current.dispose(), TypeError, `Context.current.dispose()`);
+
+    // A disposed context that nothing else references is collected.
+    (function () {
+        const context = new native.Context();
+        const getValue = context.compileFunction({ source: 'return 42;' });
+        assert.strictEqual(getValue(), 42);
+        context.dispose({ label: 'collected' });
+        assert.strictEqual(context.global, undefined, 'global of a disposed context');
+        assert.throws(() => context.compileFunction({ source: 'return 1;' }), ReferenceError, `compileFunction() after dispose()`);
+        context.dispose();
+    })();
+    assert.deepStrictEqual(native.Context.leakCheck(), [], 'leakCheck() after the only references are gone');
+
+    // A function of the context keeps it alive; the membrane to it is revoked.
+    const context = new native.Context();
+    const leaked = context.compileFunction({ source: 'return globalThis;' });
+    const membrane = new native.Membrane(globalThis, context.global);
+    const wrapper = membrane.wrap({ value: 1 });
+    const inner = membrane.unwrap(leaked);
+    context.dispose({ label: 'leaked', notify: false });
+    assert.throws(() => membrane.wrap({}), TypeError, `wrap() after dispose()`);
+    assert.throws(() => membrane.unwrap(wrapper), TypeError, `unwrap() after dispose()`);
+    assert.throws(() => wrapper.value, TypeError, `wrapper of a revoked membrane`);
+    assert.throws(() => inner(), TypeError, `wrapper of a revoked membrane`);
+    assert.deepStrictEqual(native.Context.leakCheck(), ['leaked'], 'leakCheck() while a function of the context is reachable');
+    assert.strictEqual(typeof leaked, 'function');
+
+    // A context with a frame anywhere on the stack is running, even if neither current nor entered: A calls B calls dispose(A).
+    (function () {
+        const a = new native.Context();
+        const b = new native.Context();
+        const callInA = a.compileFunction({ source: 'return callback();', arguments: ['callback'] });
+        const callInB = b.compileFunction({ source: 'return callback();', arguments: ['callback'] });
+        assert.throws(() => callInA(() => callInB(() => a.dispose())), TypeError, `dispose() below a frame of the context`);
+        assert.throws(() => callInA(() => a.dispose()), TypeError, `dispose() called from the context`);
+        // The security token of the context is restored: its global proxy is still not accessible from this context.
+        assert.throws(() => a.global.Object, TypeError, 'access to the global of the context');
+        callInA(() => b.dispose());
+        assert.strictEqual(b.global, undefined, 'a context without frames is disposed');
+        a.dispose();
+        assert.strictEqual(a.global, undefined);
+    })();
+})();
@@ -0,0 +1,52 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { Context, Template, ObjectTemplate, FunctionTemplate } = native;
+    assert.throws(() => new Template(), TypeError);
+
+    // A lazy data property calls its getter on the first access only; the result replaces the property on that global.
+    const materialized = [];
+    const lazyInterface = new Template.LazyDataProperty({
+        getter(receiver, holder, name) {
+            materialized.push(name);
+            return { name };
+        }
+    });
+    const globalTemplate = new ObjectTemplate({
+        properties: {
+            Event: lazyInterface,
+            EventTarget: lazyInterface,
+            version: { value: 1 }
+        }
+    });
+    const context = new Context({ globalTemplate });
+    assert.deepStrictEqual(materialized, []);
+    const read = context.compileFunction({ source: 'return [version, Event.name, Event === Event, typeof EventTarget];' });
+    assert.deepStrictEqual([...read()], [1, 'Event', true, 'object']);
+    assert.deepStrictEqual(materialized, ['Event', 'EventTarget']);
+    read();
+    assert.deepStrictEqual(materialized, ['Event', 'EventTarget']);
+
+    // Every context instantiates the template anew.
+    new Context({ globalTemplate }).compileFunction({ source: 'return Event;' })();
+    assert.deepStrictEqual(materialized, ['Event', 'EventTarget', 'Event']);
+
+    // The instance template of a FunctionTemplate.
+    const functionTemplate = new FunctionTemplate({
+        function() {},
+        instance: {
+            properties: {
+                answer: { value: 42 }
+            }
+        }
+    });
+    assert.strictEqual(new Context({ globalTemplate: functionTemplate }).compileFunction({ source: 'return answer;' })(), 42);
+
+    assert.strictEqual(typeof new Context({}).compileFunction({ source: 'return globalThis.Event;' })(), 'undefined');
+    assert.throws(() => new Context({ globalTemplate: {} }), TypeError);
+    assert.throws(() => new Context(5), TypeError);
+})();
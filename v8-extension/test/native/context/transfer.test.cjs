@@ -0,0 +1,65 @@
+const assert = require('node:assert');
+const vm = require('node:vm');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const realm = vm.runInContext('globalThis', vm.createContext({}));
+    const target = native.Context.for(realm);
+    assert(typeof target.transfer === 'function');
+    assert.throws(() => target.transfer(), TypeError, `transfer()`);
+    assert.throws(() => target.transfer({}, { transfer: [{}] }), TypeError, `transfer(<Object>, { transfer: [<Object>] })`);
+    assert.throws(() => target.transfer(() => {}), TypeError, `transfer(<Function>)`);
+
+    // The copy belongs to the target context and shares nothing with the input.
+    const input = { a: [1, 'b'], c: new Map([[1, { d: true }]]) };
+    const copy = target.transfer(input);
+    assert.notStrictEqual(copy, input);
+    assert.strictEqual(Object.getPrototypeOf(copy), realm.Object.prototype);
+    assert(copy.c instanceof realm.Map);
+    assert.deepStrictEqual(JSON.stringify([...copy.c]), JSON.stringify([...input.c]));
+
+    // ArrayBuffers are copied, unless transferred.
+    const copied = new Uint8Array([1, 2, 3]);
+    const copiedResult = target.transfer(copied);
+    assert(copiedResult instanceof realm.Uint8Array);
+    assert.strictEqual(copied.byteLength, 3);
+    assert.deepStrictEqual([...copiedResult], [1, 2, 3]);
+
+    const moved = new Uint8Array([4, 5, 6]);
+    const movedResult = target.transfer({ view: moved }, { transfer: [moved.buffer] });
+    assert.strictEqual(moved.byteLength, 0, 'the source buffer is detached');
+    assert(movedResult.view.buffer instanceof realm.ArrayBuffer);
+    assert.deepStrictEqual([...movedResult.view], [4, 5, 6]);
+    assert.throws(() => target.transfer(null, { transfer: [moved.buffer] }), TypeError, `transfer a detached buffer`);
+    const twice = new ArrayBuffer(1);
+    assert.throws(() => target.transfer(null, { transfer: [twice, twice] }), TypeError, `transfer a buffer twice`);
+    assert.strictEqual(twice.byteLength, 1, 'failed transfers do not detach');
+
+    // SharedArrayBuffers share memory.
+    const shared = new Int32Array(new SharedArrayBuffer(8));
+    const sharedResult = target.transfer(shared);
+    assert(sharedResult.buffer instanceof realm.SharedArrayBuffer);
+    sharedResult[1] = 42;
+    assert.strictEqual(shared[1], 42);
+
+    // Large messages (beyond the retained arena size) and repeated use of the arena.
+    const large = new Uint8Array(32 * 1024 * 1024).fill(7);
+    assert.strictEqual(target.transfer(large)[large.length - 1], 7);
+    for (let i = 0; i < 4; ++i) {
+        assert.strictEqual(target.transfer({ i }).i, i);
+    }
+
+    // Nested transfers from a getter invoked by the serializer.
+    const nested = target.transfer({ get inner() { return target.transfer({ x: 1 }).x; } });
+    assert.strictEqual(nested.inner, 1);
+
+    // A disposed context cannot receive values; the transfer list is left attached.
+    const disposed = new native.Context();
+    disposed.dispose();
+    const kept = new ArrayBuffer(4);
+    assert.throws(() => disposed.transfer({ a: 1 }, { transfer: [kept] }), { name: 'ReferenceError', message: 'the wrapped context is already disposed' });
+    assert.strictEqual(kept.byteLength, 4);
+})();
@@ -0,0 +1,65 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { createError, Context } = native;
+    assert.strictEqual(typeof createError, 'function');
+
+    for (const type of ['Error', 'RangeError', 'ReferenceError', 'SyntaxError', 'TypeError']) {
+        const error = createError(type, 'message');
+        assert(error instanceof globalThis[type]);
+        assert.strictEqual(error.message, 'message');
+        assert(error.stack.startsWith(`${type}: message\n    at `));
+    }
+    assert.throws(() => createError('DOMException', ''), TypeError);
+    assert.throws(() => createError('Error', '', { constructorOpt: {} }), TypeError);
+    assert.throws(() => createError('Error', '', { stackLimit: -1 }), RangeError);
+
+    // The stack is an own non-enumerable data property once it is read; Error.stackTraceLimit is not affected.
+    const limit = Error.stackTraceLimit;
+    const error = createError('TypeError', 'lazy');
+    assert.strictEqual(Error.stackTraceLimit, limit);
+    error.name = 'Renamed';
+    const stack = error.stack;
+    assert(stack.startsWith('Renamed: lazy\n'), 'the header is formatted when the stack is read');
+    assert.deepStrictEqual(Object.getOwnPropertyDescriptor(error, 'stack'), {
+        value: stack,
+        writable: true,
+        enumerable: false,
+        configurable: true
+    });
+
+    // constructorOpt omits the frames up to and including its topmost call.
+    function inner() {
+        return createError('Error', 'x', { constructorOpt: inner });
+    }
+    function outer() {
+        return inner();
+    }
+    const frames = outer().stack.split('\n').slice(1);
+    assert.match(frames[0], /^ {4}at outer \(/);
+    // The function itself is matched, not another anonymous function of the same script.
+    const anonymous = [function () { return createError('Error', 'x', { constructorOpt: anonymous[1] }); }, function () { return anonymous[0](); }];
+    function caller() {
+        return anonymous[1]();
+    }
+    assert.match(caller().stack.split('\n')[1], /^ {4}at caller \(/);
+    assert.strictEqual(Error.stackTraceLimit, limit);
+    function unrelated() {}
+    assert.strictEqual(createError('Error', 'x', { constructorOpt: unrelated }).stack, 'Error: x');
+
+    assert.strictEqual(createError('Error', 'x', { stackLimit: 0 }).stack, 'Error: x');
+    function nested(depth) {
+        return depth > 0 ? nested(depth - 1) : createError('Error', 'x', { stackLimit: 3 });
+    }
+    assert.strictEqual(nested(10).stack.split('\n').length, 4);
+
+    // The frames of a context with another security token are not captured.
+    const context = new Context();
+    const foreign = context.compileFunction({ source: 'return this.callback();', name: 'foreign' });
+    const crossed = foreign.call({ callback: () => createError('Error', 'x') }).stack;
+    assert(!crossed.includes('foreign'));
+})();
@@ -0,0 +1,46 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    assert.throws(() => {
+        new native.FunctionTemplate({ native: 'unknown' });
+    }, TypeError, `FunctionTemplate({ native: 'unknown' })`);
+    assert.throws(() => {
+        new native.FunctionTemplate({ native: 5 });
+    }, TypeError, `FunctionTemplate({ native: <Number> })`);
+    assert.throws(() => {
+        new native.FunctionTemplate({ native: 'clamp', function() {} });
+    }, TypeError, `FunctionTemplate({ native, function })`);
+    assert.throws(() => {
+        new native.FunctionTemplate({ native: 'clamp', constructor: true });
+    }, TypeError, `FunctionTemplate({ native, constructor: true })`);
+
+    const stringCompare = new native.FunctionTemplate({ native: 'stringCompare' }).get();
+    assert.strictEqual(stringCompare.length, 2);
+    assert.throws(() => new stringCompare('a', 'b'), TypeError, `new stringCompare()`);
+    assert.throws(() => stringCompare('a'), TypeError, `stringCompare(<String>)`);
+    assert.throws(() => stringCompare('a', 1), TypeError, `stringCompare(<String>, <Number>)`);
+
+    const stringEquals = new native.FunctionTemplate({ native: 'stringEquals' }).get();
+    const clamp = new native.FunctionTemplate({ native: 'clamp' }).get();
+    const hasFlags = new native.FunctionTemplate({ native: 'hasFlags' }).get();
+
+    // Run enough iterations for the optimizing compiler to kick in, the results must not change.
+    const strings = ['', 'a', 'ab', 'abc', 'b', 'z', 'é', '中', 'a中'];
+    for (let i = 0; i < 20000; ++i) {
+        const a = strings[i % strings.length];
+        const b = strings[(i * 7) % strings.length];
+        assert.strictEqual(stringCompare(a, b), a < b ? -1 : a > b ? 1 : 0, `stringCompare(${JSON.stringify(a)}, ${JSON.stringify(b)})`);
+        assert.strictEqual(stringEquals(a, b), a === b, `stringEquals(${JSON.stringify(a)}, ${JSON.stringify(b)})`);
+        const x = (i % 21) - 10;
+        assert.strictEqual(clamp(x, -5, 5), Math.min(Math.max(x, -5), 5), `clamp(${x}, -5, 5)`);
+        assert.strictEqual(hasFlags(i, 5), (i & 5) === 5, `hasFlags(${i}, 5)`);
+    }
+    assert(Number.isNaN(clamp(NaN, 0, 1)), `clamp(NaN, 0, 1)`);
+    assert(Number.isNaN(clamp(0.5, NaN, 1)), `clamp(0.5, NaN, 1)`);
+    assert.strictEqual(clamp('7', 0, 5), 5, `clamp(<String>, 0, 5)`);
+    assert.strictEqual(hasFlags(0xFFFFFFFF, 0x80000000), true, `hasFlags(0xFFFFFFFF, 0x80000000)`);
+})();
@@ -0,0 +1,61 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { Context, InterfaceRegistry, propertyAttribute } = native;
+    const registry = new InterfaceRegistry();
+    const installed = [];
+    const installer = (global, name) => {
+        installed.push(name);
+        return { name, global };
+    };
+    registry.register('Event', installer);
+    registry.register('EventTarget', installer);
+    registry.register('Node', installer, propertyAttribute.NONE);
+    assert.throws(() => registry.register('Event', installer), TypeError);
+    assert.throws(() => registry.register(5, installer), TypeError);
+    assert.throws(() => registry.register('Window', null), TypeError);
+
+    const context = new Context({ globalTemplate: registry });
+    assert.deepStrictEqual(installed, []);
+    assert.deepStrictEqual(registry.materialized(context), []);
+    const read = context.compileFunction({
+        source: `return [
+            Event === Event,
+            EventTarget.global === globalThis,
+            Object.keys(globalThis).join(),
+            Object.getOwnPropertyDescriptor(globalThis, 'Event').enumerable
+        ];`
+    });
+    assert.deepStrictEqual([...read()], [true, true, 'Node', false]);
+    assert.deepStrictEqual(installed, ['Event', 'EventTarget']);
+    assert.deepStrictEqual(registry.materialized(context), ['Event', 'EventTarget']);
+
+    // The installer runs once per realm; the result stays on that global.
+    read();
+    const other = new Context({ globalTemplate: registry });
+    other.compileFunction({ source: 'return Event;' })();
+    assert.deepStrictEqual(installed, ['Event', 'EventTarget', 'Event']);
+    assert.deepStrictEqual(registry.materialized(other), ['Event']);
+    assert.deepStrictEqual(registry.materialized(new Context()), []);
+
+    const statistics = registry.statistics();
+    assert.strictEqual(statistics.contexts, 2);
+    assert.deepStrictEqual(statistics.interfaces.map(entry => [entry.name, entry.materialized]), [['Event', 2], ['EventTarget', 1], ['Node', 0]]);
+
+    // The global template cannot change once a context has been created from it.
+    assert.throws(() => registry.register('Document', installer), TypeError);
+
+    // An exception of the installer is thrown at the access; the property is not replaced.
+    const failing = new InterfaceRegistry();
+    failing.register('Broken', () => {
+        throw new RangeError('not installed');
+    });
+    const broken = new Context({ globalTemplate: failing });
+    assert.throws(() => broken.compileFunction({ source: 'return Broken;' })(), RangeError);
+    assert.deepStrictEqual(failing.materialized(broken), []);
+    assert.strictEqual(failing.statistics().interfaces[0].materialized, 0);
+})();
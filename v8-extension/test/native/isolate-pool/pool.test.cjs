@@ -0,0 +1,76 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const v8 = require('node:v8');
+const vm = require('node:vm');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(async function () {
+    'use strict';
+
+    assert(typeof native.IsolatePool === 'function');
+    assert.throws(() => native.IsolatePool(), TypeError, `IsolatePool()`);
+    assert.throws(() => new native.IsolatePool({ size: 0 }), RangeError, `new IsolatePool({ size: 0 })`);
+    assert.throws(() => new native.IsolatePool({ exports: 5 }), TypeError, `new IsolatePool({ exports: <Number> })`);
+
+    const pool = new native.IsolatePool({ size: 2, exports: 'native' });
+    assert.strictEqual(pool.size, 2);
+    assert.throws(() => pool.run(5), TypeError, `pool.run(<Number>)`);
+
+    // Completion values are structured-cloned back.
+    assert.strictEqual(await pool.run('1 + 2'), 3);
+    assert.deepStrictEqual(await pool.run('({ a: [1, "b"], c: new Map([[1, 2]]) })'), { a: [1, 'b'], c: new Map([[1, 2]]) });
+
+    // Each script runs in a new context.
+    await pool.run('globalThis.leak = 1');
+    assert.strictEqual(await pool.run('typeof leak'), 'undefined');
+
+    // Promises are awaited within the microtask checkpoint.
+    assert.strictEqual(await pool.run('Promise.resolve(4).then(x => x * 2)'), 8);
+    await assert.rejects(pool.run('new Promise(() => {})'), /did not settle/);
+
+    // Exceptions reject the promise; native errors keep their class.
+    await assert.rejects(pool.run('throw new TypeError("inner")'), error => error instanceof TypeError && error.message === 'inner');
+    await assert.rejects(pool.run('(', { filename: 'broken.js' }), SyntaxError);
+    await assert.rejects(pool.run('(function () {})'), /could not be cloned/);
+
+    // The worker contexts see the classes of the addon under the configured name.
+    assert.strictEqual(await pool.run('typeof native.FunctionTemplate'), 'function');
+
+    // Tasks are spread across the workers.
+    const results = await Promise.all(Array.from({ length: 16 }, (_, i) => pool.run(`${i} * ${i}`)));
+    assert.deepStrictEqual(results, Array.from({ length: 16 }, (_, i) => i * i));
+
+    // A timeout terminates the script and rejects its promise; the worker keeps running the next tasks.
+    assert.throws(() => pool.run('1', { timeout: 0 }), RangeError, `run(source, { timeout: 0 })`);
+    await assert.rejects(pool.run('for (;;);', { timeout: 50 }), { name: 'Error', message: 'Script execution timed out after 50ms' });
+    assert.deepStrictEqual(await Promise.all([pool.run('1', { timeout: 1000 }), pool.run('2'), pool.run('3')]), [1, 2, 3]);
+
+    pool.close();
+    assert.throws(() => pool.run('1'), Error, `run() after close()`);
+    pool.close();
+
+    // close() does not wait for the running scripts: they are terminated, and the workers are joined on another thread.
+    {
+        const busy = new native.IsolatePool({ size: 1 });
+        const running = busy.run('for (;;);');
+        const queued = busy.run('1');
+        await new Promise(resolve => setTimeout(resolve, 100));
+        const start = process.hrtime.bigint();
+        busy.close();
+        assert(Number(process.hrtime.bigint() - start) / 1e6 < 100);
+        await assert.rejects(running, { message: 'The script was terminated' });
+        await assert.rejects(queued, { message: 'The isolate pool is closed' });
+        assert.strictEqual(busy.size, 1);
+    }
+
+    // A pool collected without close() does not block the GC: its workers are joined on another thread.
+    v8.setFlagsFromString('--expose-gc');
+    const gc = vm.runInNewContext('gc');
+    (() => new native.IsolatePool({ size: 2 }))();
+    const start = process.hrtime.bigint();
+    gc();
+    assert(Number(process.hrtime.bigint() - start) / 1e6 < 1000);
+})().catch(error => {
+    console.error(error);
+    process.exitCode = 1;
+});
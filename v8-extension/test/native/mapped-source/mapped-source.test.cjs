@@ -0,0 +1,69 @@
+const assert = require('node:assert');
+const fs = require('node:fs');
+const os = require('node:os');
+const { join: joinPath, resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { MappedSource, Context } = native;
+    const directory = fs.mkdtempSync(joinPath(os.tmpdir(), 'mapped-source-'));
+    try {
+        const write = (name, content) => {
+            const path = joinPath(directory, name);
+            fs.writeFileSync(path, content);
+            return path;
+        };
+
+        // Small files are copied; the source can be compiled repeatedly, in different contexts.
+        const ascii = new MappedSource(write('ascii.js', 'return this.value * 2;'));
+        assert.strictEqual(ascii.mapped, false);
+        assert.strictEqual(ascii.byteLength, 22);
+        assert.strictEqual(ascii.source, 'return this.value * 2;');
+        assert.strictEqual(Context.current.compileFunction({ source: ascii }).call({ value: 21 }), 42);
+        assert.strictEqual(new Context().compileFunction({ source: ascii.source }).call({ value: 2 }), 4);
+
+        // Non-ASCII UTF-8 is transcoded: to Latin-1 if possible, to UTF-16 otherwise; invalid bytes become U+FFFD.
+        const latin1 = new MappedSource(write('latin1.js', 'return "café";'));
+        assert.strictEqual(latin1.mapped, false);
+        assert.strictEqual(latin1.source, 'return "café";');
+        const utf8 = 'return "€ 𝄞";';
+        const wide = new MappedSource(write('wide.js', utf8));
+        assert.strictEqual(wide.source, utf8);
+        assert.strictEqual(Context.current.compileFunction({ source: wide })(), '€ 𝄞');
+        const invalid = new MappedSource(write('invalid.txt', Buffer.from([0x61, 0xE2, 0x82, 0x62, 0xFF, 0xF0, 0x9D])));
+        assert.strictEqual(invalid.source, new TextDecoder().decode(Buffer.from([0x61, 0xE2, 0x82, 0x62, 0xFF, 0xF0, 0x9D])));
+
+        // Other encodings.
+        const bytes = write('bytes.txt', Buffer.from([0x63, 0x61, 0x66, 0xE9]));
+        assert.strictEqual(new MappedSource(bytes, { encoding: 'latin1' }).source, 'café');
+        const utf16 = new MappedSource(write('utf16.txt', Buffer.from('€ß', 'utf16le')), { encoding: 'utf-16le' });
+        assert.strictEqual(utf16.source, '€ß');
+        assert.strictEqual(new MappedSource(write('empty.js', '')).source, '');
+
+        // Large ASCII and Latin-1 files are exposed directly from the mapping.
+        const statement = 'this.value += 1;\n';
+        const large = write('large.js', statement.repeat(Math.ceil((1 << 20) / statement.length)) + 'return this.value;');
+        const mapped = new MappedSource(large);
+        assert.strictEqual(mapped.mapped, true);
+        assert.strictEqual(new MappedSource(large, { encoding: 'latin1' }).mapped, true);
+        assert.strictEqual(mapped.byteLength, fs.statSync(large).size);
+        assert.strictEqual(Context.current.compileFunction({ source: mapped }).call({ value: 0 }), Math.ceil((1 << 20) / statement.length));
+
+        // Truncating a mapped file would make reading the mapping raise SIGBUS: the source switches to a copy of the file.
+        fs.truncateSync(large, statement.length);
+        assert.strictEqual(mapped.source, statement);
+        assert.strictEqual(mapped.mapped, false);
+        assert.strictEqual(mapped.byteLength, statement.length);
+        assert.strictEqual(Context.current.compileFunction({ source: mapped }).call({ value: 1 }), undefined);
+
+        assert.throws(() => new MappedSource(joinPath(directory, 'missing.js')), { name: 'Error', message: /^Cannot map ".*missing\.js": / });
+        assert.throws(() => new MappedSource(directory), Error);
+        assert.throws(() => new MappedSource(bytes, { encoding: 'ascii' }), RangeError);
+        assert.throws(() => MappedSource(bytes), TypeError);
+        assert.throws(() => Context.current.compileFunction({ source: {} }), TypeError);
+    } finally {
+        fs.rmSync(directory, { recursive: true });
+    }
+})();
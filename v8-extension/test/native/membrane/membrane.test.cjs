@@ -0,0 +1,109 @@
+const assert = require('node:assert');
+const v8 = require('node:v8');
+const vm = require('node:vm');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(async function () {
+    'use strict';
+
+    assert(typeof native.Membrane === 'function');
+    assert.throws(() => native.Membrane({}, {}), TypeError, `Membrane()`);
+    assert.throws(() => new native.Membrane({}), TypeError, `new Membrane(<Object>)`);
+    assert.throws(() => new native.Membrane({}, 5), TypeError, `new Membrane(<Object>, <Number>)`);
+    assert.throws(() => new native.Membrane({}, {}, { errors: [[Error, 5]] }), TypeError, `new Membrane(<Object>, <Object>, { errors: [[Error, <Number>]] })`);
+
+    const context = vm.createContext({});
+    const realm = vm.runInContext('globalThis', context);
+    const membrane = new native.Membrane(globalThis, realm);
+
+    // Primitives pass through; objects keep their identity.
+    assert.strictEqual(membrane.wrap(5), 5);
+    assert.strictEqual(membrane.wrap('text'), 'text');
+    const object = { a: 1, nested: { b: 2 }, list: [1, 2, 3], add(x) { return x + this.a; } };
+    const wrapper = membrane.wrap(object);
+    assert.notStrictEqual(wrapper, object);
+    assert.strictEqual(membrane.wrap(object), wrapper, 'wrap(object) returns the same wrapper');
+    assert.strictEqual(membrane.unwrap(wrapper), object, 'unwrap(wrap(object)) === object');
+    assert.strictEqual(wrapper.nested, wrapper.nested, 'nested objects keep their identity');
+
+    realm.wrapper = wrapper;
+    assert.strictEqual(vm.runInContext('wrapper.a', context), 1);
+    assert.strictEqual(vm.runInContext('wrapper.add(2)', context), 3, 'methods are called on the original receiver');
+    assert.strictEqual(vm.runInContext('wrapper.list[1] + wrapper.list.length', context), 5);
+    assert.deepStrictEqual(Array.from(vm.runInContext('Object.keys(wrapper)', context)), ['a', 'nested', 'list', 'add']);
+    assert.strictEqual(vm.runInContext('"a" in wrapper && !("z" in wrapper)', context), true);
+    assert.strictEqual(vm.runInContext('typeof wrapper.add', context), 'function');
+
+    // Writes reach the original object, values from the realm are wrapped in the other direction.
+    vm.runInContext('wrapper.c = { x: 1 }; delete wrapper.a; Object.defineProperty(wrapper, "d", { value: 4 })', context);
+    assert.strictEqual('a' in object, false);
+    assert.strictEqual(object.c.x, 1);
+    assert.strictEqual(vm.runInContext('wrapper.c', context), membrane.wrap(object.c), 'realm objects returning to the realm are unwrapped');
+    assert.deepStrictEqual(Object.getOwnPropertyDescriptor(object, 'd'), { value: 4, writable: false, enumerable: false, configurable: false });
+
+    // Constructors, prototypes and instanceof.
+    class Point {
+        constructor(x) {
+            this.x = x;
+        }
+        get double() {
+            return this.x * 2;
+        }
+    }
+    realm.Point = membrane.wrap(Point);
+    assert.deepStrictEqual(Array.from(vm.runInContext('const point = new Point(3); [point.x, point.double, point instanceof Point]', context)), [3, 6, true]);
+    assert.strictEqual(membrane.unwrap(vm.runInContext('point', context)) instanceof Point, true);
+
+    // Errors are converted through the error table, not wrapped.
+    realm.thrower = membrane.wrap(() => { throw new TypeError('outer'); });
+    assert.deepStrictEqual(
+        Array.from(vm.runInContext('(() => { try { thrower(); } catch (e) { return [e instanceof TypeError, e.message]; } })()', context)),
+        [true, 'outer']
+    );
+    const realmError = vm.runInContext('new RangeError("inner", { cause: { code: 1 } })', context);
+    const error = membrane.unwrap(realmError);
+    assert(error instanceof RangeError);
+    assert.strictEqual(error.message, 'inner');
+    assert.strictEqual(error.cause.code, 1);
+    assert.strictEqual(membrane.unwrap(realmError), error, 'unwrap(error) returns the same error');
+    assert.strictEqual(membrane.wrap(error), realmError, 'a converted error returns the original error');
+    assert.throws(() => membrane.unwrap(vm.runInContext('(() => { throw new SyntaxError("s"); })', context))(), SyntaxError);
+
+    // Additional error classes.
+    class OuterError extends Error {}
+    const InnerError = vm.runInContext('class InnerError extends Error {}; InnerError', context);
+    const custom = new native.Membrane(globalThis, realm, { errors: new Map([[OuterError, InnerError]]) });
+    assert(custom.wrap(new OuterError('x')) instanceof InnerError);
+    assert(custom.unwrap(new InnerError('x')) instanceof OuterError);
+    class DerivedError extends TypeError {}
+    assert(vm.runInContext('(e) => e instanceof TypeError', context)(custom.wrap(new DerivedError('d'))), 'unknown subclasses map to the nearest known class');
+
+    // Membranes do not share identity maps.
+    assert.notStrictEqual(custom.wrap(object), wrapper);
+
+    // An array is wrapped as an object: its elements and length are forwarded, but it is not an Array exotic object.
+    const array = [1, 2, 3];
+    realm.array = membrane.wrap(array);
+    assert.deepStrictEqual(Array.from(vm.runInContext('[array.length, array[1], Array.isArray(array), JSON.stringify(array), JSON.stringify([...array])]', context)), [3, 2, false, '{"0":1,"1":2,"2":3}', '[1,2,3]']);
+    delete realm.array;
+
+    // The original holds its wrapper weakly: an unreachable wrapper is collected and a new one is created on demand.
+    v8.setFlagsFromString('--expose-gc');
+    const gc = vm.runInNewContext('gc');
+    const retained = { value: 1 };
+    const reference = (() => {
+        const transient = membrane.wrap(retained);
+        transient.value = 2;
+        assert.strictEqual(membrane.wrap(retained), transient);
+        return new WeakRef(transient);
+    })();
+    await new Promise(resolve => setImmediate(resolve));
+    gc();
+    assert.strictEqual(reference.deref(), undefined, 'the wrapper is collected while the original is alive');
+    assert.strictEqual(membrane.wrap(retained).value, 2, 'writes reached the original');
+    assert.strictEqual(membrane.unwrap(membrane.wrap(retained)), retained);
+})().catch(error => {
+    console.error(error);
+    process.exitCode = 1;
+});
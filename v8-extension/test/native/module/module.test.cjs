@@ -0,0 +1,108 @@
+const assert = require('node:assert');
+const fs = require('node:fs');
+const os = require('node:os');
+const { join: joinPath, resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(async function () {
+    'use strict';
+
+    const { Context, Module, MappedSource } = native;
+    const directory = fs.mkdtempSync(joinPath(os.tmpdir(), 'module-'));
+    try {
+        const write = (name, content) => {
+            const path = joinPath(directory, name);
+            fs.mkdirSync(joinPath(path, '..'), { recursive: true });
+            fs.writeFileSync(path, content);
+            return path;
+        };
+        write('lib/counter.mjs', 'export let count = 0; export function increment() { return ++count; }');
+        write('lib/twice.mjs', `import { increment } from './counter.mjs'; export default function twice() { increment(); return increment(); }`);
+        write('lib/name.mjs', `export const name = 'ünïcødé';`);
+        const main = `
+            import twice from './lib/twice.mjs';
+            import { count } from './lib/counter.mjs';
+            import { name } from '${joinPath(directory, 'lib/name.mjs')}';
+            export const result = twice();
+            export { count, name };
+            export const global = globalThis;
+        `;
+        const mainPath = write('main.mjs', main);
+
+        assert.throws(() => new Module(), TypeError);
+
+        const first = new Context();
+        const module = first.compileModule({ source: main, location: mainPath });
+        assert(module instanceof Module);
+        assert.strictEqual(module.status, 'unlinked');
+        assert.strictEqual(module.location, mainPath);
+        assert.strictEqual(module.cached, false);
+        assert.deepStrictEqual(module.requests, ['./lib/twice.mjs', './lib/counter.mjs', joinPath(directory, 'lib/name.mjs')]);
+        assert.throws(() => module.evaluate(), Error);
+
+        const linking = module.link();
+        assert.strictEqual(module.link(), linking, 'link() returns the same promise');
+        assert.strictEqual(await linking, module);
+        assert.strictEqual(module.status, 'linked');
+        await module.evaluate();
+        assert.strictEqual(module.status, 'evaluated');
+        assert.strictEqual(module.namespace.result, 2);
+        assert.strictEqual(module.namespace.count, 2, 'live binding through the shared dependency');
+        assert.strictEqual(module.namespace.name, 'ünïcødé');
+        assert.strictEqual(module.namespace.global, first.global);
+
+        // A second context gets its own module instances, compiled from the code caches of the first.
+        const second = new Context();
+        const again = second.compileModule({ source: new MappedSource(mainPath), location: `file://${mainPath}` });
+        assert.strictEqual(again.cached, true);
+        await again.link();
+        await again.evaluate();
+        assert.strictEqual(again.namespace.result, 2);
+        assert.strictEqual(again.namespace.global, second.global);
+
+        // Another graph in the first context reuses the module map of the context: the counter is shared.
+        const other = first.compileModule({ source: `import twice from './lib/twice.mjs'; export const result = twice();`, location: joinPath(directory, 'other.mjs') });
+        await other.link();
+        await other.evaluate();
+        assert.strictEqual(other.namespace.result, 4);
+
+        // Failures reject the promise of link().
+        const missing = first.compileModule({ source: `import './missing.mjs';`, location: joinPath(directory, 'a.mjs') });
+        await assert.rejects(missing.link(), { name: 'Error', message: /^Cannot load module ".*missing\.mjs": / });
+        const bare = first.compileModule({ source: `import 'lodash';`, location: joinPath(directory, 'b.mjs') });
+        await assert.rejects(bare.link(), { name: 'TypeError', message: /^Cannot resolve module specifier "lodash"/ });
+        write('broken.mjs', 'export const = 1;');
+        const broken = first.compileModule({ source: `import './broken.mjs';`, location: joinPath(directory, 'c.mjs') });
+        await assert.rejects(broken.link(), SyntaxError);
+        const unexported = first.compileModule({ source: `import { nope } from './lib/counter.mjs';`, location: joinPath(directory, 'd.mjs') });
+        // Instantiation errors are created in the context of the module.
+        await assert.rejects(unexported.link(), { name: 'SyntaxError', message: /does not provide an export named 'nope'/ });
+        assert.throws(() => first.compileModule({ source: 'export const = 1;' }), SyntaxError);
+        assert.throws(() => first.compileModule({ source: 'export default 1;', location: '' }), { name: 'TypeError', message: /^Invalid option 'location' "": / });
+
+        // A rejected link is not cached: link() starts over once the missing file exists.
+        write('missing.mjs', 'export default 1;');
+        assert.strictEqual(await missing.link(), missing);
+        assert.strictEqual(missing.status, 'linked');
+
+        // Graphs linked concurrently in one context share the load of a common dependency.
+        write('shared.mjs', 'export const instance = {};');
+        const left = first.compileModule({ source: `export { instance } from './shared.mjs';`, location: joinPath(directory, 'left.mjs') });
+        const right = first.compileModule({ source: `export { instance } from './shared.mjs';`, location: joinPath(directory, 'right.mjs') });
+        await Promise.all([left.link(), right.link()]);
+        await left.evaluate();
+        await right.evaluate();
+        assert.strictEqual(left.namespace.instance, right.namespace.instance);
+
+        // Without imports there is nothing to load.
+        const standalone = first.compileModule({ source: 'export default 42;' });
+        await standalone.link();
+        await standalone.evaluate();
+        assert.strictEqual(standalone.namespace.default, 42);
+    } finally {
+        fs.rmSync(directory, { recursive: true });
+    }
+})().catch(error => {
+    console.error(error);
+    process.exitCode = 1;
+});
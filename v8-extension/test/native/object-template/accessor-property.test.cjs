@@ -0,0 +1,71 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { FunctionTemplate, ObjectTemplate, Template } = native;
+    const { AccessorProperty } = ObjectTemplate;
+    const { NativeDataProperty, LazyDataProperty } = Template;
+
+    const calls = [];
+    const storage = new WeakMap();
+    const accessor = new AccessorProperty({
+        getter(receiver, holder, name) {
+            calls.push(['get', receiver, holder, name]);
+            return storage.get(holder);
+        },
+        setter(receiver, holder, name, value) {
+            calls.push(['set', receiver, holder, name, value]);
+            storage.set(holder, value);
+        }
+    });
+    const readonly = new AccessorProperty({ getter: (receiver, holder, name) => `read:${name}` });
+    const native_ = new NativeDataProperty({
+        getter: (receiver, holder, name) => `native:${name}`,
+        setter(receiver, holder, name, value) {
+            calls.push(['native', receiver, holder, name, value]);
+        }
+    });
+    let lazyCalls = 0;
+    const lazy = new LazyDataProperty({ getter: (receiver, holder, name) => `lazy:${name}:${++lazyCalls}` });
+    const Holder = new FunctionTemplate({
+        function() {},
+        instance: { properties: { value: accessor, readonly, native: native_, lazy } }
+    }).get();
+    const holder = new Holder();
+
+    // The setter is called with the assigned value (not the getter) and the getter sees what it stored.
+    holder.value = 42;
+    assert.deepStrictEqual(calls.pop(), ['set', holder, holder, 'value', 42]);
+    assert.strictEqual(holder.value, 42);
+    assert.deepStrictEqual(calls.pop(), ['get', holder, holder, 'value']);
+
+    // The receiver differs from the holder when the property is reached through the prototype chain.
+    const derived = Object.create(holder);
+    assert.strictEqual(derived.value, 42);
+    assert.deepStrictEqual(calls.pop(), ['get', derived, holder, 'value']);
+
+    // Several objects of the same template share the property data, but not the values.
+    const other = new Holder();
+    other.value = 'other';
+    assert.strictEqual(holder.value, 42);
+    assert.strictEqual(other.value, 'other');
+
+    // Without a setter an assignment is ignored.
+    holder.readonly = 1;
+    assert.strictEqual(holder.readonly, 'read:readonly');
+
+    assert.strictEqual(holder.native, 'native:native');
+    holder.native = 'x';
+    assert.deepStrictEqual(calls.pop(), ['native', holder, holder, 'native', 'x']);
+
+    // The lazy property is computed once per object.
+    assert.strictEqual(holder.lazy, 'lazy:lazy:1');
+    assert.strictEqual(holder.lazy, 'lazy:lazy:1');
+    assert.strictEqual(other.lazy, 'lazy:lazy:2');
+
+    assert.throws(() => new AccessorProperty({}), TypeError);
+    assert.throws(() => new AccessorProperty({ getter() {}, setter: 1 }), TypeError);
+})();
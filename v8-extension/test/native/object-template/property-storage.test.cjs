@@ -0,0 +1,96 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { FunctionTemplate, ObjectTemplate } = native;
+    const { NamedPropertyStorage, IndexedPropertyStorage, NamedPropertyHandlerConfiguration } = ObjectTemplate;
+
+    const named = new NamedPropertyStorage();
+    const indexed = new IndexedPropertyStorage();
+    const Store = new FunctionTemplate({ function() {}, instance: { namedHandler: named, indexedHandler: indexed } }).get();
+
+    // Named properties live in the storage of each object.
+    const first = new Store();
+    const second = new Store();
+    first.a = 1;
+    assert.strictEqual(first.a, 1);
+    assert.strictEqual('a' in first, true);
+    assert.strictEqual('a' in second, false);
+    assert.deepStrictEqual(Object.keys(first), ['a']);
+    named.assign(first, { b: 2, c: 3 });
+    named.assign(second, new Map([['d', 4]]));
+    assert.deepStrictEqual(Object.keys(first), ['a', 'b', 'c']);
+    assert.strictEqual(second.d, 4);
+    named.remove(first, ['b']);
+    assert.strictEqual('b' in first, false);
+    assert.strictEqual(delete first.a, true);
+    assert.deepStrictEqual(Object.keys(first), ['c']);
+    named.clear(first);
+    assert.deepStrictEqual(Object.keys(first), []);
+    // Symbols are not intercepted.
+    const symbol = Symbol('own');
+    first[symbol] = true;
+    assert.deepStrictEqual(Object.getOwnPropertySymbols(first), [symbol]);
+
+    // Indexed properties are a dense vector: writing at the length appends, the bulk API replaces it.
+    first[0] = 'x';
+    first[1] = 'y';
+    assert.deepStrictEqual([first[0], first[1], first[2]], ['x', 'y', undefined]);
+    assert.deepStrictEqual(Object.keys(first), ['0', '1']);
+    indexed.assign(first, ['p', 'q', 'r']);
+    assert.deepStrictEqual(Object.keys(first), ['0', '1', '2']);
+    assert.strictEqual(first[2], 'r');
+    indexed.clear(first);
+    assert.strictEqual(0 in first, false);
+
+    // A read-only storage is only modified by the bulk API.
+    const readonly = new NamedPropertyStorage({ readonly: true });
+    const Frozen = new FunctionTemplate({ function() {}, instance: { namedHandler: readonly } }).get();
+    const frozen = new Frozen();
+    readonly.assign(frozen, { k: 1 });
+    assert.throws(() => { frozen.k = 2; }, TypeError);
+    assert.throws(() => { delete frozen.k; }, TypeError);
+    assert.strictEqual(frozen.k, 1);
+    assert.deepStrictEqual(Object.getOwnPropertyDescriptor(frozen, 'k'), { value: 1, writable: false, enumerable: true, configurable: false });
+
+    // Names missing from the storage go to the fallback handler.
+    const fallback = new NamedPropertyHandlerConfiguration({
+        getter({ name }, intercept) {
+            if (name.startsWith('computed')) {
+                intercept(name.length);
+            }
+        }
+    });
+    const withFallback = new NamedPropertyStorage({ fallback });
+    const Computed = new FunctionTemplate({ function() {}, instance: { namedHandler: withFallback } }).get();
+    const computed = new Computed();
+    withFallback.assign(computed, { computedStored: 'stored' });
+    assert.strictEqual(computed.computedStored, 'stored');
+    assert.strictEqual(computed.computedValue, 'computedValue'.length);
+    assert.strictEqual(computed.other, undefined);
+
+    // A handler configuration intercepts on its own.
+    const IndexedPropertyHandlerConfiguration = ObjectTemplate.IndexedPropertyHandlerConfiguration;
+    const Handled = new FunctionTemplate({
+        function() {},
+        instance: {
+            namedHandler: new NamedPropertyHandlerConfiguration({ getter({ name }, intercept) { intercept(`named:${name}`); } }),
+            indexedHandler: new IndexedPropertyHandlerConfiguration({ getter({ index }, intercept) { intercept(index * 2); } })
+        }
+    }).get();
+    const handled = new Handled();
+    assert.strictEqual(handled.anything, 'named:anything');
+    assert.strictEqual(handled[21], 42);
+
+    // The bulk API validates its arguments; a storage is not a handler configuration.
+    assert.throws(() => named.assign(first), TypeError);
+    assert.throws(() => named.assign(1, {}), TypeError);
+    assert.throws(() => named.remove(first, 'a'), TypeError);
+    assert.throws(() => NamedPropertyStorage.prototype.clear.call({}, first), TypeError);
+    assert.throws(() => NamedPropertyStorage(), TypeError);
+    assert.throws(() => new NamedPropertyStorage({ fallback: {} }), TypeError);
+    assert.throws(() => new FunctionTemplate({ function() {}, instance: { namedHandler: indexed } }), TypeError);
+})();
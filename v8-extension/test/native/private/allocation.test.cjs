@@ -0,0 +1,69 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const v8 = require('node:v8');
+const vm = require('node:vm');
+const { Worker } = require('node:worker_threads');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(async function () {
+    'use strict';
+
+    // Wrappers are created from several contexts of the isolate and most of them are collected between rounds, so the later
+    // implementations may reuse the memory of the freed ones. The survivors must keep their own values.
+    v8.setFlagsFromString('--expose-gc');
+    const gc = vm.runInNewContext('gc');
+    const { Context, Private } = native;
+    const target = {};
+    const survivors = [];
+    const keep = (key, index) => {
+        key.set(target, index);
+        if (index % 8 === 0) {
+            survivors.push([key, index]);
+        }
+    };
+    const check = () => {
+        for (const [key, index] of survivors) {
+            assert.strictEqual(key.get(target), index);
+        }
+    };
+
+    const context = new Context();
+    const createInContext = context.compileFunction({ source: 'return new Private();', scopes: [{ Private }] });
+    const createInVm = vm.runInNewContext('() => new Private()', { Private });
+    const creators = [() => new Private(), createInContext, createInVm];
+    let index = 0;
+    for (let round = 0; round < 3; ++round) {
+        for (const create of creators) {
+            for (let i = 0; i < 1000; ++i) {
+                keep(create(), index++);
+            }
+            await new Promise(resolve => setImmediate(resolve));
+            gc();
+            check();
+        }
+    }
+
+    // A worker creates its own wrappers and frees them on exit; the wrappers of the main thread are not affected.
+    const source = `
+        const native = require(${JSON.stringify(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'))});
+        const target = {};
+        const keys = Array.from({ length: 2000 }, (_, i) => { const key = new native.Private(); key.set(target, i); return key; });
+        require('node:worker_threads').parentPort.postMessage(keys.every((key, i) => key.get(target) === i));
+    `;
+    for (let i = 0; i < 2; ++i) {
+        const worker = new Worker(source, { eval: true });
+        const [result] = await Promise.all([
+            new Promise((resolve, reject) => worker.once('message', resolve).once('error', reject)),
+            new Promise(resolve => worker.once('exit', resolve))
+        ]);
+        assert.strictEqual(result, true);
+        for (let j = 0; j < 1000; ++j) {
+            keep(new Private(), index++);
+        }
+        gc();
+        check();
+    }
+})().catch(error => {
+    console.error(error);
+    process.exitCode = 1;
+});
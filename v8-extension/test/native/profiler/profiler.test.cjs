@@ -0,0 +1,67 @@
+const assert = require('node:assert');
+const vm = require('node:vm');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    assert(typeof native.Profiler === 'function');
+    assert.throws(() => native.Profiler(), TypeError, `Profiler()`);
+    assert.throws(() => new native.Profiler({ interval: -1 }), RangeError, `new Profiler({ interval: -1 })`);
+    assert.throws(() => new native.Profiler({ depth: 5000 }), RangeError, `new Profiler({ depth: 5000 })`);
+
+    const profiler = new native.Profiler({ interval: 1, capacity: 4096 });
+    assert.strictEqual(profiler.running, false);
+    assert.throws(() => profiler.collapse({}), TypeError, `collapse(<Object>)`);
+
+    const tenantA = vm.createContext({});
+    const tenantB = vm.createContext({});
+    const burnA = vm.runInContext('(function burnA(until) { while (Date.now() < until) {} })', tenantA, { filename: 'tenant-a.js' });
+    const burnB = vm.runInContext('(function burnB(until) { while (Date.now() < until) {} })', tenantB, { filename: 'tenant-b.js' });
+    const contextA = native.Context.for(vm.runInContext('globalThis', tenantA));
+    const contextB = native.Context.for(vm.runInContext('globalThis', tenantB));
+
+    profiler.start();
+    assert.strictEqual(profiler.running, true);
+    // Enter each tenant through vm (script evaluation enters the context of the tenant).
+    tenantA.burnA = burnA;
+    tenantB.burnB = burnB;
+    vm.runInContext('burnA(Date.now() + 60)', tenantA);
+    vm.runInContext('burnB(Date.now() + 30)', tenantB);
+    profiler.stop();
+    assert.strictEqual(profiler.running, false);
+    assert(profiler.samples > 0);
+
+    const all = profiler.collapse();
+    assert(all instanceof Map);
+    assert(all.has(contextA) && all.has(contextB), 'samples are attributed to the entered context');
+
+    const textA = profiler.collapse(contextA);
+    assert.strictEqual(textA, all.get(contextA));
+    const lines = textA.trim().split('\n');
+    for (const line of lines) {
+        assert.match(line, /^.+ \d+$/, 'collapsed-stack lines end with a count');
+    }
+    assert(textA.includes('burnA (tenant-a.js:1)'), textA);
+    assert(!textA.includes('burnB'), 'stacks of other contexts are not included');
+    const countA = lines.reduce((sum, line) => sum + Number(line.slice(line.lastIndexOf(' ') + 1)), 0);
+    const countB = profiler.collapse(contextB).trim().split('\n').reduce((sum, line) => sum + Number(line.slice(line.lastIndexOf(' ') + 1)), 0);
+    assert(countA > countB, `the tenant burning more CPU has more samples (${countA} vs ${countB})`);
+
+    // Nothing is sampled while stopped.
+    const samples = profiler.samples;
+    vm.runInContext('burnA(Date.now() + 10)', tenantA);
+    assert.strictEqual(profiler.samples, samples);
+
+    // The ring buffer keeps the most recent samples only.
+    const small = new native.Profiler({ interval: 1, capacity: 4 });
+    small.start();
+    vm.runInContext('burnA(Date.now() + 30)', tenantA);
+    small.stop();
+    assert.strictEqual(small.samples, 4);
+
+    profiler.clear();
+    assert.strictEqual(profiler.samples, 0);
+    assert.strictEqual(profiler.collapse().size, 0);
+})();
@@ -0,0 +1,66 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(async function () {
+    'use strict';
+
+    assert(typeof native.Scheduler === 'function');
+    assert.throws(() => native.Scheduler(), TypeError, `Scheduler()`);
+    assert.throws(() => new native.Scheduler({ slice: 0 }), RangeError, `new Scheduler({ slice: 0 })`);
+
+    const scheduler = new native.Scheduler({ slice: 2 });
+    assert.throws(() => scheduler.run(5), TypeError, `run(<Number>)`);
+    assert.throws(() => scheduler.run(() => 5), TypeError, `run(<Function returning a Number>)`);
+
+    // The return value of the generator fulfills the promise; arguments are passed to the generator function.
+    assert.strictEqual(await scheduler.run(function* (a, b) { const x = yield 1; return a + b + x; }, 2, 3), 6, 'yield of a non-thenable resumes with the same value');
+
+    // Yielding a thenable waits for it.
+    assert.strictEqual(await scheduler.run(function* () {
+        const value = yield new Promise(resolve => setTimeout(() => resolve(7), 5));
+        return value * 2;
+    }), 14);
+    assert.strictEqual(await scheduler.run(function* () {
+        try {
+            yield Promise.reject(new Error('inner'));
+        } catch (error) {
+            return error.message;
+        }
+    }), 'inner', 'a rejected thenable throws into the generator');
+
+    // Exceptions reject the promise.
+    await assert.rejects(scheduler.run(function* () { yield; throw new TypeError('thrown'); }), TypeError);
+
+    // Long tasks are preempted at yields and interleaved with each other.
+    const order = [];
+    let last;
+    function* busy(name, until) {
+        const end = Date.now() + until;
+        while (Date.now() < end) {
+            if (last !== name) {
+                order.push(name);
+                last = name;
+            }
+            yield;
+        }
+        return name;
+    }
+    const before = scheduler.stats;
+    assert.deepStrictEqual(await Promise.all([scheduler.run(busy, 'a', 40), scheduler.run(busy, 'b', 40)]), ['a', 'b']);
+    const after = scheduler.stats;
+    assert(after.preemptions > before.preemptions, 'long tasks are preempted');
+    assert(after.interrupts > before.interrupts, 'slices expire through interrupts');
+    assert(order.length > 2, `tasks are interleaved: ${order.join('')}`);
+    assert.strictEqual(after.tasks, 0);
+
+    // Other events are processed between turns.
+    let ticks = 0;
+    const timer = setInterval(() => ++ticks, 1);
+    await scheduler.run(busy, 'c', 40);
+    clearInterval(timer);
+    assert(ticks > 0, 'the event loop runs between turns');
+})().catch(error => {
+    console.error(error);
+    process.exitCode = 1;
+});
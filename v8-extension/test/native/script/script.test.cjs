@@ -0,0 +1,56 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { Script, Context } = native;
+
+    // Compiled once, run in any number of contexts: each run binds to the global of its context.
+    const source = 'globalThis.counter = (globalThis.counter ?? 0) + 1';
+    const script = new Script({ source, location: 'bootstrap.js' });
+    const first = new Context();
+    const second = new Context();
+    assert.strictEqual(script.run(first), 1);
+    assert.strictEqual(script.run(first), 2);
+    assert.strictEqual(script.run(second), 1);
+    assert.strictEqual(globalThis.counter, undefined);
+    assert.strictEqual(script.cachedDataRejected, undefined);
+
+    // The code cache is accepted by a script compiled from the same source and rejected for another source.
+    const cachedData = script.createCachedData();
+    assert.ok(cachedData instanceof ArrayBuffer && cachedData.byteLength > 0);
+    const cached = new Script({ source, location: 'bootstrap.js', cachedData: new Uint8Array(cachedData) });
+    assert.strictEqual(cached.cachedDataRejected, false);
+    assert.strictEqual(cached.run(second), 2);
+    const rejected = new Script({ source: '1 + 1', cachedData });
+    assert.strictEqual(rejected.cachedDataRejected, true);
+    assert.strictEqual(rejected.run(first), 2);
+
+    // Exceptions of the script propagate unchanged.
+    assert.throws(() => new Script({ source: 'throw new RangeError("inner")' }).run(first), { name: 'RangeError', message: 'inner' });
+    assert.throws(() => new Script({ source: 'return 1' }), { name: 'SyntaxError' });
+
+    // An expired timeout terminates the script and throws in the calling context; the isolate remains usable.
+    const loop = new Script({ source: 'while (true);' });
+    assert.throws(() => loop.run(first, { timeout: 20 }), error => error instanceof Error && /timed out after 20ms/.test(error.message));
+    assert.strictEqual(script.run(first, { timeout: 1000 }), 3);
+
+    // The timeout of an enclosing run is not cancelled by an inner run.
+    const current = Context.current;
+    globalThis.inner = () => loop.run(second, { timeout: 10000 });
+    const outer = new Script({ source: 'try { inner(); } catch { } "not terminated"' });
+    assert.throws(() => outer.run(current, { timeout: 20 }), /timed out after 20ms/);
+
+    // An inner timeout that expires is caught by the enclosing script.
+    globalThis.inner = () => loop.run(second, { timeout: 10 });
+    assert.strictEqual(new Script({ source: 'try { inner(); "no" } catch (e) { e.message }' }).run(current, { timeout: 10000 }), 'Script execution timed out after 10ms');
+    delete globalThis.inner;
+
+    assert.throws(() => script.run({}), TypeError);
+    assert.throws(() => script.run(first, { timeout: 0 }), RangeError);
+    assert.throws(() => Script.prototype.run.call({}, first), TypeError);
+    assert.throws(() => new Script({ source: '1', cachedData: 'nope' }), TypeError);
+    assert.throws(() => Script({ source: '1' }), TypeError);
+})();
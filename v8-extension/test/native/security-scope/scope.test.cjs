@@ -0,0 +1,59 @@
+const assert = require('node:assert');
+const vm = require('node:vm');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    assert(typeof native.SecurityScope === 'function');
+    assert.throws(() => native.SecurityScope({}), TypeError, `SecurityScope()`);
+    assert.throws(() => new native.SecurityScope(), TypeError, `new SecurityScope()`);
+    assert.throws(() => new native.SecurityScope(5), TypeError, `new SecurityScope(<Number>)`);
+    assert.throws(() => new native.SecurityScope({}, { stateError: 5 }), TypeError, `new SecurityScope({}, { stateError: <Number> })`);
+
+    const realm = vm.runInContext('globalThis', vm.createContext({}));
+    realm.value = 1;
+
+    class StateError extends Error {}
+    const scope = new native.SecurityScope(realm, { stateError: StateError });
+    assert.strictEqual(scope.locked, false);
+    assert.strictEqual(Object.getPrototypeOf(scope.lockToken), null);
+
+    // In the locked state the security token of the realm does not match the token of this context.
+    scope.enterLock();
+    assert.strictEqual(scope.locked, true);
+    assert.throws(() => realm.value, TypeError, `access to locked realm`);
+    scope.enterLock();
+    assert.strictEqual(scope.leaveLock(), true, `nested leaveLock()`);
+    assert.throws(() => realm.value, TypeError, `access to locked realm after nested leaveLock()`);
+
+    scope.enterUnlock();
+    assert.strictEqual(scope.locked, false);
+    assert.strictEqual(realm.value, 1);
+    assert.throws(() => scope.leaveLock(), StateError, `leaveLock() while unlocked`);
+    assert.strictEqual(scope.leaveUnlock(), true, `leaveUnlock() returns to locked`);
+    assert.throws(() => realm.value, TypeError, `access to locked realm after leaveUnlock()`);
+
+    const result = scope.invokeUnlocked(function (a, b) {
+        return [this, realm.value, a, b, scope.locked];
+    }, 'receiver', [2, 3]);
+    assert.deepStrictEqual(result, ['receiver', 1, 2, 3, false]);
+    assert.strictEqual(scope.locked, true, `invokeUnlocked() restores the state`);
+
+    assert.throws(() => scope.invokeUnlocked(() => {
+        throw new RangeError('test');
+    }), RangeError);
+    assert.strictEqual(scope.locked, true, `invokeUnlocked() restores the state on exception`);
+    assert.throws(() => realm.value, TypeError, `access to locked realm after invokeUnlocked() throws`);
+
+    assert.strictEqual(scope.leaveLock(), false);
+    assert.strictEqual(realm.value, 1);
+    assert.throws(() => scope.leaveLock(), StateError, `leaveLock() on empty state`);
+    assert.throws(() => scope.leaveUnlock(), StateError, `leaveUnlock() on empty state`);
+
+    assert.strictEqual(scope.invokeLocked(() => scope.locked), true);
+    assert.strictEqual(scope.locked, false);
+    assert.throws(() => scope.invokeLocked(5), TypeError, `invokeLocked(<Number>)`);
+    assert.throws(() => scope.invokeLocked(() => {}, null, 5), TypeError, `invokeLocked(fn, null, <Number>)`);
+})();
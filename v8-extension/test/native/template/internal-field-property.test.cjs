@@ -0,0 +1,69 @@
+const assert = require('node:assert');
+const zlib = require('node:zlib');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { Context, Template, FunctionTemplate } = native;
+    const { InternalFieldProperty } = Template;
+
+    // Field 0 is reserved for the embedder.
+    assert.throws(() => new InternalFieldProperty({ index: 0, type: 'int32' }), RangeError);
+    assert.throws(() => new InternalFieldProperty({ index: 1.5, type: 'int32' }), RangeError);
+
+    const count = new InternalFieldProperty({ index: 1, type: 'int32' });
+    const label = new InternalFieldProperty({ index: 2, type: 'object', readonly: true });
+    const Counter = new FunctionTemplate({
+        function() {},
+        instance: {
+            internalFieldCount: 3,
+            properties: { count, label }
+        }
+    }).get();
+
+    // Only an ObjectTemplate reserving the field can hold the property.
+    const beyond = new InternalFieldProperty({ index: 3, type: 'double' });
+    assert.throws(() => new FunctionTemplate({ function() {}, instance: { internalFieldCount: 3, properties: { beyond } } }), TypeError);
+    assert.throws(() => new FunctionTemplate({ function() {}, instance: { properties: { count } } }), TypeError);
+    assert.throws(() => new FunctionTemplate({ function() {}, properties: { count } }), TypeError);
+
+    const counter = new Counter();
+    assert.strictEqual(counter.count, 0);
+    counter.count = 41.9;
+    assert.strictEqual(counter.count, 41);
+    assert.throws(() => { counter.count = {}; }, TypeError);
+    assert.strictEqual(counter.label, null);
+    const value = {};
+    label.set(counter, value);
+    assert.strictEqual(label.get(counter), value);
+    assert.strictEqual(counter.label, value);
+
+    // Out of range: the template reserves fields 0..2 only.
+    assert.throws(() => beyond.get(counter), TypeError);
+    assert.throws(() => beyond.set(counter, 1), TypeError);
+
+    // Through the prototype chain, the fields of the holder are read; a write defines a data property on the receiver.
+    const derived = Object.create(counter);
+    assert.strictEqual(derived.count, 41);
+    derived.count = 7;
+    assert.strictEqual(counter.count, 41);
+    assert.strictEqual(Object.getOwnPropertyDescriptor(derived, 'count').value, 7);
+
+    // Receivers that were not created from a template reserving the fields.
+    const foreign = [
+        {},
+        zlib.createDeflate()._handle,
+        new Context(),
+        new native.Private('test'),
+        derived
+    ];
+    for (const object of foreign) {
+        assert.throws(() => count.get(object), TypeError);
+        assert.throws(() => count.set(object, 1), TypeError);
+        assert.throws(() => label.set(object, {}), TypeError);
+        assert.strictEqual(Reflect.get(counter, 'count', object), 41);
+    }
+    assert.strictEqual(counter.count, 41);
+})();
@@ -0,0 +1,50 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    assert(typeof native.Trace === 'function');
+    assert.throws(() => new native.Trace(), TypeError, `new Trace()`);
+    assert.strictEqual(typeof native.Trace.available, 'boolean');
+    assert.strictEqual(native.Trace.enabled, false);
+
+    const template = new native.FunctionTemplate({
+        function: function () {}
+    });
+    const callback = template.get();
+
+    // Stopped: nothing is recorded.
+    native.Trace.clear();
+    callback();
+    assert.deepStrictEqual(JSON.parse(native.Trace.export()), { traceEvents: [] });
+
+    native.Trace.start();
+    assert.strictEqual(native.Trace.enabled, true);
+    for (let i = 0; i < 10; ++i) {
+        callback();
+    }
+    native.Trace.stop();
+    callback();
+
+    const trace = JSON.parse(native.Trace.export());
+    assert(Array.isArray(trace.traceEvents));
+    if (!native.Trace.available) {
+        assert.strictEqual(trace.traceEvents.length, 0);
+        return;
+    }
+    const events = trace.traceEvents.filter(event => event.name === 'FunctionTemplate::callback');
+    assert.strictEqual(events.length, 10, `10 FunctionTemplate::callback events`);
+    for (const event of events) {
+        assert.strictEqual(event.ph, 'X');
+        assert.strictEqual(event.cat, 'function-template');
+        assert.strictEqual(event.pid, process.pid);
+        assert(Number.isFinite(event.ts) && event.ts > 0);
+        assert(Number.isFinite(event.dur) && event.dur >= 0);
+        assert(Number.isInteger(event.tid));
+    }
+
+    native.Trace.clear();
+    assert.deepStrictEqual(JSON.parse(native.Trace.export()), { traceEvents: [] });
+})();
@@ -0,0 +1,189 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const vm = require('node:vm');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { WebIDL } = native;
+    assert(typeof WebIDL === 'function');
+    assert.throws(() => new WebIDL(), TypeError, `new WebIDL()`);
+    assert.deepStrictEqual(WebIDL.interfaces, ['Event', 'CustomEvent', 'EventTarget']);
+    assert.throws(() => WebIDL.createInterface('Unknown', {}), TypeError);
+
+    const state = new WeakMap();
+    const eventImplementation = {
+        constructor(type, eventInitDict) {
+            state.set(this, { type, bubbles: !!eventInitDict?.bubbles, cancelable: false, canceled: false, target: null });
+        },
+        get type() {
+            return state.get(this).type;
+        },
+        get target() {
+            return state.get(this).target;
+        },
+        get srcElement() {
+            return state.get(this).target;
+        },
+        get currentTarget() {
+            return null;
+        },
+        composedPath() {
+            return [];
+        },
+        get eventPhase() {
+            return 0;
+        },
+        stopPropagation() {},
+        get cancelBubble() {
+            return false;
+        },
+        set cancelBubble(value) {
+            state.get(this).cancelBubble = value;
+        },
+        stopImmediatePropagation() {},
+        get bubbles() {
+            return state.get(this).bubbles;
+        },
+        get cancelable() {
+            return state.get(this).cancelable;
+        },
+        get returnValue() {
+            return !state.get(this).canceled;
+        },
+        set returnValue(value) {
+            state.get(this).canceled = !value;
+        },
+        preventDefault() {
+            state.get(this).canceled = true;
+        },
+        get defaultPrevented() {
+            return state.get(this).canceled;
+        },
+        get composed() {
+            return false;
+        },
+        get isTrusted() {
+            return false;
+        },
+        get timeStamp() {
+            return 0;
+        },
+        initEvent(...args) {
+            state.get(this).init = args;
+        }
+    };
+
+    // Every member must be implemented.
+    const incomplete = Object.defineProperties({}, Object.getOwnPropertyDescriptors(eventImplementation));
+    delete incomplete.initEvent;
+    assert.throws(() => WebIDL.createInterface('Event', incomplete), {
+        name: 'TypeError',
+        message: `The implementation of 'Event' is missing the operation 'initEvent'.`
+    });
+
+    const Event = WebIDL.createInterface('Event', eventImplementation);
+    assert.strictEqual(Event.name, 'Event');
+    assert.strictEqual(Event.length, 1);
+    assert.strictEqual(Event.AT_TARGET, 2);
+    assert.strictEqual(Event.prototype.BUBBLING_PHASE, 3);
+    assert.strictEqual(Event.prototype.initEvent.length, 1);
+    assert.throws(() => Event('x'), {
+        name: 'TypeError',
+        message: `Failed to construct 'Event': Please use the 'new' operator, this DOM object constructor cannot be called as a function.`
+    });
+    assert.throws(() => new Event(), {
+        name: 'TypeError',
+        message: `Failed to construct 'Event': 1 argument required, but only 0 present.`
+    });
+
+    // DOMString and boolean conversions.
+    const event = new Event(42, { bubbles: 1 });
+    assert(event instanceof Event);
+    assert.strictEqual(event.type, '42');
+    assert.strictEqual(event.bubbles, true);
+    assert.throws(() => new Event(Symbol('x')), TypeError);
+    event.initEvent({ toString: () => 'y' }, 'yes');
+    assert.deepStrictEqual(state.get(event).init, ['y', true, false]);
+    event.returnValue = 0;
+    assert.strictEqual(event.defaultPrevented, true);
+    assert.throws(() => event.initEvent(), {
+        name: 'TypeError',
+        message: `Failed to execute 'initEvent' on 'Event': 1 argument required, but only 0 present.`
+    });
+
+    // Receivers are checked by the signature.
+    assert.throws(() => Event.prototype.preventDefault.call({}), TypeError);
+    assert.throws(() => Object.getOwnPropertyDescriptor(Event.prototype, 'type').get.call({}), TypeError);
+
+    // [LegacyUnforgeable] attributes are own properties of the instances.
+    assert(Object.hasOwn(event, 'isTrusted'));
+    assert(!Object.hasOwn(Event.prototype, 'isTrusted'));
+    assert.strictEqual(event.isTrusted, false);
+
+    // Inheritance.
+    assert.throws(() => WebIDL.createInterface('CustomEvent', {}), TypeError);
+    const CustomEvent = WebIDL.createInterface('CustomEvent', {
+        constructor(type, eventInitDict) {
+            eventImplementation.constructor.call(this, type, eventInitDict);
+            state.get(this).detail = eventInitDict?.detail ?? null;
+        },
+        get detail() {
+            return state.get(this).detail;
+        },
+        initCustomEvent(type, bubbles, cancelable, detail) {
+            state.get(this).init = [type, bubbles, cancelable, detail];
+        }
+    }, { parent: Event });
+    assert.strictEqual(Object.getPrototypeOf(CustomEvent), Event);
+    const custom = new CustomEvent('c', { detail: 5 });
+    assert(custom instanceof Event);
+    assert.strictEqual(custom.type, 'c');
+    assert.strictEqual(custom.detail, 5);
+    custom.initCustomEvent('d');
+    assert.deepStrictEqual(state.get(custom).init, ['d', false, false, null]);
+    assert.throws(() => CustomEvent.prototype.initCustomEvent.call(event, 'x'), TypeError);
+
+    // Interface types, nullable callback interfaces and illegal receivers.
+    const listeners = new WeakMap();
+    const EventTarget = WebIDL.createInterface('EventTarget', {
+        constructor() {
+            listeners.set(this, []);
+        },
+        addEventListener(type, callback, options) {
+            listeners.get(this).push([type, callback, options]);
+        },
+        removeEventListener() {},
+        dispatchEvent(event) {
+            state.get(event).target = this;
+            return !state.get(event).canceled;
+        }
+    });
+    const target = new EventTarget();
+    target.addEventListener('a', null);
+    target.addEventListener('b', { handleEvent() {} }, true);
+    assert.strictEqual(listeners.get(target)[0][1], null);
+    assert.strictEqual(listeners.get(target)[1][2], true);
+    assert.throws(() => target.addEventListener('c', 5), {
+        name: 'TypeError',
+        message: `Failed to execute 'addEventListener' on 'EventTarget': parameter 2 is not of type 'EventListener'.`
+    });
+    assert.throws(() => target.dispatchEvent({}), {
+        name: 'TypeError',
+        message: `Failed to execute 'dispatchEvent' on 'EventTarget': parameter 1 is not of type 'Event'.`
+    });
+    assert.strictEqual(target.dispatchEvent(custom), true);
+    assert.strictEqual(custom.target, target);
+
+    // Instances created without the implementation constructor, in another realm.
+    const sandbox = vm.createContext({});
+    const OtherEvent = WebIDL.createInterface('Event', eventImplementation, { context: vm.runInContext('Object', sandbox) });
+    assert.notStrictEqual(OtherEvent, Event);
+    assert.strictEqual(Object.getPrototypeOf(OtherEvent), vm.runInContext('Function.prototype', sandbox));
+    const other = WebIDL.createInstance(OtherEvent);
+    assert.strictEqual(Object.getPrototypeOf(other), OtherEvent.prototype);
+    state.set(other, { type: 'other', canceled: false });
+    assert.strictEqual(target.dispatchEvent(other), true, 'platform objects of other realms are accepted');
+    assert.throws(() => WebIDL.createInstance(function () {}), TypeError);
+})();
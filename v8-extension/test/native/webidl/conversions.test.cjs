@@ -0,0 +1,168 @@
+const assert = require('node:assert');
+const { resolve: resolvePath } = require('node:path');
+const v8 = require('node:v8');
+const native = require(resolvePath(process.env.JS_COMPILED_MODULE_PATH, 'native.node'));
+
+(function () {
+    'use strict';
+
+    const { idl, WebIDL } = native;
+    assert(Object.isFrozen(idl));
+
+    // Scalar types.
+    assert.strictEqual(idl.boolean(''), false);
+    assert.strictEqual(idl.boolean({}), true);
+    assert.strictEqual(idl.octet(257), 1);
+    assert.strictEqual(idl.byte(255), -1);
+    assert.strictEqual(idl['unsigned long'](-1), 4294967295);
+    assert.strictEqual(idl.long(2 ** 31), -(2 ** 31));
+    assert.strictEqual(idl['long long'](-1.5), -1);
+    assert.strictEqual(idl['unsigned long long'](2 ** 40 + 0.5), 2 ** 40);
+    assert(Object.is(idl.short(-0), 0));
+    assert.strictEqual(idl.double('1.5'), 1.5);
+    assert.throws(() => idl.double(NaN), { name: 'TypeError', message: 'The provided double value is non-finite.' });
+    assert(Number.isNaN(idl['unrestricted double'](NaN)));
+    assert.strictEqual(idl.float(0.1), Math.fround(0.1));
+    assert.strictEqual(idl.DOMString(12), '12');
+    assert.strictEqual(idl.USVString('a\uD800'), 'a�');
+    assert.throws(() => idl.ByteString('Ā'), TypeError);
+    assert.throws(() => idl.object(1), { name: 'TypeError', message: `The provided value is not of type 'object'.` });
+
+    // [EnforceRange] and [Clamp].
+    const enforced = idl.enforceRange(idl.octet);
+    assert.strictEqual(enforced(255.9), 255);
+    assert.throws(() => enforced(256), { name: 'TypeError', message: `Value is outside the 'octet' value range.` });
+    assert.throws(() => enforced(Infinity), { name: 'TypeError', message: 'Value is infinite and cannot be converted to octet.' });
+    const clamped = idl.clamp(idl.byte);
+    assert.strictEqual(clamped(1000), 127);
+    assert.strictEqual(clamped(2.5), 2);
+    assert.strictEqual(clamped(NaN), 0);
+    assert.throws(() => idl.clamp(idl.double), TypeError);
+
+    // Composite types.
+    assert.strictEqual(idl.nullable(idl.long)(undefined), null);
+    assert.deepStrictEqual(idl.sequence(idl.boolean)(new Set([0, 1])), [false, true]);
+    assert.throws(() => idl.sequence(idl.long)(5), TypeError);
+    assert.throws(() => idl.nullable(idl.any), TypeError);
+    const mode = idl.enumeration('Mode', ['open', 'closed']);
+    assert.strictEqual(mode('open'), 'open');
+    assert.throws(() => mode('other'), { name: 'TypeError', message: `The provided value 'other' is not a valid enum value of type Mode.` });
+    assert.throws(() => mode('режим €'), { name: 'TypeError', message: `The provided value 'режим €' is not a valid enum value of type Mode.` });
+    assert.throws(() => idl.enumeration('Режим', ['a'])('b'), { message: `The provided value 'b' is not a valid enum value of type Режим.` });
+    // The messages are built from native literals and converted values, in each representation and past the inline buffer
+    // (256 one-byte characters): ASCII, Latin-1, two-byte (widening before or after the spill), astral and lone surrogates.
+    const enumMessage = (value, type = 'Mode') => `The provided value '${value}' is not a valid enum value of type ${type}.`;
+    for (const value of ['', 'café ÿ', '\u00ff'.repeat(300), 'x'.repeat(300), 'x'.repeat(300) + 'Ж', 'Ж' + 'x'.repeat(300), '😀\ud800x', 'a\0b']) {
+        assert.throws(() => mode(value), { message: enumMessage(value) }, JSON.stringify(value.slice(0, 8)));
+    }
+    const longType = 'Тип'.repeat(100);
+    assert.throws(() => idl.enumeration(longType, ['a'])('é'), { message: enumMessage('é', longType) });
+    assert.strictEqual(idl.callbackFunction('Function')(Math.max), Math.max);
+    assert.throws(() => idl.callbackFunction('Function')({}), { message: `The provided value is not of type 'Function'.` });
+
+    // Dictionaries: the members are read in lexicographic order, the parent members first.
+    const base = idl.dictionary({
+        zeta: { type: idl.long, default: 1 }
+    }, { name: 'Base' });
+    const options = idl.dictionary({
+        once: { type: idl.boolean, default: false },
+        capture: idl.boolean,
+        mode: { type: mode, required: true }
+    }, { name: 'Options', parent: base });
+    const order = [];
+    const input = new Proxy({ capture: 1, mode: 'closed' }, {
+        get(target, key) {
+            order.push(key);
+            return target[key];
+        }
+    });
+    assert.deepStrictEqual(options(input), { zeta: 1, capture: true, mode: 'closed', once: false });
+    assert.deepStrictEqual(order, ['zeta', 'capture', 'mode', 'once']);
+    assert.throws(() => options({}), {
+        name: 'TypeError',
+        message: `Failed to read the 'mode' property from 'Options': Required member is undefined.`
+    });
+    assert.throws(() => options({ mode: 'x' }), {
+        name: 'TypeError',
+        message: `Failed to read the 'mode' property from 'Options': The provided value 'x' is not a valid enum value of type Mode.`
+    });
+    assert.throws(() => options(1), { message: `The provided value is not of type 'Options'.` });
+    assert.deepStrictEqual(base(null), { zeta: 1 });
+    assert.throws(() => idl.dictionary({ x: 1 }), TypeError);
+    assert.throws(() => idl.dictionary({}, { parent: idl.long }), TypeError);
+
+    // The results are plain objects of the current realm; any member name is an own data property.
+    const names = idl.dictionary({
+        ['__proto__']: idl.long,
+        'a "quoted"\nname': idl.long,
+        '0': idl.long,
+        'constructor': { type: idl.long, default: 2 }
+    });
+    const named = names({ __proto__: { ['__proto__']: 1 }, 'a "quoted"\nname': 3 });
+    assert.strictEqual(Object.getPrototypeOf(named), Object.prototype);
+    assert.deepStrictEqual(Object.getOwnPropertyDescriptor(named, '__proto__'), { value: 1, writable: true, enumerable: true, configurable: true });
+    assert.deepStrictEqual(Reflect.ownKeys(named), ['__proto__', 'a "quoted"\nname', 'constructor']);
+    assert.strictEqual(named['a "quoted"\nname'], 3);
+    assert.deepStrictEqual(Reflect.ownKeys(names({ __proto__: null, 0: 4 })), ['0', 'constructor']);
+
+    // The results of the same shape share a map; they are not dictionary-mode objects.
+    v8.setFlagsFromString('--allow-natives-syntax');
+    const hasFastProperties = new Function('value', 'return %HasFastProperties(value)');
+    const haveSameMap = new Function('a', 'b', 'return %HaveSameMap(a, b)');
+    assert(hasFastProperties(options({ mode: 'open' })));
+    assert(haveSameMap(options({ mode: 'open' }), options({ mode: 'closed', once: 1 })));
+    assert(!haveSameMap(options({ mode: 'open' }), options({ mode: 'open', capture: true })));
+
+    // Unions select the member type by the kind of the value.
+    const flags = idl.dictionary({ capture: { type: idl.boolean, default: false } }, { name: 'Flags' });
+    const union = idl.union(flags, idl.boolean);
+    assert.strictEqual(union.name, '(Flags or boolean)');
+    assert.strictEqual(union(true), true);
+    assert.deepStrictEqual(union(undefined), { capture: false });
+    assert.deepStrictEqual(union({ capture: 1 }), { capture: true });
+    assert.strictEqual(union(0), false);
+    assert.strictEqual(idl.union(idl.long, idl.DOMString)(5), 5);
+    assert.strictEqual(idl.union(idl.long, idl.DOMString)(true), 'true');
+    assert.strictEqual(idl.union(idl.nullable(idl.long), idl.DOMString)(undefined), null);
+    assert.throws(() => idl.union(idl.long), TypeError);
+
+    // Interface types accept the instances created by WebIDL.createInterface().
+    const EventTarget = WebIDL.createInterface('EventTarget', {
+        constructor() {},
+        addEventListener() {},
+        removeEventListener() {},
+        dispatchEvent() {}
+    });
+    const eventTarget = idl.interface(EventTarget);
+    const target = new EventTarget();
+    assert.strictEqual(eventTarget(target), target);
+    assert.throws(() => eventTarget({}), { message: `The provided value is not of type 'EventTarget'.` });
+    assert.throws(() => idl.interface(function () {}), TypeError);
+
+    // The dictionaries and unions of the generated bindings are converted natively.
+    const received = [];
+    const Target = WebIDL.createInterface('EventTarget', {
+        constructor() {},
+        addEventListener(type, callback, options) {
+            received.push(options);
+        },
+        removeEventListener(type, callback, options) {
+            received.push(options);
+        },
+        dispatchEvent() {}
+    });
+    const object = new Target();
+    object.addEventListener('a', null);
+    object.addEventListener('a', null, { passive: 0, capture: 'yes', signal: 5 });
+    object.addEventListener('a', null, false);
+    object.removeEventListener('a', null, { once: true });
+    assert.deepStrictEqual(received, [
+        { capture: false, once: false },
+        { capture: true, once: false, passive: false },
+        false,
+        { capture: false }
+    ]);
+    // Without a string type in the union, a string falls back to the boolean type.
+    object.addEventListener('a', null, 'x');
+    assert.strictEqual(received.at(-1), true);
+})();
@@ -0,0 +1,1167 @@
+/**
+ * Generate the C++ bindings of WebIDL interfaces.
+ *
+ * Usage: node tools/webidl-bindings.mjs <output.cxx> <input.webidl>...
+ *
+ * For each interface, the output contains a function building the v8::FunctionTemplate of the interface object: the
+ * constructor, the operations and the attributes are native callbacks that check the argument count, convert the arguments
+ * to their IDL types and call the corresponding function of the JavaScript implementation given to
+ * WebIDL.createInterface(). Receivers are checked by the v8::Signature of the interface template. The conversions and the
+ * registry of the generated interfaces live in src/webidl.hxx.
+ *
+ * Supported: interfaces (with partial interfaces and mixins), constants, regular attributes and operations, a single
+ * constructor, optional and variadic arguments with default values, typedefs, enumerations, callback functions and callback
+ * interfaces. Anything else is reported as an error, so that an IDL file is never bound silently wrong.
+ */
+import { readFileSync, writeFileSync } from 'node:fs';
+import { basename } from 'node:path';
+
+class WebIDLError extends Error {
+    constructor(location, message) {
+        super(`${location.file}:${location.line}: ${message}`);
+    }
+}
+
+const tokenPatterns = [
+    ['whitespace', /[\t\n\r ]+/y],
+    ['comment', /\/\/[^\n]*|\/\*[\s\S]*?\*\//y],
+    ['decimal', /-?(?:(?:[0-9]+\.[0-9]*|[0-9]*\.[0-9]+)(?:[Ee][+-]?[0-9]+)?|[0-9]+[Ee][+-]?[0-9]+)/y],
+    ['integer', /-?(?:[1-9][0-9]*|0[Xx][0-9A-Fa-f]+|0[0-7]*)/y],
+    ['identifier', /[_-]?[A-Za-z][0-9A-Z_a-z-]*/y],
+    ['string', /"[^"]*"/y],
+    ['other', /\.\.\.|[^\t\n\r 0-9A-Za-z]/y]
+];
+
+function tokenize(source, file) {
+    const tokens = [];
+    let line = 1;
+    let position = 0;
+    while (position < source.length) {
+        let matched = false;
+        for (const [type, pattern] of tokenPatterns) {
+            pattern.lastIndex = position;
+            const match = pattern.exec(source);
+            if (match == null) {
+                continue;
+            }
+            if (type !== 'whitespace' && type !== 'comment') {
+                tokens.push({ type, value: match[0], file, line });
+            }
+            line += match[0].split('\n').length - 1;
+            position = pattern.lastIndex;
+            matched = true;
+            break;
+        }
+        if (!matched) {
+            throw new WebIDLError({ file, line }, `Unexpected character ${JSON.stringify(source[position])}`);
+        }
+    }
+    tokens.push({ type: 'eof', value: '', file, line });
+    return tokens;
+}
+
+class Parser {
+    #tokens;
+    #index = 0;
+
+    constructor(tokens) {
+        this.#tokens = tokens;
+    }
+
+    peek(offset = 0) {
+        return this.#tokens[Math.min(this.#index + offset, this.#tokens.length - 1)];
+    }
+
+    next() {
+        const token = this.peek();
+        if (token.type !== 'eof') {
+            ++this.#index;
+        }
+        return token;
+    }
+
+    accept(value) {
+        const token = this.peek();
+        if (token.type !== 'string' && token.value === value) {
+            return this.next();
+        }
+        return null;
+    }
+
+    expect(value) {
+        const token = this.accept(value);
+        if (token == null) {
+            throw new WebIDLError(this.peek(), `Expected "${value}", found "${this.peek().value}"`);
+        }
+        return token;
+    }
+
+    identifier() {
+        const token = this.next();
+        if (token.type !== 'identifier') {
+            throw new WebIDLError(token, `Expected an identifier, found "${token.value}"`);
+        }
+        return token.value.replace(/^_/, '');
+    }
+
+    definitions() {
+        const definitions = [];
+        while (this.peek().type !== 'eof') {
+            const extendedAttributes = this.extendedAttributes();
+            const location = this.peek();
+            const definition = this.definition();
+            definition.extendedAttributes = extendedAttributes;
+            definition.location = location;
+            definitions.push(definition);
+        }
+        return definitions;
+    }
+
+    definition() {
+        if (this.accept('callback')) {
+            if (this.accept('interface')) {
+                const name = this.identifier();
+                this.skipBlock();
+                this.expect(';');
+                return { kind: 'callback interface', name };
+            }
+            const name = this.identifier();
+            this.expect('=');
+            const returnType = this.type();
+            this.expect('(');
+            const args = this.argumentList();
+            this.expect(')');
+            this.expect(';');
+            return { kind: 'callback', name, returnType, arguments: args };
+        }
+        const partial = this.accept('partial') != null;
+        if (this.accept('interface')) {
+            const mixin = this.accept('mixin') != null;
+            const name = this.identifier();
+            const parent = !mixin && !partial && this.accept(':') ? this.identifier() : null;
+            const members = this.interfaceMembers();
+            this.expect(';');
+            return { kind: mixin ? 'interface mixin' : 'interface', partial, name, parent, members };
+        }
+        if (this.accept('dictionary')) {
+            const name = this.identifier();
+            const parent = !partial && this.accept(':') ? this.identifier() : null;
+            const members = this.dictionaryMembers();
+            this.expect(';');
+            return { kind: 'dictionary', partial, name, parent, members };
+        }
+        if (partial) {
+            throw new WebIDLError(this.peek(), `Unsupported partial definition "${this.peek().value}"`);
+        }
+        if (this.accept('enum')) {
+            const name = this.identifier();
+            const values = [];
+            this.expect('{');
+            while (!this.accept('}')) {
+                const token = this.next();
+                if (token.type !== 'string') {
+                    throw new WebIDLError(token, `Expected a string, found "${token.value}"`);
+                }
+                values.push(token.value.slice(1, -1));
+                if (!this.accept(',')) {
+                    this.expect('}');
+                    break;
+                }
+            }
+            this.expect(';');
+            return { kind: 'enum', name, values };
+        }
+        if (this.accept('typedef')) {
+            const type = this.typeWithExtendedAttributes();
+            const name = this.identifier();
+            this.expect(';');
+            return { kind: 'typedef', name, type };
+        }
+        if (this.peek().type === 'identifier' && this.peek(1).value === 'includes') {
+            const target = this.identifier();
+            this.expect('includes');
+            const mixin = this.identifier();
+            this.expect(';');
+            return { kind: 'includes', target, mixin };
+        }
+        throw new WebIDLError(this.peek(), `Unsupported definition "${this.peek().value}"`);
+    }
+
+    interfaceMembers() {
+        const members = [];
+        this.expect('{');
+        while (!this.accept('}')) {
+            const extendedAttributes = this.extendedAttributes();
+            const location = this.peek();
+            const member = this.interfaceMember();
+            member.extendedAttributes = extendedAttributes;
+            member.location = location;
+            members.push(member);
+        }
+        return members;
+    }
+
+    interfaceMember() {
+        if (this.accept('const')) {
+            const type = this.type();
+            const name = this.identifier();
+            this.expect('=');
+            const value = this.constValue();
+            this.expect(';');
+            return { kind: 'const', type, name, value };
+        }
+        if (this.accept('constructor')) {
+            this.expect('(');
+            const args = this.argumentList();
+            this.expect(')');
+            this.expect(';');
+            return { kind: 'constructor', arguments: args };
+        }
+        for (const keyword of ['static', 'stringifier', 'inherit', 'getter', 'setter', 'deleter', 'iterable', 'async', 'maplike', 'setlike']) {
+            if (this.peek().value === keyword) {
+                throw new WebIDLError(this.peek(), `Unsupported interface member "${keyword}"`);
+            }
+        }
+        const readonly = this.accept('readonly') != null;
+        if (this.accept('attribute')) {
+            const type = this.typeWithExtendedAttributes();
+            const name = this.identifier();
+            this.expect(';');
+            return { kind: 'attribute', readonly, type, name };
+        }
+        if (readonly) {
+            throw new WebIDLError(this.peek(), `Expected "attribute", found "${this.peek().value}"`);
+        }
+        const returnType = this.type();
+        const name = this.identifier();
+        this.expect('(');
+        const args = this.argumentList();
+        this.expect(')');
+        this.expect(';');
+        return { kind: 'operation', returnType, name, arguments: args };
+    }
+
+    dictionaryMembers() {
+        const members = [];
+        this.expect('{');
+        while (!this.accept('}')) {
+            const extendedAttributes = this.extendedAttributes();
+            const location = this.peek();
+            const required = this.accept('required') != null;
+            const type = this.typeWithExtendedAttributes();
+            const name = this.identifier();
+            const defaultValue = this.accept('=') ? this.defaultValue() : null;
+            this.expect(';');
+            members.push({ kind: 'field', required, type, name, defaultValue, extendedAttributes, location });
+        }
+        return members;
+    }
+
+    argumentList() {
+        const args = [];
+        if (this.peek().value === ')') {
+            return args;
+        }
+        do {
+            const extendedAttributes = this.extendedAttributes();
+            const location = this.peek();
+            const optional = this.accept('optional') != null;
+            const type = this.typeWithExtendedAttributes();
+            const variadic = !optional && this.accept('...') != null;
+            const name = this.argumentName();
+            const defaultValue = optional && this.accept('=') ? this.defaultValue() : null;
+            args.push({ optional, variadic, type, name, defaultValue, extendedAttributes, location });
+        } while (this.accept(','));
+        return args;
+    }
+
+    argumentName() {
+        // Argument names may be keywords, e.g. "callback" or "interface".
+        const token = this.next();
+        if (token.type !== 'identifier') {
+            throw new WebIDLError(token, `Expected an argument name, found "${token.value}"`);
+        }
+        return token.value.replace(/^_/, '');
+    }
+
+    typeWithExtendedAttributes() {
+        const extendedAttributes = this.extendedAttributes();
+        const type = this.type();
+        if (extendedAttributes.length > 0) {
+            type.extendedAttributes = extendedAttributes;
+        }
+        return type;
+    }
+
+    type() {
+        const location = this.peek();
+        let type;
+        if (this.accept('(')) {
+            const members = [this.typeWithExtendedAttributes()];
+            while (this.accept('or')) {
+                members.push(this.typeWithExtendedAttributes());
+            }
+            this.expect(')');
+            type = { kind: 'union', members };
+        } else {
+            type = this.nonUnionType();
+        }
+        type.location = location;
+        if (this.accept('?')) {
+            type = { kind: 'nullable', inner: type, location };
+        }
+        return type;
+    }
+
+    nonUnionType() {
+        if (this.accept('unsigned')) {
+            return { kind: 'named', name: `unsigned ${this.integerType()}` };
+        }
+        if (this.accept('unrestricted')) {
+            const token = this.next();
+            if (token.value !== 'float' && token.value !== 'double') {
+                throw new WebIDLError(token, `Expected "float" or "double", found "${token.value}"`);
+            }
+            return { kind: 'named', name: `unrestricted ${token.value}` };
+        }
+        if (this.peek().value === 'short' || this.peek().value === 'long') {
+            return { kind: 'named', name: this.integerType() };
+        }
+        for (const name of ['sequence', 'FrozenArray', 'ObservableArray', 'Promise', 'record']) {
+            if (this.accept(name)) {
+                this.expect('<');
+                const args = [this.typeWithExtendedAttributes()];
+                if (name === 'record') {
+                    this.expect(',');
+                    args.push(this.typeWithExtendedAttributes());
+                }
+                this.expect('>');
+                return { kind: 'generic', name, arguments: args };
+            }
+        }
+        return { kind: 'named', name: this.identifier() };
+    }
+
+    integerType() {
+        if (this.accept('short')) {
+            return 'short';
+        }
+        this.expect('long');
+        return this.accept('long') ? 'long long' : 'long';
+    }
+
+    constValue() {
+        const token = this.next();
+        if (token.value === 'true' || token.value === 'false') {
+            return { kind: 'boolean', value: token.value === 'true' };
+        }
+        if (token.type === 'integer') {
+            return { kind: 'number', value: Number.parseInt(token.value) };
+        }
+        if (token.type === 'decimal') {
+            return { kind: 'number', value: Number.parseFloat(token.value) };
+        }
+        if (token.value === 'Infinity' || token.value === '-Infinity' || token.value === 'NaN') {
+            return { kind: 'number', value: Number(token.value) };
+        }
+        throw new WebIDLError(token, `Expected a constant value, found "${token.value}"`);
+    }
+
+    defaultValue() {
+        if (this.peek().type === 'string') {
+            return { kind: 'string', value: this.next().value.slice(1, -1) };
+        }
+        if (this.accept('null')) {
+            return { kind: 'null' };
+        }
+        if (this.accept('[')) {
+            this.expect(']');
+            return { kind: 'sequence' };
+        }
+        if (this.accept('{')) {
+            this.expect('}');
+            return { kind: 'dictionary' };
+        }
+        return this.constValue();
+    }
+
+    extendedAttributes() {
+        const list = [];
+        if (!this.accept('[')) {
+            return list;
+        }
+        let depth = 0;
+        let current = null;
+        for (;;) {
+            const token = this.next();
+            if (token.type === 'eof') {
+                throw new WebIDLError(token, 'Unterminated extended attribute list');
+            }
+            if (depth === 0 && token.value === ']') {
+                break;
+            }
+            if (depth === 0 && token.value === ',') {
+                current = null;
+                continue;
+            }
+            if (token.value === '(' || token.value === '[' || token.value === '{') {
+                ++depth;
+            } else if (token.value === ')' || token.value === ']' || token.value === '}') {
+                --depth;
+            }
+            if (current == null) {
+                current = { name: token.value, location: token, tokens: [] };
+                list.push(current);
+            } else {
+                current.tokens.push(token.value);
+            }
+        }
+        return list;
+    }
+
+    skipBlock() {
+        this.expect('{');
+        let depth = 1;
+        while (depth > 0) {
+            const token = this.next();
+            if (token.type === 'eof') {
+                throw new WebIDLError(token, 'Unterminated block');
+            }
+            if (token.value === '{') {
+                ++depth;
+            } else if (token.value === '}') {
+                --depth;
+            }
+        }
+    }
+}
+
+// Extended attributes that do not change the generated code.
+const ignoredExtendedAttributes = new Set(['Exposed', 'SecureContext', 'Global', 'LegacyWindowAlias', 'CrossOriginIsolated']);
+
+function checkExtendedAttributes(list, supported = []) {
+    for (const attribute of list ?? []) {
+        if (!ignoredExtendedAttributes.has(attribute.name) && !supported.includes(attribute.name)) {
+            throw new WebIDLError(attribute.location, `Unsupported extended attribute [${attribute.name}]`);
+        }
+    }
+}
+
+function hasExtendedAttribute(list, name) {
+    return (list ?? []).some(attribute => attribute.name === name);
+}
+
+function resolve(definitions) {
+    const interfaces = new Map();
+    const mixins = new Map();
+    const partials = [];
+    const includes = [];
+    const types = new Map();
+    for (const definition of definitions) {
+        switch (definition.kind) {
+            case 'interface':
+                if (definition.partial) {
+                    partials.push(definition);
+                    break;
+                }
+                checkExtendedAttributes(definition.extendedAttributes);
+                if (interfaces.has(definition.name)) {
+                    throw new WebIDLError(definition.location, `Duplicate interface "${definition.name}"`);
+                }
+                interfaces.set(definition.name, definition);
+                break;
+            case 'interface mixin':
+                if (definition.partial) {
+                    partials.push(definition);
+                    break;
+                }
+                mixins.set(definition.name, definition);
+                break;
+            case 'includes':
+                includes.push(definition);
+                break;
+            case 'dictionary':
+                if (definition.partial) {
+                    partials.push(definition);
+                    break;
+                }
+                // fall through
+            default:
+                if (types.has(definition.name)) {
+                    throw new WebIDLError(definition.location, `Duplicate definition "${definition.name}"`);
+                }
+                types.set(definition.name, definition);
+        }
+    }
+    for (const partial of partials) {
+        const target = partial.kind === 'dictionary' ? types.get(partial.name) : (partial.kind === 'interface mixin' ? mixins : interfaces).get(partial.name);
+        if (target == null) {
+            throw new WebIDLError(partial.location, `Partial ${partial.kind} "${partial.name}" has no definition`);
+        }
+        if (target.kind !== partial.kind) {
+            throw new WebIDLError(partial.location, `Partial ${partial.kind} "${partial.name}" has no definition`);
+        }
+        target.members.push(...partial.members);
+    }
+    for (const include of includes) {
+        const target = interfaces.get(include.target);
+        const mixin = mixins.get(include.mixin);
+        if (target == null || mixin == null) {
+            throw new WebIDLError(include.location, `"${include.target} includes ${include.mixin}" refers to an unknown definition`);
+        }
+        target.members.push(...mixin.members);
+    }
+    const order = [...interfaces.keys()];
+    for (const definition of interfaces.values()) {
+        definition.index = order.indexOf(definition.name);
+        if (definition.parent != null && !interfaces.has(definition.parent)) {
+            throw new WebIDLError(definition.location, `Interface "${definition.name}" inherits from unknown interface "${definition.parent}"`);
+        }
+        const constructors = definition.members.filter(member => member.kind === 'constructor');
+        if (constructors.length > 1) {
+            throw new WebIDLError(constructors[1].location, `Overloaded constructors of "${definition.name}" are not supported`);
+        }
+        const names = new Set();
+        for (const member of definition.members) {
+            if (member.kind === 'constructor') {
+                continue;
+            }
+            if (names.has(member.name)) {
+                throw new WebIDLError(member.location, `Overloaded or duplicate member "${definition.name}.${member.name}" is not supported`);
+            }
+            names.add(member.name);
+        }
+    }
+    for (const definition of types.values()) {
+        if (definition.kind !== 'dictionary') {
+            continue;
+        }
+        checkExtendedAttributes(definition.extendedAttributes);
+        if (definition.parent != null && types.get(definition.parent)?.kind !== 'dictionary') {
+            throw new WebIDLError(definition.location, `Dictionary "${definition.name}" inherits from unknown dictionary "${definition.parent}"`);
+        }
+    }
+    return { interfaces, types };
+}
+
+const integerTypes = {
+    'byte': 'idl::Byte',
+    'octet': 'idl::Octet',
+    'short': 'idl::Short',
+    'unsigned short': 'idl::UnsignedShort',
+    'long': 'idl::Long',
+    'unsigned long': 'idl::UnsignedLong',
+    'long long': 'idl::LongLong',
+    'unsigned long long': 'idl::UnsignedLongLong'
+};
+
+// The types converted by convert<T>() of webidl.hxx, with their category in Converter of webidl-converter.hxx.
+const simpleTypes = {
+    'any': ['idl::Any', 'Any'],
+    'boolean': ['idl::Boolean', 'Boolean'],
+    ...Object.fromEntries(Object.entries(integerTypes).map(([name, type]) => [name, [type, 'Numeric']])),
+    'float': ['idl::Float', 'Numeric'],
+    'unrestricted float': ['idl::UnrestrictedFloat', 'Numeric'],
+    'double': ['idl::Double', 'Numeric'],
+    'unrestricted double': ['idl::UnrestrictedDouble', 'Numeric'],
+    'DOMString': ['idl::DOMString', 'String'],
+    'ByteString': ['idl::ByteString', 'String'],
+    'USVString': ['idl::USVString', 'String'],
+    'object': ['idl::Object', 'Object']
+};
+
+// Extended attributes applicable to types, which select the conversion.
+const typeExtendedAttributes = ['EnforceRange', 'Clamp', 'LegacyNullToEmptyString'];
+
+/**
+ * The type with the extended attributes of its argument or dictionary member, e.g. [EnforceRange] of an argument.
+ */
+function withExtendedAttributes(type, extendedAttributes) {
+    if ((extendedAttributes ?? []).length === 0) {
+        return type;
+    }
+    return { ...type, extendedAttributes: [...(type.extendedAttributes ?? []), ...extendedAttributes] };
+}
+
+function cString(value) {
+    return JSON.stringify(value).replace(/\?/g, '\\?');
+}
+
+function cIdentifier(...parts) {
+    return parts.join('_').replace(/[^0-9A-Za-z_]/g, '_');
+}
+
+class Generator {
+    #interfaces;
+    #types;
+    #enumerations = new Set();
+    #converters = [];
+    #converterIndex = new Map();
+    #callbackLines = [];
+    #builderLines = [];
+
+    constructor({ interfaces, types }) {
+        this.#interfaces = interfaces;
+        this.#types = types;
+    }
+
+    generate(sources) {
+        const callbacks = [];
+        const builders = [];
+        for (const definition of this.#interfaces.values()) {
+            this.interface(definition);
+            const [callbackLines, builderLines] = this.#split();
+            callbacks.push(...callbackLines);
+            builders.push(...builderLines);
+        }
+        const enumerations = [];
+        for (const name of this.#enumerations) {
+            const values = this.#types.get(name).values;
+            enumerations.push(`        const char *const ${cIdentifier(name, 'values')}[] = { ${values.map(cString).join(', ')} };`);
+        }
+        const converters = this.#converters.flatMap(({ name, expression }) => [
+            `        // ${name}`,
+            `        converters.push_back(${expression});`
+        ]);
+        const table = [...this.#interfaces.values()].map(definition => {
+            const parent = definition.parent == null ? -1 : this.#interfaces.get(definition.parent).index;
+            return `        { ${cString(definition.name)}, ${parent}, ${cIdentifier('create', definition.name)} }`;
+        });
+        return [
+            `// Generated by tools/webidl-bindings.mjs from ${sources.map(source => basename(source)).join(', ')}; do not edit.`,
+            '',
+            '#include "webidl.hxx"',
+            '',
+            '#include "js-string-table.hxx"',
+            '#include "trace.hxx"',
+            '#include "webidl-converter.hxx"',
+            '',
+            'namespace dragiyski::node_ext::webidl {',
+            '    namespace {',
+            ...enumerations,
+            ...(enumerations.length > 0 ? [''] : []),
+            ...callbacks,
+            ...builders,
+            '    }',
+            '',
+            '    const InterfaceDefinition definitions[] = {',
+            table.join(',\n'),
+            '    };',
+            '',
+            `    const std::size_t definition_count = ${table.length};`,
+            '',
+            '    void create_converters(v8::Isolate *isolate, std::vector<std::shared_ptr<const Converter>> &converters) {',
+            `        converters.reserve(${this.#converters.length});`,
+            ...converters,
+            '    }',
+            '}',
+            ''
+        ].join('\n');
+    }
+
+    #split() {
+        const result = [this.#callbackLines, this.#builderLines];
+        this.#callbackLines = [];
+        this.#builderLines = [];
+        return result;
+    }
+
+    #callback(...lines) {
+        this.#callbackLines.push(...lines);
+    }
+
+    #builder(...lines) {
+        this.#builderLines.push(...lines);
+    }
+
+    interface(definition) {
+        const name = definition.name;
+        const constructor = definition.members.find(member => member.kind === 'constructor');
+        const builder = cIdentifier('create', name);
+        this.#builder(
+            `        v8::MaybeLocal<v8::FunctionTemplate> ${builder}(v8::Local<v8::Context> context, v8::Local<v8::Object> implementation, v8::Local<v8::FunctionTemplate> parent) {`,
+            '            static const constexpr auto __function_return_type__ = []() { return v8::MaybeLocal<v8::FunctionTemplate>(); };',
+            '            auto isolate = context->GetIsolate();',
+            ''
+        );
+        if (constructor != null) {
+            checkExtendedAttributes(constructor.extendedAttributes);
+            const callback = cIdentifier(name, 'constructor');
+            this.#function(callback, `${name}.constructor`, { kind: 'Constructor', interface: name, member: 'constructor' }, constructor.arguments, null);
+            this.#builder(
+                `            JS_EXPRESSION_RETURN(constructor, get_operation(context, implementation, ${cString(name)}, "constructor"));`,
+                `            auto class_template = v8::FunctionTemplate::New(isolate, ${callback}, constructor, {}, ${this.#length(constructor.arguments)});`
+            );
+        } else {
+            this.#builder(`            auto class_template = v8::FunctionTemplate::New(isolate, illegal_constructor, {}, {}, 0);`);
+        }
+        this.#builder(
+            `            class_template->SetClassName(StringTable::Get(isolate, ${cString(name)}));`,
+            '            if (!parent.IsEmpty()) {',
+            '                class_template->Inherit(parent);',
+            '            }',
+            '            class_template->ReadOnlyPrototype();',
+            '            auto signature = v8::Signature::New(isolate, class_template);',
+            '            auto prototype_template = class_template->PrototypeTemplate();'
+        );
+        // Only the [LegacyUnforgeable] attributes are installed on the instances.
+        if (definition.members.some(member => member.kind === 'attribute' && hasExtendedAttribute(member.extendedAttributes, 'LegacyUnforgeable'))) {
+            this.#builder('            auto instance_template = class_template->InstanceTemplate();');
+        }
+        for (const member of definition.members) {
+            switch (member.kind) {
+                case 'const':
+                    this.#constant(member);
+                    break;
+                case 'attribute':
+                    this.#attribute(name, member);
+                    break;
+                case 'operation':
+                    this.#operation(name, member);
+                    break;
+            }
+        }
+        this.#builder(
+            '            return class_template;',
+            '        }',
+            ''
+        );
+    }
+
+    #constant(member) {
+        checkExtendedAttributes(member.extendedAttributes);
+        const value = member.value;
+        let expression;
+        if (value.kind === 'boolean') {
+            expression = `v8::Boolean::New(isolate, ${value.value})`;
+        } else if (Number.isInteger(value.value) && Math.abs(value.value) <= 2147483647) {
+            expression = `v8::Integer::New(isolate, ${value.value})`;
+        } else {
+            expression = `v8::Number::New(isolate, ${this.#double(value.value)})`;
+        }
+        this.#builder(
+            '            {',
+            `                auto name = StringTable::Get(isolate, ${cString(member.name)});`,
+            `                auto value = ${expression};`,
+            '                class_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_CONST);',
+            '                prototype_template->Set(name, value, JS_PROPERTY_ATTRIBUTE_CONST);',
+            '            }'
+        );
+    }
+
+    #attribute(interfaceName, member) {
+        checkExtendedAttributes(member.extendedAttributes, ['LegacyUnforgeable']);
+        const unforgeable = hasExtendedAttribute(member.extendedAttributes, 'LegacyUnforgeable');
+        const holder = unforgeable ? 'instance_template' : 'prototype_template';
+        const attributes = unforgeable ? 'v8::PropertyAttribute::DontDelete' : 'v8::PropertyAttribute::None';
+        const getter = cIdentifier(interfaceName, 'get', member.name);
+        this.#callback(
+            `        void ${getter}(const v8::FunctionCallbackInfo<v8::Value> &info) {`,
+            '            using __function_return_type__ = void;',
+            `            JS_TRACE_SCOPE("webidl", ${cString(`get ${interfaceName}.${member.name}`)});`,
+            '            auto isolate = info.GetIsolate();',
+            '            v8::HandleScope scope(isolate);',
+            '            auto context = isolate->GetCurrentContext();',
+            '',
+            '            JS_EXPRESSION_RETURN(result, info.Data().As<v8::Function>()->Call(context, info.This(), 0, nullptr));',
+            '            info.GetReturnValue().Set(result);',
+            '        }',
+            ''
+        );
+        this.#builder(
+            '            {',
+            `                JS_EXPRESSION_RETURN(getter, get_getter(context, implementation, ${cString(interfaceName)}, ${cString(member.name)}));`,
+            `                auto getter_template = v8::FunctionTemplate::New(isolate, ${getter}, getter, signature, 0, v8::ConstructorBehavior::kThrow, v8::SideEffectType::kHasSideEffect);`
+        );
+        if (member.readonly) {
+            this.#builder('                v8::Local<v8::FunctionTemplate> setter_template;');
+        } else {
+            const setter = cIdentifier(interfaceName, 'set', member.name);
+            const site = { kind: 'Setter', interface: interfaceName, member: member.name };
+            this.#function(setter, `set ${interfaceName}.${member.name}`, site, [{ type: member.type, name: member.name, extendedAttributes: [] }], null);
+            this.#builder(
+                `                JS_EXPRESSION_RETURN(setter, get_setter(context, implementation, ${cString(interfaceName)}, ${cString(member.name)}));`,
+                `                auto setter_template = v8::FunctionTemplate::New(isolate, ${setter}, setter, signature, 1, v8::ConstructorBehavior::kThrow);`
+            );
+        }
+        this.#builder(
+            `                ${holder}->SetAccessorProperty(StringTable::Get(isolate, ${cString(member.name)}), getter_template, setter_template, ${attributes});`,
+            '            }'
+        );
+    }
+
+    #operation(interfaceName, member) {
+        checkExtendedAttributes(member.extendedAttributes);
+        const callback = cIdentifier(interfaceName, member.name);
+        const site = { kind: 'Operation', interface: interfaceName, member: member.name };
+        this.#function(callback, `${interfaceName}.${member.name}`, site, member.arguments, member.returnType);
+        this.#builder(
+            '            {',
+            `                JS_EXPRESSION_RETURN(operation, get_operation(context, implementation, ${cString(interfaceName)}, ${cString(member.name)}));`,
+            `                auto name = StringTable::Get(isolate, ${cString(member.name)});`,
+            `                auto value = v8::FunctionTemplate::New(isolate, ${callback}, operation, signature, ${this.#length(member.arguments)}, v8::ConstructorBehavior::kThrow);`,
+            '                value->SetClassName(name);',
+            '                prototype_template->Set(name, value, v8::PropertyAttribute::None);',
+            '            }'
+        );
+    }
+
+    #length(args) {
+        const index = args.findIndex(argument => argument.optional || argument.variadic);
+        return index < 0 ? args.length : index;
+    }
+
+    /**
+     * A callback converting its arguments and calling the implementation function in the data of the template.
+     */
+    #function(callback, traceName, site, args, returnType) {
+        const required = site.kind === 'Setter' ? 1 : this.#length(args);
+        const variadic = args.length > 0 && args[args.length - 1].variadic;
+        const fixed = variadic ? args.length - 1 : args.length;
+        this.#callback(
+            `        void ${callback}(const v8::FunctionCallbackInfo<v8::Value> &info) {`,
+            '            using __function_return_type__ = void;',
+            `            JS_TRACE_SCOPE("webidl", ${cString(traceName)});`,
+            '            auto isolate = info.GetIsolate();',
+            '            v8::HandleScope scope(isolate);',
+            '            auto context = isolate->GetCurrentContext();'
+        );
+        if (args.length > 0) {
+            this.#callback(`            static const constexpr Site site = { ${cString(site.interface)}, ${cString(site.member)}, Site::${site.kind} };`);
+        }
+        this.#callback('');
+        if (site.kind === 'Constructor') {
+            this.#callback(
+                '            if (!info.IsConstructCall()) {',
+                `                JS_THROW_ERROR(TypeError, isolate, "Failed to construct '", ${cString(site.interface)}, "': Please use the 'new' operator, this DOM object constructor cannot be called as a function.");`,
+                '            }'
+            );
+        }
+        if (required > 0) {
+            this.#callback(
+                `            if (!check_argument_count(info, site, ${required})) {`,
+                '                return;',
+                '            }'
+            );
+        }
+        if (variadic) {
+            this.#callback(
+                `            std::vector<v8::Local<v8::Value>> arguments(std::max(info.Length(), ${fixed}));`
+            );
+        } else if (args.length > 0) {
+            this.#callback(`            v8::Local<v8::Value> arguments[${args.length}];`);
+        }
+        args.forEach((argument, index) => {
+            checkExtendedAttributes(argument.extendedAttributes, typeExtendedAttributes);
+            const type = withExtendedAttributes(argument.type, argument.extendedAttributes);
+            const parameter = site.kind === 'Setter' ? -1 : index;
+            if (argument.variadic) {
+                this.#callback(
+                    `            for (int index = ${index}; index < info.Length(); ++index) {`,
+                    ...this.#conversion(type, 'arguments[index]', 'info[index]', 'index', '                '),
+                    '            }'
+                );
+            } else if (argument.optional && argument.defaultValue == null && this.#isAny(type)) {
+                this.#callback(`            arguments[${index}] = info[${index}];`);
+            } else if (argument.optional && argument.defaultValue?.kind !== 'dictionary') {
+                this.#callback(
+                    `            if (!info[${index}]->IsUndefined()) {`,
+                    ...this.#conversion(type, `arguments[${index}]`, `info[${index}]`, `${parameter}`, '                '),
+                    '            } else {',
+                    `                arguments[${index}] = ${this.#defaultValue(argument)};`,
+                    '            }'
+                );
+            } else {
+                // The default "{}" is the conversion of undefined to the dictionary, so undefined is converted as any value.
+                this.#callback(...this.#conversion(type, `arguments[${index}]`, `info[${index}]`, `${parameter}`, '            '));
+            }
+        });
+        const argc = variadic ? 'static_cast<int>(arguments.size())' : `${args.length}`;
+        const argv = variadic ? 'arguments.data()' : args.length > 0 ? 'arguments' : 'nullptr';
+        const call = `info.Data().As<v8::Function>()->Call(context, info.This(), ${argc}, ${argv})`;
+        if (returnType == null || (returnType.kind === 'named' && returnType.name === 'undefined')) {
+            this.#callback(`            JS_EXPRESSION_IGNORE(${call});`);
+        } else {
+            this.#callback(
+                `            JS_EXPRESSION_RETURN(result, ${call});`,
+                '            info.GetReturnValue().Set(result);'
+            );
+        }
+        this.#callback('        }', '');
+    }
+
+    #isAny(type) {
+        type = this.#resolveTypedef(type);
+        return type.kind === 'named' && type.name === 'any';
+    }
+
+    #resolveTypedef(type) {
+        while (type.kind === 'named' && this.#types.get(type.name)?.kind === 'typedef') {
+            type = withExtendedAttributes(this.#types.get(type.name).type, type.extendedAttributes);
+        }
+        return type;
+    }
+
+    /**
+     * Statements assigning the conversion of value to target, returning from the callback if the conversion throws.
+     */
+    #conversion(type, target, value, argument, indent) {
+        type = this.#resolveTypedef(type);
+        if (type.kind === 'nullable' && this.#isAny(type.inner)) {
+            throw new WebIDLError(type.location, 'Type "any?" is not valid');
+        }
+        if (this.#isAny(type)) {
+            return [`${indent}${target} = ${value};`];
+        }
+        const idlType = this.#idlType(type);
+        if (idlType == null && type.kind === 'nullable') {
+            return [
+                `${indent}if (${value}->IsNullOrUndefined()) {`,
+                `${indent}    ${target} = v8::Null(isolate);`,
+                `${indent}} else {`,
+                ...this.#conversion(type.inner, target, value, argument, `${indent}    `),
+                `${indent}}`
+            ];
+        }
+        const expression = idlType != null ? `convert<${idlType}>(context, ${value}, site, ${argument})` : this.#converter(type, value, argument);
+        return [
+            `${indent}{`,
+            `${indent}    JS_EXPRESSION_RETURN(converted, ${expression});`,
+            `${indent}    ${target} = converted;`,
+            `${indent}}`
+        ];
+    }
+
+    /**
+     * The type argument of convert<T>() of webidl.hxx, if the type is known at compile time; otherwise null.
+     */
+    #idlType(type) {
+        type = this.#resolveTypedef(type);
+        const attributes = (type.extendedAttributes ?? []).map(attribute => attribute.name);
+        checkExtendedAttributes(type.extendedAttributes, typeExtendedAttributes);
+        if (type.kind === 'nullable') {
+            const inner = this.#idlType(type.inner);
+            return inner != null ? `idl::Nullable<${inner}>` : null;
+        }
+        if (type.kind === 'generic' && type.name === 'sequence') {
+            const element = this.#idlType(type.arguments[0]);
+            return element != null ? `idl::Sequence<${element}>` : null;
+        }
+        if (type.kind !== 'named' || !(type.name in simpleTypes)) {
+            return null;
+        }
+        let result = simpleTypes[type.name][0];
+        for (const name of attributes) {
+            if ((name === 'EnforceRange' || name === 'Clamp') && !(type.name in integerTypes)) {
+                throw new WebIDLError(type.location, `[${name}] applies to integer types only`);
+            }
+            if (name === 'LegacyNullToEmptyString' && type.name !== 'DOMString') {
+                throw new WebIDLError(type.location, `[${name}] applies to DOMString only`);
+            }
+        }
+        if (attributes.includes('EnforceRange') && attributes.includes('Clamp')) {
+            throw new WebIDLError(type.location, '[EnforceRange] and [Clamp] are exclusive');
+        }
+        if (attributes.includes('EnforceRange')) {
+            result = `idl::EnforceRange<${result}>`;
+        } else if (attributes.includes('Clamp')) {
+            result = `idl::Clamp<${result}>`;
+        } else if (attributes.includes('LegacyNullToEmptyString')) {
+            result = `idl::LegacyNullToEmptyString<${result}>`;
+        }
+        return result;
+    }
+
+    #converter(type, value, argument) {
+        if (type.kind === 'named' && this.#interfaces.has(type.name)) {
+            return `to_interface(context, ${value}, site, ${argument}, ${this.#interfaces.get(type.name).index})`;
+        }
+        const definition = type.kind === 'named' ? this.#types.get(type.name) : null;
+        switch (definition?.kind) {
+            case 'callback':
+                return `to_callback_function(context, ${value}, site, ${argument}, ${cString(type.name)})`;
+            case 'callback interface':
+                return `to_callback_interface(context, ${value}, site, ${argument}, ${cString(type.name)})`;
+            case 'enum':
+                this.#enumerations.add(type.name);
+                return `to_enumeration(context, ${value}, site, ${argument}, ${cString(type.name)}, ${cIdentifier(type.name, 'values')}, ${definition.values.length})`;
+        }
+        // The dictionaries, the unions and the sequences of them are converted by the converters built per isolate.
+        return `get_converter(isolate, ${this.#register(type)}).convert(context, ${value}, site, ${argument})`;
+    }
+
+    /**
+     * The index of the converter of the type in create_converters().
+     */
+    #register(type) {
+        type = this.#resolveTypedef(type);
+        const key = this.#typeKey(type);
+        const index = this.#converterIndex.get(key);
+        if (index === -1) {
+            throw new WebIDLError(type.location, `Type "${this.#typeName(type)}" refers to itself`);
+        }
+        if (index != null) {
+            return index;
+        }
+        this.#converterIndex.set(key, -1);
+        const definition = type.kind === 'named' ? this.#types.get(type.name) : null;
+        const expression = definition?.kind === 'dictionary' ? this.#dictionary(definition) : this.#runtime(type);
+        this.#converters.push({ name: key, expression });
+        this.#converterIndex.set(key, this.#converters.length - 1);
+        return this.#converters.length - 1;
+    }
+
+    /**
+     * An expression creating the std::shared_ptr<const Converter> of the type within create_converters().
+     */
+    #runtime(type) {
+        type = this.#resolveTypedef(type);
+        const unsupported = () => new WebIDLError(type.location, `Conversion to ${this.#typeName(type)} is not supported`);
+        if (type.kind === 'nullable') {
+            return `std::make_shared<NullableConverter>(${this.#runtime(type.inner)})`;
+        }
+        const idlType = this.#idlType(type);
+        if (idlType != null) {
+            const category = type.kind === 'generic' ? 'Sequence' : simpleTypes[type.name][1];
+            return `std::make_shared<FunctionConverter>(Converter::${category}, ${cString(this.#typeName(type))}, &convert<${idlType}>)`;
+        }
+        if (type.kind === 'union') {
+            const members = type.members.map(member => this.#runtime(member));
+            return `std::make_shared<UnionConverter>(std::vector<std::shared_ptr<const Converter>> { ${members.join(', ')} })`;
+        }
+        if (type.kind === 'generic') {
+            if (type.name !== 'sequence') {
+                throw unsupported();
+            }
+            return `std::make_shared<SequenceConverter>(${this.#runtime(type.arguments[0])})`;
+        }
+        if (this.#interfaces.has(type.name)) {
+            return `std::make_shared<InterfaceConverter>(${this.#interfaces.get(type.name).index})`;
+        }
+        const definition = this.#types.get(type.name);
+        switch (definition?.kind) {
+            case 'callback':
+                return `std::make_shared<CallbackConverter>(Converter::CallbackFunction, ${cString(type.name)})`;
+            case 'callback interface':
+                return `std::make_shared<CallbackConverter>(Converter::CallbackInterface, ${cString(type.name)})`;
+            case 'enum':
+                return `std::make_shared<EnumerationConverter>(isolate, ${cString(type.name)}, std::vector<std::string> { ${definition.values.map(cString).join(', ')} })`;
+            case 'dictionary':
+                return `converters[${this.#register(type)}]`;
+        }
+        throw unsupported();
+    }
+
+    #dictionary(definition) {
+        const parent = definition.parent == null ? 'nullptr' : `std::static_pointer_cast<const DictionaryConverter>(converters[${this.#register({ kind: 'named', name: definition.parent })}])`;
+        const members = definition.members.map(member => {
+            checkExtendedAttributes(member.extendedAttributes, typeExtendedAttributes);
+            const type = withExtendedAttributes(member.type, member.extendedAttributes);
+            let kind = 'NoDefault';
+            let value = '{}';
+            if (member.required && member.defaultValue != null) {
+                throw new WebIDLError(member.location, `Required member "${definition.name}.${member.name}" cannot have a default value`);
+            }
+            switch (member.defaultValue?.kind) {
+                case undefined:
+                    break;
+                case 'dictionary':
+                    kind = 'DefaultEmpty';
+                    break;
+                case 'sequence':
+                    kind = 'DefaultEmptySequence';
+                    break;
+                default:
+                    kind = 'DefaultValue';
+                    value = `Shared<v8::Value>(isolate, ${this.#defaultValue(member)})`;
+            }
+            return `{ ${cString(member.name)}, ${this.#runtime(type)}, DictionaryConverter::Member::${kind}, ${value}, ${member.required} }`;
+        });
+        return [
+            `std::make_shared<DictionaryConverter>(isolate, ${cString(definition.name)}, ${parent}, std::vector<DictionaryConverter::Member> {`,
+            members.map(member => `            ${member}`).join(',\n'),
+            '        })'
+        ].join('\n');
+    }
+
+    #typeKey(type) {
+        const attributes = (type.extendedAttributes ?? []).map(attribute => `[${attribute.name}] `).join('');
+        return `${attributes}${this.#typeName(type)}`;
+    }
+
+    #typeName(type) {
+        switch (type.kind) {
+            case 'nullable':
+                return `${this.#typeName(type.inner)}?`;
+            case 'union':
+                return `(${type.members.map(member => this.#typeName(member)).join(' or ')})`;
+            case 'generic':
+                return `${type.name}<${type.arguments.map(argument => this.#typeName(argument)).join(', ')}>`;
+            default:
+                return type.name;
+        }
+    }
+
+    #defaultValue(argument) {
+        const value = argument.defaultValue;
+        if (value == null) {
+            return 'v8::Undefined(isolate)';
+        }
+        const type = this.#resolveTypedef(argument.type);
+        switch (value.kind) {
+            case 'null':
+                return 'v8::Null(isolate)';
+            case 'boolean':
+                return value.value ? 'v8::True(isolate)' : 'v8::False(isolate)';
+            case 'string':
+                return `v8::String::NewFromUtf8Literal(isolate, ${cString(value.value)})`;
+            case 'number':
+                if (type.kind === 'named' && type.name in integerTypes && Math.abs(value.value) <= 2147483647) {
+                    return `v8::Integer::New(isolate, ${value.value})`;
+                }
+                return `v8::Number::New(isolate, ${this.#double(value.value)})`;
+            case 'sequence':
+                return 'v8::Array::New(isolate)';
+            case 'dictionary':
+                return 'v8::Object::New(isolate)';
+        }
+        throw new WebIDLError(argument.location, `Unsupported default value of "${argument.name}"`);
+    }
+
+    #double(value) {
+        if (Number.isNaN(value)) {
+            return 'std::numeric_limits<double>::quiet_NaN()';
+        }
+        if (!Number.isFinite(value)) {
+            return `${value < 0 ? '-' : ''}std::numeric_limits<double>::infinity()`;
+        }
+        const text = String(value);
+        return /[.e]/.test(text) ? text : `${text}.0`;
+    }
+}
+
+function main(argv) {
+    if (argv.length < 2) {
+        process.stderr.write('Usage: node tools/webidl-bindings.mjs <output.cxx> <input.webidl>...\n');
+        return 2;
+    }
+    const [output, ...sources] = argv;
+    const definitions = [];
+    for (const source of sources) {
+        const parser = new Parser(tokenize(readFileSync(source, 'utf-8'), source));
+        definitions.push(...parser.definitions());
+    }
+    const code = new Generator(resolve(definitions)).generate(sources);
+    writeFileSync(output, code);
+    return 0;
+}
+
+try {
+    process.exitCode = main(process.argv.slice(2));
+} catch (error) {
+    if (!(error instanceof WebIDLError)) {
+        throw error;
+    }
+    process.stderr.write(`webidl-bindings: ${error.message}\n`);
+    process.exitCode = 1;
+}
@@ -44,6 +44,7 @@ class Event {
     path = [];
     type = '';
     currentTarget = null;
+    eventPhase = EventPhase.NONE;
     stopPropagation = false;
     stopImmediatePropagation = false;
     canceled = false;
@@ -5,7 +5,14 @@ import {
     Platform, requireArgumentCountInterceptor, requireArgumentTypeInterceptor, returnValueInterfaceInterceptor, validateConstructorTargetInterceptor, validateThisImplementationInterceptor
 } from '@dragiyski/web-platform-core';
 import { requireNewTargetInterceptor } from './interceptor.js';
-import { messages } from './messages.js';
+import messages from './messages.js';
+
+const EventPhase = Object.freeze({
+    NONE: 0,
+    CAPTURING_PHASE: 1,
+    AT_TARGET: 2,
+    BUBBLING_PHASE: 3
+});
 
 class EventTarget {
     eventListenerList = [];
@@ -46,18 +53,22 @@ class EventTarget {
             return;
         }
         if (listener.passive == null) {
-            listener.passive = this.defaultPassiveValue(listener.type, this);
+            listener.passive = EventTarget.defaultPassiveValue(listener.type, this);
         }
-        if (!this.eventListenerList.some(
-            item => item.callback === listener.callback && item.type === listener.type && item.capture === listener.capture
-        )) {
+        if (this.findEventListener(listener.type, listener.callback, listener.capture) == null) {
             this.eventListenerList.push(listener);
         }
         if (listener.signal != null) {
-            listener.signal.add(() => { this.removeEventListener(this, listener); });
+            listener.signal.add(() => { this.removeEventListener(listener); });
         }
     }
 
+    findEventListener(type, callback, capture) {
+        return this.eventListenerList.find(
+            item => item.callback === callback && item.type === type && item.capture === capture
+        );
+    }
+
     /**
      * @param {EventListener} listener
      */
@@ -75,6 +86,99 @@ class EventTarget {
         });
         this.eventListenerList.length = 0;
     }
+
+    /**
+     * The "dispatch" algorithm of the DOM standard, without shadow trees (there are no nodes in this realm yet).
+     * @param {import('./Event.js').Event} event
+     * @returns {boolean}
+     */
+    dispatch(event) {
+        event.dispatching = true;
+        event.target = this;
+        const path = [{ invocationTarget: this, shadowAdjustedTarget: this, rootOfClosedTree: false, slotInClosedTree: false }];
+        for (let parent = this.getTheParent(event); parent != null; parent = parent.getTheParent(event)) {
+            path.push({ invocationTarget: parent, shadowAdjustedTarget: null, rootOfClosedTree: false, slotInClosedTree: false });
+        }
+        event.path = path;
+        for (let index = path.length - 1; index >= 0; --index) {
+            const struct = path[index];
+            event.eventPhase = struct.shadowAdjustedTarget != null ? EventPhase.AT_TARGET : EventPhase.CAPTURING_PHASE;
+            invoke(struct, event, true);
+        }
+        for (let index = 0; index < path.length; ++index) {
+            const struct = path[index];
+            if (struct.shadowAdjustedTarget != null) {
+                event.eventPhase = EventPhase.AT_TARGET;
+            } else if (event.bubbles) {
+                event.eventPhase = EventPhase.BUBBLING_PHASE;
+            } else {
+                continue;
+            }
+            invoke(struct, event, false);
+        }
+        event.eventPhase = EventPhase.NONE;
+        event.currentTarget = null;
+        event.path = [];
+        event.dispatching = false;
+        event.stopPropagation = false;
+        event.stopImmediatePropagation = false;
+        return !event.canceled;
+    }
+}
+
+function invoke(struct, event, capturing) {
+    if (event.stopPropagation) {
+        return;
+    }
+    const target = struct.invocationTarget;
+    event.currentTarget = target;
+    // Listeners added during the dispatch are not invoked, listeners removed during the dispatch are skipped by their flag.
+    const listeners = [...target.eventListenerList];
+    if (listeners.length <= 0) {
+        return;
+    }
+    const platform = Platform.current();
+    const thisArg = platform.interfaceOf(target);
+    const args = [platform.interfaceOf(event)];
+    for (const listener of listeners) {
+        if (listener.removed || listener.type !== event.type || capturing !== listener.capture) {
+            continue;
+        }
+        if (listener.once) {
+            target.removeEventListener(listener);
+        }
+        if (listener.passive) {
+            event.inPassiveListener = true;
+        }
+        try {
+            callListener(listener.callback, thisArg, args);
+        } catch (exception) {
+            reportException(exception);
+        }
+        event.inPassiveListener = false;
+        if (event.stopImmediatePropagation) {
+            return;
+        }
+    }
+}
+
+function callListener(callback, thisArg, args) {
+    if (typeof callback === 'function') {
+        return Reflect.apply(callback, thisArg, args);
+    }
+    const handleEvent = callback.handleEvent;
+    if (typeof handleEvent !== 'function') {
+        throw new TypeError(`The provided callback is not a function and has no callable 'handleEvent' property.`);
+    }
+    return Reflect.apply(handleEvent, callback, args);
+}
+
+/**
+ * "Report an exception": the realm has no global object firing ErrorEvent yet, so the exception goes to the developer
+ * console, and the dispatch continues with the next listener.
+ */
+function reportException(exception) {
+    console.error('Uncaught', exception);
 }
 
 function convertToAbortSignal(value) {
@@ -97,8 +201,9 @@ class EventListenerOptions {
     constructor(options) {
         if (options === Object(options)) {
             this.capture = !!options.capture;
+        } else {
+            this.capture = !!options;
         }
-        this.capture = !!options;
     }
 }
 
@@ -214,9 +319,10 @@ export default function install(platform) {
                                 const platform = Platform.current();
                                 const realm = platform.getRealm();
                                 options = new realm.EventListenerOptions(options);
-                                this.eventListenerList.filter(
-                                    listener => listener.callback === callback && listener.type === type && listener.capture === options.capture
-                                ).forEach(this.removeEventListener, this);
+                                const listener = this.findEventListener(type, callback, options.capture);
+                                if (listener != null) {
+                                    this.removeEventListener(listener);
+                                }
                             }
                         )
                     )
@@ -245,7 +351,14 @@ export default function install(platform) {
                                         if (event.dispatching || !event.initialized) {
                                             platform.throw(realm.DOMException.create(messages.eventAlreadyDispatched()));
                                         }
-                                        // TODO: Continue dispatchEvent method
+                                        event.isTrusted = false;
+                                        // Listeners are user code, so they must run in locked state (see Platform.callUserFunction).
+                                        platform.enterLock();
+                                        try {
+                                            return this.dispatch(event);
+                                        } finally {
+                                            platform.leaveLock();
+                                        }
                                     }
                                 )
                             )
@@ -0,0 +1,96 @@
+import assert from 'node:assert';
+import { mock, test } from 'node:test';
+
+// The platform of the core package needs the full native extension. EventTarget only needs a realm to install into and the
+// interceptor chain, so the validating interceptors pass through and the methods of the prototype run on the implementation.
+const realm = Object.create(null);
+const platform = {
+    realm: Object.create(null),
+    getRealm: () => realm,
+    createInterface: () => function Interface() {},
+    createNativeFunction: (options, callee) => function (...args) {
+        return callee(platform, this, args, new.target);
+    },
+    interfaceOf: implementation => implementation,
+    enterLock() {},
+    leaveLock() {},
+    throw(error) {
+        throw error;
+    },
+    isThrown: () => false
+};
+const passThrough = (...args) => args.at(-1);
+mock.module('@dragiyski/web-platform-core', {
+    namedExports: {
+        Platform: { current: () => platform },
+        messages: Object.create(null),
+        constructorErrorMessageInterceptor: passThrough,
+        functionInterceptor: callee => (platform, thisArg, args) => Reflect.apply(callee, thisArg, args),
+        methodErrorMessageInterceptor: passThrough,
+        requireArgumentCountInterceptor: passThrough,
+        requireArgumentTypeInterceptor: passThrough,
+        returnValueInterfaceInterceptor: passThrough,
+        validateConstructorTargetInterceptor: passThrough,
+        validateThisImplementationInterceptor: passThrough
+    }
+});
+const { default: install } = await import('../src/EventTarget.js');
+install(platform);
+const { addEventListener, removeEventListener, dispatchEvent } = platform.realm.EventTarget.prototype;
+
+function createEvent(type) {
+    return { type, bubbles: false, initialized: true, dispatching: false, canceled: false, stopPropagation: false, stopImmediatePropagation: false };
+}
+
+test('a listener exception is reported and the dispatch continues', t => {
+    const report = t.mock.method(console, 'error', () => {});
+    const target = new realm.EventTarget();
+    const error = new Error('listener');
+    const calls = [];
+    addEventListener.call(target, 'test', () => {
+        calls.push(1);
+        throw error;
+    });
+    addEventListener.call(target, 'test', () => {
+        calls.push(2);
+    });
+    assert.strictEqual(dispatchEvent.call(target, createEvent('test')), true);
+    assert.deepStrictEqual(calls, [1, 2]);
+    assert.strictEqual(report.mock.callCount(), 1);
+    assert.strictEqual(report.mock.calls[0].arguments.at(-1), error);
+});
+
+test('a listener removed during the dispatch is not called', () => {
+    const target = new realm.EventTarget();
+    const calls = [];
+    const second = () => {
+        calls.push(2);
+    };
+    addEventListener.call(target, 'test', () => {
+        calls.push(1);
+        removeEventListener.call(target, 'test', second);
+    });
+    addEventListener.call(target, 'test', second);
+    dispatchEvent.call(target, createEvent('test'));
+    assert.deepStrictEqual(calls, [1]);
+    assert.strictEqual(target.eventListenerList.length, 1);
+});
+
+test('removeEventListener() matches the capture flag of the options', () => {
+    const target = new realm.EventTarget();
+    const listener = () => {};
+    addEventListener.call(target, 'test', listener, { capture: true });
+    removeEventListener.call(target, 'test', listener, { capture: false });
+    assert.strictEqual(target.eventListenerList.length, 1);
+    removeEventListener.call(target, 'test', listener, { capture: true });
+    assert.strictEqual(target.eventListenerList.length, 0);
+});
+
+test('EventListenerOptions reads capture from a dictionary', () => {
+    assert.strictEqual(new realm.EventListenerOptions({ capture: false }).capture, false);
+    assert.strictEqual(new realm.EventListenerOptions({ capture: 1 }).capture, true);
+    assert.strictEqual(new realm.EventListenerOptions({}).capture, false);
+    assert.strictEqual(new realm.EventListenerOptions(true).capture, true);
+    assert.strictEqual(new realm.EventListenerOptions(undefined).capture, false);
+    assert.strictEqual(new realm.AddEventListenerOptions({ capture: false, once: true }).capture, false);
+});